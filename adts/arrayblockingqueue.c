@@ -0,0 +1,428 @@
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * implementation for array-based, bounded, blocking FIFO queue
+ *
+ * the elements are kept in a circular buffer, as in ArrayQueue, that is
+ * grown on demand up to the capacity; one mutex guards the buffer, and
+ * producers and consumers wait on separate condition variables
+ *
+ * to avoid waking threads that have nothing to do, notEmpty is only
+ * signalled when the queue goes from empty to non-empty, and notFull only
+ * when it goes from full to non-full; a thread that was woken passes the
+ * signal on if, after its own operation, there is still work for another
+ * waiter, so a burst of n enqueues (or a drainTo() that frees n slots)
+ * wakes up to n waiters one after another without lost wakeups
+ */
+
+#include "ADTs/arrayblockingqueue.h"
+#include <stdlib.h>
+#include <limits.h>
+#include <pthread.h>
+#include <time.h>
+
+#define DEFAULT_BLOCKINGQUEUE_CAPACITY 50L
+
+typedef struct bq_data {
+    pthread_mutex_t lock;
+    pthread_cond_t notEmpty;
+    pthread_cond_t notFull;
+    long capacity;              /* LONG_MAX if unbounded */
+    long count;
+    long size;                  /* number of slots in buffer */
+    long in;
+    long out;
+    long takers;                /* threads waiting on notEmpty */
+    long putters;               /* threads waiting on notFull */
+    void **buffer;
+    void (*freeValue)(void *e);
+} BQData;
+
+static void purge(BQData *bqd) {
+    long i, n;
+
+    for (i = bqd->out, n = bqd->count; n > 0; i = (i + 1) % bqd->size, n--)
+        bqd->freeValue(bqd->buffer[i]);
+}
+
+/*
+ * computes the absolute CLOCK_MONOTONIC time `msecs' from now
+ */
+static void deadline(struct timespec *ts, long msecs) {
+    clock_gettime(CLOCK_MONOTONIC, ts);
+    ts->tv_sec += msecs / 1000;
+    ts->tv_nsec += (msecs % 1000) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+/*
+ * waits on `cv' until woken or, if `ts' is non-NULL, until the deadline
+ * passes; returns false if the deadline has passed
+ */
+static bool await(BQData *bqd, pthread_cond_t *cv, long *waiters,
+                  struct timespec *ts) {
+    int rc = 0;
+
+    (*waiters)++;
+    if (ts == NULL)
+        pthread_cond_wait(cv, &bqd->lock);
+    else
+        rc = pthread_cond_timedwait(cv, &bqd->lock, ts);
+    (*waiters)--;
+    return (rc == 0);
+}
+
+/*
+ * makes room for one more element; called with the lock held and
+ * count < capacity
+ */
+static bool grow(BQData *bqd) {
+    long nsize;
+    void **tmp;
+    long n, i, j;
+
+    if (bqd->count < bqd->size)
+        return true;
+    nsize = (bqd->size > bqd->capacity / 2) ? bqd->capacity : 2 * bqd->size;
+    tmp = (void **)malloc(nsize * sizeof(void *));
+    if (tmp == NULL)
+        return false;
+    for (i = bqd->out, j = 0, n = bqd->count; n > 0; i = (i + 1) % bqd->size) {
+        tmp[j++] = bqd->buffer[i];
+        n--;
+    }
+    free(bqd->buffer);
+    bqd->buffer = tmp;
+    bqd->size = nsize;
+    bqd->out = 0L;
+    bqd->in = bqd->count;
+    return true;
+}
+
+/*
+ * removes the head element; called with the lock held and count > 0
+ */
+static void *take(BQData *bqd) {
+    void *element = bqd->buffer[bqd->out];
+
+    bqd->out = (bqd->out + 1) % bqd->size;
+    if (bqd->count-- == bqd->capacity && bqd->putters > 0)
+        pthread_cond_signal(&bqd->notFull);
+    return element;
+}
+
+static bool put(BQData *bqd, void *element, long msecs) {
+    struct timespec ts;
+    bool waited = false;
+    bool status;
+
+    pthread_mutex_lock(&bqd->lock);
+    if (bqd->count == bqd->capacity && msecs != 0L) {
+        if (msecs > 0L)
+            deadline(&ts, msecs);
+        waited = true;
+        while (bqd->count == bqd->capacity)
+            if (! await(bqd, &bqd->notFull, &bqd->putters,
+                        (msecs > 0L) ? &ts : NULL))
+                break;
+    }
+    status = (bqd->count < bqd->capacity && grow(bqd));
+    if (status) {
+        bqd->buffer[bqd->in] = element;
+        bqd->in = (bqd->in + 1) % bqd->size;
+        if (bqd->count++ == 0L && bqd->takers > 0)
+            pthread_cond_signal(&bqd->notEmpty);
+    }
+    if (waited && bqd->count < bqd->capacity && bqd->putters > 0)
+        pthread_cond_signal(&bqd->notFull);     /* pass it on */
+    pthread_mutex_unlock(&bqd->lock);
+    return status;
+}
+
+static bool get(BQData *bqd, void **element, long msecs) {
+    struct timespec ts;
+    bool waited = false;
+    bool status;
+
+    pthread_mutex_lock(&bqd->lock);
+    if (bqd->count == 0L && msecs != 0L) {
+        if (msecs > 0L)
+            deadline(&ts, msecs);
+        waited = true;
+        while (bqd->count == 0L)
+            if (! await(bqd, &bqd->notEmpty, &bqd->takers,
+                        (msecs > 0L) ? &ts : NULL))
+                break;
+    }
+    status = (bqd->count > 0L);
+    if (status)
+        *element = take(bqd);
+    if (waited && bqd->count > 0L && bqd->takers > 0)
+        pthread_cond_signal(&bqd->notEmpty);    /* pass it on */
+    pthread_mutex_unlock(&bqd->lock);
+    return status;
+}
+
+static void bq_destroy(const BlockingQueue *bq) {
+    BQData *bqd = (BQData *)bq->self;
+
+    purge(bqd);
+    pthread_cond_destroy(&bqd->notFull);
+    pthread_cond_destroy(&bqd->notEmpty);
+    pthread_mutex_destroy(&bqd->lock);
+    free(bqd->buffer);
+    free(bqd);
+    free((void *)bq);
+}
+
+static void bq_clear(const BlockingQueue *bq) {
+    BQData *bqd = (BQData *)bq->self;
+
+    pthread_mutex_lock(&bqd->lock);
+    purge(bqd);
+    if (bqd->count == bqd->capacity && bqd->putters > 0)
+        pthread_cond_signal(&bqd->notFull);
+    bqd->count = 0L;
+    bqd->in = 0L;
+    bqd->out = 0L;
+    pthread_mutex_unlock(&bqd->lock);
+}
+
+static bool bq_enqueue(const BlockingQueue *bq, void *element) {
+    return put((BQData *)bq->self, element, -1L);
+}
+
+static bool bq_timedEnqueue(const BlockingQueue *bq, void *element,
+                            long msecs) {
+    return put((BQData *)bq->self, element, (msecs < 0L) ? 0L : msecs);
+}
+
+static bool bq_dequeue(const BlockingQueue *bq, void **element) {
+    return get((BQData *)bq->self, element, -1L);
+}
+
+static bool bq_timedDequeue(const BlockingQueue *bq, void **element,
+                            long msecs) {
+    return get((BQData *)bq->self, element, (msecs < 0L) ? 0L : msecs);
+}
+
+static long bq_drainTo(const BlockingQueue *bq, const Queue *q, long max) {
+    BQData *bqd = (BQData *)bq->self;
+    long n = 0L;
+
+    pthread_mutex_lock(&bqd->lock);
+    while (bqd->count > 0L && (max <= 0L || n < max)) {
+        if (! q->enqueue(q, bqd->buffer[bqd->out]))
+            break;
+        (void)take(bqd);
+        n++;
+    }
+    pthread_mutex_unlock(&bqd->lock);
+    return n;
+}
+
+static bool bq_front(const BlockingQueue *bq, void **element) {
+    BQData *bqd = (BQData *)bq->self;
+    bool status;
+
+    pthread_mutex_lock(&bqd->lock);
+    status = (bqd->count > 0L);
+    if (status)
+        *element = bqd->buffer[bqd->out];
+    pthread_mutex_unlock(&bqd->lock);
+    return status;
+}
+
+static long bq_size(const BlockingQueue *bq) {
+    BQData *bqd = (BQData *)bq->self;
+    long n;
+
+    pthread_mutex_lock(&bqd->lock);
+    n = bqd->count;
+    pthread_mutex_unlock(&bqd->lock);
+    return n;
+}
+
+static long bq_remainingCapacity(const BlockingQueue *bq) {
+    BQData *bqd = (BQData *)bq->self;
+    long n = -1L;
+
+    pthread_mutex_lock(&bqd->lock);
+    if (bqd->capacity != LONG_MAX)
+        n = bqd->capacity - bqd->count;
+    pthread_mutex_unlock(&bqd->lock);
+    return n;
+}
+
+static bool bq_isEmpty(const BlockingQueue *bq) {
+    return (bq_size(bq) == 0L);
+}
+
+/*
+ * copies the elements, head to tail; called with the lock held
+ */
+static void **genArray(BQData *bqd) {
+    void **tmp = NULL;
+
+    if (bqd->count > 0L) {
+        tmp = (void **)malloc(bqd->count * sizeof(void *));
+        if (tmp != NULL) {
+            long i, j, n;
+
+            n = bqd->count;
+            for (i = bqd->out, j = 0; n > 0; i = (i+1) % bqd->size, j++, n--)
+                tmp[j] = bqd->buffer[i];
+        }
+    }
+    return tmp;
+}
+
+static void **bq_toArray(const BlockingQueue *bq, long *len) {
+    BQData *bqd = (BQData *)bq->self;
+    void **tmp;
+
+    pthread_mutex_lock(&bqd->lock);
+    tmp = genArray(bqd);
+    if (tmp != NULL)
+        *len = bqd->count;
+    pthread_mutex_unlock(&bqd->lock);
+    return tmp;
+}
+
+static const Iterator *bq_itCreate(const BlockingQueue *bq) {
+    const Iterator *it = NULL;
+    long len;
+    void **tmp = bq_toArray(bq, &len);
+
+    if (tmp != NULL) {
+        it = Iterator_create(len, tmp);
+        if (it == NULL)
+            free(tmp);
+    }
+    return it;
+}
+
+static const BlockingQueue *bq_create(const BlockingQueue *bq);
+
+static BlockingQueue template = {
+    NULL, bq_create, bq_destroy, bq_clear, bq_enqueue, bq_timedEnqueue,
+    bq_dequeue, bq_timedDequeue, bq_drainTo, bq_front, bq_size,
+    bq_remainingCapacity, bq_isEmpty, bq_toArray, bq_itCreate
+};
+
+/*
+ * helper function to initialize the lock and condition variables; the
+ * condition variables use CLOCK_MONOTONIC so that timed waits are not
+ * disturbed by changes to the time of day
+ */
+static bool initSync(BQData *bqd) {
+    pthread_condattr_t attr;
+    bool status = false;
+
+    if (pthread_condattr_init(&attr) != 0)
+        return false;
+    if (pthread_condattr_setclock(&attr, CLOCK_MONOTONIC) == 0 &&
+        pthread_mutex_init(&bqd->lock, NULL) == 0) {
+        if (pthread_cond_init(&bqd->notEmpty, &attr) == 0) {
+            if (pthread_cond_init(&bqd->notFull, &attr) == 0)
+                status = true;
+            else
+                pthread_cond_destroy(&bqd->notEmpty);
+        }
+        if (! status)
+            pthread_mutex_destroy(&bqd->lock);
+    }
+    pthread_condattr_destroy(&attr);
+    return status;
+}
+
+/*
+ * helper function to create a new BlockingQueue dispatch table
+ */
+static const BlockingQueue *newBlockingQueue(long capacity,
+                                             void (*freeValue)(void *e)) {
+    BlockingQueue *bq = (BlockingQueue *)malloc(sizeof(BlockingQueue));
+
+    if (bq != NULL) {
+        BQData *bqd = (BQData *)malloc(sizeof(BQData));
+
+        if (bqd != NULL) {
+            long cap = (capacity <= 0L) ? LONG_MAX : capacity;
+            long size = (cap < DEFAULT_BLOCKINGQUEUE_CAPACITY) ?
+                        cap : DEFAULT_BLOCKINGQUEUE_CAPACITY;
+            void **tmp = (void **)malloc(size * sizeof(void *));
+
+            if (tmp != NULL && initSync(bqd)) {
+                bqd->capacity = cap;
+                bqd->count = 0L;
+                bqd->size = size;
+                bqd->in = 0L;
+                bqd->out = 0L;
+                bqd->takers = 0L;
+                bqd->putters = 0L;
+                bqd->buffer = tmp;
+                bqd->freeValue = freeValue;
+                *bq = template;
+                bq->self = bqd;
+            } else {
+                free(tmp);
+                free(bqd);
+                free(bq);
+                bq = NULL;
+            }
+        } else {
+            free(bq);
+            bq = NULL;
+        }
+    }
+    return bq;
+}
+
+static const BlockingQueue *bq_create(const BlockingQueue *bq) {
+    BQData *bqd = (BQData *)bq->self;
+    long cap = (bqd->capacity == LONG_MAX) ? 0L : bqd->capacity;
+
+    return newBlockingQueue(cap, bqd->freeValue);
+}
+
+const BlockingQueue *ArrayBlockingQueue(long capacity,
+                                        void (*freeValue)(void *e)) {
+    return newBlockingQueue(capacity, freeValue);
+}
+
+const BlockingQueue *BlockingQueue_create(long capacity,
+                                          void (*freeValue)(void *e)) {
+    return newBlockingQueue(capacity, freeValue);
+}
@@ -0,0 +1,54 @@
+#ifndef _ARRAYBLOCKINGQUEUE_H_
+#define _ARRAYBLOCKINGQUEUE_H_
+
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * constructor for array-based blocking queue
+ */
+
+#include "ADTs/ADTdefs.h"
+#include "ADTs/blockingqueue.h"
+
+/*
+ * create a blocking queue that holds at most `capacity' elements; if
+ * capacity is <= 0L, the queue is unbounded
+ *
+ * freeValue is a function pointer that will be called by
+ * destroy() and clear() on each entry in the BlockingQueue
+ *
+ * returns a pointer to the queue, or NULL if there are malloc() errors
+ */
+const BlockingQueue *ArrayBlockingQueue(long capacity,
+                                        void (*freeValue)(void *e));
+
+#endif /* _ARRAYBLOCKINGQUEUE_H_ */
@@ -36,14 +36,7 @@
 #include "ADTs/arraydeque.h"
 #include <stdlib.h>
 
-typedef struct d_data {
-    long size;
-    long count;
-    long head;
-    long tail;
-    void **buffer;
-    void (*freeValue)(void *e);
-} DData;
+typedef struct arraydeque_data DData;     /* declared in arraydeque.h */
 
 /*
  * traverses deque, calling freeValue on each element
@@ -49,4 +49,109 @@
  */
 const Deque *ArrayDeque(long capacity, void (*freeValue)(void *e));
 
+/*
+ * direct-call API
+ *
+ * the functions below behave exactly like the dispatch table methods of
+ * the same names, but may only be applied to a deque created by
+ * ArrayDeque() or Deque_create(); they are defined inline, so that a call
+ * site that knows the concrete type pays neither an indirect call nor,
+ * on the fast path, any call at all
+ *
+ * generic code should continue to use the dispatch table
+ */
+
+/*
+ * the private data of an array-based deque; declared here only for the
+ * inline functions below, and not to be used directly
+ */
+struct arraydeque_data {
+    long size;
+    long count;
+    long head;
+    long tail;
+    void **buffer;
+    void (*freeValue)(void *e);
+};
+
+/*
+ * inserts in place if there is room; otherwise insertFirst() resizes the
+ * buffer
+ */
+static inline bool ArrayDeque_insertFirst(const Deque *d, void *element) {
+    struct arraydeque_data *dd = (struct arraydeque_data *)d->self;
+
+    if (dd->count == 0L || dd->count == dd->size)
+        return d->insertFirst(d, element);
+    dd->head = (dd->head == 0L) ? dd->size - 1 : dd->head - 1;
+    dd->buffer[dd->head] = element;
+    dd->count++;
+    return true;
+}
+
+/*
+ * inserts in place if there is room; otherwise insertLast() resizes the
+ * buffer
+ */
+static inline bool ArrayDeque_insertLast(const Deque *d, void *element) {
+    struct arraydeque_data *dd = (struct arraydeque_data *)d->self;
+
+    if (dd->count == 0L || dd->count == dd->size)
+        return d->insertLast(d, element);
+    dd->tail = (dd->tail + 1 == dd->size) ? 0L : dd->tail + 1;
+    dd->buffer[dd->tail] = element;
+    dd->count++;
+    return true;
+}
+
+static inline bool ArrayDeque_first(const Deque *d, void **element) {
+    struct arraydeque_data *dd = (struct arraydeque_data *)d->self;
+    bool status = (dd->count > 0L);
+
+    if (status)
+        *element = dd->buffer[dd->head];
+    return status;
+}
+
+static inline bool ArrayDeque_last(const Deque *d, void **element) {
+    struct arraydeque_data *dd = (struct arraydeque_data *)d->self;
+    bool status = (dd->count > 0L);
+
+    if (status)
+        *element = dd->buffer[dd->tail];
+    return status;
+}
+
+static inline bool ArrayDeque_removeFirst(const Deque *d, void **element) {
+    struct arraydeque_data *dd = (struct arraydeque_data *)d->self;
+    bool status = (dd->count > 0L);
+
+    if (status) {
+        *element = dd->buffer[dd->head];
+        dd->head = (dd->head + 1 == dd->size) ? 0L : dd->head + 1;
+        dd->count--;
+    }
+    return status;
+}
+
+static inline bool ArrayDeque_removeLast(const Deque *d, void **element) {
+    struct arraydeque_data *dd = (struct arraydeque_data *)d->self;
+    bool status = (dd->count > 0L);
+
+    if (status) {
+        *element = dd->buffer[dd->tail];
+        dd->tail = (dd->tail == 0L) ? dd->size - 1 : dd->tail - 1;
+        dd->count--;
+    }
+    return status;
+}
+
+static inline long ArrayDeque_size(const Deque *d) {
+    return ((struct arraydeque_data *)d->self)->count;
+}
+
+static inline bool ArrayDeque_isEmpty(const Deque *d) {
+    return (((struct arraydeque_data *)d->self)->count == 0L);
+}
+
 #endif /* _ARRAYDEQUE_H_ */
@@ -34,14 +34,10 @@
  */
 
 #include "ADTs/arraylist.h"
+#include "ADTs/parallel.h"
 #include <stdlib.h>
 
-typedef struct al_data {
-    long capacity;
-    long size;
-    void **theArray;
-    void (*freeValue)(void *e);
-} AlData;
+typedef struct arraylist_data AlData;      /* declared in arraylist.h */
 
 /*
  * traverses arraylist, calling freeValue on each element
@@ -230,10 +226,65 @@ static const Iterator *al_itCreate(const ArrayList *al) {
     return it;
 }
 
+static void **al_span(const ArrayList *al, long *len) {
+    AlData *ald = (AlData *)al->self;
+
+    *len = ald->size;
+    return ald->theArray;
+}
+
+static void al_forEach(const ArrayList *al, const ThreadPool *tp,
+                       void (*fxn)(void *e, void *arg), void *arg) {
+    AlData *ald = (AlData *)al->self;
+
+    Parallel_forEach(tp, ald->theArray, ald->size, fxn, arg);
+}
+
+static const ArrayList *al_parallelMap(const ArrayList *al,
+                                       const ThreadPool *tp,
+                                       void *(*fxn)(void *e, void *arg),
+                                       void *arg, void (*freeValue)(void *e)) {
+    AlData *ald = (AlData *)al->self;
+    const ArrayList *nal = ArrayList_create(ald->size, freeValue);
+
+    if (nal != NULL) {
+        AlData *nald = (AlData *)nal->self;
+
+        Parallel_map(tp, ald->theArray, nald->theArray, ald->size, fxn, arg);
+        nald->size = ald->size;
+    }
+    return nal;
+}
+
+static const ArrayList *al_filter(const ArrayList *al, const ThreadPool *tp,
+                                  bool (*pred)(void *e, void *arg),
+                                  void *arg) {
+    AlData *ald = (AlData *)al->self;
+    const ArrayList *nal = ArrayList_create(ald->size, doNothing);
+
+    if (nal != NULL) {
+        AlData *nald = (AlData *)nal->self;
+
+        nald->size = Parallel_filter(tp, ald->theArray, nald->theArray,
+                                     ald->size, pred, arg);
+    }
+    return nal;
+}
+
+static void *al_reduce(const ArrayList *al, const ThreadPool *tp,
+                       void *identity,
+                       void *(*combine)(void *x, void *y, void *arg),
+                       void *arg) {
+    AlData *ald = (AlData *)al->self;
+
+    return Parallel_reduce(tp, ald->theArray, ald->size, identity, combine,
+                           arg);
+}
+
 static ArrayList template = {
     NULL, al_destroy, al_add, al_clear, al_ensureCapacity, al_get, al_insert,
     al_isEmpty, al_remove, al_set, al_size, al_toArray, al_trimToSize,
-    al_itCreate
+    al_itCreate, al_span, al_forEach, al_parallelMap, al_filter, al_reduce
 };
 
 const ArrayList *ArrayList_create(long capacity, void (*freeValue)(void *e)) {
@@ -34,6 +34,7 @@
 
 #include "ADTs/ADTdefs.h"
 #include "ADTs/iterator.h"                   /* needed for factory method */
+#include "ADTs/threadpool.h"                 /* needed for parallel methods */
 
 /* interface definition for generic arraylist implementation
  *
@@ -149,6 +150,114 @@ struct arraylist {
  * returns pointer to the Iterator or NULL if failure
  */
     const Iterator *(*itCreate)(const ArrayList *al);
+
+/* returns the arraylist's backing array, holding the elements in order,
+ * and the number of elements in `*len'; this is not a copy, so loops over
+ * it run without a call per element
+ *
+ * the pointer is only valid until the arraylist is next modified, and
+ * the elements must not be modified through it
+ */
+    void **(*span)(const ArrayList *al, long *len);
+
+/* the following methods process the elements in place, in parallel on
+ * the thread pool `tp', or serially if `tp' is NULL; see parallel.h
+ *
+ * the arraylist must not be modified while they run
+ */
+
+/* calls fxn(e, arg) on each element of the arraylist */
+    void (*forEach)(const ArrayList *al, const ThreadPool *tp,
+                    void (*fxn)(void *e, void *arg), void *arg);
+
+/* creates a new arraylist whose `i'th element is fxn(e, arg), where `e' is
+ * the `i'th element of this arraylist; freeValue is used by the new list
+ *
+ * returns pointer to the new arraylist, or NULL if malloc failure
+ */
+    const ArrayList *(*parallelMap)(const ArrayList *al, const ThreadPool *tp,
+                                    void *(*fxn)(void *e, void *arg),
+                                    void *arg, void (*freeValue)(void *e));
+
+/* creates a new arraylist holding, in order, the elements of this
+ * arraylist for which pred(e, arg) is true; the elements remain the
+ * responsibility of this arraylist, so the new list uses doNothing
+ *
+ * returns pointer to the new arraylist, or NULL if malloc failure
+ */
+    const ArrayList *(*filter)(const ArrayList *al, const ThreadPool *tp,
+                               bool (*pred)(void *e, void *arg), void *arg);
+
+/* combines the elements of the arraylist, starting from `identity', with
+ * the associative function combine(x, y, arg); Parallel_sumLong,
+ * Parallel_minLong and Parallel_maxLong are reduced without calls
+ *
+ * returns the result, which is `identity' if the arraylist is empty
+ */
+    void *(*reduce)(const ArrayList *al, const ThreadPool *tp, void *identity,
+                    void *(*combine)(void *x, void *y, void *arg), void *arg);
 };
 
+/* direct-call API
+ *
+ * the functions below behave exactly like the dispatch table methods of
+ * the same names, but call the implementation directly; the simplest are
+ * defined inline, so that a call site pays neither an indirect call nor,
+ * on the fast path, any call at all
+ *
+ * generic code should continue to use the dispatch table
+ */
+
+/* the private data of an arraylist; declared here only for the inline
+ * functions below, and not to be used directly
+ */
+struct arraylist_data {
+    long capacity;
+    long size;
+    void **theArray;
+    void (*freeValue)(void *e);
+};
+
+static inline bool ArrayList_get(const ArrayList *al, long index,
+                                 void **element) {
+    struct arraylist_data *ald = (struct arraylist_data *)al->self;
+    bool status = (index >= 0L && index < ald->size);
+
+    if (status)
+        *element = ald->theArray[index];
+    return status;
+}
+
+static inline bool ArrayList_set(const ArrayList *al, long index,
+                                 void *element) {
+    struct arraylist_data *ald = (struct arraylist_data *)al->self;
+    bool status = (index >= 0L && index < ald->size);
+
+    if (status) {
+        void *previous = ald->theArray[index];
+        ald->theArray[index] = element;
+        ald->freeValue(previous);
+    }
+    return status;
+}
+
+/* appends in place if there is room; otherwise add() resizes the array */
+static inline bool ArrayList_add(const ArrayList *al, void *element) {
+    struct arraylist_data *ald = (struct arraylist_data *)al->self;
+
+    if (ald->size < ald->capacity) {
+        ald->theArray[ald->size++] = element;
+        return true;
+    }
+    return al->add(al, element);
+}
+
+static inline long ArrayList_size(const ArrayList *al) {
+    return ((struct arraylist_data *)al->self)->size;
+}
+
+static inline bool ArrayList_isEmpty(const ArrayList *al) {
+    return (((struct arraylist_data *)al->self)->size == 0L);
+}
+
 #endif /* _ARRAYLIST_H_ */
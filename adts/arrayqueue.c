@@ -36,14 +36,7 @@
 #include "ADTs/arrayqueue.h"
 #include <stdlib.h>
 
-typedef struct q_data {
-    long count;
-    long size;
-    int in;
-    int out;
-    void **buffer;
-    void (*freeValue)(void *e);
-} QData;
+typedef struct arrayqueue_data QData;     /* declared in arrayqueue.h */
 
 static void purge(QData *qd) {
     int i, n;
@@ -229,3 +222,20 @@ const Queue *ArrayQueue(long capacity, void (*freeValue)(void *e)) {
 const Queue *Queue_create(void (*freeValue)(void *e)) {
     return newQueue(DEFAULT_QUEUE_CAPACITY, freeValue);
 }
+
+bool ArrayQueue_spans(const Queue *q, void ***first, long *firstLen,
+                      void ***second, long *secondLen) {
+    QData *qd = (QData *)q->self;
+    long n;
+
+    if (q->enqueue != q_enqueue)
+        return false;
+    n = qd->size - qd->out;             /* slots from out to the end */
+    if (n > qd->count)
+        n = qd->count;
+    *first = qd->buffer + qd->out;
+    *firstLen = n;
+    *second = qd->buffer;
+    *secondLen = qd->count - n;
+    return true;
+}
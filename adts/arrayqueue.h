@@ -51,4 +51,92 @@
  */
 const Queue *ArrayQueue(long capacity, void (*freeValue)(void *e));
 
+/*
+ * returns the backing array of an array-based queue as two spans: the
+ * elements, from head to tail, are (*first)[0 .. *firstLen-1] followed by
+ * (*second)[0 .. *secondLen-1]; the second span is only non-empty when the
+ * elements wrap around the end of the circular buffer
+ *
+ * the spans are not copies, so loops over them run without a call per
+ * element; they are only valid until the queue is next modified, and the
+ * elements must not be modified through them
+ *
+ * returns true if successful, false if `q' was not created by ArrayQueue()
+ * or Queue_create()
+ */
+bool ArrayQueue_spans(const Queue *q, void ***first, long *firstLen,
+                      void ***second, long *secondLen);
+
+/*
+ * direct-call API
+ *
+ * the functions below behave exactly like the dispatch table methods of
+ * the same names, but may only be applied to a queue created by
+ * ArrayQueue() or Queue_create(); they are defined inline, so that a call
+ * site that knows the concrete type pays neither an indirect call nor,
+ * on the fast path, any call at all
+ *
+ * generic code should continue to use the dispatch table
+ */
+
+/*
+ * the private data of an array-based queue; declared here only for the
+ * inline functions below, and not to be used directly
+ */
+struct arrayqueue_data {
+    long count;
+    long size;
+    int in;
+    int out;
+    void **buffer;
+    void (*freeValue)(void *e);
+};
+
+/*
+ * enqueues in place if there is room; otherwise enqueue() resizes the
+ * buffer
+ */
+static inline bool ArrayQueue_enqueue(const Queue *q, void *element) {
+    struct arrayqueue_data *qd = (struct arrayqueue_data *)q->self;
+
+    if (qd->count < qd->size) {
+        int i = qd->in;
+        qd->buffer[i] = element;
+        qd->in = (i + 1) % qd->size;
+        qd->count++;
+        return true;
+    }
+    return q->enqueue(q, element);
+}
+
+static inline bool ArrayQueue_dequeue(const Queue *q, void **element) {
+    struct arrayqueue_data *qd = (struct arrayqueue_data *)q->self;
+    bool status = (qd->count > 0L);
+
+    if (status) {
+        int i = qd->out;
+        *element = qd->buffer[i];
+        qd->out = (i + 1) % qd->size;
+        qd->count--;
+    }
+    return status;
+}
+
+static inline bool ArrayQueue_front(const Queue *q, void **element) {
+    struct arrayqueue_data *qd = (struct arrayqueue_data *)q->self;
+    bool status = (qd->count > 0L);
+
+    if (status)
+        *element = qd->buffer[qd->out];
+    return status;
+}
+
+static inline long ArrayQueue_size(const Queue *q) {
+    return ((struct arrayqueue_data *)q->self)->count;
+}
+
+static inline bool ArrayQueue_isEmpty(const Queue *q) {
+    return (((struct arrayqueue_data *)q->self)->count == 0L);
+}
+
 #endif /* _ARRAYQUEUE_H_ */
@@ -36,12 +36,7 @@
 #include "ADTs/arraystack.h"
 #include <stdlib.h>
 
-typedef struct st_data {
-    long capacity;
-    long next;
-    void **theArray;
-    void (*freeValue)(void *e);
-} StData;
+typedef struct arraystack_data StData;    /* declared in arraystack.h */
 
 /*
  * local function - traverses stack, applying user-supplied function
@@ -218,3 +213,12 @@ const Stack *ArrayStack(long capacity, void (*freeValue)(void *e)) {
 const Stack *Stack_create(void (*freeValue)(void *e)) {
     return newStack(DEFAULT_STACK_CAPACITY, freeValue);
 }
+
+void **ArrayStack_span(const Stack *st, long *len) {
+    StData *std = (StData *)st->self;
+
+    if (st->push != st_push)
+        return NULL;
+    *len = std->next;
+    return std->theArray;
+}
@@ -54,4 +54,79 @@
  */
 const Stack *ArrayStack(long capacity, void (*freeValue)(void *e));
 
+/*
+ * returns the backing array of an array-based stack, holding the elements
+ * from the bottom of the stack to the top, and the number of elements in
+ * `*len'; this is not a copy, so loops over it run without a call per
+ * element
+ *
+ * the pointer is only valid until the stack is next modified, and the
+ * elements must not be modified through it
+ *
+ * returns NULL if `st' was not created by ArrayStack() or Stack_create()
+ */
+void **ArrayStack_span(const Stack *st, long *len);
+
+/*
+ * direct-call API
+ *
+ * the functions below behave exactly like the dispatch table methods of
+ * the same names, but may only be applied to a stack created by
+ * ArrayStack() or Stack_create(); they are defined inline, so that a call
+ * site that knows the concrete type pays neither an indirect call nor,
+ * on the fast path, any call at all
+ *
+ * generic code should continue to use the dispatch table
+ */
+
+/*
+ * the private data of an array-based stack; declared here only for the
+ * inline functions below, and not to be used directly
+ */
+struct arraystack_data {
+    long capacity;
+    long next;
+    void **theArray;
+    void (*freeValue)(void *e);
+};
+
+/*
+ * pushes in place if there is room; otherwise push() resizes the array
+ */
+static inline bool ArrayStack_push(const Stack *st, void *element) {
+    struct arraystack_data *std = (struct arraystack_data *)st->self;
+
+    if (std->next < std->capacity) {
+        std->theArray[std->next++] = element;
+        return true;
+    }
+    return st->push(st, element);
+}
+
+static inline bool ArrayStack_pop(const Stack *st, void **element) {
+    struct arraystack_data *std = (struct arraystack_data *)st->self;
+    bool status = (std->next > 0L);
+
+    if (status)
+        *element = std->theArray[--std->next];
+    return status;
+}
+
+static inline bool ArrayStack_peek(const Stack *st, void **element) {
+    struct arraystack_data *std = (struct arraystack_data *)st->self;
+    bool status = (std->next > 0L);
+
+    if (status)
+        *element = std->theArray[std->next - 1];
+    return status;
+}
+
+static inline long ArrayStack_size(const Stack *st) {
+    return ((struct arraystack_data *)st->self)->next;
+}
+
+static inline bool ArrayStack_isEmpty(const Stack *st) {
+    return (((struct arraystack_data *)st->self)->next == 0L);
+}
+
 #endif /* _ARRAYSTACK_H_ */
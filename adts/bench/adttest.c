@@ -0,0 +1,1244 @@
+/*
+ * behavioural tests for the concurrent and bounded ADTs, and the CSKMaps
+ *
+ * each test number given on the command line is run in turn, and prints
+ * "Test ... success" or "Test ... failure"; the benchmarks in this
+ * directory measure the same ADTs, but only check their results in bulk
+ */
+
+#include "ADTs/arrayblockingqueue.h"
+#include "ADTs/arrayqueue.h"
+#include "ADTs/countmin.h"
+#include "ADTs/epoch.h"
+#include "ADTs/hashcache.h"
+#include "ADTs/hashcskmap.h"
+#include "ADTs/hyperloglog.h"
+#include "ADTs/lockfreestack.h"
+#include "ADTs/lsmstore.h"
+#include "ADTs/multiqueue.h"
+#include "ADTs/parallel.h"
+#include "ADTs/spacesaving.h"
+#include "ADTs/threadpool.h"
+#include "ADTs/ttlcskmap.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#define USAGE "usage: %s test# . . .\n"
+#define NTHREADS 4
+
+static void flagFree(void *p) {
+    *(bool *)p = true;
+}
+
+/*
+ * retires `n' dummy objects, in critical sections of 64 each, so that
+ * the epoch advances
+ */
+static void churn(long n) {
+    long i;
+
+    for (i = 0L; i < n; i++) {
+        if (i % 64L == 0L)
+            Epoch_enter();
+        Epoch_retire(NULL, doNothing);
+        if (i % 64L == 63L || i == n - 1L)
+            Epoch_exit();
+    }
+}
+
+typedef struct pinned {         /* a thread held in a critical section */
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int stage;                  /* 1 once inside, 2 when told to leave */
+} Pinned;
+
+static void *pin(void *arg) {
+    Pinned *p = (Pinned *)arg;
+
+    Epoch_enter();
+    pthread_mutex_lock(&p->lock);
+    p->stage = 1;
+    pthread_cond_broadcast(&p->cond);
+    while (p->stage != 2)
+        pthread_cond_wait(&p->cond, &p->lock);
+    pthread_mutex_unlock(&p->lock);
+    Epoch_exit();
+    return NULL;
+}
+
+typedef struct pusher {
+    pthread_t tid;
+    const Stack *st;
+    long first;                 /* pushes first .. first+n-1 */
+    long n;
+    long popped;                /* sum of the values it popped */
+} Pusher;
+
+static void *pushPop(void *arg) {
+    Pusher *w = (Pusher *)arg;
+    long i;
+    void *v;
+
+    for (i = 0L; i < w->n; i++) {
+        (void)w->st->push(w->st, ADT_VALUE(w->first + i));
+        if (i % 3L != 0L && w->st->pop(w->st, &v))
+            w->popped += (long)v;
+    }
+    return NULL;
+}
+
+typedef struct mqWorker {
+    pthread_t tid;
+    const PrioQueue *pq;
+    const PrioQueue *other;     /* for merger() */
+    long first;                 /* inserts first .. first+n-1 */
+    long n;
+    long removed;               /* sum of the values it removed */
+} MQWorker;
+
+static void *insertRemove(void *arg) {
+    MQWorker *w = (MQWorker *)arg;
+    long i;
+    void *p, *v;
+
+    for (i = 0L; i < w->n; i++) {
+        (void)w->pq->insert(w->pq, ADT_VALUE(w->first + i),
+                            ADT_VALUE(w->first + i));
+        if (i % 2L == 1L && w->pq->removeMin(w->pq, &p, &v))
+            w->removed += (long)v;
+    }
+    return NULL;
+}
+
+static void *merger(void *arg) {
+    MQWorker *w = (MQWorker *)arg;
+    long i;
+
+    for (i = 0L; i < w->n; i++)
+        (void)w->pq->merge(w->pq, w->other);
+    return NULL;
+}
+
+static const ThreadPool *pool;
+
+/*
+ * fib(n), with fib(n-1) submitted to the pool and waited for, so that
+ * every worker may be waiting in get() at once
+ */
+static void *fib(void *arg) {
+    long n = (long)arg;
+    const Future *f;
+    void *a, *b;
+
+    if (n < 2L)
+        return arg;
+    if ((f = pool->submit(pool, fib, ADT_VALUE(n - 1L))) == NULL)
+        a = fib(ADT_VALUE(n - 1L));
+    b = fib(ADT_VALUE(n - 2L));
+    if (f != NULL) {
+        (void)f->get(f, &a);
+        f->destroy(f);
+    }
+    return ADT_VALUE((long)a + (long)b);
+}
+
+static void visit(long lo, long hi, void *arg) {
+    atomic_long *visits = (atomic_long *)arg;
+
+    for (; lo < hi; lo++)
+        atomic_fetch_add(&visits[lo], 1L);
+}
+
+static void bump(void *arg) {
+    atomic_fetch_add((atomic_long *)arg, 1L);
+}
+
+static long keyCost(void *k, void *v) {
+    (void)v;
+    return (long)k % 4L;                /* a quarter of the keys cost 0 */
+}
+
+static long fakeTime;
+
+static long fakeClock(void) {
+    return fakeTime;
+}
+
+#define LSM_KEYS 4000L
+
+/*
+ * writes rounds 0 .. rounds-1 of keys k in [first, LSM_KEYS) with step
+ * `step'; key k ends up removed if k % 7 == 0, else with value "v<k>-<r>"
+ * for the last round r
+ */
+static bool lsmWrite(const LSMStore *s, long first, long step, int rounds) {
+    char key[32], value[64];
+    bool status = true;
+    long k;
+    int r;
+
+    for (r = 0; r < rounds; r++)
+        for (k = first; k < LSM_KEYS; k += step) {
+            sprintf(key, "key%08ld", k);
+            sprintf(value, "v%ld-%d", k, r);
+            status &= s->put(s, key, value);
+            if (r == rounds - 1 && k % 7L == 0L)
+                status &= s->remove(s, key);
+        }
+    return status;
+}
+
+/*
+ * returns the number of keys whose get() disagrees with lsmWrite()
+ */
+static long lsmCheck(const LSMStore *s, int rounds) {
+    char key[32], value[64], *v;
+    long k, bad = 0L;
+
+    for (k = 0L; k < LSM_KEYS + 100L; k++) {
+        bool want = (k < LSM_KEYS && k % 7L != 0L), got;
+
+        sprintf(key, "key%08ld", k);
+        sprintf(value, "v%ld-%d", k, rounds - 1);
+        got = s->get(s, key, &v);
+        if (got != want || (got && strcmp(v, value) != 0))
+            bad++;
+        if (got)
+            free(v);
+    }
+    return bad;
+}
+
+typedef struct lsmWriter {
+    pthread_t tid;
+    const LSMStore *s;
+    long first;
+    bool ok;
+} LSMWriter;
+
+static void *lsmWriter(void *arg) {
+    LSMWriter *w = (LSMWriter *)arg;
+
+    w->ok = lsmWrite(w->s, w->first, NTHREADS, 3);
+    return NULL;
+}
+
+static void countVisit(void *e, void *arg) {
+    atomic_fetch_add(&((atomic_long *)arg)[(long)e], 1L);
+}
+
+static void *triple(void *e, void *arg) {
+    (void)arg;
+    return ADT_VALUE(3L * (long)e);
+}
+
+static bool multipleOf(void *e, void *arg) {
+    return ((long)e % (long)arg == 0L);
+}
+
+/*
+ * associative but not commutative, with NULL as identity, so reducing
+ * elements that are all non-NULL gives the first and the last of them
+ */
+static void *first(void *x, void *y, void *arg) {
+    (void)arg;
+    return (x != NULL) ? x : y;
+}
+
+static void *last(void *x, void *y, void *arg) {
+    (void)arg;
+    return (y != NULL) ? y : x;
+}
+
+/*
+ * a hash for the sketches, which want all 60 bits of theirs to be mixed;
+ * hashLong() leaves the top bits of small keys 0
+ */
+static long mixLong(void *key, long N) {
+    unsigned long x = (unsigned long)key;
+
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9UL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebUL;
+    x ^= x >> 31;
+    return (long)(x % (unsigned long)N);
+}
+
+/*
+ * the stream for the sketch tests: item i < SK_HEAVY occurs
+ * SK_HEAVY_COUNT times, and items SK_HEAVY .. SK_ITEMS-1 once each
+ */
+#define SK_ITEMS 100000L
+#define SK_HEAVY 10L
+#define SK_HEAVY_COUNT 5000L
+
+static long skTrue(long i) {
+    return (i < SK_HEAVY) ? SK_HEAVY_COUNT : 1L;
+}
+
+#define BQ_ITEMS 20000L
+
+typedef struct bqWorker {
+    pthread_t tid;
+    const BlockingQueue *bq;
+    long id;                    /* producers: enqueue id*BQ_ITEMS + i */
+    long count;                 /* consumers: elements to dequeue */
+    long sum;                   /* consumers: sum of the elements */
+    bool ordered;               /* consumers: each producer's in order */
+} BQWorker;
+
+static void *producer(void *arg) {
+    BQWorker *w = (BQWorker *)arg;
+    long i;
+
+    for (i = 0L; i < BQ_ITEMS; i++)
+        (void)w->bq->enqueue(w->bq, ADT_VALUE(w->id * BQ_ITEMS + i));
+    return NULL;
+}
+
+static void *consumer(void *arg) {
+    BQWorker *w = (BQWorker *)arg;
+    long i, last[NTHREADS];
+    void *v;
+
+    for (i = 0L; i < NTHREADS; i++)
+        last[i] = -1L;
+    w->sum = 0L;
+    w->ordered = true;
+    for (i = 0L; i < w->count; i++) {
+        long p;
+        (void)w->bq->dequeue(w->bq, &v);
+        w->sum += (long)v;
+        p = (long)v / BQ_ITEMS;
+        if ((long)v % BQ_ITEMS <= last[p])
+            w->ordered = false;
+        last[p] = (long)v % BQ_ITEMS;
+    }
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    char dir[64];
+    int i;
+
+    if (argc < 2) {
+        fprintf(stderr, USAGE, argv[0]);
+        return EXIT_FAILURE;
+    }
+    sprintf(dir, "/tmp/adttest%d", (int)getpid());
+    for (i = 1; i < argc; i++) {
+        int test = 0;
+        sscanf(argv[i], "%d", &test);
+        switch(test) {
+          case 1: {
+            printf("Test epoch retirement waits for a pinned thread ... ");
+            Pinned p = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0};
+            bool gone = false, early;
+            pthread_t tid;
+
+            pthread_create(&tid, NULL, pin, &p);
+            pthread_mutex_lock(&p.lock);
+            while (p.stage != 1)
+                pthread_cond_wait(&p.cond, &p.lock);
+            pthread_mutex_unlock(&p.lock);
+            Epoch_enter();
+            Epoch_retire(&gone, flagFree);
+            Epoch_exit();
+            churn(10000L);
+            early = gone;
+            pthread_mutex_lock(&p.lock);
+            p.stage = 2;
+            pthread_cond_broadcast(&p.cond);
+            pthread_mutex_unlock(&p.lock);
+            pthread_join(tid, NULL);
+            churn(10000L);
+            if (! early && gone)
+                printf("success\n");
+            else
+                printf("failure\n");
+            break;
+          }
+          case 2: {
+            printf("Test LockFreeStack is LIFO ... ");
+            const Stack *st = LockFreeStack(doNothing);
+            int success = (st != NULL);
+            long j;
+            void *v;
+
+            for (j = 1L; success && j <= 1000L; j++)
+                success = st->push(st, ADT_VALUE(j));
+            success = success && st->size(st) == 1000L;
+            for (j = 1000L; success && j >= 1L; j--)
+                success = st->pop(st, &v) && (long)v == j;
+            success = success && ! st->pop(st, &v) && st->isEmpty(st);
+            if (success)
+                printf("success\n");
+            else
+                printf("failure\n");
+            if (st != NULL)
+                st->destroy(st);
+            break;
+          }
+          case 3: {
+            printf("Test LockFreeStack loses no value under contention ... ");
+            const Stack *st = LockFreeStack(doNothing);
+            Pusher w[NTHREADS];
+            long n = 200000L, got = 0L, want;
+            int j;
+            void *v;
+
+            for (j = 0; j < NTHREADS; j++) {
+                w[j].st = st;
+                w[j].first = 1L + j * n;
+                w[j].n = n;
+                w[j].popped = 0L;
+                pthread_create(&w[j].tid, NULL, pushPop, &w[j]);
+            }
+            for (j = 0; j < NTHREADS; j++) {
+                pthread_join(w[j].tid, NULL);
+                got += w[j].popped;
+            }
+            while (st->pop(st, &v))
+                got += (long)v;
+            want = (NTHREADS * n) * (NTHREADS * n + 1L) / 2L;
+            if (got == want)
+                printf("success\n");
+            else
+                printf("failure\n");
+            st->destroy(st);
+            break;
+          }
+          case 4: {
+            printf("Test MultiQueue with one shard is exactly ordered ... ");
+            const PrioQueue *pq = MultiQueue(1L, cmpLong, doNothing,
+                                             doNothing);
+            long j, prev = -1L;
+            int success = (pq != NULL);
+            void *p, *v;
+
+            srand(415);
+            for (j = 0L; success && j < 10000L; j++) {
+                long r = rand() % 100000L;
+                success = pq->insert(pq, ADT_VALUE(r), ADT_VALUE(r));
+            }
+            for (j = 0L; success && j < 10000L; j++) {
+                success = pq->removeMin(pq, &p, &v) && (long)p >= prev &&
+                          p == v;
+                prev = (long)p;
+            }
+            success = success && ! pq->removeMin(pq, &p, &v);
+            if (success)
+                printf("success\n");
+            else
+                printf("failure\n");
+            if (pq != NULL)
+                pq->destroy(pq);
+            break;
+          }
+          case 5: {
+            printf("Test MultiQueue loses no entry under contention ... ");
+            const PrioQueue *pq = MultiQueue(0L, cmpLong, doNothing,
+                                             doNothing);
+            MQWorker w[NTHREADS];
+            long n = 100000L, got = 0L, want;
+            int j;
+            void *p, *v;
+
+            for (j = 0; j < NTHREADS; j++) {
+                w[j].pq = pq;
+                w[j].first = 1L + j * n;
+                w[j].n = n;
+                w[j].removed = 0L;
+                pthread_create(&w[j].tid, NULL, insertRemove, &w[j]);
+            }
+            for (j = 0; j < NTHREADS; j++) {
+                pthread_join(w[j].tid, NULL);
+                got += w[j].removed;
+            }
+            while (pq->removeMin(pq, &p, &v))
+                got += (long)v;
+            want = (NTHREADS * n) * (NTHREADS * n + 1L) / 2L;
+            if (got == want)
+                printf("success\n");
+            else
+                printf("failure\n");
+            pq->destroy(pq);
+            break;
+          }
+          case 6: {
+            printf("Test MultiQueues merged into each other at once ... ");
+            const PrioQueue *a = MultiQueue(4L, cmpLong, doNothing, doNothing);
+            const PrioQueue *b = MultiQueue(4L, cmpLong, doNothing, doNothing);
+            MQWorker w[2];
+            long j, got = 0L;
+            void *p, *v;
+
+            for (j = 1L; j <= 1000L; j++) {
+                a->insert(a, ADT_VALUE(j), ADT_VALUE(j));
+                b->insert(b, ADT_VALUE(j + 1000L), ADT_VALUE(j + 1000L));
+            }
+            w[0].pq = a;                /* would deadlock without an */
+            w[0].other = b;             /* order on the shard locks */
+            w[1].pq = b;
+            w[1].other = a;
+            for (j = 0L; j < 2L; j++) {
+                w[j].n = 200000L;
+                pthread_create(&w[j].tid, NULL, merger, &w[j]);
+            }
+            for (j = 0L; j < 2L; j++)
+                pthread_join(w[j].tid, NULL);
+            while (a->removeMin(a, &p, &v))
+                got += (long)v;
+            while (b->removeMin(b, &p, &v))
+                got += (long)v;
+            if (got == 2000L * 2001L / 2L)
+                printf("success\n");
+            else
+                printf("failure\n");
+            a->destroy(a);
+            b->destroy(b);
+            break;
+          }
+          case 7: {
+            printf("Test ThreadPool tasks that wait for their subtasks ... ");
+            void *result = NULL;
+            const Future *f;
+
+            pool = ThreadPool_create(2L);
+            f = (pool == NULL) ? NULL : pool->submit(pool, fib, ADT_VALUE(20L));
+            if (f != NULL) {
+                (void)f->get(f, &result);
+                f->destroy(f);
+            }
+            if ((long)result == 6765L)
+                printf("success\n");
+            else
+                printf("failure\n");
+            if (pool != NULL)
+                pool->destroy(pool);
+            break;
+          }
+          case 8: {
+            printf("Test ThreadPool parallelFor() visits each index once ... ");
+            const ThreadPool *tp = ThreadPool_create(NTHREADS);
+            long n = 100000L, grains[] = {1L, 0L, 7L, 1000000L}, j, k;
+            atomic_long *visits = (atomic_long *)calloc(n, sizeof(atomic_long));
+            int success = (tp != NULL && visits != NULL);
+
+            for (k = 0L; success && k < 4L; k++) {
+                tp->parallelFor(tp, 0L, n, grains[k], visit, visits);
+                for (j = 0L; j < n; j++)
+                    if (atomic_load(&visits[j]) != k + 1L)
+                        success = 0;
+            }
+            if (success)
+                printf("success\n");
+            else
+                printf("failure\n");
+            free(visits);
+            if (tp != NULL)
+                tp->destroy(tp);
+            break;
+          }
+          case 9: {
+            printf("Test ThreadPool waitAll() waits for every task ... ");
+            const ThreadPool *tp = ThreadPool_create(NTHREADS);
+            atomic_long count;
+            long j, n = 100000L;
+            int success = (tp != NULL);
+
+            atomic_init(&count, 0L);
+            for (j = 0L; success && j < n; j++)
+                success = tp->execute(tp, bump, &count);
+            if (success) {
+                tp->waitAll(tp);
+                success = (atomic_load(&count) == n);
+            }
+            if (success)
+                printf("success\n");
+            else
+                printf("failure\n");
+            if (tp != NULL)
+                tp->destroy(tp);
+            break;
+          }
+          case 10: {
+            printf("Test LRUCache evicts the least recently used entry ... ");
+            const Cache *c = LRUCache(3L, hashLong, cmpLong, NULL,
+                                      doNothing, doNothing);
+            CacheStats st;
+            void *v;
+            int success = (c != NULL);
+
+            if (success) {
+                c->put(c, ADT_VALUE(1L), ADT_VALUE(10L));
+                c->put(c, ADT_VALUE(2L), ADT_VALUE(20L));
+                c->put(c, ADT_VALUE(3L), ADT_VALUE(30L));
+                success = c->get(c, ADT_VALUE(1L), &v) && (long)v == 10L;
+                c->put(c, ADT_VALUE(4L), ADT_VALUE(40L));
+                c->stats(c, &st);
+                success = success && ! c->containsKey(c, ADT_VALUE(2L)) &&
+                          c->containsKey(c, ADT_VALUE(1L)) &&
+                          c->containsKey(c, ADT_VALUE(3L)) &&
+                          c->containsKey(c, ADT_VALUE(4L)) &&
+                          c->size(c) == 3L && st.evictions == 1L &&
+                          st.hits == 1L;
+            }
+            if (success)
+                printf("success\n");
+            else
+                printf("failure\n");
+            if (c != NULL)
+                c->destroy(c);
+            break;
+          }
+          case 11: {
+            printf("Test caches stay within capacity, some entries free ... ");
+            const Cache *c[3];
+            long j;
+            int k, success = 1;
+            void *v;
+
+            c[0] = LRUCache(20L, hashLong, cmpLong, keyCost, doNothing,
+                            doNothing);
+            c[1] = ClockCache(20L, hashLong, cmpLong, keyCost, doNothing,
+                              doNothing);
+            c[2] = ARCCache(20L, hashLong, cmpLong, keyCost, doNothing,
+                            doNothing);
+            srand(415);
+            for (k = 0; k < 3; k++) {
+                if (c[k] == NULL) {
+                    success = 0;
+                    continue;
+                }
+                for (j = 0L; j < 200000L; j++) {
+                    long key = 1L + ((rand() % 4) ? rand() % 30 : rand() % 300);
+                    if (! c[k]->get(c[k], ADT_VALUE(key), &v))
+                        c[k]->put(c[k], ADT_VALUE(key), ADT_VALUE(key));
+                    if (c[k]->cost(c[k]) > 20L)
+                        success = 0;
+                }
+                c[k]->destroy(c[k]);
+            }
+            if (success)
+                printf("success\n");
+            else
+                printf("failure\n");
+            break;
+          }
+          case 12: {
+            printf("Test ARCCache keeps reused entries through a scan ... ");
+            const Cache *c = ARCCache(100L, hashLong, cmpLong, NULL,
+                                      doNothing, doNothing);
+            long j, kept = 0L;
+            void *v;
+
+            for (j = 0L; j < 100L; j++) {   /* 50 hot keys, used twice */
+                long key = 1L + j % 50L;
+                if (! c->get(c, ADT_VALUE(key), &v))
+                    c->put(c, ADT_VALUE(key), ADT_VALUE(key));
+            }
+            for (j = 1000L; j < 11000L; j++)        /* used once */
+                if (! c->get(c, ADT_VALUE(j), &v))
+                    c->put(c, ADT_VALUE(j), ADT_VALUE(j));
+            for (j = 1L; j <= 50L; j++)
+                if (c->get(c, ADT_VALUE(j), &v))
+                    kept++;
+            if (kept == 50L)
+                printf("success\n");
+            else
+                printf("failure\n");
+            c->destroy(c);
+            break;
+          }
+          case 13: {
+            printf("Test TTLCSKMap entries expire after their TTL ... ");
+            const CSKMap *m;
+            int success;
+            void *v;
+
+            fakeTime = 1000L;
+            m = TTLCSKMap(0L, 0.0, 640L, fakeClock, doNothing);
+            success = (m != NULL) && m->put(m, "a", ADT_VALUE(1L));
+            fakeTime += 639L;
+            success = success && m->get(m, "a", &v) && (long)v == 1L;
+            fakeTime += 2L;
+            success = success && ! m->get(m, "a", &v);
+            success = success && m->put(m, "b", ADT_VALUE(2L));
+            fakeTime += 1000L;
+            success = success && TTLCSKMap_expire(m, 0L) == 1L &&
+                      m->size(m) == 0L;
+            if (success)
+                printf("success\n");
+            else
+                printf("failure\n");
+            if (m != NULL)
+                m->destroy(m);
+            break;
+          }
+          case 14: {
+            printf("Test TTLCSKMap putTTL() and touch() ... ");
+            const CSKMap *m;
+            int success;
+            void *v;
+
+            fakeTime = 1000L;
+            m = TTLCSKMap(0L, 0.0, 0L, fakeClock, doNothing);
+            success = (m != NULL) && m->put(m, "forever", ADT_VALUE(1L)) &&
+                      TTLCSKMap_putTTL(m, "short", ADT_VALUE(2L), 100L);
+            fakeTime += 50L;
+            success = success && TTLCSKMap_touch(m, "short", 100L) &&
+                      ! TTLCSKMap_touch(m, "absent", 100L);
+            fakeTime += 90L;
+            success = success && m->get(m, "short", &v);
+            fakeTime += 20L;
+            success = success && ! m->get(m, "short", &v);
+            fakeTime += 1000000L;
+            success = success && m->get(m, "forever", &v) && (long)v == 1L;
+            if (success)
+                printf("success\n");
+            else
+                printf("failure\n");
+            if (m != NULL)
+                m->destroy(m);
+            break;
+          }
+          case 15: {
+            printf("Test TTLCSKMap sweep gets past a crowded slot ... ");
+            const CSKMap *m;
+            char key[32];
+            long j;
+
+            fakeTime = 1000L;
+            m = TTLCSKMap(0L, 0.0, 64L, fakeClock, doNothing);
+            for (j = 0L; j < 20L; j++) {    /* more than a slice, one slot */
+                sprintf(key, "long%ld", j);
+                TTLCSKMap_putTTL(m, key, ADT_VALUE(j), 640L);
+            }
+            for (j = 0L; j < 600L; j++) {   /* one put per tick */
+                fakeTime++;
+                sprintf(key, "k%ld", j);
+                m->put(m, key, ADT_VALUE(j));
+            }
+            /* 64 live short entries and the 20 long ones, give or take */
+            if (m->size(m) <= 100L)
+                printf("success\n");
+            else
+                printf("failure\n");
+            m->destroy(m);
+            break;
+          }
+          case 16: {
+            printf("Test LSMStore put(), get() and remove() ... ");
+            const LSMStore *s;
+            long bytes;
+            int success;
+
+            removeDir(dir);
+            s = LSMStore_create(dir, 16L * 1024L);  /* so it flushes */
+            success = (s != NULL) && lsmWrite(s, 0L, 1L, 2) &&
+                      lsmCheck(s, 2) == 0L && s->tables(s, &bytes) > 0L;
+            if (s != NULL)
+                success &= s->close(s);
+            if (success)
+                printf("success\n");
+            else
+                printf("failure\n");
+            removeDir(dir);
+            break;
+          }
+          case 17: {
+            printf("Test LSMStore concurrent writes survive reopen and compact ... ");
+            const LSMStore *s;
+            LSMWriter w[NTHREADS];
+            long bytes;
+            int j, success;
+
+            removeDir(dir);
+            s = LSMStore_create(dir, 16L * 1024L);
+            success = (s != NULL);
+            for (j = 0; success && j < NTHREADS; j++) {
+                w[j].s = s;
+                w[j].first = j;
+                pthread_create(&w[j].tid, NULL, lsmWriter, &w[j]);
+            }
+            for (j = 0; success && j < NTHREADS; j++) {
+                pthread_join(w[j].tid, NULL);
+                success &= w[j].ok;
+            }
+            success = success && lsmCheck(s, 3) == 0L && s->close(s);
+            s = success ? LSMStore_create(dir, 16L * 1024L) : NULL;
+            success = (s != NULL) && lsmCheck(s, 3) == 0L &&
+                      s->compact(s) && s->tables(s, &bytes) == 1L &&
+                      lsmCheck(s, 3) == 0L;
+            if (s != NULL)
+                success &= s->close(s);
+            if (success)
+                printf("success\n");
+            else
+                printf("failure\n");
+            removeDir(dir);
+            break;
+          }
+          case 18: {
+            printf("Test LSMStore recovers writes from its log after a crash ... ");
+            const LSMStore *s;
+            int status, success;
+            pid_t pid;
+
+            removeDir(dir);
+            fflush(stdout);
+            if ((pid = fork()) == 0) {      /* writes, then dies unclosed */
+                s = LSMStore_create(dir, 16L * 1024L);
+                _exit((s != NULL && lsmWrite(s, 0L, 1L, 2)) ? 0 : 1);
+            }
+            success = (pid > 0 && waitpid(pid, &status, 0) == pid &&
+                       WIFEXITED(status) && WEXITSTATUS(status) == 0);
+            s = success ? LSMStore_create(dir, 16L * 1024L) : NULL;
+            success = (s != NULL) && lsmCheck(s, 2) == 0L;
+            if (s != NULL)
+                success &= s->close(s);
+            if (success)
+                printf("success\n");
+            else
+                printf("failure\n");
+            removeDir(dir);
+            break;
+          }
+          case 19: {
+            printf("Test HashCSKMap direct calls agree with the dispatch table ... ");
+            const CSKMap *a = HashCSKMap(4L, 0.0, doNothing);
+            const CSKMap *b = HashCSKMap(4L, 0.0, doNothing);
+            void *va = NULL, *vb = NULL;
+            char key[32];
+            long j;
+            int success = (a != NULL && b != NULL);
+
+            srand(415);
+            for (j = 0L; success && j < 20000L; j++) {
+                long k = rand() % 100L;
+                sprintf(key, "k%d", rand() % 2000);
+                if (k < 30L)
+                    success = a->put(a, key, ADT_VALUE(j)) ==
+                              HashCSKMap_put(b, key, ADT_VALUE(j));
+                else if (k < 50L)
+                    success = a->putUnique(a, key, ADT_VALUE(j)) ==
+                              HashCSKMap_putUnique(b, key, ADT_VALUE(j));
+                else if (k < 70L)
+                    success = a->remove(a, key) == HashCSKMap_remove(b, key);
+                else if (k < 90L)
+                    success = a->get(a, key, &va) ==
+                              HashCSKMap_get(b, key, &vb) && va == vb;
+                else
+                    success = a->containsKey(a, key) ==
+                              HashCSKMap_containsKey(b, key) &&
+                              a->isEmpty(a) == HashCSKMap_isEmpty(b);
+                success = success && a->size(a) == HashCSKMap_size(b);
+            }
+            if (success)
+                printf("success\n");
+            else
+                printf("failure\n");
+            if (a != NULL)
+                a->destroy(a);
+            if (b != NULL)
+                b->destroy(b);
+            break;
+          }
+          case 20: {
+            printf("Test ArrayBlockingQueue bounds and timeouts ... ");
+            const BlockingQueue *bq = ArrayBlockingQueue(3L, doNothing);
+            double start, waited[2];
+            long j;
+            void *v;
+            int success = (bq != NULL);
+
+            for (j = 1L; success && j <= 3L; j++)
+                success = bq->timedEnqueue(bq, ADT_VALUE(j), 0L);
+            start = now();
+            success = success && bq->remainingCapacity(bq) == 0L &&
+                      ! bq->timedEnqueue(bq, ADT_VALUE(4L), 50L);
+            waited[0] = now() - start;
+            success = success && bq->front(bq, &v) && (long)v == 1L;
+            for (j = 1L; success && j <= 3L; j++)
+                success = bq->timedDequeue(bq, &v, 0L) && (long)v == j;
+            start = now();
+            success = success && ! bq->timedDequeue(bq, &v, 50L) &&
+                      bq->isEmpty(bq) && bq->remainingCapacity(bq) == 3L;
+            waited[1] = now() - start;
+            success = success && waited[0] >= 0.04 && waited[1] >= 0.04;
+            if (success)
+                printf("success\n");
+            else
+                printf("failure\n");
+            if (bq != NULL)
+                bq->destroy(bq);
+            break;
+          }
+          case 21: {
+            printf("Test ArrayBlockingQueue with blocked producers and consumers ... ");
+            const BlockingQueue *bq = ArrayBlockingQueue(8L, doNothing);
+            BQWorker w[2 * NTHREADS];
+            long n = NTHREADS * BQ_ITEMS, want = n * (n - 1L) / 2L, sum = 0L;
+            int t, success = (bq != NULL);
+
+            for (t = 0; bq != NULL && t < 2 * NTHREADS; t++) {
+                w[t].bq = bq;
+                w[t].id = t;
+                w[t].count = BQ_ITEMS;
+                pthread_create(&w[t].tid, NULL,
+                               (t < NTHREADS) ? producer : consumer, &w[t]);
+            }
+            for (t = 0; bq != NULL && t < 2 * NTHREADS; t++) {
+                pthread_join(w[t].tid, NULL);
+                if (t >= NTHREADS) {
+                    sum += w[t].sum;
+                    success &= w[t].ordered;
+                }
+            }
+            success = success && sum == want && bq->isEmpty(bq);
+            if (success)
+                printf("success\n");
+            else
+                printf("failure\n");
+            if (bq != NULL)
+                bq->destroy(bq);
+            break;
+          }
+          case 22: {
+            printf("Test ArrayBlockingQueue drainTo() and clear() ... ");
+            const BlockingQueue *bq = ArrayBlockingQueue(0L, free);
+            const Queue *q = ArrayQueue(0L, free);
+            long j;
+            void *v;
+            int success = (bq != NULL && q != NULL);
+
+            for (j = 0L; success && j < 1000L; j++) {
+                long *p = (long *)malloc(sizeof(long));
+                *p = j;
+                success = bq->enqueue(bq, p);
+            }
+            success = success && bq->remainingCapacity(bq) == -1L &&
+                      bq->drainTo(bq, q, 100L) == 100L &&
+                      bq->size(bq) == 900L && q->size(q) == 100L;
+            for (j = 0L; success && j < 100L; j++) {
+                success = q->dequeue(q, &v) && *(long *)v == j;
+                free(v);
+            }
+            success = success && bq->drainTo(bq, q, 0L) == 900L &&
+                      bq->isEmpty(bq) && q->front(q, &v) &&
+                      *(long *)v == 100L;
+            if (success) {
+                v = malloc(sizeof(long));
+                success = bq->enqueue(bq, v);
+                bq->clear(bq);          /* ASan reports a leak if not freed */
+                success = success && bq->isEmpty(bq);
+            }
+            if (success)
+                printf("success\n");
+            else
+                printf("failure\n");
+            if (bq != NULL)
+                bq->destroy(bq);
+            if (q != NULL)
+                q->destroy(q);
+            break;
+          }
+          case 23: {
+            printf("Test Parallel forEach(), map() and filter() ... ");
+            const ThreadPool *tp = ThreadPool_create(NTHREADS);
+            const ThreadPool *pools[2];
+            long n = 100003L, j, k, m;
+            void **a = (void **)malloc((n + 1L) * sizeof(void *));
+            void **b = (void **)malloc((n + 1L) * sizeof(void *));
+            atomic_long *visits = (atomic_long *)calloc(n + 1L, sizeof(atomic_long));
+            int success = (tp != NULL && a != NULL && b != NULL &&
+                           visits != NULL);
+
+            pools[0] = tp;
+            pools[1] = NULL;            /* the calling thread does it all */
+            for (k = 0L; success && k < 2L; k++) {
+                for (j = 0L; j <= n; j++)
+                    a[j] = ADT_VALUE(j);
+                /* a + 1 does not start on a cache line */
+                Parallel_forEach(pools[k], a + 1, n, countVisit, visits);
+                for (j = 1L; j <= n; j++)
+                    if (atomic_load(&visits[j]) != k + 1L)
+                        success = 0;
+                Parallel_map(pools[k], a + 1, a + 1, n, triple, NULL);
+                for (j = 1L; j <= n; j++)
+                    if ((long)a[j] != 3L * j)
+                        success = 0;
+                m = Parallel_filter(pools[k], a + 1, b, n, multipleOf,
+                                    ADT_VALUE(7L));
+                success = success && m == n / 7L;
+                for (j = 0L; success && j < m; j++)
+                    success = (long)b[j] == 21L * (j + 1L);
+            }
+            if (success)
+                printf("success\n");
+            else
+                printf("failure\n");
+            free(a);
+            free(b);
+            free(visits);
+            if (tp != NULL)
+                tp->destroy(tp);
+            break;
+          }
+          case 24: {
+            printf("Test Parallel reduce() combines the chunks in order ... ");
+            const ThreadPool *tp = ThreadPool_create(NTHREADS);
+            long n = 100003L, j;
+            void **a = (void **)malloc(n * sizeof(void *));
+            int success = (tp != NULL && a != NULL);
+
+            for (j = 0L; success && j < n; j++)
+                a[j] = ADT_VALUE((j * 7919L) % n - n / 2L);
+            success = success &&
+                (long)Parallel_reduce(tp, a, n, ADT_VALUE(0L), Parallel_sumLong,
+                                      NULL) == 0L &&
+                (long)Parallel_reduce(tp, a, n, ADT_VALUE(LONG_MAX),
+                                      Parallel_minLong, NULL) == -(n / 2L) &&
+                (long)Parallel_reduce(tp, a, n, ADT_VALUE(LONG_MIN),
+                                      Parallel_maxLong, NULL) == n / 2L &&
+                Parallel_reduce(tp, a, n, NULL, first, NULL) == a[0] &&
+                Parallel_reduce(tp, a, n, NULL, last, NULL) == a[n - 1L] &&
+                Parallel_reduce(tp, a, 0L, ADT_VALUE(5L), Parallel_sumLong,
+                                NULL) == ADT_VALUE(5L);
+            for (j = 0L; success && j < n; j++)   /* overflows, and wraps */
+                a[j] = ADT_VALUE(LONG_MAX);
+            success = success &&
+                (long)Parallel_reduce(tp, a, n, ADT_VALUE(0L), Parallel_sumLong,
+                                      NULL) ==
+                (long)((unsigned long)n * (unsigned long)LONG_MAX);
+            if (success)
+                printf("success\n");
+            else
+                printf("failure\n");
+            free(a);
+            if (tp != NULL)
+                tp->destroy(tp);
+            break;
+          }
+          case 25: {
+            printf("Test CountMin bounds, conservative update and merge ... ");
+            const CountMin *cm[4];
+            long i, total = SK_HEAVY * SK_HEAVY_COUNT + SK_ITEMS - SK_HEAVY;
+            long over[2] = {0L, 0L}, bad = 0L, width, depth;
+            int k, success = 1;
+
+            cm[0] = CountMin_create(0.001, 0.01, false, mixLong);
+            cm[1] = CountMin_create(0.001, 0.01, true, mixLong);
+            cm[2] = CountMin_create(0.001, 0.01, false, mixLong);
+            cm[3] = CountMin_create(0.01, 0.01, false, mixLong);
+            for (k = 0; k < 4; k++)
+                if (cm[k] == NULL)
+                    success = 0;
+            for (i = 0L; success && i < SK_ITEMS; i++) {
+                cm[0]->add(cm[0], ADT_VALUE(i), skTrue(i));
+                cm[1]->add(cm[1], ADT_VALUE(i), skTrue(i));
+                if (i % 2L == 0L)       /* cm[0] == cm[2] merged with cm[3] */
+                    cm[2]->add(cm[2], ADT_VALUE(i), skTrue(i));
+            }
+            for (i = 0L; success && i < SK_ITEMS; i++) {
+                long e0 = cm[0]->estimate(cm[0], ADT_VALUE(i));
+                long e1 = cm[1]->estimate(cm[1], ADT_VALUE(i));
+                if (e0 < skTrue(i) || e1 < skTrue(i) || e1 > e0)
+                    success = 0;
+                over[0] += e0 - skTrue(i);
+                over[1] += e1 - skTrue(i);
+                if (e0 - skTrue(i) > (long)(0.001 * total) + 1L)
+                    bad++;
+            }
+            success = success && cm[0]->total(cm[0]) == total &&
+                      over[1] < over[0] && bad <= SK_ITEMS / 100L &&
+                      cm[0]->bytes(cm[0], &width, &depth) > 0L &&
+                      width == 2719L && depth == 5L &&
+                      ! cm[2]->merge(cm[2], cm[3]);
+            if (success) {
+                const CountMin *rest = CountMin_create(0.001, 0.01, false,
+                                                       mixLong);
+                success = (rest != NULL);
+                for (i = 1L; success && i < SK_ITEMS; i += 2L)
+                    rest->add(rest, ADT_VALUE(i), skTrue(i));
+                success = success && cm[2]->merge(cm[2], rest) &&
+                          cm[2]->total(cm[2]) == total;
+                for (i = 0L; success && i < SK_ITEMS; i++)
+                    success = cm[2]->estimate(cm[2], ADT_VALUE(i)) ==
+                              cm[0]->estimate(cm[0], ADT_VALUE(i));
+                if (rest != NULL)
+                    rest->destroy(rest);
+            }
+            if (success)
+                printf("success\n");
+            else
+                printf("failure\n");
+            for (k = 0; k < 4; k++)
+                if (cm[k] != NULL)
+                    cm[k]->destroy(cm[k]);
+            break;
+          }
+          case 26: {
+            printf("Test HyperLogLog sparse to dense, and merge ... ");
+            const HyperLogLog *h = HyperLogLog_create(14, mixLong);
+            const HyperLogLog *g = HyperLogLog_create(14, mixLong);
+            const HyperLogLog *small = HyperLogLog_create(8, mixLong);
+            long i, became = -1L, e;
+            int success = (h != NULL && g != NULL && small != NULL);
+
+            for (i = 0L; success && i < 1000L; i++)
+                success = h->add(h, ADT_VALUE(i)) && h->add(h, ADT_VALUE(i));
+            e = success ? h->estimate(h) : 0L;
+            success = success && h->isSparse(h) && e >= 995L && e <= 1005L;
+            for (; success && i < 200000L; i++) {
+                success = h->add(h, ADT_VALUE(i));
+                if (became < 0L && ! h->isSparse(h))
+                    became = i;
+            }
+            e = success ? h->estimate(h) : 0L;
+            /* three standard errors, 1.04 / sqrt(2^14) each */
+            success = success && became > 1000L &&
+                      h->bytes(h) == 16384L && labs(e - 200000L) < 4900L;
+            for (i = 150000L; success && i < 300000L; i++)
+                success = g->add(g, ADT_VALUE(i));
+            success = success && g->merge(g, h) && h->merge(h, h) &&
+                      h->estimate(h) == e;            /* a no-op */
+            e = success ? g->estimate(g) : 0L;
+            success = success && labs(e - 300000L) < 7300L &&
+                      ! g->merge(g, small) && ! small->isSparse(small);
+            if (success) {              /* two sparse sketches stay exact */
+                g->clear(g);
+                h->clear(h);
+                for (i = 0L; success && i < 300L; i++)
+                    success = g->add(g, ADT_VALUE(i)) &&
+                              h->add(h, ADT_VALUE(i + 200L));
+                success = success && g->merge(g, h);
+                e = success ? g->estimate(g) : 0L;
+                success = success && g->isSparse(g) && e >= 497L && e <= 503L;
+            }
+            if (success)
+                printf("success\n");
+            else
+                printf("failure\n");
+            if (h != NULL)
+                h->destroy(h);
+            if (g != NULL)
+                g->destroy(g);
+            if (small != NULL)
+                small->destroy(small);
+            break;
+          }
+          case 27: {
+            printf("Test SpaceSaving finds the heavy hitters ... ");
+            const SpaceSaving *ss = SpaceSaving_create(50L, hashLong, cmpLong,
+                                                       NULL, doNothing);
+            SSEntry **top = NULL;
+            long i, j, len = 0L, count, error, each = 0L;
+            long total = SK_HEAVY * SK_HEAVY_COUNT + SK_ITEMS - SK_HEAVY;
+            int success = (ss != NULL);
+
+            /* interleave the heavy items with the singletons */
+            for (i = SK_HEAVY; success && i < SK_ITEMS; i++) {
+                success = ss->add(ss, ADT_VALUE(i), 1L) > 0L;
+                if (i % 25L == 0L) {
+                    for (j = 0L; success && j < SK_HEAVY; j++)
+                        success = ss->add(ss, ADT_VALUE(j), 1L) > 0L;
+                    each++;
+                }
+            }
+            for (j = 0L; success && j < SK_HEAVY; j++)     /* the rest */
+                success = ss->add(ss, ADT_VALUE(j),
+                                  SK_HEAVY_COUNT - each) > 0L;
+            success = success && ss->total(ss) == total &&
+                      ss->size(ss) == 50L;
+            for (j = 0L; success && j < SK_HEAVY; j++)
+                success = ss->estimate(ss, ADT_VALUE(j), &count, &error) &&
+                          count - error <= SK_HEAVY_COUNT &&
+                          count >= SK_HEAVY_COUNT && error <= total / 50L;
+            top = success ? ss->top(ss, &len) : NULL;
+            success = success && top != NULL && len == 50L;
+            for (i = 0L; success && i < len; i++) {
+                success = (i == 0L || top[i]->count <= top[i - 1]->count) &&
+                          (i >= SK_HEAVY || (long)top[i]->item < SK_HEAVY);
+            }
+            free(top);
+            if (success)
+                printf("success\n");
+            else
+                printf("failure\n");
+            if (ss != NULL)
+                ss->destroy(ss);
+            break;
+          }
+          case 28: {
+            printf("Test HashCSKMap_compact() leaves the entries intact ... ");
+            const CSKMap *m = HashCSKMap(0L, 0.0, doNothing);
+            bool in[10000];
+            char key[32], **keys = NULL;
+            long j, k, left, len = 0L, count = 0L, passes = 0L;
+            void *v;
+            int success = (m != NULL);
+
+            srand(415);
+            for (k = 0L; k < 10000L; k++)
+                in[k] = false;
+            for (j = 0L; success && j < 60000L; j++) {  /* scatter nodes */
+                k = rand() % 10000L;
+                sprintf(key, "key%ld", k);
+                if (j % 3L == 2L)
+                    m->remove(m, key);
+                else
+                    m->put(m, key, ADT_VALUE(10L * k));
+                in[k] = (j % 3L != 2L);
+            }
+            /* a step at a time, changing the map between the steps */
+            while (success && passes < 3L) {
+                left = HashCSKMap_compact(m, 500L);
+                success = (left >= 0L);
+                if (left == 0L)
+                    passes++;
+                k = rand() % 10000L;
+                sprintf(key, "key%ld", k);
+                m->put(m, key, ADT_VALUE(10L * k));
+                in[k] = true;
+                k = rand() % 10000L;
+                sprintf(key, "key%ld", k);
+                m->remove(m, key);
+                in[k] = false;
+            }
+            success = success && HashCSKMap_compact(m, 0L) == 0L;
+            for (k = 0L; success && k < 10000L; k++) {
+                sprintf(key, "key%ld", k);
+                success = m->get(m, key, &v) == in[k] &&
+                          (! in[k] || (long)v == 10L * k);
+                count += in[k];
+            }
+            keys = success ? m->keyArray(m, &len) : NULL;
+            success = success && keys != NULL && len == count &&
+                      m->size(m) == count;
+            for (j = 0L; success && j < len; j++)   /* the relocated keys */
+                success = sscanf(keys[j], "key%ld", &k) == 1 &&
+                          k >= 0L && k < 10000L && in[k];
+            free(keys);
+            if (success)
+                printf("success\n");
+            else
+                printf("failure\n");
+            if (m != NULL)
+                m->destroy(m);
+            break;
+          }
+          default:
+            fprintf(stderr, "%s: no test %s\n", argv[0], argv[i]);
+            break;
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,69 @@
+/*
+ * helpers shared by the benchmarks and tests in this directory
+ */
+
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#define MAX_OPTIONS 16
+
+bool getOptions(int argc, char *argv[], BenchOption options[]) {
+    char spec[2 * MAX_OPTIONS + 1];
+    int opt, i, n = 0;
+
+    for (i = 0; options[i].flag != '\0' && i < MAX_OPTIONS; i++) {
+        spec[n++] = options[i].flag;
+        spec[n++] = ':';
+    }
+    spec[n] = '\0';
+    opterr = 0;
+    while ((opt = getopt(argc, argv, spec)) != -1) {
+        BenchOption *o = options;
+
+        while (o->flag != '\0' && o->flag != opt)
+            o++;
+        switch (o->type) {
+        case 'l': *(long *)o->value = atol(optarg); break;
+        case 'i': *(int *)o->value = atoi(optarg); break;
+        case 'd': *(double *)o->value = atof(optarg); break;
+        case 's': *(char **)o->value = optarg; break;
+        default:
+            fprintf(stderr, "%s: illegal option, '-%c'\n", argv[0], optopt);
+            fprintf(stderr, "usage: %s", argv[0]);
+            for (o = options; o->flag != '\0'; o++)
+                fprintf(stderr, " [-%c %s]", o->flag, o->name);
+            fprintf(stderr, "\n");
+            return false;
+        }
+    }
+    return true;
+}
+
+double now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void removeDir(const char *dir) {
+    char cmd[strlen(dir) + 16];
+
+    sprintf(cmd, "rm -rf %s", dir);
+    if (system(cmd) != 0)
+        fprintf(stderr, "unable to remove %s\n", dir);
+}
+
+int cmpLong(void *p1, void *p2) {
+    long a = (long)p1, b = (long)p2;
+
+    return (a < b) ? -1 : (a > b);
+}
+
+long hashLong(void *key, long N) {
+    return (long)(((unsigned long)key * 2654435761UL) % (unsigned long)N);
+}
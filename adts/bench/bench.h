@@ -0,0 +1,48 @@
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+/*
+ * helpers shared by the benchmarks and tests in this directory; each
+ * program is linked with bench.c
+ */
+
+#include <stdbool.h>
+
+/*
+ * a command-line option: `-flag arg' stores arg at `value' as a long
+ * ('l'), an int ('i'), a double ('d') or the string itself ('s'); `name'
+ * describes arg in the usage message
+ */
+typedef struct benchoption {
+    char flag;
+    char type;
+    void *value;
+    const char *name;
+} BenchOption;
+
+/*
+ * parses the options in argv, which are described by `options', ending
+ * with one whose flag is '\0'
+ *
+ * returns true if successful, false after printing the illegal option
+ * and a usage message
+ */
+bool getOptions(int argc, char *argv[], BenchOption options[]);
+
+/*
+ * returns the CLOCK_MONOTONIC time, in seconds
+ */
+double now(void);
+
+/*
+ * removes directory `dir' and everything in it, if it exists
+ */
+void removeDir(const char *dir);
+
+/*
+ * comparison and hash functions for keys that are longs cast to void *
+ */
+int cmpLong(void *p1, void *p2);
+long hashLong(void *key, long N);
+
+#endif /* _BENCH_H_ */
@@ -0,0 +1,185 @@
+/*
+ * producer/consumer benchmark for ArrayBlockingQueue
+ *
+ * for 1, 2, 4, ..., maxPairs pairs, `pairs' producers each pass `ops'
+ * values to `pairs' consumers through one queue bounded at `capacity'
+ * elements; the blocking queue is compared with an ArrayQueue guarded by a
+ * pthread mutex, on which producers and consumers poll with sched_yield()
+ * when it is full or empty, which is what callers had to use before
+ *
+ * both the throughput and the CPU time consumed are reported, since
+ * polling burns CPU while waiting; the sum of the values consumed is
+ * checked against the sum of the values produced
+ */
+
+#include "ADTs/arrayblockingqueue.h"
+#include "ADTs/arrayqueue.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+
+#define DONE 0L                 /* values produced are > 0 */
+
+typedef struct shared {
+    const BlockingQueue *bq;    /* NULL for the polled queue */
+    const Queue *q;
+    pthread_mutex_t lock;
+    long capacity;
+} Shared;
+
+typedef struct worker {
+    pthread_t tid;
+    Shared *sh;
+    long first;                 /* values produced are first .. first+ops-1 */
+    long ops;
+    long consumed;              /* sum of values consumed */
+} Worker;
+
+static void send(Shared *sh, long v) {
+    if (sh->bq != NULL) {
+        sh->bq->enqueue(sh->bq, ADT_VALUE(v));
+        return;
+    }
+    for (;;) {
+        bool sent = false;
+
+        pthread_mutex_lock(&sh->lock);
+        if (sh->q->size(sh->q) < sh->capacity)
+            sent = sh->q->enqueue(sh->q, ADT_VALUE(v));
+        pthread_mutex_unlock(&sh->lock);
+        if (sent)
+            return;
+        sched_yield();
+    }
+}
+
+static long receive(Shared *sh) {
+    void *v;
+
+    if (sh->bq != NULL) {
+        sh->bq->dequeue(sh->bq, &v);
+        return (long)v;
+    }
+    for (;;) {
+        bool got;
+
+        pthread_mutex_lock(&sh->lock);
+        got = sh->q->dequeue(sh->q, &v);
+        pthread_mutex_unlock(&sh->lock);
+        if (got)
+            return (long)v;
+        sched_yield();
+    }
+}
+
+static void *produce(void *arg) {
+    Worker *w = (Worker *)arg;
+    long i;
+
+    for (i = 0; i < w->ops; i++)
+        send(w->sh, w->first + i);
+    return NULL;
+}
+
+static void *consume(void *arg) {
+    Worker *w = (Worker *)arg;
+    long v;
+
+    while ((v = receive(w->sh)) != DONE)
+        w->consumed += v;
+    return NULL;
+}
+
+static double cpu(void) {
+    struct rusage ru;
+
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6 +
+           ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+}
+
+/*
+ * returns millions of values passed per second, or -1.0 on failure;
+ * the CPU seconds used are returned in *cpuSecs
+ */
+static double trial(Shared *sh, int pairs, long ops, double *cpuSecs) {
+    Worker *w = (Worker *)malloc(2 * pairs * sizeof(Worker));
+    long want, got = 0L;
+    double start, startCpu, elapsed;
+    int i;
+
+    if (w == NULL)
+        return -1.0;
+    start = now();
+    startCpu = cpu();
+    for (i = 0; i < 2 * pairs; i++) {
+        w[i].sh = sh;
+        w[i].first = 1L + i * ops;
+        w[i].ops = ops;
+        w[i].consumed = 0L;
+        pthread_create(&w[i].tid, NULL, (i < pairs) ? produce : consume,
+                       &w[i]);
+    }
+    for (i = 0; i < pairs; i++)
+        pthread_join(w[i].tid, NULL);
+    for (i = 0; i < pairs; i++)
+        send(sh, DONE);
+    for (i = pairs; i < 2 * pairs; i++) {
+        pthread_join(w[i].tid, NULL);
+        got += w[i].consumed;
+    }
+    elapsed = now() - start;
+    *cpuSecs = cpu() - startCpu;
+    want = (pairs * ops) * (pairs * ops + 1L) / 2L;
+    free(w);
+    if (got != want)
+        return -1.0;
+    return (pairs * ops) / elapsed / 1e6;
+}
+
+int main(int argc, char *argv[]) {
+    long ops = 1000000L, capacity = 64L;
+    int maxPairs = 8, n;
+    Shared blocking, polled;
+    BenchOption options[] = {
+        {'c', 'l', &capacity, "capacity"},
+        {'n', 'l', &ops, "opsPerProducer"},
+        {'p', 'i', &maxPairs, "maxPairs"},
+        {'\0', '\0', NULL, NULL}
+    };
+
+    if (! getOptions(argc, argv, options))
+        return EXIT_FAILURE;
+    blocking.bq = ArrayBlockingQueue(capacity, doNothing);
+    blocking.q = NULL;
+    polled.bq = NULL;
+    polled.q = ArrayQueue(capacity, doNothing);
+    polled.capacity = capacity;
+    pthread_mutex_init(&polled.lock, NULL);
+    if (blocking.bq == NULL || polled.q == NULL) {
+        fprintf(stderr, "%s: unable to create queues\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    printf("%8s %24s %24s\n", "pairs", "ArrayBlockingQueue",
+           "ArrayQueue+mutex+poll");
+    printf("%8s %12s %11s %12s %11s\n", "", "Mvals/s", "cpu s",
+           "Mvals/s", "cpu s");
+    for (n = 1; n <= maxPairs; n *= 2) {
+        double ca, cb;
+        double a = trial(&blocking, n, ops / n, &ca);
+        double b = trial(&polled, n, ops / n, &cb);
+
+        if (a < 0.0 || b < 0.0) {
+            fprintf(stderr, "%s: values lost with %d pairs\n", argv[0], n);
+            return EXIT_FAILURE;
+        }
+        printf("%8d %12.2f %11.2f %12.2f %11.2f\n", n, a, ca, b, cb);
+    }
+    blocking.bq->destroy(blocking.bq);
+    polled.q->destroy(polled.q);
+    pthread_mutex_destroy(&polled.lock);
+    return EXIT_SUCCESS;
+}
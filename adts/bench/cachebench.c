@@ -0,0 +1,110 @@
+/*
+ * benchmark for the LRU, CLOCK and ARC caches
+ *
+ * `ops' lookups are made against a cache of `capacity' entries; a lookup
+ * that misses is followed by a put() of the key, as a caller would after
+ * fetching the value; the keys are drawn from:
+ *
+ * - hot: 90% of lookups go to a hot set of capacity/2 keys, the rest to
+ *   a set of 10 * capacity keys
+ * - scan: the same, but every `period' lookups a scan of 2 * capacity
+ *   keys that are never used again is made
+ *
+ * for each policy, the hit ratio and the time per lookup are shown
+ */
+
+#include "ADTs/hashcache.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/* per-run random number generator, so that every policy sees the same keys */
+static unsigned long xorshift(unsigned long *state) {
+    unsigned long x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+static void lookup(const Cache *c, long key) {
+    void *v;
+
+    if (! c->get(c, ADT_VALUE(key), &v))
+        c->put(c, ADT_VALUE(key), ADT_VALUE(key));
+}
+
+/*
+ * returns the time per lookup in ns; the hit ratio is returned in *ratio
+ */
+static double trial(const Cache *c, long ops, long capacity, long period,
+                    double *ratio) {
+    unsigned long state = 88172645463325252UL;
+    long hot = capacity / 2, cold = 10 * capacity, scan = 0L, i, n = 0L;
+    double start = now(), elapsed;
+    CacheStats stats;
+
+    for (i = 0; i < ops; i++) {
+        unsigned long r = xorshift(&state);
+
+        if (r % 10 != 0)
+            lookup(c, 1L + (long)((r >> 8) % hot));
+        else
+            lookup(c, 1L + hot + (long)((r >> 8) % cold));
+        n++;
+        if (period > 0L && i % period == period - 1) {
+            long j;
+
+            for (j = 0; j < 2 * capacity; j++, n++)
+                lookup(c, 1L + hot + cold + scan++);
+        }
+    }
+    elapsed = now() - start;
+    c->stats(c, &stats);
+    *ratio = stats.hitRatio;
+    return elapsed * 1e9 / n;
+}
+
+int main(int argc, char *argv[]) {
+    long ops = 2000000L, capacity = 10000L, period = 20000L;
+    const char *names[3] = {"LRUCache", "ClockCache", "ARCCache"};
+    const Cache *(*ctors[3])(long, long (*)(void *, long),
+                             int (*)(void *, void *), long (*)(void *, void *),
+                             void (*)(void *), void (*)(void *)) = {
+        LRUCache, ClockCache, ARCCache
+    };
+    int k, w;
+    BenchOption options[] = {
+        {'n', 'l', &ops, "ops"},
+        {'c', 'l', &capacity, "capacity"},
+        {'p', 'l', &period, "period"},
+        {'\0', '\0', NULL, NULL}
+    };
+
+    if (! getOptions(argc, argv, options))
+        return EXIT_FAILURE;
+    if (capacity < 2L) {
+        fprintf(stderr, "%s: capacity must be at least 2\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    printf("%12s %10s %10s %10s %10s\n", "", "hot", "ns/op", "scan", "ns/op");
+    for (k = 0; k < 3; k++) {
+        double ratio[2], ns[2];
+
+        for (w = 0; w < 2; w++) {
+            const Cache *c = ctors[k](capacity, hashLong, cmpLong, NULL, doNothing,
+                                      doNothing);
+
+            if (c == NULL) {
+                fprintf(stderr, "%s: unable to create cache\n", argv[0]);
+                return EXIT_FAILURE;
+            }
+            ns[w] = trial(c, ops, capacity, (w == 0) ? 0L : period, &ratio[w]);
+            c->destroy(c);
+        }
+        printf("%12s %10.3f %10.1f %10.3f %10.1f\n", names[k], ratio[0], ns[0],
+               ratio[1], ns[1]);
+    }
+    return EXIT_SUCCESS;
+}
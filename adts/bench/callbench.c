@@ -0,0 +1,168 @@
+/*
+ * benchmark for the direct-call API against the dispatch table
+ *
+ * each workload is run `reps' times, once through the dispatch table and
+ * once through the direct-call functions:
+ *
+ * - ArrayList: add() `n' longs, then get() each of them
+ * - ArrayStack: push() `n' longs, then pop() each of them
+ * - ArrayQueue: enqueue() `n' longs, then dequeue() each of them
+ * - HashMap: put() `n' long keys, then get() each of them
+ *
+ * the sums of the values retrieved are checked against each other
+ */
+
+#include "ADTs/arraylist.h"
+#include "ADTs/arraystack.h"
+#include "ADTs/arrayqueue.h"
+#include "ADTs/hashmap.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static long listDispatch(long n) {
+    const ArrayList *al = ArrayList_create(0L, doNothing);
+    long i, sum = 0L;
+    void *v;
+
+    for (i = 0; i < n; i++)
+        al->add(al, ADT_VALUE(i));
+    for (i = 0; i < n; i++)
+        if (al->get(al, i, &v))
+            sum += (long)v;
+    al->destroy(al);
+    return sum;
+}
+
+static long listDirect(long n) {
+    const ArrayList *al = ArrayList_create(0L, doNothing);
+    long i, sum = 0L;
+    void *v;
+
+    for (i = 0; i < n; i++)
+        ArrayList_add(al, ADT_VALUE(i));
+    for (i = 0; i < n; i++)
+        if (ArrayList_get(al, i, &v))
+            sum += (long)v;
+    al->destroy(al);
+    return sum;
+}
+
+static long stackDispatch(long n) {
+    const Stack *st = ArrayStack(0L, doNothing);
+    long i, sum = 0L;
+    void *v;
+
+    for (i = 0; i < n; i++)
+        st->push(st, ADT_VALUE(i));
+    while (st->pop(st, &v))
+        sum += (long)v;
+    st->destroy(st);
+    return sum;
+}
+
+static long stackDirect(long n) {
+    const Stack *st = ArrayStack(0L, doNothing);
+    long i, sum = 0L;
+    void *v;
+
+    for (i = 0; i < n; i++)
+        ArrayStack_push(st, ADT_VALUE(i));
+    while (ArrayStack_pop(st, &v))
+        sum += (long)v;
+    st->destroy(st);
+    return sum;
+}
+
+static long queueDispatch(long n) {
+    const Queue *q = ArrayQueue(0L, doNothing);
+    long i, sum = 0L;
+    void *v;
+
+    for (i = 0; i < n; i++)
+        q->enqueue(q, ADT_VALUE(i));
+    while (q->dequeue(q, &v))
+        sum += (long)v;
+    q->destroy(q);
+    return sum;
+}
+
+static long queueDirect(long n) {
+    const Queue *q = ArrayQueue(0L, doNothing);
+    long i, sum = 0L;
+    void *v;
+
+    for (i = 0; i < n; i++)
+        ArrayQueue_enqueue(q, ADT_VALUE(i));
+    while (ArrayQueue_dequeue(q, &v))
+        sum += (long)v;
+    q->destroy(q);
+    return sum;
+}
+
+static long mapDispatch(long n) {
+    const Map *m = HashMap(0L, 0.0, hashLong, cmpLong, doNothing, doNothing);
+    long i, sum = 0L;
+    void *v;
+
+    for (i = 0; i < n; i++)
+        m->put(m, ADT_VALUE(i), ADT_VALUE(i));
+    for (i = 0; i < n; i++)
+        if (m->get(m, ADT_VALUE(i), &v))
+            sum += (long)v;
+    m->destroy(m);
+    return sum;
+}
+
+static long mapDirect(long n) {
+    const Map *m = HashMap(0L, 0.0, hashLong, cmpLong, doNothing, doNothing);
+    long i, sum = 0L;
+    void *v;
+
+    for (i = 0; i < n; i++)
+        HashMap_put(m, ADT_VALUE(i), ADT_VALUE(i));
+    for (i = 0; i < n; i++)
+        if (HashMap_get(m, ADT_VALUE(i), &v))
+            sum += (long)v;
+    m->destroy(m);
+    return sum;
+}
+
+int main(int argc, char *argv[]) {
+    long n = 1000000L, reps = 10L, r;
+    const char *names[4] = {"ArrayList", "ArrayStack", "ArrayQueue",
+                            "HashMap"};
+    long (*fxns[4][2])(long) = {
+        {listDispatch, listDirect}, {stackDispatch, stackDirect},
+        {queueDispatch, queueDirect}, {mapDispatch, mapDirect}
+    };
+    int k, d;
+    BenchOption options[] = {
+        {'n', 'l', &n, "elements"},
+        {'r', 'l', &reps, "reps"},
+        {'\0', '\0', NULL, NULL}
+    };
+
+    if (! getOptions(argc, argv, options))
+        return EXIT_FAILURE;
+    printf("%10s %12s %12s   (ns/element)\n", "", "dispatch", "direct");
+    for (k = 0; k < 4; k++) {
+        long sums[2] = {0L, 0L};
+        double times[2] = {0.0, 0.0};
+
+        for (r = 0; r < reps; r++)
+            for (d = 0; d < 2; d++) {
+                double start = now();
+
+                sums[d] += fxns[k][d](n);
+                times[d] += now() - start;
+            }
+        if (sums[0] != sums[1]) {
+            fprintf(stderr, "%s: %s sums differ\n", argv[0], names[k]);
+            return EXIT_FAILURE;
+        }
+        printf("%10s %12.2f %12.2f\n", names[k], times[0] * 1e9 / (n * reps),
+               times[1] * 1e9 / (n * reps));
+    }
+    return EXIT_SUCCESS;
+}
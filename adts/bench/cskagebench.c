@@ -0,0 +1,148 @@
+/*
+ * benchmark for HashCSKMap_compact()
+ *
+ * a HashCSKMap of `n' entries is measured three times, by `n' get()s of
+ * random keys that are present and by a scan of every entry with
+ * itCreate():
+ *
+ * - fresh: just after being built
+ * - aged: after `churn' x n remove()s of random keys, each followed by a
+ *   put() of a new key, while other allocations of random sizes come and
+ *   go, so that the nodes are scattered across the heap
+ * - compacted: after a pass of HashCSKMap_compact() over the aged map,
+ *   `step' entries at a time; the number of calls and the longest of them
+ *   are reported too
+ *
+ * agebench does the same for HashMap
+ */
+
+#include "ADTs/hashcskmap.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NOISE (1L << 20)        /* other allocations alive at once */
+
+static void makeKey(char *buf, long k) {
+    sprintf(buf, "user:%ld:profile", k);
+}
+
+static void **noise;
+
+/*
+ * frees one random other allocation and makes another of random size
+ */
+static void stir(void) {
+    long i = rand() % NOISE;
+
+    free(noise[i]);
+    noise[i] = malloc(16 + rand() % 240);
+}
+
+/*
+ * the keys present are live[0 .. n-1]; returns ns per get(), and in
+ * `*scan' ns per entry of a scan, or -1.0 if a key or value is wrong
+ */
+static double probe(const CSKMap *m, long *live, long n, double *scan) {
+    const Iterator *it;
+    double start = now();
+    long i, count = 0L;
+    char key[64];
+    MEntry *e;
+    void *v;
+
+    srand(415);
+    for (i = 0L; i < n; i++) {
+        long k = live[rand() % n];
+        makeKey(key, k);
+        if (! m->get(m, key, &v) || (long)v != k)
+            return -1.0;
+    }
+    start = now() - start;
+    *scan = now();
+    if ((it = m->itCreate(m)) == NULL)
+        return -1.0;
+    while (it->next(it, (void **)&e))
+        count += (atol(e->key + 5) == (long)e->value);
+    it->destroy(it);
+    *scan = (now() - *scan) / n * 1e9;
+    return (count == n) ? start / n * 1e9 : -1.0;
+}
+
+/*
+ * returns the time taken by a pass, or -1.0 if compact() failed
+ */
+static double compact(const CSKMap *m, long step, long *calls, double *longest) {
+    double start = now(), t;
+    long left;
+
+    *calls = 0L;
+    *longest = 0.0;
+    do {
+        t = now();
+        left = HashCSKMap_compact(m, step);
+        t = now() - t;
+        if (t > *longest)
+            *longest = t;
+        (*calls)++;
+    } while (left > 0L);
+    return (left < 0L) ? -1.0 : now() - start;
+}
+
+int main(int argc, char *argv[]) {
+    long n = 1000000L, churn = 4L, step = 4096L, next, i, calls;
+    double get[3], scan[3], longest, total;
+    const CSKMap *m = HashCSKMap(0L, 0.0, doNothing);
+    char key[64];
+    long *live;
+    BenchOption options[] = {
+        {'n', 'l', &n, "entries"},
+        {'c', 'l', &churn, "churn"},
+        {'s', 'l', &step, "step"},
+        {'\0', '\0', NULL, NULL}
+    };
+
+    if (! getOptions(argc, argv, options))
+        return EXIT_FAILURE;
+    live = (long *)malloc(n * sizeof(long));
+    noise = (void **)calloc(NOISE, sizeof(void *));
+    if (m == NULL || live == NULL || noise == NULL) {
+        fprintf(stderr, "%s: unable to allocate map and arrays\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    for (i = 0L; i < n; i++) {
+        live[i] = i;
+        makeKey(key, i);
+        m->put(m, key, (void *)i);
+    }
+    get[0] = probe(m, live, n, &scan[0]);
+    srand(416);
+    for (next = n, i = 0L; i < churn * n; i++, next++) {
+        long j = rand() % n;
+        makeKey(key, live[j]);
+        m->remove(m, key);
+        makeKey(key, next);
+        m->put(m, key, (void *)next);
+        live[j] = next;
+        stir();
+    }
+    get[1] = probe(m, live, n, &scan[1]);
+    total = compact(m, step, &calls, &longest);
+    get[2] = probe(m, live, n, &scan[2]);
+    if (get[0] < 0.0 || get[1] < 0.0 || get[2] < 0.0 || total < 0.0) {
+        fprintf(stderr, "%s: wrong value or compact() failed\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    printf("%10s %10s %10s %10s   (ns)\n", "", "fresh", "aged", "compacted");
+    printf("%10s %10.1f %10.1f %10.1f\n", "get()", get[0], get[1], get[2]);
+    printf("%10s %10.1f %10.1f %10.1f\n", "scan", scan[0], scan[1], scan[2]);
+    printf("compaction: %ld calls, longest %.0f us, total %.0f ms\n", calls,
+           longest * 1e6, total * 1e3);
+    m->destroy(m);
+    for (i = 0L; i < NOISE; i++)
+        free(noise[i]);
+    free(noise);
+    free(live);
+    return EXIT_SUCCESS;
+}
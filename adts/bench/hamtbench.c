@@ -0,0 +1,106 @@
+/*
+ * benchmark for HAMTMap against HashMap
+ *
+ * for a map of `n' long keys:
+ *
+ * - build: put() each key into an empty map
+ * - get: get() each key
+ * - versions: `v' times, take a snapshot of the map and put() one key
+ *   into the snapshot, keeping every version; a HashMap snapshot is a
+ *   create() followed by a put() of every entry
+ *
+ * the time per operation is reported, and the number of entries visible
+ * in the oldest and newest versions is checked
+ */
+
+#include "ADTs/hamtmap.h"
+#include "ADTs/hashmap.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * returns a copy of m, which holds `n' entries
+ */
+static const Map *copy(const Map *m, long n) {
+    const Map *c = HAMTMap_snapshot(m);
+    MEntry **entries;
+    long i, len;
+
+    if (c != NULL)
+        return c;
+    c = HashMap(2 * n, 0.0, hashLong, cmpLong, doNothing, doNothing);
+    if (c == NULL || (entries = m->entryArray(m, &len)) == NULL)
+        return c;
+    for (i = 0; i < len; i++)
+        c->put(c, entries[i]->key, entries[i]->value);
+    free(entries);
+    return c;
+}
+
+/*
+ * runs the three workloads on m, printing ns per operation;
+ * returns 0 if the checks fail
+ */
+static int trial(const char *name, const Map *m, long n, long v) {
+    const Map **versions = (const Map **)malloc((v + 1) * sizeof(Map *));
+    double t0, t1, t2, t3;
+    long i, sum = 0L;
+    void *value;
+    int ok;
+
+    if (versions == NULL)
+        return 0;
+    t0 = now();
+    for (i = 0; i < n; i++)
+        m->put(m, (void *)i, (void *)i);
+    t1 = now();
+    for (i = 0; i < n; i++)
+        if (m->get(m, (void *)i, &value))
+            sum += (long)value;
+    t2 = now();
+    versions[0] = m;
+    for (i = 1; i <= v; i++) {
+        versions[i] = copy(versions[i - 1], n + i - 1);
+        versions[i]->put(versions[i], (void *)(n + i - 1), NULL);
+    }
+    t3 = now();
+    ok = (sum == n * (n - 1) / 2 && m->size(m) == n &&
+          versions[v]->size(versions[v]) == n + v);
+    for (i = 1; i <= v; i++)
+        versions[i]->destroy(versions[i]);
+    free(versions);
+    printf("%10s %10.1f %10.1f %14.1f\n", name, (t1 - t0) / n * 1e9,
+           (t2 - t1) / n * 1e9, (t3 - t2) / v * 1e9);
+    return ok;
+}
+
+int main(int argc, char *argv[]) {
+    long n = 100000L, v = 100L;
+    const Map *h, *t;
+    int ok;
+    BenchOption options[] = {
+        {'n', 'l', &n, "elements"},
+        {'v', 'l', &v, "versions"},
+        {'\0', '\0', NULL, NULL}
+    };
+
+    if (! getOptions(argc, argv, options))
+        return EXIT_FAILURE;
+    h = HashMap(2 * n, 0.0, hashLong, cmpLong, doNothing, doNothing);
+    t = HAMTMap(hashLong, cmpLong, doNothing, doNothing);
+    if (h == NULL || t == NULL) {
+        fprintf(stderr, "%s: unable to create maps\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    printf("%10s %10s %10s %14s   (ns/op)\n", "", "put", "get",
+           "snapshot+put");
+    ok = trial("HAMTMap", t, n, v) && trial("HashMap", h, n, v);
+    h->destroy(h);
+    t->destroy(t);
+    if (! ok) {
+        fprintf(stderr, "%s: versions are inconsistent\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,113 @@
+/*
+ * benchmark for the ways of looping over an ArrayList
+ *
+ * sums `n' longs held in an ArrayList, `reps' times, using:
+ *
+ * - get() for each index
+ * - an Iterator, with hasNext() and next() for each element
+ * - an Iterator, with nextBatch() into a buffer of `batch' elements
+ * - span(), looping over the backing array directly
+ *
+ * the sums are checked against each other
+ */
+
+#include "ADTs/arraylist.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static long byGet(const ArrayList *al) {
+    long i, n = al->size(al), sum = 0L;
+
+    for (i = 0; i < n; i++) {
+        void *v;
+
+        al->get(al, i, &v);
+        sum += (long)v;
+    }
+    return sum;
+}
+
+static long byNext(const ArrayList *al) {
+    const Iterator *it = al->itCreate(al);
+    long sum = 0L;
+    void *v;
+
+    while (it->hasNext(it)) {
+        it->next(it, &v);
+        sum += (long)v;
+    }
+    it->destroy(it);
+    return sum;
+}
+
+static long byBatch(const ArrayList *al, void **buf, long batch) {
+    const Iterator *it = al->itCreate(al);
+    long i, n, sum = 0L;
+
+    while ((n = it->nextBatch(it, buf, batch)) > 0L)
+        for (i = 0; i < n; i++)
+            sum += (long)buf[i];
+    it->destroy(it);
+    return sum;
+}
+
+static long bySpan(const ArrayList *al) {
+    long i, n, sum = 0L;
+    void **a = al->span(al, &n);
+
+    for (i = 0; i < n; i++)
+        sum += (long)a[i];
+    return sum;
+}
+
+int main(int argc, char *argv[]) {
+    long n = 1000000L, reps = 20L, batch = 256L, i, r;
+    long sums[4] = {0L, 0L, 0L, 0L};
+    double times[4] = {0.0, 0.0, 0.0, 0.0};
+    const char *names[4] = {"get()", "hasNext/next", "nextBatch", "span"};
+    const ArrayList *al;
+    void **buf;
+    int k;
+    BenchOption options[] = {
+        {'n', 'l', &n, "elements"},
+        {'r', 'l', &reps, "reps"},
+        {'b', 'l', &batch, "batch"},
+        {'\0', '\0', NULL, NULL}
+    };
+
+    if (! getOptions(argc, argv, options))
+        return EXIT_FAILURE;
+    al = ArrayList_create(n, doNothing);
+    buf = (void **)malloc(batch * sizeof(void *));
+    if (al == NULL || buf == NULL) {
+        fprintf(stderr, "%s: unable to allocate list\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    for (i = 0; i < n; i++)
+        al->add(al, ADT_VALUE(i));
+    for (r = 0; r < reps; r++) {
+        for (k = 0; k < 4; k++) {
+            double start = now();
+
+            switch (k) {
+            case 0: sums[k] += byGet(al); break;
+            case 1: sums[k] += byNext(al); break;
+            case 2: sums[k] += byBatch(al, buf, batch); break;
+            case 3: sums[k] += bySpan(al); break;
+            }
+            times[k] += now() - start;
+        }
+    }
+    for (k = 0; k < 4; k++) {
+        if (sums[k] != sums[0]) {
+            fprintf(stderr, "%s: %s sum is wrong\n", argv[0], names[k]);
+            return EXIT_FAILURE;
+        }
+        printf("%14s %8.2f ns/element\n", names[k],
+               times[k] * 1e9 / (n * reps));
+    }
+    free(buf);
+    al->destroy(al);
+    return EXIT_SUCCESS;
+}
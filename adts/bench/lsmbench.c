@@ -0,0 +1,130 @@
+/*
+ * benchmark for LSMStore
+ *
+ * for 1, 2, 4, ..., maxThreads threads, a new store in `dir' is loaded
+ * with `n' put()s of distinct 16-byte keys and `v'-byte values, shared
+ * among the threads; since each put() returns only once its record is
+ * durable, one thread pays an fdatasync() per put(), while several share
+ * each one through group commit
+ *
+ * the last store is then read back: `n' get()s of keys present, in random
+ * order, and `n' get()s of keys that are not, most of which the Bloom
+ * filters answer without reading; every value is checked
+ */
+
+#include "ADTs/lsmstore.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+typedef struct worker {
+    pthread_t tid;
+    const LSMStore *s;
+    long first;                 /* keys first, first+step, ... < n */
+    long step;
+    long n;
+    long v;
+    long failures;
+} Worker;
+
+static void makeKey(char *buf, long k) {
+    sprintf(buf, "k%015ld", k);
+}
+
+static void makeValue(char *buf, long k, long v) {
+    long i;
+
+    for (i = 0L; i < v; i++)
+        buf[i] = 'a' + (k + i) % 26;
+    buf[v] = '\0';
+}
+
+static void *run(void *arg) {
+    Worker *w = (Worker *)arg;
+    char key[32], value[w->v + 1];
+    long k;
+
+    for (k = w->first; k < w->n; k += w->step) {
+        makeKey(key, k);
+        makeValue(value, k, w->v);
+        if (! w->s->put(w->s, key, value))
+            w->failures++;
+    }
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    long n = 200000L, v = 100L, i, failures = 0L, bytes;
+    int maxThreads = 16, t, nthreads;
+    char *dir = "/tmp/lsmbench";
+    const LSMStore *s = NULL;
+    double start, elapsed;
+    BenchOption options[] = {
+        {'d', 's', &dir, "dir"},
+        {'n', 'l', &n, "puts"},
+        {'v', 'l', &v, "valueBytes"},
+        {'t', 'i', &maxThreads, "maxThreads"},
+        {'\0', '\0', NULL, NULL}
+    };
+
+    if (! getOptions(argc, argv, options))
+        return EXIT_FAILURE;
+    printf("%8s %12s %12s %8s\n", "threads", "puts/s", "MB/s", "tables");
+    for (nthreads = 1; nthreads <= maxThreads; nthreads *= 2) {
+        Worker w[nthreads];
+
+        if (s != NULL)
+            s->close(s);
+        removeDir(dir);
+        if ((s = LSMStore_create(dir, 0L)) == NULL) {
+            fprintf(stderr, "%s: unable to create store in %s\n", argv[0],
+                    dir);
+            return EXIT_FAILURE;
+        }
+        start = now();
+        for (t = 0; t < nthreads; t++) {
+            w[t] = (Worker){0, s, t, nthreads, n, v, 0L};
+            pthread_create(&w[t].tid, NULL, run, &w[t]);
+        }
+        for (t = 0; t < nthreads; t++) {
+            pthread_join(w[t].tid, NULL);
+            failures += w[t].failures;
+        }
+        elapsed = now() - start;
+        printf("%8d %12.0f %12.2f %8ld\n", nthreads, n / elapsed,
+               n * (16.0 + v) / elapsed / 1e6, s->tables(s, &bytes));
+    }
+    if (failures > 0L || ! s->compact(s)) {
+        fprintf(stderr, "%s: put() or compact() failed\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    printf("compacted: %ld tables, %ld bytes\n", s->tables(s, &bytes), bytes);
+    for (t = 0; t < 2; t++) {
+        char key[32], want[v + 1], *got;
+
+        srand(415);
+        start = now();
+        for (i = 0L; i < n; i++) {
+            long k = rand() % n;
+            makeKey(key, (t == 0) ? k : n + k);
+            makeValue(want, k, v);
+            if (s->get(s, key, &got)) {
+                failures += (t != 0 || strcmp(got, want) != 0);
+                free(got);
+            } else
+                failures += (t == 0);
+        }
+        elapsed = now() - start;
+        printf("get() of keys %s: %.2f us each\n",
+               (t == 0) ? "present" : "absent", elapsed / n * 1e6);
+    }
+    if (! s->close(s) || failures > 0L) {
+        fprintf(stderr, "%s: wrong values read\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    removeDir(dir);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,169 @@
+/*
+ * contention benchmark for SkipListMap
+ *
+ * for 1, 2, 4, ..., maxThreads threads, each thread performs `ops'
+ * operations on one shared map over a key range of `keys' keys: 80% get(),
+ * 10% put(), and 10% remove(); the skip-list map is compared with a
+ * HashMap guarded by a pthread mutex, which is what callers had to use
+ * before
+ *
+ * afterwards, the skip-list map's entryArray() must be in strictly
+ * ascending key order and agree with size(); a reader thread also checks
+ * the order of itCreate() while the updates are running
+ */
+
+#include "ADTs/skiplistmap.h"
+#include "ADTs/hashmap.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+typedef struct worker {
+    pthread_t tid;
+    const Map *m;
+    pthread_mutex_t *lock;      /* NULL for the skip-list map */
+    unsigned int seed;
+    long ops;
+    long keys;
+} Worker;
+
+static atomic_bool running;
+static atomic_long disorders;
+
+static void *run(void *arg) {
+    Worker *w = (Worker *)arg;
+    long i;
+    void *v;
+
+    for (i = 0; i < w->ops; i++) {
+        int r = rand_r(&w->seed) % 10;
+        long k = 1L + rand_r(&w->seed) % w->keys;
+
+        if (w->lock != NULL)
+            pthread_mutex_lock(w->lock);
+        if (r == 0)
+            w->m->put(w->m, ADT_VALUE(k), ADT_VALUE(k));
+        else if (r == 1)
+            w->m->remove(w->m, ADT_VALUE(k));
+        else if (w->m->get(w->m, ADT_VALUE(k), &v) && (long)v != k)
+            atomic_fetch_add(&disorders, 1L);
+        if (w->lock != NULL)
+            pthread_mutex_unlock(w->lock);
+    }
+    return NULL;
+}
+
+/*
+ * iterates over the map until the updaters finish, counting any pair of
+ * successive entries that are out of order
+ */
+static void *scan(void *arg) {
+    const Map *m = (const Map *)arg;
+
+    while (atomic_load(&running)) {
+        const Iterator *it = m->itCreate(m);
+        MEntry *e;
+        long prev = 0L;
+
+        if (it == NULL)
+            continue;
+        while (it->hasNext(it)) {
+            (void)it->next(it, ADT_ADDRESS(&e));
+            if ((long)e->key <= prev)
+                atomic_fetch_add(&disorders, 1L);
+            prev = (long)e->key;
+        }
+        it->destroy(it);
+    }
+    return NULL;
+}
+
+/*
+ * returns millions of operations per second, or -1.0 on failure
+ */
+static double trial(const Map *m, pthread_mutex_t *lock, int nthreads,
+                    long ops, long keys) {
+    Worker *w = (Worker *)malloc(nthreads * sizeof(Worker));
+    pthread_t reader;
+    double start, elapsed;
+    int i;
+
+    if (w == NULL)
+        return -1.0;
+    atomic_store(&running, true);
+    if (lock == NULL)
+        pthread_create(&reader, NULL, scan, (void *)m);
+    start = now();
+    for (i = 0; i < nthreads; i++) {
+        w[i].m = m;
+        w[i].lock = lock;
+        w[i].seed = 415U + i;
+        w[i].ops = ops;
+        w[i].keys = keys;
+        pthread_create(&w[i].tid, NULL, run, &w[i]);
+    }
+    for (i = 0; i < nthreads; i++)
+        pthread_join(w[i].tid, NULL);
+    elapsed = now() - start;
+    atomic_store(&running, false);
+    if (lock == NULL) {
+        MEntry **a;
+        long len = 0L, j;
+
+        pthread_join(reader, NULL);
+        a = m->entryArray(m, &len);
+        if (len != m->size(m))
+            atomic_fetch_add(&disorders, 1L);
+        for (j = 1; j < len; j++)
+            if ((long)a[j - 1]->key >= (long)a[j]->key)
+                atomic_fetch_add(&disorders, 1L);
+        free(a);
+    }
+    free(w);
+    if (atomic_load(&disorders) != 0L)
+        return -1.0;
+    return (nthreads * ops) / elapsed / 1e6;
+}
+
+int main(int argc, char *argv[]) {
+    long ops = 1000000L, keys = 100000L, i;
+    int maxThreads = 64, n;
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    const Map *sl = SkipListMap(cmpLong, doNothing, doNothing);
+    const Map *hm = HashMap(0L, 0.0, hashLong, cmpLong, doNothing, doNothing);
+    BenchOption options[] = {
+        {'n', 'l', &ops, "opsPerThread"},
+        {'k', 'l', &keys, "keys"},
+        {'t', 'i', &maxThreads, "maxThreads"},
+        {'\0', '\0', NULL, NULL}
+    };
+
+    if (! getOptions(argc, argv, options))
+        return EXIT_FAILURE;
+    if (sl == NULL || hm == NULL) {
+        fprintf(stderr, "%s: unable to create maps\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    for (i = 1; i <= keys; i += 2) {        /* start half full */
+        sl->put(sl, ADT_VALUE(i), ADT_VALUE(i));
+        hm->put(hm, ADT_VALUE(i), ADT_VALUE(i));
+    }
+    printf("%8s %16s %16s   (Mops/s)\n", "threads", "SkipListMap",
+           "HashMap+mutex");
+    for (n = 1; n <= maxThreads; n *= 2) {
+        double a = trial(sl, NULL, n, ops / n, keys);
+        double b = trial(hm, &lock, n, ops / n, keys);
+
+        if (a < 0.0 || b < 0.0) {
+            fprintf(stderr, "%s: inconsistent map with %d threads\n",
+                    argv[0], n);
+            return EXIT_FAILURE;
+        }
+        printf("%8d %16.2f %16.2f\n", n, a, b);
+    }
+    sl->destroy(sl);
+    hm->destroy(hm);
+    return EXIT_SUCCESS;
+}
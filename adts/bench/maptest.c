@@ -0,0 +1,875 @@
+/*
+ * behavioural tests for the Map ADTs, their iterators, and the direct-call
+ * API of the array and hash implementations
+ *
+ * each test number given on the command line is run in turn, and prints
+ * "Test ... success" or "Test ... failure"; these are kept apart from
+ * adttest because map.h and cskmap.h both define MEntry
+ */
+
+#include "ADTs/arraydeque.h"
+#include "ADTs/arraylist.h"
+#include "ADTs/arrayqueue.h"
+#include "ADTs/arraystack.h"
+#include "ADTs/hamtmap.h"
+#include "ADTs/hashmap.h"
+#include "ADTs/mergeiterator.h"
+#include "ADTs/skiplistmap.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#define USAGE "usage: %s test# . . .\n"
+#define NTHREADS 4
+
+static long freed = 0L;         /* calls of countFree() */
+
+static void countFree(void *v) {
+    (void)v;
+    freed++;
+}
+
+static long widest = 0L;        /* largest N passed to hashWidest() */
+
+static long hashWidest(void *key, long N) {
+    if (N > widest)
+        widest = N;
+    return hashLong(key, N);
+}
+
+/*
+ * returns the number of entries returned by `it', which are counted in
+ * seen[key], after destroying it; values must be 10 * key
+ */
+static long drain(const Iterator *it, long seen[], long n) {
+    MEntry *e;
+    long count = 0L;
+
+    while (it->next(it, (void **)&e)) {
+        long k = (long)e->key;
+        if (k >= 0L && k < n && (long)e->value == 10L * k)
+            seen[k]++;
+        count++;
+    }
+    it->destroy(it);
+    return count;
+}
+
+/*
+ * the helpers below apply the same random operations to two instances,
+ * `a' through the dispatch table and `b' through the direct-call API,
+ * and return true if every result agrees; inserts only slightly outnumber
+ * removals, so that the buffers both grow and wrap around
+ */
+#define DIRECT_OPS 20000L
+
+static bool directList(void) {
+    const ArrayList *a = ArrayList_create(4L, doNothing);
+    const ArrayList *b = ArrayList_create(4L, doNothing);
+    void *va = NULL, *vb = NULL;
+    long j;
+    bool ok = (a != NULL && b != NULL);
+
+    for (j = 0L; ok && j < DIRECT_OPS; j++) {
+        long k = rand() % 100L;
+        long n = a->size(a);
+        if (k < 50L)
+            ok = a->add(a, ADT_VALUE(j)) == ArrayList_add(b, ADT_VALUE(j));
+        else if (k < 75L)
+            ok = a->get(a, k - 50L, &va) == ArrayList_get(b, k - 50L, &vb) &&
+                 (k - 50L >= n || va == vb);
+        else if (k < 90L)
+            ok = a->set(a, k * n / 100L, ADT_VALUE(-j)) ==
+                 ArrayList_set(b, k * n / 100L, ADT_VALUE(-j));
+        else
+            ok = a->isEmpty(a) == ArrayList_isEmpty(b);
+        ok = ok && a->size(a) == ArrayList_size(b);
+    }
+    for (j = 0L; ok && j < a->size(a); j++)
+        ok = a->get(a, j, &va) && ArrayList_get(b, j, &vb) && va == vb;
+    if (a != NULL)
+        a->destroy(a);
+    if (b != NULL)
+        b->destroy(b);
+    return ok;
+}
+
+static bool directStack(void) {
+    const Stack *a = ArrayStack(4L, doNothing);
+    const Stack *b = ArrayStack(4L, doNothing);
+    void *va = NULL, *vb = NULL;
+    long j;
+    bool ok = (a != NULL && b != NULL);
+
+    for (j = 0L; ok && j < DIRECT_OPS; j++) {
+        long k = rand() % 100L;
+        if (k < 46L)
+            ok = a->push(a, ADT_VALUE(j)) == ArrayStack_push(b, ADT_VALUE(j));
+        else if (k < 90L)
+            ok = a->pop(a, &va) == ArrayStack_pop(b, &vb) && va == vb;
+        else
+            ok = a->peek(a, &va) == ArrayStack_peek(b, &vb) && va == vb &&
+                 a->isEmpty(a) == ArrayStack_isEmpty(b);
+        ok = ok && a->size(a) == ArrayStack_size(b);
+    }
+    if (a != NULL)
+        a->destroy(a);
+    if (b != NULL)
+        b->destroy(b);
+    return ok;
+}
+
+static bool directQueue(void) {
+    const Queue *a = ArrayQueue(4L, doNothing);
+    const Queue *b = ArrayQueue(4L, doNothing);
+    void *va = NULL, *vb = NULL;
+    long j;
+    bool ok = (a != NULL && b != NULL);
+
+    for (j = 0L; ok && j < DIRECT_OPS; j++) {
+        long k = rand() % 100L;
+        if (k < 46L)
+            ok = a->enqueue(a, ADT_VALUE(j)) ==
+                 ArrayQueue_enqueue(b, ADT_VALUE(j));
+        else if (k < 90L)
+            ok = a->dequeue(a, &va) == ArrayQueue_dequeue(b, &vb) && va == vb;
+        else
+            ok = a->front(a, &va) == ArrayQueue_front(b, &vb) && va == vb &&
+                 a->isEmpty(a) == ArrayQueue_isEmpty(b);
+        ok = ok && a->size(a) == ArrayQueue_size(b);
+    }
+    if (a != NULL)
+        a->destroy(a);
+    if (b != NULL)
+        b->destroy(b);
+    return ok;
+}
+
+static bool directDeque(void) {
+    const Deque *a = ArrayDeque(4L, doNothing);
+    const Deque *b = ArrayDeque(4L, doNothing);
+    void *va = NULL, *vb = NULL;
+    long j;
+    bool ok = (a != NULL && b != NULL);
+
+    for (j = 0L; ok && j < DIRECT_OPS; j++) {
+        long k = rand() % 100L;
+        if (k < 23L)
+            ok = a->insertFirst(a, ADT_VALUE(j)) ==
+                 ArrayDeque_insertFirst(b, ADT_VALUE(j));
+        else if (k < 46L)
+            ok = a->insertLast(a, ADT_VALUE(j)) ==
+                 ArrayDeque_insertLast(b, ADT_VALUE(j));
+        else if (k < 68L)
+            ok = a->removeFirst(a, &va) == ArrayDeque_removeFirst(b, &vb) &&
+                 va == vb;
+        else if (k < 90L)
+            ok = a->removeLast(a, &va) == ArrayDeque_removeLast(b, &vb) &&
+                 va == vb;
+        else
+            ok = a->first(a, &va) == ArrayDeque_first(b, &vb) && va == vb &&
+                 a->last(a, &va) == ArrayDeque_last(b, &vb) && va == vb &&
+                 a->isEmpty(a) == ArrayDeque_isEmpty(b);
+        ok = ok && a->size(a) == ArrayDeque_size(b);
+    }
+    if (a != NULL)
+        a->destroy(a);
+    if (b != NULL)
+        b->destroy(b);
+    return ok;
+}
+
+static bool directHashMap(void) {
+    const Map *a = HashMap(4L, 0.0, hashLong, cmpLong, doNothing, doNothing);
+    const Map *b = HashMap(4L, 0.0, hashLong, cmpLong, doNothing, doNothing);
+    void *va = NULL, *vb = NULL;
+    long j;
+    bool ok = (a != NULL && b != NULL);
+
+    for (j = 0L; ok && j < DIRECT_OPS; j++) {
+        long k = rand() % 100L;
+        void *key = ADT_VALUE(rand() % 2000L);
+        if (k < 30L)
+            ok = a->put(a, key, ADT_VALUE(j)) ==
+                 HashMap_put(b, key, ADT_VALUE(j));
+        else if (k < 50L)
+            ok = a->putUnique(a, key, ADT_VALUE(j)) ==
+                 HashMap_putUnique(b, key, ADT_VALUE(j));
+        else if (k < 70L)
+            ok = a->remove(a, key) == HashMap_remove(b, key);
+        else if (k < 90L)
+            ok = a->get(a, key, &va) == HashMap_get(b, key, &vb) && va == vb;
+        else
+            ok = a->containsKey(a, key) == HashMap_containsKey(b, key) &&
+                 a->isEmpty(a) == HashMap_isEmpty(b);
+        ok = ok && a->size(a) == HashMap_size(b);
+    }
+    if (a != NULL)
+        a->destroy(a);
+    if (b != NULL)
+        b->destroy(b);
+    return ok;
+}
+
+/*
+ * returns true if `it' returns 0, 1, ..., n-1, fetched by a mixture of
+ * next() and nextBatch() calls of several sizes, and then no more; the
+ * iterator is destroyed
+ */
+static bool batches(const Iterator *it, long n) {
+    long sizes[] = {1L, 7L, 0L, 64L, 1000L}, j = 0L, k, got;
+    void *buf[1000];
+    int s = 0;
+    bool ok = (it != NULL);
+
+    while (ok && j < n) {
+        if (s % 3 == 1) {
+            ok = it->next(it, &buf[0]) && (long)buf[0] == j++;
+        } else {
+            got = it->nextBatch(it, buf, sizes[s % 5]);
+            ok = got == ((n - j < sizes[s % 5]) ? n - j : sizes[s % 5]);
+            for (k = 0L; ok && k < got; k++)
+                ok = (long)buf[k] == j++;
+        }
+        s++;
+    }
+    ok = ok && it->nextBatch(it, buf, 10L) == 0L && ! it->hasNext(it);
+    if (it != NULL)
+        it->destroy(it);
+    return ok;
+}
+
+/*
+ * returns true if the entries of `m' are in strictly ascending key order,
+ * each with value 10 * key, and there are size() of them
+ */
+static bool ascending(const Map *m) {
+    const Iterator *it = m->itCreate(m);
+    MEntry *e;
+    long count = 0L, last = -1L;
+    bool ok = true;
+
+    if (it == NULL)
+        return m->isEmpty(m);
+    while (it->next(it, (void **)&e)) {
+        if ((long)e->key <= last || (long)e->value != 10L * (long)e->key)
+            ok = false;
+        last = (long)e->key;
+        count++;
+    }
+    it->destroy(it);
+    return ok && count == m->size(m);
+}
+
+/*
+ * the value that version `v' of the map built by maptest 9 holds for key
+ * k, or -1L if none; see the test for how each version is made
+ */
+static long hamtWant(int v, long k) {
+    if (v == 0)
+        return (k < 1000L || (k >= 2000L && k < 2100L)) ? 10L * k : -1L;
+    if (v == 3 && k == 1L)
+        return -1L;
+    if (v >= 2 && k == 5000L)
+        return 50002L;
+    return (k < 1000L && k % 2L == 1L) ? 10L * k + 1L : -1L;
+}
+
+/*
+ * returns true if `m' holds exactly the entries that want(v, k) gives for
+ * 0 <= k < n, through get(), size() and an iterator
+ */
+static bool hamtHolds(const Map *m, int v, long n, long (*want)(int, long)) {
+    const Iterator *it;
+    MEntry *e;
+    long k, count = 0L, entries = 0L;
+    void *val;
+    bool ok = (m != NULL);
+
+    for (k = 0L; ok && k < n; k++) {
+        long w = want(v, k);
+        if (w >= 0L) {
+            ok = m->get(m, ADT_VALUE(k), &val) && (long)val == w;
+            count++;
+        } else
+            ok = ! m->containsKey(m, ADT_VALUE(k));
+    }
+    if (ok && (it = m->itCreate(m)) != NULL) {
+        while (it->next(it, (void **)&e))
+            if (want(v, (long)e->key) == (long)e->value)
+                entries++;
+        it->destroy(it);
+    }
+    return ok && m->size(m) == count && entries == count;
+}
+
+/* a hash under which every key collides with a quarter of the others */
+static long hashQuarter(void *key, long N) {
+    (void)N;
+    return (long)key % 4L;
+}
+
+static long collideWant(int v, long k) {
+    if (k >= 200L)
+        return -1L;
+    return (v == 0 || k % 2L == 1L) ? 10L * k : -1L;
+}
+
+/*
+ * the elements merged by maptest 11: keys are few, so that most compare
+ * equal, and each remembers where it came from
+ */
+typedef struct rec {
+    long key;
+    long source;
+    long seq;                   /* position in its source */
+} Rec;
+
+#define MERGE_SOURCES 7L
+#define MERGE_LEN 3000L
+
+static int cmpRec(void *p1, void *p2) {
+    long k1 = ((Rec *)p1)->key, k2 = ((Rec *)p2)->key;
+    return (k1 < k2) ? -1 : (k1 > k2) ? 1 : 0;
+}
+
+/*
+ * returns true if `it' yields all `n' elements in key order, those with
+ * equal keys in source order, and then in their order within the source;
+ * the iterator is destroyed
+ */
+static bool stable(const Iterator *it, long n) {
+    Rec *prev = NULL, *r;
+    void *buf[16];
+    long count = 0L, got, j;
+    bool ok = (it != NULL);
+
+    while (ok && (got = (count % 2L) ? it->nextBatch(it, buf, 16L) :
+                        (it->next(it, &buf[0]) ? 1L : 0L)) > 0L)
+        for (j = 0L; ok && j < got; j++, count++) {
+            r = (Rec *)buf[j];
+            ok = prev == NULL || prev->key < r->key ||
+                 (prev->key == r->key && (prev->source < r->source ||
+                  (prev->source == r->source && prev->seq < r->seq)));
+            prev = r;
+        }
+    if (it != NULL)
+        it->destroy(it);
+    return ok && count == n;
+}
+
+#define SL_KEYS 20000L
+
+typedef struct slWorker {
+    pthread_t tid;
+    const Map *m;
+    long first;                 /* writes first, first+NTHREADS, ... */
+    bool ok;
+} SLWorker;
+
+/*
+ * puts its keys with a wrong value, replaces them with the right one, then
+ * removes every third; keys are interleaved with those of other workers,
+ * so that neighbouring nodes are changed concurrently
+ */
+static void *slWriter(void *arg) {
+    SLWorker *w = (SLWorker *)arg;
+    long k;
+
+    w->ok = true;
+    for (k = w->first; k < SL_KEYS; k += NTHREADS)
+        w->ok &= w->m->putUnique(w->m, ADT_VALUE(k), ADT_VALUE(k));
+    for (k = w->first; k < SL_KEYS; k += NTHREADS)
+        w->ok &= w->m->put(w->m, ADT_VALUE(k), ADT_VALUE(10L * k));
+    for (k = w->first; k < SL_KEYS; k += NTHREADS)
+        if (k % 3L == 0L)
+            w->ok &= w->m->remove(w->m, ADT_VALUE(k));
+    return NULL;
+}
+
+/*
+ * reads while the writers run; a key, once found, must map to k or 10 * k
+ */
+static void *slReader(void *arg) {
+    SLWorker *w = (SLWorker *)arg;
+    long k, round;
+    void *v;
+
+    w->ok = true;
+    for (round = 0L; round < 5L; round++)
+        for (k = 0L; k < SL_KEYS; k++)
+            if (w->m->get(w->m, ADT_VALUE(k), &v) &&
+                (long)v != k && (long)v != 10L * k)
+                w->ok = false;
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    int i;
+
+    if (argc < 2) {
+        fprintf(stderr, USAGE, argv[0]);
+        return EXIT_FAILURE;
+    }
+    for (i = 1; i < argc; i++) {
+        int test = 0;
+        sscanf(argv[i], "%d", &test);
+        switch(test) {
+          case 1: {
+            printf("Test HashMap iterator sees the map as it was created ... ");
+            const Map *m = HashMap(64L, 0.0, hashLong, cmpLong, doNothing,
+                                   doNothing);
+            const Iterator *it;
+            long seen[1000], j;
+            int success;
+
+            for (j = 0L; j < 1000L; j++) {
+                seen[j] = 0L;
+                m->put(m, ADT_VALUE(j), ADT_VALUE(10L * j));
+            }
+            it = m->itCreate(m);
+            for (j = 0L; j < 1000L; j += 2L)
+                m->remove(m, ADT_VALUE(j));
+            for (j = 1L; j < 1000L; j += 2L)
+                m->put(m, ADT_VALUE(j), ADT_VALUE(j));
+            for (j = 1000L; j < 2000L; j++)
+                m->put(m, ADT_VALUE(j), ADT_VALUE(10L * j));
+            success = (it != NULL) && drain(it, seen, 1000L) == 1000L &&
+                      m->size(m) == 1500L;
+            for (j = 0L; j < 1000L; j++)
+                if (seen[j] != 1L)
+                    success = 0;
+            if (success)
+                printf("success\n");
+            else
+                printf("failure\n");
+            m->destroy(m);
+            break;
+          }
+          case 2: {
+            printf("Test HashMap defers frees until the last iterator ... ");
+            const Map *m = HashMap(64L, 0.0, hashLong, cmpLong, doNothing,
+                                   countFree);
+            const Iterator *it1, *it2;
+            long seen[200], j;
+            int success;
+
+            freed = 0L;
+            for (j = 0L; j < 200L; j++) {
+                seen[j] = 0L;
+                m->put(m, ADT_VALUE(j), ADT_VALUE(10L * j));
+            }
+            it1 = m->itCreate(m);
+            it2 = m->itCreate(m);
+            for (j = 0L; j < 100L; j++)
+                m->remove(m, ADT_VALUE(j));
+            m->put(m, ADT_VALUE(150L), ADT_VALUE(0L));
+            success = (it1 != NULL && it2 != NULL) && freed == 0L &&
+                      drain(it1, seen, 200L) == 200L && freed == 0L &&
+                      drain(it2, seen, 200L) == 200L && freed == 101L;
+            m->clear(m);
+            success = success && freed == 201L;
+            for (j = 0L; j < 200L; j++)
+                if (seen[j] != 2L)
+                    success = 0;
+            if (success)
+                printf("success\n");
+            else
+                printf("failure\n");
+            m->destroy(m);
+            break;
+          }
+          case 3: {
+            printf("Test HashMap does not resize while iterated ... ");
+            const Map *m = HashMap(16L, 0.75, hashWidest, cmpLong, doNothing,
+                                   doNothing);
+            const Iterator *it;
+            long j;
+            int success;
+
+            m->put(m, ADT_VALUE(0L), ADT_VALUE(0L));
+            it = m->itCreate(m);
+            widest = 0L;
+            for (j = 1L; j < 10000L; j++)
+                m->put(m, ADT_VALUE(j), ADT_VALUE(10L * j));
+            success = (it != NULL) && widest == 16L &&
+                      m->size(m) == 10000L;
+            if (it != NULL)
+                it->destroy(it);
+            for (j = 10000L; j < 10200L; j++)
+                m->put(m, ADT_VALUE(j), ADT_VALUE(10L * j));
+            success = success && widest > 16L;
+            for (j = 0L; j < 10200L; j++) {
+                void *v;
+                if (! m->get(m, ADT_VALUE(j), &v) || (long)v != 10L * j)
+                    success = 0;
+            }
+            if (success)
+                printf("success\n");
+            else
+                printf("failure\n");
+            m->destroy(m);
+            break;
+          }
+          case 4: {
+            printf("Test HashMap destroyed before its iterator ... ");
+            const Map *m = HashMap(64L, 0.0, hashLong, cmpLong, doNothing,
+                                   countFree);
+            const Iterator *it;
+            long seen[300], j;
+            int success;
+
+            freed = 0L;
+            for (j = 0L; j < 300L; j++) {
+                seen[j] = 0L;
+                m->put(m, ADT_VALUE(j), ADT_VALUE(10L * j));
+            }
+            it = m->itCreate(m);
+            m->remove(m, ADT_VALUE(7L));
+            m->destroy(m);
+            success = (it != NULL) && freed == 0L &&
+                      drain(it, seen, 300L) == 300L && freed == 300L;
+            for (j = 0L; j < 300L; j++)
+                if (seen[j] != 1L)
+                    success = 0;
+            if (success)
+                printf("success\n");
+            else
+                printf("failure\n");
+            break;
+          }
+          case 5: {
+            printf("Test direct calls agree with the dispatch tables ... ");
+            bool success;
+
+            srand(415);
+            success = directList() & directStack() & directQueue() &
+                      directDeque() & directHashMap();
+            if (success)
+                printf("success\n");
+            else
+                printf("failure\n");
+            break;
+          }
+          case 6: {
+            printf("Test SkipListMap keeps its entries in key order ... ");
+            const Map *m = SkipListMap(cmpLong, doNothing, doNothing);
+            long j;
+            void *v;
+            int success = (m != NULL);
+
+            srand(415);
+            for (j = 0L; success && j < 5000L; j++) {
+                long k = rand() % 1000L;
+                if (j % 4L == 3L)
+                    m->remove(m, ADT_VALUE(k));
+                else
+                    m->put(m, ADT_VALUE(k), ADT_VALUE(10L * k));
+                if (j % 500L == 0L)
+                    success = ascending(m);
+            }
+            success = success && ascending(m) &&
+                      m->putUnique(m, ADT_VALUE(-1L), ADT_VALUE(-10L)) &&
+                      ! m->putUnique(m, ADT_VALUE(-1L), ADT_VALUE(-20L)) &&
+                      m->get(m, ADT_VALUE(-1L), &v) && (long)v == -10L &&
+                      m->remove(m, ADT_VALUE(-1L)) &&
+                      ! m->containsKey(m, ADT_VALUE(-1L)) &&
+                      ! m->remove(m, ADT_VALUE(-1L));
+            if (m != NULL) {
+                m->clear(m);
+                success = success && m->isEmpty(m) && m->size(m) == 0L;
+                m->destroy(m);
+            }
+            if (success)
+                printf("success\n");
+            else
+                printf("failure\n");
+            break;
+          }
+          case 7: {
+            printf("Test SkipListMap under concurrent writers and readers ... ");
+            const Map *m = SkipListMap(cmpLong, doNothing, doNothing);
+            SLWorker w[2 * NTHREADS];
+            long k;
+            void *v;
+            int t, success = (m != NULL);
+
+            for (t = 0; m != NULL && t < 2 * NTHREADS; t++) {
+                w[t].m = m;
+                w[t].first = t;
+                pthread_create(&w[t].tid, NULL,
+                               (t < NTHREADS) ? slWriter : slReader, &w[t]);
+            }
+            for (t = 0; m != NULL && t < 2 * NTHREADS; t++) {
+                pthread_join(w[t].tid, NULL);
+                success &= w[t].ok;
+            }
+            for (k = 0L; success && k < SL_KEYS; k++) {
+                bool found = m->get(m, ADT_VALUE(k), &v);
+                if (found != (k % 3L != 0L) || (found && (long)v != 10L * k))
+                    success = 0;
+            }
+            success = success && ascending(m) &&
+                      m->size(m) == SL_KEYS - (SL_KEYS + 2L) / 3L;
+            if (success)
+                printf("success\n");
+            else
+                printf("failure\n");
+            if (m != NULL)
+                m->destroy(m);
+            break;
+          }
+          case 8: {
+            printf("Test Iterator nextBatch() and the array spans ... ");
+            const ArrayList *al = ArrayList_create(0L, doNothing);
+            const Stack *st = ArrayStack(0L, doNothing);
+            const Queue *q = ArrayQueue(16L, doNothing);
+            void **span, **first, **second, *v;
+            long j, len, len1, len2;
+            int success = (al != NULL && st != NULL && q != NULL);
+
+            for (j = 0L; success && j < 5000L; j++)
+                success = al->add(al, ADT_VALUE(j)) &&
+                          st->push(st, ADT_VALUE(j));
+            for (j = 0L; success && j < 10L; j++)   /* so that q wraps */
+                success = q->enqueue(q, ADT_VALUE(-1L)) &&
+                          q->dequeue(q, &v);
+            for (j = 0L; success && j < 12L; j++)
+                success = q->enqueue(q, ADT_VALUE(j));
+            success = success && batches(al->itCreate(al), 5000L) &&
+                      batches(q->itCreate(q), 12L);
+            span = success ? al->span(al, &len) : NULL;
+            success = success && span != NULL && len == 5000L;
+            for (j = 0L; success && j < len; j++)
+                success = (long)span[j] == j;
+            span = success ? ArrayStack_span(st, &len) : NULL;
+            success = success && span != NULL && len == 5000L;
+            for (j = 0L; success && j < len; j++)
+                success = (long)span[j] == j;
+            success = success &&
+                      ArrayQueue_spans(q, &first, &len1, &second, &len2) &&
+                      len1 == 6L && len2 == 6L;
+            for (j = 0L; success && j < 12L; j++)
+                success = (long)((j < len1) ? first[j] : second[j - len1]) == j;
+            if (success) {              /* HashMap has its own nextBatch() */
+                const Map *m = HashMap(0L, 0.0, hashLong, cmpLong, doNothing,
+                                       doNothing);
+                const Iterator *it;
+                void *buf[100];
+                long seen[3000], got, total = 0L;
+
+                for (j = 0L; j < 3000L; j++) {
+                    seen[j] = 0L;
+                    if (m != NULL)
+                        m->put(m, ADT_VALUE(j), ADT_VALUE(10L * j));
+                }
+                it = (m != NULL) ? m->itCreate(m) : NULL;
+                while (it != NULL && (got = it->nextBatch(it, buf, 100L)) > 0L)
+                    for (j = 0L; j < got; j++, total++)
+                        seen[(long)((MEntry *)buf[j])->key]++;
+                for (j = 0L; j < 3000L; j++)
+                    if (seen[j] != 1L)
+                        success = 0;
+                success = success && it != NULL && total == 3000L;
+                if (it != NULL)
+                    it->destroy(it);
+                if (m != NULL)
+                    m->destroy(m);
+            }
+            if (success)
+                printf("success\n");
+            else
+                printf("failure\n");
+            if (al != NULL)
+                al->destroy(al);
+            if (st != NULL)
+                st->destroy(st);
+            if (q != NULL)
+                q->destroy(q);
+            break;
+          }
+          case 9: {
+            printf("Test HAMTMap versions are unchanged by each other ... ");
+            const Map *v[4] = {NULL, NULL, NULL, NULL};
+            long k, n = 5100L;
+            int j, success;
+
+            freed = 0L;
+            v[0] = HAMTMap(hashLong, cmpLong, doNothing, countFree);
+            for (k = 0L; v[0] != NULL && k < 1000L; k++)
+                v[0]->put(v[0], ADT_VALUE(k), ADT_VALUE(10L * k));
+            v[1] = (v[0] != NULL) ? HAMTMap_snapshot(v[0]) : NULL;
+            for (k = 0L; v[1] != NULL && k < 1000L; k++)
+                if (k % 2L == 0L)
+                    v[1]->remove(v[1], ADT_VALUE(k));
+                else
+                    v[1]->put(v[1], ADT_VALUE(k), ADT_VALUE(10L * k + 1L));
+            for (k = 2000L; v[0] != NULL && k < 2100L; k++)
+                v[0]->put(v[0], ADT_VALUE(k), ADT_VALUE(10L * k));
+            if (v[1] != NULL)
+                v[2] = HAMTMap_assoc(v[1], ADT_VALUE(5000L), ADT_VALUE(50002L));
+            if (v[2] != NULL)
+                v[3] = HAMTMap_dissoc(v[2], ADT_VALUE(1L));
+            success = (v[3] != NULL) && freed == 0L;
+            for (j = 0; success && j < 4; j++)
+                success = hamtHolds(v[j], j, n, hamtWant);
+            /* only v[0] holds the evens, 2000..2099 and the first odds */
+            if (v[0] != NULL)
+                v[0]->destroy(v[0]);
+            success = success && freed == 1100L;
+            for (j = 1; success && j < 4; j++)
+                success = hamtHolds(v[j], j, n, hamtWant);
+            for (j = 1; j < 4; j++)
+                if (v[j] != NULL)
+                    v[j]->destroy(v[j]);
+            success = success && freed == 1601L;
+            if (success)
+                printf("success\n");
+            else
+                printf("failure\n");
+            break;
+          }
+          case 10: {
+            printf("Test HAMTMap versions with colliding hashes ... ");
+            const Map *v0 = HAMTMap(hashQuarter, cmpLong, doNothing, doNothing);
+            const Map *v1;
+            long k;
+            int success;
+
+            for (k = 0L; v0 != NULL && k < 200L; k++)
+                v0->put(v0, ADT_VALUE(k), ADT_VALUE(10L * k));
+            v1 = (v0 != NULL) ? HAMTMap_snapshot(v0) : NULL;
+            for (k = 0L; v1 != NULL && k < 200L; k += 2L)
+                v1->remove(v1, ADT_VALUE(k));
+            success = hamtHolds(v0, 0, 300L, collideWant) &&
+                      hamtHolds(v1, 1, 300L, collideWant);
+            if (v0 != NULL)
+                v0->destroy(v0);
+            success = success && hamtHolds(v1, 1, 300L, collideWant);
+            if (v1 != NULL)
+                v1->destroy(v1);
+            if (success)
+                printf("success\n");
+            else
+                printf("failure\n");
+            break;
+          }
+          case 11: {
+            printf("Test MergeIterator keeps equal keys in source order ... ");
+            Rec *recs = (Rec *)malloc(MERGE_SOURCES * MERGE_LEN * sizeof(Rec));
+            void **arrays[MERGE_SOURCES];
+            long lens[MERGE_SOURCES], s, j, n = 0L;
+            const Iterator *sources[MERGE_SOURCES];
+            const ArrayList *lists[MERGE_SOURCES];
+            int success = (recs != NULL);
+
+            srand(415);
+            for (s = 0L; s < MERGE_SOURCES; s++) {
+                long key = 0L;
+                lens[s] = (s == 3L) ? 0L : MERGE_LEN - s * 100L;
+                arrays[s] = (void **)malloc(MERGE_LEN * sizeof(void *));
+                lists[s] = ArrayList_create(0L, doNothing);
+                if (arrays[s] == NULL || lists[s] == NULL)
+                    success = 0;
+                for (j = 0L; success && j < lens[s]; j++) {
+                    Rec *r = &recs[s * MERGE_LEN + j];
+                    key += (rand() % 4 == 0);   /* runs of equal keys */
+                    r->key = key;
+                    r->source = s;
+                    r->seq = j;
+                    arrays[s][j] = r;
+                    lists[s]->add(lists[s], r);
+                }
+                n += lens[s];
+            }
+            success = success &&
+                      stable(MergeIterator_arrays(cmpRec, arrays, lens,
+                                                  MERGE_SOURCES), n);
+            for (s = 0L; success && s < MERGE_SOURCES; s++) {
+                sources[s] = lists[s]->itCreate(lists[s]);
+                if (sources[s] == NULL && lens[s] > 0L)
+                    success = 0;
+            }
+            if (success) {              /* an empty list has no iterator */
+                long k = 0L;
+                for (s = 0L; s < MERGE_SOURCES; s++)
+                    if (sources[s] != NULL)
+                        sources[k++] = sources[s];
+                success = stable(MergeIterator(cmpRec, sources, k), n);
+            }
+            if (success)
+                printf("success\n");
+            else
+                printf("failure\n");
+            for (s = 0L; s < MERGE_SOURCES; s++) {
+                free(arrays[s]);
+                if (lists[s] != NULL)
+                    lists[s]->destroy(lists[s]);
+            }
+            free(recs);
+            break;
+          }
+          case 12: {
+            printf("Test HashMap_compact() leaves the entries intact ... ");
+            const Map *m = HashMap(0L, 0.0, hashLong, cmpLong, doNothing,
+                                   countFree);
+            const Iterator *it = NULL;
+            bool in[10000];
+            long j, k, left, count = 0L, passes = 0L;
+            void *v;
+            int success = (m != NULL);
+
+            srand(415);
+            for (k = 0L; k < 10000L; k++)
+                in[k] = false;
+            for (j = 0L; success && j < 60000L; j++) {  /* scatter nodes */
+                k = rand() % 10000L;
+                if (j % 3L == 2L)
+                    m->remove(m, ADT_VALUE(k));
+                else
+                    m->put(m, ADT_VALUE(k), ADT_VALUE(10L * k));
+                in[k] = (j % 3L != 2L);
+            }
+            /* a step at a time, changing the map between the steps */
+            while (success && passes < 3L) {
+                left = HashMap_compact(m, 500L);
+                success = (left >= 0L);
+                if (left == 0L)
+                    passes++;
+                k = rand() % 10000L;
+                m->put(m, ADT_VALUE(k), ADT_VALUE(10L * k));
+                in[k] = true;
+                k = rand() % 10000L;
+                m->remove(m, ADT_VALUE(k));
+                in[k] = false;
+            }
+            success = success && HashMap_compact(m, 0L) == 0L;
+            for (k = 0L; success && k < 10000L; k++) {
+                success = m->get(m, ADT_VALUE(k), &v) == in[k] &&
+                          (! in[k] || (long)v == 10L * k);
+                count += in[k];
+            }
+            success = success && m->size(m) == count &&
+                      (it = m->itCreate(m)) != NULL &&
+                      HashMap_compact(m, 0L) == -1L;    /* while iterated */
+            if (it != NULL)
+                it->destroy(it);
+            if (m != NULL) {
+                freed = 0L;
+                m->destroy(m);
+                success = success && freed == count;
+            }
+            if (success)
+                printf("success\n");
+            else
+                printf("failure\n");
+            break;
+          }
+          default:
+            fprintf(stderr, "%s: no test %s\n", argv[0], argv[i]);
+            break;
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,155 @@
+/*
+ * benchmark for MergeIterator
+ *
+ * `n' random values are dealt round robin into k sorted arrays, for
+ * k = 2, 4, 8, ..., maxK; each set of arrays is then merged back into one
+ * sorted array three ways:
+ *
+ * - with MergeIterator_arrays(), drained with nextBatch()
+ * - with a HeapPrioQueue holding the head of each array
+ * - by concatenating the arrays and calling qsort(), which is what callers
+ *   had to do before
+ *
+ * reported are nanoseconds and comparisons per element; every result is
+ * checked against the sorted values
+ */
+
+#include "ADTs/mergeiterator.h"
+#include "ADTs/heapprioqueue.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BATCH 1024L
+
+static long compares;
+
+static int cmp(void *p1, void *p2) {
+    long a = (long)p1, b = (long)p2;
+
+    compares++;
+    return (a < b) ? -1 : (a > b);
+}
+
+static int qcmp(const void *p1, const void *p2) {
+    return cmp(*(void **)p1, *(void **)p2);
+}
+
+static void loserTree(void **arrays[], long lens[], long k, void **out) {
+    const Iterator *it = MergeIterator_arrays(cmp, arrays, lens, k);
+    long n, m = 0L;
+
+    while ((n = it->nextBatch(it, out + m, BATCH)) > 0L)
+        m += n;
+    it->destroy(it);
+}
+
+/*
+ * the priority of each array is its head; the value is its index
+ */
+static void heap(void **arrays[], long lens[], long k, void **out) {
+    const PrioQueue *pq = HeapPrioQueue(cmp, doNothing, doNothing);
+    long *pos = (long *)calloc(k, sizeof(long));
+    long i, m = 0L;
+    void *head, *v;
+
+    for (i = 0L; i < k; i++)
+        if (lens[i] > 0L)
+            pq->insert(pq, arrays[i][0], ADT_VALUE(i));
+    while (pq->removeMin(pq, &head, &v)) {
+        i = (long)v;
+        out[m++] = head;
+        if (++pos[i] < lens[i])
+            pq->insert(pq, arrays[i][pos[i]], v);
+    }
+    free(pos);
+    pq->destroy(pq);
+}
+
+static void concat(void **arrays[], long lens[], long k, void **out) {
+    long i, m = 0L;
+
+    for (i = 0L; i < k; i++) {
+        memcpy(out + m, arrays[i], lens[i] * sizeof(void *));
+        m += lens[i];
+    }
+    qsort(out, m, sizeof(void *), qcmp);
+}
+
+/*
+ * runs one way of merging; returns -1.0 if the result is wrong
+ */
+static double trial(void (*merge)(void ***, long *, long, void **),
+                    void **arrays[], long lens[], long k, void **out,
+                    void **want, long n, double *perElement) {
+    double start;
+
+    compares = 0L;
+    start = now();
+    (*merge)(arrays, lens, k, out);
+    start = now() - start;
+    *perElement = (double)compares / n;
+    if (memcmp(out, want, n * sizeof(void *)) != 0)
+        return -1.0;
+    return start / n * 1e9;
+}
+
+int main(int argc, char *argv[]) {
+    long n = 4000000L, maxK = 1024L, k, i;
+    void **values, **out, ***arrays;
+    long *lens;
+    BenchOption options[] = {
+        {'n', 'l', &n, "values"},
+        {'k', 'l', &maxK, "maxK"},
+        {'\0', '\0', NULL, NULL}
+    };
+
+    if (! getOptions(argc, argv, options))
+        return EXIT_FAILURE;
+    values = (void **)malloc(n * sizeof(void *));
+    out = (void **)malloc(n * sizeof(void *));
+    arrays = (void ***)malloc(maxK * sizeof(void **));
+    lens = (long *)malloc(maxK * sizeof(long));
+    if (values == NULL || out == NULL || arrays == NULL || lens == NULL) {
+        fprintf(stderr, "%s: unable to allocate arrays\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    srand(415);
+    for (i = 0L; i < n; i++)
+        values[i] = ADT_VALUE((long)rand());
+    printf("%6s %18s %18s %18s   (ns, compares per element)\n", "k",
+           "MergeIterator", "HeapPrioQueue", "concat+qsort");
+    for (k = 2L; k <= maxK; k *= 2) {
+        double t[3], c[3];
+        int j;
+
+        for (i = 0L; i < k; i++) {
+            lens[i] = 0L;
+            arrays[i] = (void **)malloc((n / k + 1) * sizeof(void *));
+        }
+        for (i = 0L; i < n; i++)
+            arrays[i % k][lens[i % k]++] = values[i];
+        for (i = 0L; i < k; i++)
+            qsort(arrays[i], lens[i], sizeof(void *), qcmp);
+        if (k == 2L)
+            qsort(values, n, sizeof(void *), qcmp);
+        t[0] = trial(loserTree, arrays, lens, k, out, values, n, &c[0]);
+        t[1] = trial(heap, arrays, lens, k, out, values, n, &c[1]);
+        t[2] = trial(concat, arrays, lens, k, out, values, n, &c[2]);
+        for (j = 0; j < 3; j++)
+            if (t[j] < 0.0) {
+                fprintf(stderr, "%s: wrong merge with k = %ld\n", argv[0], k);
+                return EXIT_FAILURE;
+            }
+        printf("%6ld %11.1f %6.2f %11.1f %6.2f %11.1f %6.2f\n", k,
+               t[0], c[0], t[1], c[1], t[2], c[2]);
+        for (i = 0L; i < k; i++)
+            free(arrays[i]);
+    }
+    free(values);
+    free(out);
+    free(arrays);
+    free(lens);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,116 @@
+/*
+ * scaling benchmark for the parallel ArrayList operations
+ *
+ * fills an ArrayList with `n' longs and times, for pools of 1, 2, 4, ...,
+ * maxThreads workers:
+ *
+ * - reduce() with Parallel_sumLong, which takes the vectorized path
+ * - reduce() with a user-supplied sum, which calls it per element
+ * - filter() keeping the odd elements
+ *
+ * the baselines are the loops callers wrote before: get() in a for loop
+ * summing the elements, and another adding the odd ones to a new list;
+ * the results are checked against them
+ */
+
+#include "ADTs/arraylist.h"
+#include "ADTs/parallel.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static void *sum(void *x, void *y, void *arg) {
+    (void)arg;
+    return (void *)((long)x + (long)y);
+}
+
+static bool odd(void *e, void *arg) {
+    (void)arg;
+    return ((long)e & 1L) != 0L;
+}
+
+int main(int argc, char *argv[]) {
+    long n = 20000000L, i, want = 0L, odds = 0L;
+    int maxThreads = 8, t;
+    const ArrayList *al;
+    double start, base, baseF;
+    BenchOption options[] = {
+        {'n', 'l', &n, "elements"},
+        {'t', 'i', &maxThreads, "maxThreads"},
+        {'\0', '\0', NULL, NULL}
+    };
+
+    if (! getOptions(argc, argv, options))
+        return EXIT_FAILURE;
+    if ((al = ArrayList_create(n, doNothing)) == NULL) {
+        fprintf(stderr, "%s: unable to create list\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    for (i = 0; i < n; i++)
+        al->add(al, ADT_VALUE((i * 7919L) % 1000003L));
+    start = now();
+    for (i = 0; i < n; i++) {
+        void *v;
+
+        al->get(al, i, &v);
+        want += (long)v;
+    }
+    base = now() - start;
+    start = now();
+    {
+        const ArrayList *f = ArrayList_create(0L, doNothing);
+
+        for (i = 0; f != NULL && i < n; i++) {
+            void *v;
+
+            al->get(al, i, &v);
+            if (odd(v, NULL))
+                f->add(f, v);
+        }
+        if (f == NULL) {
+            fprintf(stderr, "%s: unable to create list\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+        odds = f->size(f);
+        f->destroy(f);
+    }
+    baseF = now() - start;
+    printf("get() loops: sum %.3fs, filter %.3fs\n", base, baseF);
+    printf("%8s %12s %12s %12s   (speedup over get() loops)\n", "threads",
+           "sumLong", "user sum", "filter");
+    for (t = 0; t <= maxThreads; t = (t == 0) ? 1 : 2 * t) {
+        const ThreadPool *tp = (t == 0) ? NULL : ThreadPool_create(t);
+        const ArrayList *f;
+        double a, b, c;
+        void *r1, *r2;
+
+        if (t > 0 && tp == NULL) {
+            fprintf(stderr, "%s: unable to create pool\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+        start = now();
+        r1 = al->reduce(al, tp, ADT_VALUE(0L), Parallel_sumLong, NULL);
+        a = now() - start;
+        start = now();
+        r2 = al->reduce(al, tp, ADT_VALUE(0L), sum, NULL);
+        b = now() - start;
+        start = now();
+        f = al->filter(al, tp, odd, NULL);
+        c = now() - start;
+        if ((long)r1 != want || (long)r2 != want || f == NULL ||
+            f->size(f) != odds) {
+            fprintf(stderr, "%s: wrong result with %d threads\n", argv[0], t);
+            return EXIT_FAILURE;
+        }
+        f->destroy(f);
+        if (tp != NULL)
+            tp->destroy(tp);
+        if (t == 0)
+            printf("%8s", "NULL");
+        else
+            printf("%8d", t);
+        printf(" %12.2f %12.2f %12.2f\n", base / a, base / b, baseF / c);
+    }
+    al->destroy(al);
+    return EXIT_SUCCESS;
+}
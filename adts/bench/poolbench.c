@@ -0,0 +1,121 @@
+/*
+ * scaling benchmark for ThreadPool
+ *
+ * for pools of 1, 2, 4, ..., maxThreads workers, times two workloads
+ * against the same work done serially by the calling thread:
+ *
+ * - parallelFor() over an array of `n' doubles, applying a few
+ *   floating point operations to each element
+ * - a recursive Fibonacci computation in which every call above a
+ *   cutoff submits one of its halves and waits on the Future, which
+ *   exercises work stealing and helping while waiting
+ *
+ * the results are checked against the serial versions
+ */
+
+#include "ADTs/threadpool.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define CUTOFF 20L              /* fib() below this runs serially */
+
+static const ThreadPool *pool;
+static double *data;
+
+static void update(long lo, long hi, void *arg) {
+    long i;
+
+    (void)arg;
+    for (i = lo; i < hi; i++)
+        data[i] = sqrt(data[i] * data[i] + 1.0) - 0.5;
+}
+
+static long sfib(long n) {
+    return (n < 2L) ? n : sfib(n - 1) + sfib(n - 2);
+}
+
+static void *pfib(void *arg) {
+    long n = (long)arg;
+    const Future *f;
+    void *a, *b;
+
+    if (n < CUTOFF)
+        return (void *)sfib(n);
+    if ((f = pool->submit(pool, pfib, (void *)(n - 1))) == NULL)
+        return (void *)sfib(n);
+    b = pfib((void *)(n - 2));
+    f->get(f, &a);
+    f->destroy(f);
+    return (void *)((long)a + (long)b);
+}
+
+static double checksum(long n) {
+    double sum = 0.0;
+    long i;
+
+    for (i = 0; i < n; i++)
+        sum += data[i];
+    return sum;
+}
+
+static void fill(long n) {
+    long i;
+
+    for (i = 0; i < n; i++)
+        data[i] = (double)i;
+}
+
+int main(int argc, char *argv[]) {
+    long n = 10000000L, fibN = 35L, want;
+    int maxThreads = 8, t;
+    double start, serialFor, serialFib, expect;
+    BenchOption options[] = {
+        {'n', 'l', &n, "arraySize"},
+        {'f', 'l', &fibN, "fibN"},
+        {'t', 'i', &maxThreads, "maxThreads"},
+        {'\0', '\0', NULL, NULL}
+    };
+
+    if (! getOptions(argc, argv, options))
+        return EXIT_FAILURE;
+    if ((data = (double *)malloc(n * sizeof(double))) == NULL) {
+        fprintf(stderr, "%s: unable to allocate %ld doubles\n", argv[0], n);
+        return EXIT_FAILURE;
+    }
+    fill(n);
+    start = now();
+    update(0L, n, NULL);
+    serialFor = now() - start;
+    expect = checksum(n);
+    start = now();
+    want = sfib(fibN);
+    serialFib = now() - start;
+    printf("serial: parallelFor %.3fs, fib %.3fs\n", serialFor, serialFib);
+    printf("%8s %12s %12s   (speedup)\n", "threads", "parallelFor", "fib");
+    for (t = 1; t <= maxThreads; t *= 2) {
+        double a, b;
+        void *got;
+
+        if ((pool = ThreadPool_create(t)) == NULL) {
+            fprintf(stderr, "%s: unable to create pool\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+        fill(n);
+        start = now();
+        pool->parallelFor(pool, 0L, n, 0L, update, NULL);
+        a = now() - start;
+        start = now();
+        got = pfib((void *)fibN);
+        b = now() - start;
+        pool->destroy(pool);
+        if (checksum(n) != expect || (long)got != want) {
+            fprintf(stderr, "%s: wrong result with %d threads\n", argv[0], t);
+            return EXIT_FAILURE;
+        }
+        printf("%8d %12.2f %12.2f\n", t, serialFor / a, serialFib / b);
+    }
+    free(data);
+    return EXIT_SUCCESS;
+}
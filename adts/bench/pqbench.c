@@ -0,0 +1,126 @@
+/*
+ * contention benchmark for MultiQueue
+ *
+ * for 1, 2, 4, ..., maxThreads threads, each thread performs `ops' pairs
+ * of insert() and removeMin() with random priorities on one shared
+ * priority queue, which is prefilled with `prefill' entries; the
+ * MultiQueue is compared with a HeapPrioQueue guarded by a pthread mutex,
+ * which is what callers had to use before
+ *
+ * every value inserted is a distinct integer; the sum of the values
+ * removed is checked against the sum of the values inserted
+ */
+
+#include "ADTs/multiqueue.h"
+#include "ADTs/heapprioqueue.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+typedef struct worker {
+    pthread_t tid;
+    const PrioQueue *pq;
+    pthread_mutex_t *lock;      /* NULL for the MultiQueue */
+    unsigned int seed;
+    long first;                 /* values inserted are first .. first+ops-1 */
+    long ops;
+    long removed;               /* sum of values removed */
+} Worker;
+
+static void *run(void *arg) {
+    Worker *w = (Worker *)arg;
+    long i;
+    void *p, *v;
+
+    for (i = 0; i < w->ops; i++) {
+        long prio = rand_r(&w->seed) % 1000000;
+
+        if (w->lock != NULL)
+            pthread_mutex_lock(w->lock);
+        w->pq->insert(w->pq, ADT_VALUE(prio), ADT_VALUE(w->first + i));
+        if (w->lock != NULL)
+            pthread_mutex_unlock(w->lock);
+        if (w->lock != NULL)
+            pthread_mutex_lock(w->lock);
+        if (w->pq->removeMin(w->pq, &p, &v))
+            w->removed += (long)v;
+        if (w->lock != NULL)
+            pthread_mutex_unlock(w->lock);
+    }
+    return NULL;
+}
+
+/*
+ * returns millions of insert/removeMin pairs per second, or -1.0 on failure
+ */
+static double trial(const PrioQueue *pq, pthread_mutex_t *lock, int nthreads,
+                    long ops, long prefill) {
+    Worker *w = (Worker *)malloc(nthreads * sizeof(Worker));
+    long want = 0L, got = 0L, i;
+    double start, elapsed;
+    void *p, *v;
+
+    if (w == NULL)
+        return -1.0;
+    for (i = 1; i <= prefill; i++)
+        pq->insert(pq, ADT_VALUE((long)(rand() % 1000000)), ADT_VALUE(i));
+    start = now();
+    for (i = 0; i < nthreads; i++) {
+        w[i].pq = pq;
+        w[i].lock = lock;
+        w[i].seed = 415U + i;
+        w[i].first = 1L + prefill + i * ops;
+        w[i].ops = ops;
+        w[i].removed = 0L;
+        pthread_create(&w[i].tid, NULL, run, &w[i]);
+    }
+    for (i = 0; i < nthreads; i++) {
+        pthread_join(w[i].tid, NULL);
+        got += w[i].removed;
+    }
+    elapsed = now() - start;
+    while (pq->removeMin(pq, &p, &v))
+        got += (long)v;
+    want = (prefill + nthreads * ops) * (prefill + nthreads * ops + 1L) / 2L;
+    free(w);
+    if (got != want)
+        return -1.0;
+    return (nthreads * ops) / elapsed / 1e6;
+}
+
+int main(int argc, char *argv[]) {
+    long ops = 1000000L, prefill = 100000L;
+    int maxThreads = 64, n;
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    const PrioQueue *mq = MultiQueue(0L, cmpLong, doNothing, doNothing);
+    const PrioQueue *hq = HeapPrioQueue(cmpLong, doNothing, doNothing);
+    BenchOption options[] = {
+        {'n', 'l', &ops, "opsPerThread"},
+        {'p', 'l', &prefill, "prefill"},
+        {'t', 'i', &maxThreads, "maxThreads"},
+        {'\0', '\0', NULL, NULL}
+    };
+
+    if (! getOptions(argc, argv, options))
+        return EXIT_FAILURE;
+    if (mq == NULL || hq == NULL) {
+        fprintf(stderr, "%s: unable to create priority queues\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    printf("%8s %16s %16s   (Mops/s)\n", "threads", "MultiQueue",
+           "HeapPQ+mutex");
+    for (n = 1; n <= maxThreads; n *= 2) {
+        double a = trial(mq, NULL, n, ops / n, prefill);
+        double b = trial(hq, &lock, n, ops / n, prefill);
+
+        if (a < 0.0 || b < 0.0) {
+            fprintf(stderr, "%s: values lost with %d threads\n", argv[0], n);
+            return EXIT_FAILURE;
+        }
+        printf("%8d %16.2f %16.2f\n", n, a, b);
+    }
+    mq->destroy(mq);
+    hq->destroy(hq);
+    return EXIT_SUCCESS;
+}
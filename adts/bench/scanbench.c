@@ -0,0 +1,130 @@
+/*
+ * benchmark for HashMap iteration
+ *
+ * for a map of `n' long keys, `reps' times:
+ *
+ * - first: itCreate(), read `k' entries, then destroy() the iterator
+ * - scan: iterate over the whole map while put()ting one key and
+ *   remove()ing another for every entry read
+ *
+ * each is compared with the copying iterator that itCreate() used to
+ * return, an Iterator_create() over entryArray(); as the entries that
+ * the scan removes would be freed under such an iterator, its scan copies
+ * keyArray() instead
+ *
+ * the scans check that every key present when the iterator was created
+ * is seen exactly once
+ */
+
+#include "ADTs/hashmap.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const Iterator *copying(const Map *m) {
+    long len;
+    MEntry **entries = m->entryArray(m, &len);
+    const Iterator *it;
+
+    if (entries == NULL)
+        return NULL;
+    if ((it = Iterator_create(len, (void **)entries)) == NULL)
+        free(entries);
+    return it;
+}
+
+/*
+ * reads the first k entries; returns the sum of their values
+ */
+static long first(const Map *m, bool copy, long k) {
+    const Iterator *it = copy ? copying(m) : m->itCreate(m);
+    MEntry *e;
+    long sum = 0L;
+
+    while (k-- > 0 && it->next(it, (void **)&e))
+        sum += (long)e->value;
+    it->destroy(it);
+    return sum;
+}
+
+/*
+ * scans the map, which holds keys [lo, lo+n), while moving the window to
+ * [lo+n, lo+2n); returns false if a key is missed or seen twice
+ */
+static bool scan(const Map *m, bool copy, long lo, long n, char *seen) {
+    const Iterator *it;
+    void *element;
+    long i = 0L, len;
+
+    if (copy) {			/* the entries removed would be freed */
+        void **keys = m->keyArray(m, &len);
+        if ((it = Iterator_create(len, keys)) == NULL)
+            return false;
+    } else
+        it = m->itCreate(m);
+    memset(seen, 0, n);
+    while (it->next(it, &element)) {
+        long k = (copy ? (long)element : (long)((MEntry *)element)->key) - lo;
+        if (k < 0 || k >= n || seen[k])
+            return false;
+        seen[k] = 1;
+        m->put(m, (void *)(lo + n + i), (void *)(lo + n + i));
+        m->remove(m, (void *)(lo + i));
+        i++;
+    }
+    it->destroy(it);
+    return (i == n);
+}
+
+int main(int argc, char *argv[]) {
+    long n = 1000000L, k = 10L, reps = 10L, i, r, lo[2], sum[2] = {0L, 0L};
+    double t[4];
+    const Map *m[2];
+    char *seen;
+    int c;
+    BenchOption options[] = {
+        {'n', 'l', &n, "elements"},
+        {'k', 'l', &k, "first"},
+        {'r', 'l', &reps, "reps"},
+        {'\0', '\0', NULL, NULL}
+    };
+
+    if (! getOptions(argc, argv, options))
+        return EXIT_FAILURE;
+    seen = (char *)malloc(n);
+    for (c = 0; c < 2; c++) {
+        m[c] = HashMap(2 * n, 0.0, hashLong, cmpLong, doNothing, doNothing);
+        if (m[c] == NULL || seen == NULL) {
+            fprintf(stderr, "%s: unable to create maps\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+        for (i = 0; i < n; i++)
+            m[c]->put(m[c], (void *)i, (void *)i);
+        lo[c] = 0L;
+    }
+    for (c = 0; c < 2; c++) {
+        t[c] = now();
+        for (r = 0; r < reps; r++)
+            sum[c] += first(m[c], c == 1, k);
+        t[c] = now() - t[c];
+    }
+    for (c = 0; c < 2; c++) {
+        t[2 + c] = now();
+        for (r = 0; r < reps; r++, lo[c] += n)
+            if (! scan(m[c], c == 1, lo[c], n, seen)) {
+                fprintf(stderr, "%s: scan saw wrong keys\n", argv[0]);
+                return EXIT_FAILURE;
+            }
+        t[2 + c] = now() - t[2 + c];
+    }
+    printf("%10s %16s %16s\n", "", "itCreate", "entryArray copy");
+    printf("%10s %13.1fus %13.1fus\n", "first", t[0] / reps * 1e6,
+           t[1] / reps * 1e6);
+    printf("%10s %13.1fns %13.1fns   (per entry)\n", "scan",
+           t[2] / reps / n * 1e9, t[3] / reps / n * 1e9);
+    m[0]->destroy(m[0]);
+    m[1]->destroy(m[1]);
+    free(seen);
+    return (sum[0] == sum[1] || k > n) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,179 @@
+/*
+ * benchmark for the sketches against exact counting
+ *
+ * a stream of `n' events is drawn from `d' distinct string keys with a
+ * Zipf(s) distribution; the exact counts are kept in a HashCSKMap of
+ * boxed counters, and the same stream is fed to:
+ *
+ * - a CountMin with epsilon 0.0005 and delta 0.01, plain and conservative
+ * - a HyperLogLog with precision 14
+ * - a SpaceSaving with `c' counters
+ *
+ * reported are the storage of each (the map's as measured by mallinfo2),
+ * the mean overestimate of the CountMins over the `k' most frequent keys
+ * and over all keys, the HyperLogLog's error, and how many of the true
+ * top `k' keys are among the SpaceSaving's top `k'
+ */
+
+#include "ADTs/hashcskmap.h"
+#include "ADTs/countmin.h"
+#include "ADTs/hyperloglog.h"
+#include "ADTs/spacesaving.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+#include <math.h>
+
+/* FNV-1a */
+static long hash(void *key, long N) {
+    unsigned long h = 14695981039346656037UL;
+    char *p;
+
+    for (p = (char *)key; *p != '\0'; p++)
+        h = (h ^ (unsigned char)*p) * 1099511628211UL;
+    return (long)(h % (unsigned long)N);
+}
+
+static int cmp(void *p1, void *p2) {
+    return strcmp((char *)p1, (char *)p2);
+}
+
+static void *copyKey(void *item) {
+    return strdup((char *)item);
+}
+
+/* a key's rank, for sorting by true count */
+typedef struct ranked {
+    char *key;
+    long count;
+} Ranked;
+
+static int byCount(const void *p1, const void *p2) {
+    long a = ((const Ranked *)p1)->count;
+    long b = ((const Ranked *)p2)->count;
+
+    return (a > b) ? -1 : (a < b);
+}
+
+int main(int argc, char *argv[]) {
+    long n = 10000000L, d = 1000000L, k = 100L, counters = 1000L;
+    long i, j, len;
+    double s = 1.1, *cdf, sum = 0.0, over[2][2] = {{0.0, 0.0}, {0.0, 0.0}};
+    char **keys;
+    Ranked *ranked;
+    const CSKMap *exact;
+    const CountMin *cm[2];
+    const HyperLogLog *hll;
+    const SpaceSaving *ss;
+    SSEntry **top;
+    size_t before;
+    long mapBytes, w, dp, found = 0L, distinct;
+    int c;
+    BenchOption options[] = {
+        {'n', 'l', &n, "events"},
+        {'d', 'l', &d, "distinct"},
+        {'s', 'd', &s, "skew"},
+        {'k', 'l', &k, "topK"},
+        {'c', 'l', &counters, "counters"},
+        {'\0', '\0', NULL, NULL}
+    };
+
+    if (! getOptions(argc, argv, options))
+        return EXIT_FAILURE;
+    cdf = (double *)malloc(d * sizeof(double));
+    keys = (char **)malloc(d * sizeof(char *));
+    for (i = 0; i < d; i++) {
+        char buf[32];
+        sum += 1.0 / pow((double)(i + 1), s);
+        cdf[i] = sum;
+        sprintf(buf, "key-%ld", (i * 7919L) % d);
+        keys[i] = strdup(buf);
+    }
+    before = mallinfo2().uordblks;
+    exact = HashCSKMap(0L, 0.0, free);
+    cm[0] = CountMin_create(0.0005, 0.01, false, hash);
+    cm[1] = CountMin_create(0.0005, 0.01, true, hash);
+    hll = HyperLogLog_create(14, hash);
+    ss = SpaceSaving_create(counters, hash, cmp, copyKey, free);
+    if (exact == NULL || cm[0] == NULL || cm[1] == NULL || hll == NULL ||
+        ss == NULL) {
+        fprintf(stderr, "%s: unable to create sketches\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    srand(415);
+    for (i = 0; i < n; i++) {
+        double u = sum * (rand() / (RAND_MAX + 1.0));
+        long lo = 0L, hi = d - 1L, *count;
+
+        while (lo < hi) {               /* first rank with cdf >= u */
+            long mid = (lo + hi) / 2;
+            if (cdf[mid] < u)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        if (exact->get(exact, keys[lo], (void **)&count))
+            (*count)++;
+        else if ((count = (long *)malloc(sizeof(long))) != NULL) {
+            *count = 1L;
+            exact->put(exact, keys[lo], count);
+        }
+        cm[0]->add(cm[0], keys[lo], 1L);
+        cm[1]->add(cm[1], keys[lo], 1L);
+        hll->add(hll, keys[lo]);
+        ss->add(ss, keys[lo], 1L);
+    }
+    distinct = exact->size(exact);
+    ranked = (Ranked *)malloc(distinct * sizeof(Ranked));
+    for (i = 0, j = 0; i < d; i++) {
+        long *count;
+        if (exact->get(exact, keys[i], (void **)&count)) {
+            ranked[j].key = keys[i];
+            ranked[j++].count = *count;
+        }
+    }
+    qsort(ranked, distinct, sizeof(Ranked), byCount);
+    for (c = 0; c < 2; c++)
+        for (i = 0; i < distinct; i++) {
+            long e = cm[c]->estimate(cm[c], ranked[i].key) - ranked[i].count;
+            if (i < k)
+                over[c][0] += e;
+            over[c][1] += e;
+        }
+    top = ss->top(ss, &len);
+    for (i = 0; i < len && i < k; i++)
+        for (j = 0; j < k && j < distinct; j++)
+            if (strcmp((char *)top[i]->item, ranked[j].key) == 0)
+                found++;
+    /* the map's storage: everything allocated since, less the sketches */
+    mapBytes = (long)(mallinfo2().uordblks - before);
+    mapBytes -= 2 * cm[0]->bytes(cm[0], &w, &dp) + hll->bytes(hll);
+    printf("%ld events, %ld distinct keys, skew %.2f\n\n", n, distinct, s);
+    printf("%-24s %12ld bytes\n", "HashCSKMap (exact)", mapBytes);
+    printf("%-24s %12ld bytes   (%ld x %ld)\n", "CountMin",
+           cm[0]->bytes(cm[0], &w, &dp), w, dp);
+    printf("%-24s %12ld bytes\n", "HyperLogLog", hll->bytes(hll));
+    printf("\nCountMin mean overestimate      top %ld     all keys\n", k);
+    printf("%-24s %12.2f %12.2f\n", "  plain", over[0][0] / k,
+           over[0][1] / distinct);
+    printf("%-24s %12.2f %12.2f\n", "  conservative", over[1][0] / k,
+           over[1][1] / distinct);
+    printf("\nHyperLogLog estimate %ld, error %.2f%%\n", hll->estimate(hll),
+           100.0 * (hll->estimate(hll) - distinct) / distinct);
+    printf("SpaceSaving(%ld) found %ld of the true top %ld\n", counters, found,
+           k);
+    free(top);
+    ss->destroy(ss);
+    hll->destroy(hll);
+    cm[0]->destroy(cm[0]);
+    cm[1]->destroy(cm[1]);
+    exact->destroy(exact);
+    for (i = 0; i < d; i++)
+        free(keys[i]);
+    free(keys);
+    free(cdf);
+    free(ranked);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,119 @@
+/*
+ * contention benchmark for LockFreeStack
+ *
+ * for 1, 2, 4, ..., maxThreads threads, each thread performs `ops' pairs
+ * of push() and pop() on one shared stack; the lock-free stack is compared
+ * with an LListStack guarded by a pthread mutex, which is what callers
+ * had to use before
+ *
+ * every value pushed is a distinct integer; the sum of the values popped
+ * is checked against the sum of the values pushed
+ */
+
+#include "ADTs/lockfreestack.h"
+#include "ADTs/lliststack.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+typedef struct worker {
+    pthread_t tid;
+    const Stack *st;
+    pthread_mutex_t *lock;      /* NULL for the lock-free stack */
+    long first;                 /* values pushed are first .. first+ops-1 */
+    long ops;
+    long popped;                /* sum of values popped */
+} Worker;
+
+static void *run(void *arg) {
+    Worker *w = (Worker *)arg;
+    long i;
+    void *v;
+
+    for (i = 0; i < w->ops; i++) {
+        if (w->lock != NULL)
+            pthread_mutex_lock(w->lock);
+        w->st->push(w->st, ADT_VALUE(w->first + i));
+        if (w->lock != NULL)
+            pthread_mutex_unlock(w->lock);
+        if (w->lock != NULL)
+            pthread_mutex_lock(w->lock);
+        if (w->st->pop(w->st, &v))
+            w->popped += (long)v;
+        if (w->lock != NULL)
+            pthread_mutex_unlock(w->lock);
+    }
+    return NULL;
+}
+
+/*
+ * returns millions of push/pop pairs per second, or -1.0 on failure
+ */
+static double trial(const Stack *st, pthread_mutex_t *lock, int nthreads,
+                    long ops) {
+    Worker *w = (Worker *)malloc(nthreads * sizeof(Worker));
+    long want = 0L, got = 0L;
+    double start, elapsed;
+    void *v;
+    int i;
+
+    if (w == NULL)
+        return -1.0;
+    start = now();
+    for (i = 0; i < nthreads; i++) {
+        w[i].st = st;
+        w[i].lock = lock;
+        w[i].first = 1L + i * ops;
+        w[i].ops = ops;
+        w[i].popped = 0L;
+        pthread_create(&w[i].tid, NULL, run, &w[i]);
+    }
+    for (i = 0; i < nthreads; i++) {
+        pthread_join(w[i].tid, NULL);
+        got += w[i].popped;
+    }
+    elapsed = now() - start;
+    while (st->pop(st, &v))
+        got += (long)v;
+    want = (nthreads * ops) * (nthreads * ops + 1L) / 2L;
+    free(w);
+    if (got != want)
+        return -1.0;
+    return (nthreads * ops) / elapsed / 1e6;
+}
+
+int main(int argc, char *argv[]) {
+    long ops = 1000000L;
+    int maxThreads = 64, n;
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    const Stack *lf = LockFreeStack(doNothing);
+    const Stack *ll = LListStack(doNothing);
+    BenchOption options[] = {
+        {'n', 'l', &ops, "opsPerThread"},
+        {'t', 'i', &maxThreads, "maxThreads"},
+        {'\0', '\0', NULL, NULL}
+    };
+
+    if (! getOptions(argc, argv, options))
+        return EXIT_FAILURE;
+    if (lf == NULL || ll == NULL) {
+        fprintf(stderr, "%s: unable to create stacks\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    printf("%8s %16s %16s   (Mops/s)\n", "threads", "LockFreeStack",
+           "LListStack+mutex");
+    for (n = 1; n <= maxThreads; n *= 2) {
+        double a = trial(lf, NULL, n, ops / n);
+        double b = trial(ll, &lock, n, ops / n);
+
+        if (a < 0.0 || b < 0.0) {
+            fprintf(stderr, "%s: values lost with %d threads\n", argv[0], n);
+            return EXIT_FAILURE;
+        }
+        printf("%8d %16.2f %16.2f\n", n, a, b);
+    }
+    lf->destroy(lf);
+    ll->destroy(ll);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,117 @@
+/*
+ * benchmark for TTLCSKMap
+ *
+ * a session store sees `ops' operations, each a put() of a new session
+ * (one in `ratio') or a get() of a recent one; sessions expire `ttl'
+ * simulated milliseconds after they are put, and one millisecond passes
+ * per operation
+ *
+ * the TTLCSKMap is compared with a HashCSKMap whose values hold their
+ * expiry times, purged by a scan of keyArray() every `period'
+ * milliseconds, which is what callers had to do before
+ *
+ * both maps are sized for the sessions that are live at once; for each,
+ * the mean and worst time per operation, the number of operations that
+ * took longer than 100us, and the largest size of the map are shown
+ */
+
+#include "ADTs/ttlcskmap.h"
+#include "ADTs/hashcskmap.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static long simTime = 0L;
+
+static long simClock(void) {
+    return simTime;
+}
+
+/* purges the expired sessions from a HashCSKMap by scanning every key */
+static void scan(const CSKMap *m) {
+    long i, len;
+    char **keys = m->keyArray(m, &len);
+
+    if (keys == NULL)
+        return;
+    for (i = 0; i < len; i++) {
+        void *v;
+
+        if (m->get(m, keys[i], &v) && *(long *)v <= simTime)
+            m->remove(m, keys[i]);
+    }
+    free(keys);
+}
+
+/*
+ * runs the workload; if period > 0L, m is a HashCSKMap purged by scan()
+ */
+static void trial(const char *name, const CSKMap *m, long ops, long ttl,
+                  long period, long ratio) {
+    double total = 0.0, worst = 0.0;
+    long i, next = 0L, maxSize = 0L, stalls = 0L;
+    char key[32];
+
+    simTime = 0L;
+    for (i = 0; i < ops; i++, simTime++) {
+        double start = now(), elapsed;
+
+        if (i % ratio == 0) {
+            long *v = (long *)malloc(sizeof(long));
+
+            *v = simTime + ttl;
+            sprintf(key, "session%ld", next++);
+            m->put(m, key, v);
+        } else {
+            void *v;
+
+            sprintf(key, "session%ld", next - 1 - (i % (ttl / ratio + 1)));
+            m->get(m, key, &v);
+        }
+        if (period > 0L && simTime % period == 0L)
+            scan(m);
+        elapsed = now() - start;
+        total += elapsed;
+        if (elapsed > worst)
+            worst = elapsed;
+        if (elapsed > 100e-6)
+            stalls++;
+        if (m->size(m) > maxSize)
+            maxSize = m->size(m);
+    }
+    printf("%20s %10.1f %10.1f %10ld %10ld\n", name, total * 1e9 / ops,
+           worst * 1e6, stalls, maxSize);
+}
+
+int main(int argc, char *argv[]) {
+    long ops = 2000000L, ttl = 100000L, period = 10000L, ratio = 4L;
+    const CSKMap *ttlMap, *hashMap;
+    BenchOption options[] = {
+        {'n', 'l', &ops, "ops"},
+        {'t', 'l', &ttl, "ttl"},
+        {'p', 'l', &period, "period"},
+        {'r', 'l', &ratio, "ratio"},
+        {'\0', '\0', NULL, NULL}
+    };
+
+    if (! getOptions(argc, argv, options))
+        return EXIT_FAILURE;
+    if (ttl <= 0L || period <= 0L || ratio <= 0L) {
+        fprintf(stderr, "%s: ttl, period and ratio must be positive\n",
+                argv[0]);
+        return EXIT_FAILURE;
+    }
+    ttlMap = TTLCSKMap(2 * ttl / ratio, 0.0, ttl, simClock, free);
+    hashMap = HashCSKMap(2 * ttl / ratio, 0.0, free);
+    if (ttlMap == NULL || hashMap == NULL) {
+        fprintf(stderr, "%s: unable to create maps\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    printf("%20s %10s %10s %10s %10s\n", "", "mean (ns)", "worst (us)",
+           ">100us", "max size");
+    trial("TTLCSKMap", ttlMap, ops, ttl, 0L, ratio);
+    trial("HashCSKMap + scan", hashMap, ops, ttl, period, ratio);
+    ttlMap->destroy(ttlMap);
+    hashMap->destroy(hashMap);
+    return EXIT_SUCCESS;
+}
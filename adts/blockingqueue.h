@@ -0,0 +1,194 @@
+#ifndef _BLOCKINGQUEUE_H_
+#define _BLOCKINGQUEUE_H_
+
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * interface definition for a bounded, thread-safe FIFO queue whose
+ * enqueue() blocks while the queue is full and whose dequeue() blocks
+ * while the queue is empty
+ *
+ * patterned roughly after Java 6 BlockingQueue interface
+ *
+ * every method except destroy() may be called concurrently from any
+ * number of threads without external locking
+ */
+
+#include "ADTs/ADTdefs.h"
+#include "ADTs/iterator.h"              /* needed for factory method */
+#include "ADTs/queue.h"                 /* needed for drainTo() */
+
+typedef struct blockingqueue BlockingQueue;     /* forward reference */
+
+/*
+ * this function signature is provided as the default constructor for
+ * any BlockingQueue implementation
+ *
+ * capacity is the maximum number of elements in the queue; if capacity
+ * is <= 0L, the queue is unbounded and enqueue() never blocks
+ *
+ * freeValue is a function pointer that will be called by
+ * destroy() and clear() on each entry in the BlockingQueue
+ *
+ * returns a pointer to the queue instance, or NULL if errors
+ */
+const BlockingQueue *BlockingQueue_create(long capacity,
+                                          void (*freeValue)(void *e));
+
+/*
+ * dispatch table for a generic BlockingQueue
+ */
+struct blockingqueue {
+/*
+ * the private data of the queue
+ */
+    void *self;
+
+/*
+ * create a new queue using the same implementation and capacity as the
+ * queue upon which the method has been invoked; returns NULL if error
+ * creating the queue
+ */
+    const BlockingQueue *(*create)(const BlockingQueue *bq);
+
+/*
+ * destroys the queue;
+ * applies constructor-specified freeValue to each element in the queue
+ * the storage associated with the queue is then returned to the heap
+ *
+ * no other thread may be using, or blocked in, the queue
+ */
+    void (*destroy)(const BlockingQueue *bq);
+
+/*
+ * clears all elements from the queue;
+ * applies constructor-specified freeValue to each element in the queue
+ *
+ * upon return, the queue is empty
+ */
+    void (*clear)(const BlockingQueue *bq);
+
+/*
+ * appends `element' to the end of the queue, waiting for space to become
+ * available if the queue is full
+ *
+ * returns true if successful, false if unsuccessful (malloc failure)
+ */
+    bool (*enqueue)(const BlockingQueue *bq, void *element);
+
+/*
+ * appends `element' to the end of the queue, waiting at most `msecs'
+ * milliseconds for space to become available if the queue is full;
+ * if `msecs' is <= 0L, the method does not wait
+ *
+ * returns true if successful, false if unsuccessful (timed out, or
+ * malloc failure)
+ */
+    bool (*timedEnqueue)(const BlockingQueue *bq, void *element, long msecs);
+
+/*
+ * retrieves, and removes, the head of the queue, returning that element
+ * in `*element'; waits for an element to become available if the queue
+ * is empty
+ *
+ * returns true
+ */
+    bool (*dequeue)(const BlockingQueue *bq, void **element);
+
+/*
+ * retrieves, and removes, the head of the queue, returning that element
+ * in `*element'; waits at most `msecs' milliseconds for an element to
+ * become available if the queue is empty; if `msecs' is <= 0L, the
+ * method does not wait
+ *
+ * returns true if successful, false if not (timed out)
+ */
+    bool (*timedDequeue)(const BlockingQueue *bq, void **element, long msecs);
+
+/*
+ * removes at most `max' elements from the head of the queue, enqueueing
+ * them in order on `q'; if `max' is <= 0L, all of the elements are removed;
+ * the method never waits for elements to arrive
+ *
+ * `q' must not be shared with other threads while the method runs
+ *
+ * returns the number of elements moved; this is less than requested only
+ * if the queue ran out of elements or q->enqueue() failed, in which case
+ * the remaining elements stay in the queue
+ */
+    long (*drainTo)(const BlockingQueue *bq, const Queue *q, long max);
+
+/*
+ * retrieves, but does not remove, the head of the queue, returning that
+ * element in `*element'; never waits
+ *
+ * returns true if successful, false if unsuccessful (queue is empty)
+ */
+    bool (*front)(const BlockingQueue *bq, void **element);
+
+/*
+ * returns the number of elements in the queue
+ */
+    long (*size)(const BlockingQueue *bq);
+
+/*
+ * returns the number of elements that can be enqueued without waiting,
+ * or -1L if the queue is unbounded
+ */
+    long (*remainingCapacity)(const BlockingQueue *bq);
+
+/*
+ * returns true if the queue is empty, false if not
+ */
+    bool (*isEmpty)(const BlockingQueue *bq);
+
+/*
+ * returns an array containing all of the elements of the queue in
+ * proper sequence (from first to last element); returns the length of the
+ * queue in `*len'
+ *
+ * returns pointer to array of void * elements, or NULL if malloc failure
+ *
+ * NB - it is the caller's responsibility to free the void * array when
+ *      finished with it
+ */
+    void **(*toArray)(const BlockingQueue *bq, long *len);
+
+/*
+ * creates an iterator for running through a snapshot of the queue
+ *
+ * returns pointer to the Iterator or NULL
+ */
+    const Iterator *(*itCreate)(const BlockingQueue *bq);
+};
+
+#endif /* _BLOCKINGQUEUE_H_ */
@@ -0,0 +1,150 @@
+#ifndef _CACHE_H_
+#define _CACHE_H_
+
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * interface definition for a bounded key/value cache
+ *
+ * a cache holds at most `capacity' units of cost; when a put() would
+ * exceed the capacity, entries chosen by the implementation's eviction
+ * policy are removed, applying freeK and freeV to each, until the new
+ * entry fits
+ *
+ * the cost of an entry is computed once, by put(), using the
+ * constructor-specified cost function; if that function is NULL, each
+ * entry costs 1, so that capacity is a number of entries
+ */
+
+#include "ADTs/ADTdefs.h"
+#include "ADTs/iterator.h"              /* needed for factory method */
+
+typedef struct cache Cache;             /* forward reference */
+
+/* hit and miss counts since the cache was created or stats were reset */
+typedef struct cachestats {
+    long hits;                  /* get() calls that found their key */
+    long misses;                /* get() calls that did not */
+    long insertions;            /* put() calls that added a new key */
+    long evictions;             /* entries removed to make room */
+    double hitRatio;            /* hits / (hits + misses), 0.0 if neither */
+} CacheStats;
+
+/* now define struct cache */
+struct cache {
+/* the private data for the cache */
+    void *self;
+
+/* create a new, empty cache using the same implementation, capacity,
+ * and function pointers as the cache upon which the method has been
+ * invoked; returns NULL if error creating the new cache
+ */
+    const Cache *(*create)(const Cache *c);
+
+/* destroys the cache;
+ * applies constructor-specified freeK and freeV to each entry in the cache
+ * the storage associated with the cache is returned to the heap */
+    void (*destroy)(const Cache *c);
+
+/* clears all (key,value) pairs from the cache;
+ * applies constructor-specified freeK and freeV to each entry in the cache
+ * the statistics are not reset
+ *
+ * upon return, the cache is empty */
+    void (*clear)(const Cache *c);
+
+/* returns true if key is cached, false if not; unlike get(), it does not
+ * count as a use of the entry, nor as a hit or miss */
+    bool (*containsKey)(const Cache *c, void *key);
+
+/* returns the value associated with key in *value; returns true if key was
+ * found in the cache, false if not
+ *
+ * the lookup counts as a hit or a miss, and a hit counts as a use of the
+ * entry for the eviction policy */
+    bool (*get)(const Cache *c, void *key, void **value);
+
+/* puts (key,value) into the cache, evicting entries as needed;
+ * applies constructor-specified freeK and freeV if there was a previous
+ * entry associated with key
+ *
+ * returns true if (key,value) was successfully stored in the cache,
+ * false if malloc failure or if the cost of the entry exceeds the
+ * capacity of the cache; if false, freeK and freeV have not been applied
+ * to key and value */
+    bool (*put)(const Cache *c, void *key, void *value);
+
+/* removes the (key,value) pair from the cache;
+ * applies constructor-specified freeK and freeV to the removed entry
+ *
+ * returns true if (key,value) was present and removed,
+ * false if it was not present */
+    bool (*remove)(const Cache *c, void *key);
+
+/* returns the number of (key,value) pairs in the cache */
+    long (*size)(const Cache *c);
+
+/* returns true if the cache is empty, false if not */
+    bool (*isEmpty)(const Cache *c);
+
+/* returns the total cost of the (key,value) pairs in the cache */
+    long (*cost)(const Cache *c);
+
+/* returns the capacity of the cache */
+    long (*capacity)(const Cache *c);
+
+/* returns the statistics for the cache in *stats */
+    void (*stats)(const Cache *c, CacheStats *stats);
+
+/* resets the statistics for the cache to zero */
+    void (*resetStats)(const Cache *c);
+
+/* returns an array containing all of the keys in the cache; the order
+ * depends upon the eviction policy; returns the length of the array in *len
+ *
+ * returns a pointer to the array of void * keys, or NULL if malloc failure
+ * or if the cache is empty
+ *
+ * NB - the caller is responsible for freeing the void * array when finished
+ * with it */
+    void **(*keyArray)(const Cache *c, long *len);
+
+/* create generic iterator to the keys in the cache, in the same order as
+ * keyArray()
+ *
+ * returns pointer to the Iterator or NULL if malloc failure
+ * or if the cache is empty
+ */
+    const Iterator *(*itCreate)(const Cache *c);
+};
+
+#endif /* _CACHE_H_ */
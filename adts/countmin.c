@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * implementation of a Count-Min sketch
+ *
+ * the row hashes are h1 + i * h2 (mod width), h1 and h2 being the two
+ * halves of a 64-bit mix of the caller's hash; two independent hashes are
+ * enough to give the rows the error bound of independent ones
+ */
+
+#include "ADTs/countmin.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define HASH_N (1L << 60)
+#define E 2.718281828459045
+#define MAX_DEPTH 32
+
+typedef struct cm_data {
+    long (*hash)(void *, long N);
+    bool conservative;
+    long width;
+    long depth;
+    long total;
+    long *counters;                     /* depth rows of width counters */
+} CMData;
+
+static unsigned long mix(unsigned long x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdUL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53UL;
+    x ^= x >> 33;
+    return x;
+}
+
+/*
+ * returns pointers to the counters of `item' in each row in c[]; the
+ * depth is at most MAX_DEPTH
+ */
+static void counters(CMData *cmd, void *item, long *c[]) {
+    unsigned long x = mix((unsigned long)cmd->hash(item, HASH_N));
+    unsigned long h1 = x & 0xffffffffUL, h2 = (x >> 32) | 1UL;
+    long i;
+
+    for (i = 0; i < cmd->depth; i++)
+        c[i] = cmd->counters + i * cmd->width + (h1 + i * h2) % cmd->width;
+}
+
+static void cm_destroy(const CountMin *cm) {
+    CMData *cmd = (CMData *)cm->self;
+    free(cmd->counters);
+    free(cmd);
+    free((void *)cm);
+}
+
+static void cm_clear(const CountMin *cm) {
+    CMData *cmd = (CMData *)cm->self;
+    memset(cmd->counters, 0, cmd->width * cmd->depth * sizeof(long));
+    cmd->total = 0L;
+}
+
+static long cm_add(const CountMin *cm, void *item, long count) {
+    CMData *cmd = (CMData *)cm->self;
+    long *c[MAX_DEPTH];
+    long min = -1L, i;
+
+    counters(cmd, item, c);
+    cmd->total += count;
+    if (! cmd->conservative) {
+        for (i = 0; i < cmd->depth; i++) {
+            *c[i] += count;
+            if (min < 0L || *c[i] < min)
+                min = *c[i];
+        }
+        return min;
+    }
+    for (i = 0; i < cmd->depth; i++)
+        if (min < 0L || *c[i] < min)
+            min = *c[i];
+    min += count;
+    for (i = 0; i < cmd->depth; i++)
+        if (*c[i] < min)
+            *c[i] = min;
+    return min;
+}
+
+static long cm_estimate(const CountMin *cm, void *item) {
+    CMData *cmd = (CMData *)cm->self;
+    long *c[MAX_DEPTH];
+    long min = -1L, i;
+
+    counters(cmd, item, c);
+    for (i = 0; i < cmd->depth; i++)
+        if (min < 0L || *c[i] < min)
+            min = *c[i];
+    return min;
+}
+
+static long cm_total(const CountMin *cm) {
+    CMData *cmd = (CMData *)cm->self;
+    return cmd->total;
+}
+
+static bool cm_merge(const CountMin *cm, const CountMin *other) {
+    CMData *cmd = (CMData *)cm->self;
+    CMData *omd = (CMData *)other->self;
+    long i;
+
+    if (cmd->width != omd->width || cmd->depth != omd->depth)
+        return false;
+    for (i = 0; i < cmd->width * cmd->depth; i++)
+        cmd->counters[i] += omd->counters[i];
+    cmd->total += omd->total;
+    return true;
+}
+
+static long cm_bytes(const CountMin *cm, long *width, long *depth) {
+    CMData *cmd = (CMData *)cm->self;
+    *width = cmd->width;
+    *depth = cmd->depth;
+    return cmd->width * cmd->depth * sizeof(long);
+}
+
+static CountMin template = {
+    NULL, cm_destroy, cm_clear, cm_add, cm_estimate, cm_total, cm_merge,
+    cm_bytes
+};
+
+const CountMin *CountMin_create(double epsilon, double delta,
+                                bool conservative,
+                                long (*hash)(void *item, long N)) {
+    CountMin *cm;
+    CMData *cmd;
+    double p;
+
+    if (epsilon <= 0.0 || epsilon >= 1.0 || delta <= 0.0 || delta >= 1.0)
+        return NULL;
+    if (delta < 1e-13)          /* depth would exceed MAX_DEPTH */
+        delta = 1e-13;
+    if ((cm = (CountMin *)malloc(sizeof(CountMin))) == NULL)
+        return NULL;
+    if ((cmd = (CMData *)malloc(sizeof(CMData))) == NULL) {
+        free(cm);
+        return NULL;
+    }
+    cmd->hash = hash;
+    cmd->conservative = conservative;
+    cmd->width = (long)(E / epsilon);
+    if (cmd->width < E / epsilon)
+        cmd->width++;
+    for (cmd->depth = 0L, p = 1.0; p > delta; p /= E)   /* ceil(ln(1/d)) */
+        cmd->depth++;
+    cmd->total = 0L;
+    cmd->counters = (long *)calloc(cmd->width * cmd->depth, sizeof(long));
+    if (cmd->counters == NULL) {
+        free(cmd);
+        free(cm);
+        return NULL;
+    }
+    *cm = template;
+    cm->self = cmd;
+    return cm;
+}
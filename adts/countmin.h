@@ -0,0 +1,120 @@
+#ifndef _COUNTMIN_H_
+#define _COUNTMIN_H_
+
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * interface definition for a Count-Min sketch, which estimates how often
+ * each item has been seen in a stream in a fixed amount of storage
+ *
+ * the sketch is a depth x width array of counters; each row has its own
+ * hash of the item, and an item's estimate is the minimum of its counters
+ * in the rows; the estimate is never less than the true count, and with
+ * probability 1 - delta exceeds it by no more than epsilon * total()
+ *
+ * with conservative update, add() raises only those counters that are
+ * below the item's new estimate, which reduces the overestimates of
+ * infrequent items considerably; the bounds above still hold
+ */
+
+#include "ADTs/ADTdefs.h"
+
+typedef struct countmin CountMin;       /* forward reference */
+
+/*
+ * create a sketch with width ceil(e / epsilon) and depth ceil(ln(1 / delta));
+ * a delta below 1e-13 is treated as 1e-13
+ *
+ * the hash function pointer is applied to an item with N = 2^60; the
+ * rows' hashes are derived from the result, so it should use as many of
+ * its bits as it can
+ *
+ * returns a pointer to the sketch, or NULL if epsilon or delta is not in
+ * (0, 1) or if malloc errors
+ */
+const CountMin *CountMin_create(double epsilon, double delta,
+                                bool conservative,
+                                long (*hash)(void *item, long N));
+
+/*
+ * now define dispatch table
+ */
+struct countmin {
+/*
+ * the private data of the sketch
+ */
+    void *self;
+
+/*
+ * returns the storage associated with the sketch to the heap
+ */
+    void (*destroy)(const CountMin *cm);
+
+/*
+ * resets every counter to 0
+ */
+    void (*clear)(const CountMin *cm);
+
+/*
+ * records `count' more occurrences of `item'; count must be positive
+ *
+ * returns the item's new estimate
+ */
+    long (*add)(const CountMin *cm, void *item, long count);
+
+/*
+ * returns the estimated number of occurrences of `item'
+ */
+    long (*estimate)(const CountMin *cm, void *item);
+
+/*
+ * returns the sum of the counts passed to add()
+ */
+    long (*total)(const CountMin *cm);
+
+/*
+ * adds the counters of `other' into `cm'; the two must have been created
+ * with the same epsilon, delta and hash function
+ *
+ * returns true if successful, false if their sizes differ
+ */
+    bool (*merge)(const CountMin *cm, const CountMin *other);
+
+/*
+ * returns the width and depth of the sketch in `*width' and `*depth'
+ *
+ * returns the number of bytes of counters
+ */
+    long (*bytes)(const CountMin *cm, long *width, long *depth);
+};
+
+#endif /* _COUNTMIN_H_ */
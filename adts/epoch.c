@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * implementation of epoch-based memory reclamation
+ *
+ * the global epoch only advances once every thread that is inside a
+ * critical section has observed the current epoch, so a thread's own
+ * epoch is never more than one behind it; a node retired while the global
+ * epoch is e (read after the node was unlinked) therefore cannot be
+ * referenced by any thread once the global epoch reaches e + 2, so each
+ * thread keeps its retirements in NLIMBO buckets, one per epoch modulo 3
+ */
+
+#include "ADTs/epoch.h"
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#define NLIMBO 3
+#define DEFAULT_LIMBO_SIZE 64
+#define ADVANCE_INTERVAL 64     /* retirements between attempts to advance */
+
+typedef struct pending {
+    void *p;
+    void (*freeFxn)(void *p);
+} Pending;
+
+typedef struct limbo {
+    unsigned long epoch;        /* epoch in which the entries were retired */
+    long count;
+    long size;
+    Pending *entries;
+} Limbo;
+
+/*
+ * one record per registered thread; records are never unlinked, and a
+ * record released by an exiting thread is reused by the next thread to
+ * register, together with any retirements it still holds
+ */
+typedef struct threadrec {
+    struct threadrec *next;
+    atomic_bool inUse;
+    atomic_ulong state;         /* (epoch << 1) | 1 while in a critical section */
+    int nesting;
+    long retires;
+    Limbo limbo[NLIMBO];
+} ThreadRec;
+
+static atomic_ulong globalEpoch = 0UL;
+static _Atomic(ThreadRec *) records = NULL;
+static pthread_once_t keyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t recKey;
+static __thread ThreadRec *myRec = NULL;
+
+/*
+ * pthread key destructor - called when a registered thread exits
+ */
+static void releaseRec(void *arg) {
+    ThreadRec *r = (ThreadRec *)arg;
+
+    r->nesting = 0;
+    atomic_store(&r->state, 0UL);
+    atomic_store(&r->inUse, false);
+}
+
+static void makeKey(void) {
+    (void)pthread_key_create(&recKey, releaseRec);
+}
+
+/*
+ * claim a released record if there is one, otherwise add a new record
+ * to the list
+ *
+ * returns the record, or NULL if malloc errors
+ */
+static ThreadRec *registerThread(void) {
+    ThreadRec *r;
+
+    (void)pthread_once(&keyOnce, makeKey);
+    for (r = atomic_load(&records); r != NULL; r = r->next) {
+        bool expected = false;
+
+        if (! atomic_load(&r->inUse) &&
+            atomic_compare_exchange_strong(&r->inUse, &expected, true))
+            break;
+    }
+    if (r == NULL) {
+        if ((r = (ThreadRec *)calloc(1, sizeof(ThreadRec))) == NULL)
+            return NULL;
+        atomic_init(&r->inUse, true);
+        atomic_init(&r->state, 0UL);
+        r->next = atomic_load(&records);
+        while (! atomic_compare_exchange_weak(&records, &(r->next), r))
+            ;
+    }
+    if (pthread_setspecific(recKey, r) != 0) {
+        atomic_store(&r->inUse, false);
+        return NULL;
+    }
+    myRec = r;
+    return r;
+}
+
+/*
+ * call the free function of every entry in a bucket
+ */
+static void freeLimbo(Limbo *l) {
+    long i;
+
+    for (i = 0; i < l->count; i++)
+        l->entries[i].freeFxn(l->entries[i].p);
+    l->count = 0L;
+}
+
+/*
+ * advance the global epoch from e to e + 1 if every thread in a critical
+ * section has observed e
+ */
+static void tryAdvance(void) {
+    unsigned long e = atomic_load(&globalEpoch);
+    ThreadRec *r;
+
+    for (r = atomic_load(&records); r != NULL; r = r->next) {
+        unsigned long s = atomic_load(&r->state);
+
+        if ((s & 1UL) && (s >> 1) != e)
+            return;
+    }
+    (void)atomic_compare_exchange_strong(&globalEpoch, &e, e + 1);
+}
+
+bool Epoch_enter(void) {
+    ThreadRec *r = myRec;
+
+    if (r == NULL && (r = registerThread()) == NULL)
+        return false;
+    if (r->nesting++ == 0) {
+        unsigned long e = atomic_load(&globalEpoch);
+        int i;
+
+        atomic_store(&r->state, (e << 1) | 1UL);
+        atomic_thread_fence(memory_order_seq_cst);
+        for (i = 0; i < NLIMBO; i++)
+            if (r->limbo[i].count > 0 && r->limbo[i].epoch + 2 <= e)
+                freeLimbo(&(r->limbo[i]));
+    }
+    return true;
+}
+
+void Epoch_exit(void) {
+    ThreadRec *r = myRec;
+
+    if (r != NULL && --r->nesting == 0)
+        atomic_store_explicit(&r->state, atomic_load(&r->state) & ~1UL,
+                              memory_order_release);
+}
+
+void Epoch_retire(void *p, void (*freeFxn)(void *p)) {
+    ThreadRec *r = myRec;
+    unsigned long e = atomic_load(&globalEpoch);
+    Limbo *l = &(r->limbo[e % NLIMBO]);
+
+    if (l->epoch != e) {        /* left over from epoch e - 3 or earlier */
+        freeLimbo(l);
+        l->epoch = e;
+    }
+    if (l->count == l->size) {
+        long size = (l->size == 0L) ? DEFAULT_LIMBO_SIZE : 2 * l->size;
+        Pending *tmp = (Pending *)realloc(l->entries, size * sizeof(Pending));
+
+        if (tmp == NULL)        /* cannot be freed safely, so leak it */
+            return;
+        l->entries = tmp;
+        l->size = size;
+    }
+    l->entries[l->count].p = p;
+    l->entries[l->count].freeFxn = freeFxn;
+    l->count++;
+    if (++r->retires % ADVANCE_INTERVAL == 0)
+        tryAdvance();
+}
@@ -0,0 +1,73 @@
+#ifndef _EPOCH_H_
+#define _EPOCH_H_
+
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ADTs/ADTdefs.h"
+
+/*
+ * epoch-based memory reclamation for the concurrent ADTs
+ *
+ * a lock-free structure cannot free() a node as soon as it unlinks it,
+ * since other threads may still be reading it; instead, every operation
+ * that dereferences shared nodes is bracketed by Epoch_enter()/Epoch_exit(),
+ * and an unlinked node is handed to Epoch_retire(), which frees it once
+ * every thread that might have seen it has left its critical section
+ *
+ * a single process-wide epoch is shared by all of the ADTs that use this
+ * module; each thread registers itself the first time it calls
+ * Epoch_enter(), and its pending retirements are handed on to the next
+ * thread to register once it exits
+ */
+
+/*
+ * start a critical section for the calling thread; critical sections may
+ * be nested
+ *
+ * returns true if successful, false if the thread could not be
+ * registered (malloc errors)
+ */
+bool Epoch_enter(void);
+
+/*
+ * end the critical section started by the matching Epoch_enter()
+ */
+void Epoch_exit(void);
+
+/*
+ * arrange for freeFxn(p) to be called once no thread can hold a reference
+ * to p; must be called inside a critical section, after p has been made
+ * unreachable from the shared structure
+ */
+void Epoch_retire(void *p, void (*freeFxn)(void *p));
+
+#endif /* _EPOCH_H_ */
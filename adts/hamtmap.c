@@ -0,0 +1,745 @@
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * implementation of a persistent hash array mapped trie
+ *
+ * every node is reference counted; a node whose count is 1 is reachable
+ * from only one map, through ancestors whose counts are also 1, so put()
+ * and remove() update it in place; a node whose count is greater is shared
+ * with a snapshot, and is copied instead, the copy taking a reference to
+ * each of the node's children
+ *
+ * an entry is a leaf node, so that freeK and freeV are applied only when
+ * the last map holding the entry releases it; keys whose hashes are equal
+ * share a collision node - the caller's hash has 60 bits (N = 2^60), and
+ * hashOf() spreads them over all 64 without adding any, so the trie can
+ * tell apart no more keys than those 60 bits can
+ *
+ * the recursive helpers either succeed, taking over the caller's
+ * reference to `node', or fail because of malloc, leaving everything as
+ * it was; any allocation that would be needed after a change has been
+ * made below is done before recursing
+ */
+
+#include "ADTs/hamtmap.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#define BITS 5
+#define MASK 31UL
+#define HASH_N (1L << 60)
+
+typedef enum { LEAF, BRANCH, COLLISION } Kind;
+
+typedef struct hnode {
+    atomic_long refs;
+    Kind kind;
+} HNode;
+
+typedef struct leaf {
+    HNode h;
+    unsigned long hash;
+    MEntry entry;
+} Leaf;
+
+typedef struct branch {
+    HNode h;
+    unsigned int bitmap;		/* bit i set if child i is present */
+    int n;
+    HNode *kids[];			/* present children, in index order */
+} Branch;
+
+typedef struct collision {
+    HNode h;
+    unsigned long hash;
+    int n;
+    Leaf *leaves[];
+} Collision;
+
+typedef struct m_data {
+    long (*hash)(void *, long N);
+    int (*cmp)(void *, void *);
+    void (*freeK)(void *k);
+    void (*freeV)(void *v);
+    HNode *root;			/* NULL if the map is empty */
+    long size;
+} MData;
+
+/*
+ * applies the caller's hash function, then mixes the result so that the
+ * trie stays balanced even when the hash function uses few bits; the mix
+ * is a bijection, so two keys' 64-bit results are equal exactly when their
+ * 60-bit hashes are
+ */
+static unsigned long hashOf(MData *md, void *key) {
+    unsigned long x = (unsigned long)md->hash(key, HASH_N);
+
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdUL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53UL;
+    x ^= x >> 33;
+    return x;
+}
+
+static unsigned int indexOf(unsigned long hash, int shift) {
+    return (unsigned int)((hash >> shift) & MASK);
+}
+
+static int position(unsigned int bitmap, unsigned int bit) {
+    return __builtin_popcount(bitmap & (bit - 1));
+}
+
+/*
+ * node helpers
+ */
+
+static void retain(HNode *p) {
+    atomic_fetch_add(&p->refs, 1L);
+}
+
+static bool shared(HNode *p) {
+    return (atomic_load(&p->refs) > 1L);
+}
+
+static void release(MData *md, HNode *p) {
+    int i;
+
+    if (p == NULL || atomic_fetch_sub(&p->refs, 1L) != 1L)
+        return;
+    switch (p->kind) {
+    case LEAF:
+        md->freeK(((Leaf *)p)->entry.key);
+        md->freeV(((Leaf *)p)->entry.value);
+        break;
+    case BRANCH:
+        for (i = 0; i < ((Branch *)p)->n; i++)
+            release(md, ((Branch *)p)->kids[i]);
+        break;
+    case COLLISION:
+        for (i = 0; i < ((Collision *)p)->n; i++)
+            release(md, (HNode *)((Collision *)p)->leaves[i]);
+        break;
+    }
+    free(p);
+}
+
+static void initNode(HNode *p, Kind kind) {
+    atomic_init(&p->refs, 1L);
+    p->kind = kind;
+}
+
+static Leaf *newLeaf(unsigned long hash, void *key, void *value) {
+    Leaf *p = (Leaf *)malloc(sizeof(Leaf));
+
+    if (p != NULL) {
+        initNode(&p->h, LEAF);
+        p->hash = hash;
+        p->entry.key = key;
+        p->entry.value = value;
+    }
+    return p;
+}
+
+static Branch *newBranch(int n) {
+    Branch *p = (Branch *)malloc(sizeof(Branch) + n * sizeof(HNode *));
+
+    if (p != NULL) {
+        initNode(&p->h, BRANCH);
+        p->bitmap = 0U;
+        p->n = n;
+    }
+    return p;
+}
+
+static Collision *newCollision(unsigned long hash, int n) {
+    Collision *p = (Collision *)malloc(sizeof(Collision) + n * sizeof(Leaf *));
+
+    if (p != NULL) {
+        initNode(&p->h, COLLISION);
+        p->hash = hash;
+        p->n = n;
+    }
+    return p;
+}
+
+/* the hash of the keys below a leaf or collision node */
+static unsigned long hashBelow(HNode *p) {
+    return (p->kind == LEAF) ? ((Leaf *)p)->hash : ((Collision *)p)->hash;
+}
+
+/*
+ * returns a chain of branches, starting at `shift', below which the leaf
+ * or collision node `a' and leaf `b', whose hashes differ, are siblings;
+ * returns NULL if malloc failure
+ */
+static HNode *pair(HNode *a, Leaf *b, int shift) {
+    unsigned long ha = hashBelow(a);
+    Branch *chain[64 / BITS + 1];
+    int levels = 0, s, i;
+
+    for (s = shift; indexOf(ha, s) == indexOf(b->hash, s); s += BITS)
+        levels++;
+    levels++;
+    for (i = 0; i < levels; i++) {
+        chain[i] = newBranch((i == levels - 1) ? 2 : 1);
+        if (chain[i] == NULL) {
+            while (--i >= 0)
+                free(chain[i]);
+            return NULL;
+        }
+    }
+    for (i = 0, s = shift; i < levels - 1; i++, s += BITS) {
+        chain[i]->bitmap = 1U << indexOf(ha, s);
+        chain[i]->kids[0] = (HNode *)chain[i + 1];
+    }
+    chain[i]->bitmap = (1U << indexOf(ha, s)) | (1U << indexOf(b->hash, s));
+    chain[i]->kids[indexOf(ha, s) < indexOf(b->hash, s) ? 0 : 1] = a;
+    chain[i]->kids[indexOf(ha, s) < indexOf(b->hash, s) ? 1 : 0] = (HNode *)b;
+    return (HNode *)chain[0];
+}
+
+/*
+ * puts leaf into the subtree rooted at node, at depth `shift'; *added is
+ * set true if the key was not already present
+ *
+ * returns the new subtree, or NULL if malloc failure
+ */
+static HNode *assoc(MData *md, HNode *node, int shift, Leaf *leaf,
+                    bool *added) {
+    int i;
+
+    *added = true;
+    if (node == NULL)
+        return (HNode *)leaf;
+    if (node->kind == LEAF) {
+        Leaf *l = (Leaf *)node;
+        Collision *c;
+
+        if (l->hash != leaf->hash)
+            return pair(node, leaf, shift);
+        if (md->cmp(l->entry.key, leaf->entry.key) == 0) {
+            *added = false;
+            release(md, node);
+            return (HNode *)leaf;
+        }
+        if ((c = newCollision(leaf->hash, 2)) == NULL)
+            return NULL;
+        c->leaves[0] = l;
+        c->leaves[1] = leaf;
+        return (HNode *)c;
+    }
+    if (node->kind == COLLISION) {
+        Collision *c = (Collision *)node, *copy;
+
+        if (c->hash != leaf->hash)
+            return pair(node, leaf, shift);
+        for (i = 0; i < c->n; i++)
+            if (md->cmp(c->leaves[i]->entry.key, leaf->entry.key) == 0)
+                break;
+        *added = (i == c->n);
+        if (! *added && ! shared(node)) {
+            release(md, (HNode *)c->leaves[i]);
+            c->leaves[i] = leaf;
+            return node;
+        }
+        copy = newCollision(c->hash, c->n + (*added ? 1 : 0));
+        if (copy == NULL)
+            return NULL;
+        memcpy(copy->leaves, c->leaves, c->n * sizeof(Leaf *));
+        copy->leaves[i] = leaf;
+        for (i = 0; i < copy->n; i++)
+            if (copy->leaves[i] != leaf)
+                retain((HNode *)copy->leaves[i]);
+        release(md, node);
+        return (HNode *)copy;
+    } else {
+        Branch *b = (Branch *)node, *copy;
+        unsigned int bit = 1U << indexOf(leaf->hash, shift);
+        int pos = position(b->bitmap, bit);
+
+        if (! (b->bitmap & bit)) {		/* a new child */
+            copy = newBranch(b->n + 1);
+            if (copy == NULL)
+                return NULL;
+            copy->bitmap = b->bitmap | bit;
+            memcpy(copy->kids, b->kids, pos * sizeof(HNode *));
+            copy->kids[pos] = (HNode *)leaf;
+            memcpy(copy->kids + pos + 1, b->kids + pos,
+                   (b->n - pos) * sizeof(HNode *));
+            if (shared(node)) {
+                for (i = 0; i < b->n; i++)
+                    retain(b->kids[i]);
+                release(md, node);
+            } else
+                free(node);
+            return (HNode *)copy;
+        }
+        if (! shared(node)) {
+            HNode *kid = assoc(md, b->kids[pos], shift + BITS, leaf, added);
+
+            if (kid == NULL)
+                return NULL;
+            b->kids[pos] = kid;
+            return node;
+        } else {
+            HNode *kid;
+
+            if ((copy = newBranch(b->n)) == NULL)
+                return NULL;
+            retain(b->kids[pos]);		/* the copy's reference */
+            kid = assoc(md, b->kids[pos], shift + BITS, leaf, added);
+            if (kid == NULL) {
+                release(md, b->kids[pos]);
+                free(copy);
+                return NULL;
+            }
+            copy->bitmap = b->bitmap;
+            for (i = 0; i < b->n; i++) {
+                copy->kids[i] = (i == pos) ? kid : b->kids[i];
+                if (i != pos)
+                    retain(copy->kids[i]);
+            }
+            release(md, node);
+            return (HNode *)copy;
+        }
+    }
+}
+
+/*
+ * removes key from the subtree rooted at node, at depth `shift'; the new
+ * subtree, which may be NULL, is returned in *out, and *removed is set
+ * true if the key was present
+ *
+ * returns false if malloc failure
+ */
+static bool dissoc(MData *md, HNode *node, int shift, unsigned long hash,
+                   void *key, HNode **out, bool *removed) {
+    int i;
+
+    *out = node;
+    *removed = false;
+    if (node == NULL)
+        return true;
+    if (node->kind == LEAF) {
+        Leaf *l = (Leaf *)node;
+
+        if (l->hash == hash && md->cmp(l->entry.key, key) == 0) {
+            *removed = true;
+            *out = NULL;
+            release(md, node);
+        }
+        return true;
+    }
+    if (node->kind == COLLISION) {
+        Collision *c = (Collision *)node, *copy;
+        int j, k;
+
+        if (c->hash != hash)
+            return true;
+        for (i = 0; i < c->n; i++)
+            if (md->cmp(c->leaves[i]->entry.key, key) == 0)
+                break;
+        if (i == c->n)
+            return true;
+        *removed = true;
+        if (c->n == 2) {			/* the other leaf replaces it */
+            *out = (HNode *)c->leaves[1 - i];
+            retain(*out);
+            release(md, node);
+            return true;
+        }
+        if ((copy = newCollision(c->hash, c->n - 1)) == NULL) {
+            *removed = false;
+            return false;
+        }
+        for (j = 0, k = 0; j < c->n; j++)
+            if (j != i) {
+                copy->leaves[k++] = c->leaves[j];
+                retain((HNode *)c->leaves[j]);
+            }
+        *out = (HNode *)copy;
+        release(md, node);
+        return true;
+    } else {
+        Branch *b = (Branch *)node, *copy = NULL;
+        unsigned int bit = 1U << indexOf(hash, shift);
+        int pos = position(b->bitmap, bit);
+        bool isShared = shared(node);
+        HNode *kid, *other;
+
+        if (! (b->bitmap & bit))
+            return true;
+        if (isShared) {
+            if ((copy = newBranch(b->n)) == NULL)
+                return false;
+            retain(b->kids[pos]);		/* the copy's reference */
+        }
+        if (! dissoc(md, b->kids[pos], shift + BITS, hash, key, &kid,
+                     removed)) {
+            if (isShared) {
+                release(md, b->kids[pos]);
+                free(copy);
+            }
+            return false;
+        }
+        if (! *removed) {
+            if (isShared) {
+                release(md, kid);
+                free(copy);
+            }
+            return true;
+        }
+        /* a branch left with one leaf or collision node is replaced by it */
+        other = (b->n == 2) ? b->kids[1 - pos] : NULL;
+        if (b->n == 1 && kid == NULL) {
+            *out = NULL;
+        } else if (kid == NULL && other != NULL && other->kind != BRANCH) {
+            *out = other;
+            if (isShared)			/* else node's reference moves */
+                retain(other);
+        } else if (b->n == 1 && kid->kind != BRANCH) {
+            *out = kid;
+            kid = NULL;				/* now *out's reference */
+        } else if (! isShared) {
+            if (kid != NULL)
+                b->kids[pos] = kid;
+            else {
+                memmove(b->kids + pos, b->kids + pos + 1,
+                        (b->n - pos - 1) * sizeof(HNode *));
+                b->n--;
+                b->bitmap &= ~bit;
+            }
+            return true;
+        } else {
+            copy->bitmap = b->bitmap;
+            copy->n = 0;
+            for (i = 0; i < b->n; i++) {
+                if (i == pos) {
+                    if (kid != NULL)
+                        copy->kids[copy->n++] = kid;
+                    else
+                        copy->bitmap &= ~bit;
+                } else {
+                    copy->kids[copy->n++] = b->kids[i];
+                    retain(b->kids[i]);
+                }
+            }
+            *out = (HNode *)copy;
+            release(md, node);
+            return true;
+        }
+        /* node is being replaced by *out, or by nothing */
+        free(copy);
+        if (isShared)
+            release(md, node);
+        else
+            free(node);
+        return true;
+    }
+}
+
+/*
+ * local function to locate key in a map
+ *
+ * returns pointer to leaf, if found; NULL if not found
+ */
+static Leaf *findKey(MData *md, void *key) {
+    unsigned long hash = hashOf(md, key);
+    HNode *p = md->root;
+    int shift = 0, i;
+
+    while (p != NULL) {
+        if (p->kind == LEAF) {
+            Leaf *l = (Leaf *)p;
+            if (l->hash == hash && md->cmp(l->entry.key, key) == 0)
+                return l;
+            break;
+        } else if (p->kind == COLLISION) {
+            Collision *c = (Collision *)p;
+            if (c->hash == hash)
+                for (i = 0; i < c->n; i++)
+                    if (md->cmp(c->leaves[i]->entry.key, key) == 0)
+                        return c->leaves[i];
+            break;
+        } else {
+            Branch *b = (Branch *)p;
+            unsigned int bit = 1U << indexOf(hash, shift);
+            if (! (b->bitmap & bit))
+                break;
+            p = b->kids[position(b->bitmap, bit)];
+            shift += BITS;
+        }
+    }
+    return NULL;
+}
+
+static void m_destroy(const Map *m) {
+    MData *md = (MData *)m->self;
+    release(md, md->root);
+    free(md);
+    free((void *)m);
+}
+
+static void m_clear(const Map *m) {
+    MData *md = (MData *)m->self;
+    release(md, md->root);
+    md->root = NULL;
+    md->size = 0L;
+}
+
+static bool m_containsKey(const Map *m, void *key) {
+    MData *md = (MData *)m->self;
+
+    return (findKey(md, key) != NULL);
+}
+
+static bool m_get(const Map *m, void *key, void **value) {
+    MData *md = (MData *)m->self;
+    Leaf *l = findKey(md, key);
+    bool status = (l != NULL);
+
+    if (status)
+        *value = l->entry.value;
+    return status;
+}
+
+static bool m_put(const Map *m, void *key, void *value) {
+    MData *md = (MData *)m->self;
+    Leaf *l = newLeaf(hashOf(md, key), key, value);
+    HNode *root;
+    bool added;
+
+    if (l == NULL)
+        return false;
+    root = assoc(md, md->root, 0, l, &added);
+    if (root == NULL) {
+        free(l);
+        return false;
+    }
+    md->root = root;
+    if (added)
+        md->size++;
+    return true;
+}
+
+static bool m_putUnique(const Map *m, void *key, void *value) {
+    MData *md = (MData *)m->self;
+
+    if (findKey(md, key) != NULL)
+        return false;
+    return m_put(m, key, value);
+}
+
+static bool m_remove(const Map *m, void *key) {
+    MData *md = (MData *)m->self;
+    HNode *root;
+    bool removed;
+
+    if (! dissoc(md, md->root, 0, hashOf(md, key), key, &root, &removed))
+        return false;
+    md->root = root;
+    if (removed)
+        md->size--;
+    return removed;
+}
+
+static long m_size(const Map *m) {
+    MData *md = (MData *)m->self;
+    return md->size;
+}
+
+static bool m_isEmpty(const Map *m) {
+    MData *md = (MData *)m->self;
+    return (md->size == 0L);
+}
+
+/*
+ * helper function that appends the entries below p to tmp[*n ...]
+ */
+static void collect(HNode *p, MEntry **tmp, long *n) {
+    int i;
+
+    if (p == NULL)
+        return;
+    switch (p->kind) {
+    case LEAF:
+        tmp[(*n)++] = &((Leaf *)p)->entry;
+        break;
+    case BRANCH:
+        for (i = 0; i < ((Branch *)p)->n; i++)
+            collect(((Branch *)p)->kids[i], tmp, n);
+        break;
+    case COLLISION:
+        for (i = 0; i < ((Collision *)p)->n; i++)
+            tmp[(*n)++] = &((Collision *)p)->leaves[i]->entry;
+        break;
+    }
+}
+
+/*
+ * helper function for generating an array of MEntry * from a map
+ *
+ * returns pointer to the array or NULL if malloc failure
+ */
+static MEntry **entries(MData *md) {
+    MEntry **tmp = NULL;
+    if (md->size > 0L) {
+        tmp = (MEntry **)malloc(md->size * sizeof(MEntry *));
+        if (tmp != NULL) {
+            long n = 0L;
+            collect(md->root, tmp, &n);
+        }
+    }
+    return tmp;
+}
+
+static void **m_keyArray(const Map *m, long *len) {
+    MData *md = (MData *)m->self;
+    MEntry **tmp = entries(md);
+    long i;
+
+    if (tmp == NULL)
+        return NULL;
+    for (i = 0L; i < md->size; i++)
+        ((void **)tmp)[i] = tmp[i]->key;
+    *len = md->size;
+    return (void **)tmp;
+}
+
+static MEntry **m_entryArray(const Map *m, long *len) {
+    MData *md = (MData *)m->self;
+    MEntry **tmp = entries(md);
+
+    if (tmp != NULL)
+        *len = md->size;
+    return tmp;
+}
+
+static const Iterator *m_itCreate(const Map *m) {
+    MData *md = (MData *)m->self;
+    const Iterator *it = NULL;
+    void **tmp = (void **)entries(md);
+
+    if (tmp != NULL) {
+        it = Iterator_create(md->size, tmp);
+        if (it == NULL)
+            free(tmp);
+    }
+    return it;
+}
+
+static const Map *m_create(const Map *m);
+
+static Map template = {
+    NULL, m_create, m_destroy, m_clear, m_containsKey, m_get, m_put,
+    m_putUnique, m_remove, m_size, m_isEmpty, m_keyArray, m_entryArray,
+    m_itCreate
+};
+
+/*
+ * helper function to create a new Map dispatch table holding `root'
+ */
+static const Map *newMap(long (*hash)(void*, long), int (*cmp)(void*, void*),
+                         void (*freeK)(void*), void (*freeV)(void *),
+                         HNode *root, long size) {
+    Map *m = (Map *)malloc(sizeof(Map));
+
+    if (m != NULL) {
+        MData *md = (MData *)malloc(sizeof(MData));
+
+        if (md != NULL) {
+            md->hash = hash; md->cmp = cmp;
+            md->freeK = freeK; md->freeV = freeV;
+            md->root = root; md->size = size;
+            *m = template;
+            m->self = md;
+        } else {
+            free(m); m = NULL;
+        }
+    }
+    return m;
+}
+
+static const Map *m_create(const Map *m) {
+    MData *md = (MData *)m->self;
+
+    return newMap(md->hash, md->cmp, md->freeK, md->freeV, NULL, 0L);
+}
+
+const Map *HAMTMap(long (*hash)(void*, long N), int (*cmp)(void*, void*),
+                   void (*freeK)(void *k), void (*freeV)(void *v)) {
+
+    return newMap(hash, cmp, freeK, freeV, NULL, 0L);
+}
+
+const Map *HAMTMap_snapshot(const Map *m) {
+    MData *md = (MData *)m->self;
+    const Map *s;
+
+    if (m->put != m_put)
+        return NULL;
+    s = newMap(md->hash, md->cmp, md->freeK, md->freeV, md->root, md->size);
+    if (s != NULL && md->root != NULL)
+        retain(md->root);
+    return s;
+}
+
+const Map *HAMTMap_assoc(const Map *m, void *key, void *value) {
+    const Map *s = HAMTMap_snapshot(m);
+
+    if (s != NULL && ! m_put(s, key, value)) {
+        m_destroy(s);
+        s = NULL;
+    }
+    return s;
+}
+
+const Map *HAMTMap_dissoc(const Map *m, void *key) {
+    const Map *s = HAMTMap_snapshot(m);
+    MData *md;
+    HNode *root;
+    bool removed;
+
+    if (s == NULL)
+        return NULL;
+    md = (MData *)s->self;
+    if (! dissoc(md, md->root, 0, hashOf(md, key), key, &root, &removed)) {
+        m_destroy(s);
+        return NULL;
+    }
+    md->root = root;
+    if (removed)
+        md->size--;
+    return s;
+}
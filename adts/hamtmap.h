@@ -0,0 +1,83 @@
+#ifndef _HAMTMAP_H_
+#define _HAMTMAP_H_
+
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ADTs/ADTdefs.h"
+#include "ADTs/map.h"
+
+/* constructor for persistent hash-array-mapped-trie map */
+
+/* create a hash array mapped trie: a 32-way trie indexed 5 bits at a time
+ * by the hash of the key, in which each node holds only the children that
+ * are present
+ *
+ * the trie is persistent: HAMTMap_snapshot() returns, in O(1), a new Map
+ * that shares every node with the original, and a later put() or remove()
+ * on either copies only the nodes on the path to the key, so that the
+ * other is unchanged; nodes that are not shared are updated in place, so
+ * a map built without snapshots costs no more than an ordinary trie
+ *
+ * a map and its snapshots may be used by different threads at once; a
+ * single map must not be used by more than one thread at a time
+ *
+ * returns a pointer to the map, or NULL if there are malloc errors
+ *
+ * the hash function pointer is applied to a key with N = 2^60 to yield the
+ * bits that index the trie; it should use as many of them as it can
+ *
+ * the cmp function pointer is applied to a pair of keys, yielding <0 | 0 | >0
+ *
+ * freeK is a function pointer that will be called on the key of an entry
+ * when the last map holding the entry no longer does so, by destroy(),
+ * clear(), put(), or remove()
+ *
+ * freeV is a function pointer that will be called on the value of an entry
+ * in the same way as freeK
+ */
+const Map *HAMTMap(long (*hash)(void*, long N), int (*cmp)(void*, void*),
+                   void (*freeK)(void *k), void (*freeV)(void *v));
+
+/* returns a new map holding the same entries as `m', sharing all of its
+ * storage, or NULL if malloc failure or if `m' was not created by HAMTMap()
+ */
+const Map *HAMTMap_snapshot(const Map *m);
+
+/* returns a new version of `m' in which (key,value) has been put() or key
+ * has been remove()d; `m' is unchanged
+ *
+ * returns NULL if malloc failure or if `m' was not created by HAMTMap()
+ */
+const Map *HAMTMap_assoc(const Map *m, void *key, void *value);
+const Map *HAMTMap_dissoc(const Map *m, void *key);
+
+#endif /* _HAMTMAP_H_ */
@@ -0,0 +1,646 @@
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * implementation of the LRU, CLOCK and ARC caches
+ *
+ * every entry is on one hash chain and on one doubly-linked list; each
+ * list has a sentinel, whose next is the most recently used entry and
+ * whose prev is the least recently used entry
+ *
+ * LRU and CLOCK use only list T1; for CLOCK, the list is the clock face,
+ * and a new entry is linked just behind the hand
+ *
+ * ARC resident entries are on T1 (used once) or T2 (used again); ghosts,
+ * entries whose values have been evicted, are on B1 or B2 and stay in the
+ * hash table, so that a put() of a remembered key finds its ghost; all
+ * four lists are sized in units of cost, and `target' is the cost that
+ * T1 should be allowed to reach before T2 gives up entries
+ */
+
+#include "ADTs/hashcache.h"
+#include <stdlib.h>
+
+#define DEFAULT_BUCKETS 16
+#define MAX_BUCKETS 134217728L
+#define LOAD_FACTOR 0.75
+
+typedef enum { LRU, CLOCK, ARC } Policy;
+typedef enum { T1, T2, B1, B2, NLISTS } ListId;
+
+typedef struct centry CEntry;
+struct centry {
+    CEntry *chain;              /* next on the hash chain */
+    CEntry *prev;               /* towards the MRU end of its list */
+    CEntry *next;               /* towards the LRU end of its list */
+    void *key;
+    void *value;
+    long cost;
+    ListId list;
+    bool referenced;            /* CLOCK only */
+};
+
+typedef struct clist {
+    CEntry head;                /* sentinel */
+    long cost;
+    long count;
+} CList;
+
+typedef struct cdata {
+    Policy policy;
+    long (*hash)(void *, long N);
+    int (*cmp)(void *, void *);
+    long (*costOf)(void *k, void *v);
+    void (*freeK)(void *k);
+    void (*freeV)(void *v);
+    long capacity;
+    long nbuckets;
+    long nentries;              /* entries in the hash table, ghosts included */
+    CEntry **buckets;
+    CList lists[NLISTS];
+    CEntry *hand;               /* CLOCK only; NULL if T1 is empty */
+    long target;                /* ARC only */
+    CacheStats stats;
+} CData;
+
+#define RESIDENT(e) ((e)->list == T1 || (e)->list == T2)
+
+/*
+ * list helpers
+ */
+static void listInit(CList *l) {
+    l->head.prev = &(l->head);
+    l->head.next = &(l->head);
+    l->cost = 0L;
+    l->count = 0L;
+}
+
+/* link e into l just before `at', which may be the sentinel */
+static void linkBefore(CData *cd, ListId id, CEntry *at, CEntry *e) {
+    CList *l = &(cd->lists[id]);
+
+    e->prev = at->prev;
+    e->next = at;
+    at->prev->next = e;
+    at->prev = e;
+    e->list = id;
+    l->cost += e->cost;
+    l->count++;
+}
+
+static void linkMRU(CData *cd, ListId id, CEntry *e) {
+    linkBefore(cd, id, cd->lists[id].head.next, e);
+}
+
+static void listUnlink(CData *cd, CEntry *e) {
+    CList *l = &(cd->lists[e->list]);
+
+    e->prev->next = e->next;
+    e->next->prev = e->prev;
+    l->cost -= e->cost;
+    l->count--;
+}
+
+static CEntry *lruOf(CData *cd, ListId id) {
+    CEntry *e = cd->lists[id].head.prev;
+
+    return (e == &(cd->lists[id].head)) ? NULL : e;
+}
+
+static long residentCost(CData *cd) {
+    return cd->lists[T1].cost + cd->lists[T2].cost;
+}
+
+/*
+ * hash table helpers
+ */
+static CEntry *findKey(CData *cd, void *key) {
+    CEntry *p;
+
+    for (p = cd->buckets[cd->hash(key, cd->nbuckets)]; p != NULL; p = p->chain)
+        if (cd->cmp(p->key, key) == 0)
+            break;
+    return p;
+}
+
+/*
+ * doubles the number of buckets; if malloc fails, the chains just get
+ * longer
+ */
+static void resize(CData *cd) {
+    long i, j, N = 2 * cd->nbuckets;
+    CEntry *p, *q, **array;
+
+    if (N > MAX_BUCKETS)
+        N = MAX_BUCKETS;
+    if (N == cd->nbuckets)
+        return;
+    array = (CEntry **)malloc(N * sizeof(CEntry *));
+    if (array == NULL)
+        return;
+    for (j = 0; j < N; j++)
+        array[j] = NULL;
+    for (i = 0; i < cd->nbuckets; i++) {
+        for (p = cd->buckets[i]; p != NULL; p = q) {
+            q = p->chain;
+            j = cd->hash(p->key, N);
+            p->chain = array[j];
+            array[j] = p;
+        }
+    }
+    free(cd->buckets);
+    cd->buckets = array;
+    cd->nbuckets = N;
+}
+
+static void hashInsert(CData *cd, CEntry *e) {
+    long i;
+
+    if (cd->nentries >= LOAD_FACTOR * cd->nbuckets)
+        resize(cd);
+    i = cd->hash(e->key, cd->nbuckets);
+    e->chain = cd->buckets[i];
+    cd->buckets[i] = e;
+    cd->nentries++;
+}
+
+static void hashRemove(CData *cd, CEntry *e) {
+    CEntry **pp = &(cd->buckets[cd->hash(e->key, cd->nbuckets)]);
+
+    while (*pp != e)
+        pp = &((*pp)->chain);
+    *pp = e->chain;
+    cd->nentries--;
+}
+
+/*
+ * moves the clock hand to the next entry on the clock face
+ */
+static void advanceHand(CData *cd) {
+    CEntry *head = &(cd->lists[T1].head);
+
+    cd->hand = cd->hand->next;
+    if (cd->hand == head)
+        cd->hand = head->next;
+    if (cd->hand == head)
+        cd->hand = NULL;
+}
+
+/*
+ * removes e from the cache altogether, applying freeK and, if e is
+ * resident, freeV
+ */
+static void drop(CData *cd, CEntry *e) {
+    if (cd->policy == CLOCK && cd->hand == e)
+        advanceHand(cd);
+    listUnlink(cd, e);
+    if (cd->policy == CLOCK && cd->lists[T1].count == 0L)
+        cd->hand = NULL;
+    hashRemove(cd, e);
+    cd->freeK(e->key);
+    if (RESIDENT(e))
+        cd->freeV(e->value);
+    free(e);
+}
+
+/*
+ * ARC: turns resident entry e into a ghost on list `ghost'
+ */
+static void demote(CData *cd, CEntry *e, ListId ghost) {
+    listUnlink(cd, e);
+    cd->freeV(e->value);
+    e->value = NULL;
+    linkMRU(cd, ghost, e);
+    cd->stats.evictions++;
+}
+
+/*
+ * evicts entries until `cost' more will fit; `inB2' is true if the entry
+ * about to be put() was found on B2, which ARC treats as evidence against
+ * T1
+ */
+static void makeRoom(CData *cd, long cost, bool inB2) {
+    while (residentCost(cd) + cost > cd->capacity) {
+        switch (cd->policy) {
+        case LRU:
+            drop(cd, lruOf(cd, T1));
+            cd->stats.evictions++;
+            break;
+        case CLOCK:
+            while (cd->hand->referenced) {
+                cd->hand->referenced = false;
+                advanceHand(cd);
+            }
+            drop(cd, cd->hand);
+            cd->stats.evictions++;
+            break;
+        case ARC: {
+            CList *t1 = &(cd->lists[T1]);
+
+            if (t1->count > 0L && (t1->cost > cd->target ||
+                                   (inB2 && t1->cost >= cd->target) ||
+                                   cd->lists[T2].count == 0L))
+                demote(cd, lruOf(cd, T1), B1);
+            else
+                demote(cd, lruOf(cd, T2), B2);
+            break;
+          }
+        }
+    }
+}
+
+/*
+ * ARC: forgets ghosts until T1 and B1 together fit in the capacity, and
+ * all four lists together fit in twice the capacity
+ */
+static void trimGhosts(CData *cd) {
+    CEntry *e;
+
+    while (cd->lists[T1].cost + cd->lists[B1].cost > cd->capacity &&
+           (e = lruOf(cd, B1)) != NULL)
+        drop(cd, e);
+    while (residentCost(cd) + cd->lists[B1].cost + cd->lists[B2].cost >
+           2 * cd->capacity) {
+        if ((e = lruOf(cd, B2)) == NULL && (e = lruOf(cd, B1)) == NULL)
+            break;
+        drop(cd, e);
+    }
+}
+
+/*
+ * records a use of resident entry e
+ */
+static void touch(CData *cd, CEntry *e) {
+    switch (cd->policy) {
+    case LRU:
+        listUnlink(cd, e);
+        linkMRU(cd, T1, e);
+        break;
+    case CLOCK:
+        e->referenced = true;
+        break;
+    case ARC:
+        listUnlink(cd, e);
+        linkMRU(cd, T2, e);
+        break;
+    }
+}
+
+/*
+ * frees every entry, ghosts included, and empties the lists
+ */
+static void purge(CData *cd) {
+    long i;
+
+    for (i = 0L; i < cd->nbuckets; i++) {
+        CEntry *p, *q;
+
+        for (p = cd->buckets[i]; p != NULL; p = q) {
+            q = p->chain;
+            cd->freeK(p->key);
+            if (RESIDENT(p))
+                cd->freeV(p->value);
+            free(p);
+        }
+        cd->buckets[i] = NULL;
+    }
+    for (i = 0L; i < NLISTS; i++)
+        listInit(&(cd->lists[i]));
+    cd->nentries = 0L;
+    cd->hand = NULL;
+    cd->target = 0L;
+}
+
+static void c_destroy(const Cache *c) {
+    CData *cd = (CData *)c->self;
+
+    purge(cd);
+    free(cd->buckets);
+    free(cd);
+    free((void *)c);
+}
+
+static void c_clear(const Cache *c) {
+    CData *cd = (CData *)c->self;
+
+    purge(cd);
+}
+
+static bool c_containsKey(const Cache *c, void *key) {
+    CData *cd = (CData *)c->self;
+    CEntry *e = findKey(cd, key);
+
+    return (e != NULL && RESIDENT(e));
+}
+
+static bool c_get(const Cache *c, void *key, void **value) {
+    CData *cd = (CData *)c->self;
+    CEntry *e = findKey(cd, key);
+
+    if (e == NULL || ! RESIDENT(e)) {
+        cd->stats.misses++;
+        return false;
+    }
+    cd->stats.hits++;
+    touch(cd, e);
+    *value = e->value;
+    return true;
+}
+
+/*
+ * ARC: a put() has found the ghost of its key; adapts the target size of
+ * T1 and reclaims the ghost for reuse
+ *
+ * entries may cost 0, so a ghost list may hold entries yet cost nothing;
+ * its cost is taken to be at least 1 when dividing by it
+ */
+static void ghostHit(CData *cd, CEntry *e, long cost) {
+    long b1 = cd->lists[B1].cost, b2 = cd->lists[B2].cost, delta = cost;
+
+    if (e->list == B1) {
+        if (b2 > b1)
+            delta = (long)((double)cost * b2 / ((b1 > 0L) ? b1 : 1L));
+        cd->target += delta;
+        if (cd->target > cd->capacity)
+            cd->target = cd->capacity;
+    } else {
+        if (b1 > b2)
+            delta = (long)((double)cost * b1 / ((b2 > 0L) ? b2 : 1L));
+        cd->target -= delta;
+        if (cd->target < 0L)
+            cd->target = 0L;
+    }
+    listUnlink(cd, e);
+}
+
+static bool c_put(const Cache *c, void *key, void *value) {
+    CData *cd = (CData *)c->self;
+    long cost = (cd->costOf != NULL) ? cd->costOf(key, value) : 1L;
+    CEntry *e;
+    bool inB2 = false;
+
+    if (cost < 0L || cost > cd->capacity)
+        return false;
+    e = findKey(cd, key);
+    if (e != NULL && RESIDENT(e)) {
+        CList *l = &(cd->lists[e->list]);
+
+        cd->freeK(e->key);
+        cd->freeV(e->value);
+        e->key = key;
+        e->value = value;
+        l->cost += cost - e->cost;
+        e->cost = cost;
+        touch(cd, e);
+        makeRoom(cd, 0L, false);
+        if (cd->policy == ARC)
+            trimGhosts(cd);
+        return true;
+    }
+    if (e != NULL) {                    /* an ARC ghost */
+        inB2 = (e->list == B2);
+        ghostHit(cd, e, cost);
+        cd->freeK(e->key);
+        e->key = key;
+    } else {
+        e = (CEntry *)malloc(sizeof(CEntry));
+        if (e == NULL)
+            return false;
+        e->key = key;
+        e->list = T1;                   /* not yet linked */
+        hashInsert(cd, e);
+    }
+    e->value = value;
+    e->cost = cost;
+    e->referenced = false;
+    makeRoom(cd, cost, inB2);
+    if (cd->policy == ARC && e->list != T1) {
+        linkMRU(cd, T2, e);             /* seen before, so used again */
+    } else if (cd->policy == CLOCK && cd->hand != NULL) {
+        linkBefore(cd, T1, cd->hand, e);
+    } else {
+        linkMRU(cd, T1, e);
+        if (cd->policy == CLOCK)
+            cd->hand = e;
+    }
+    if (cd->policy == ARC)
+        trimGhosts(cd);
+    cd->stats.insertions++;
+    return true;
+}
+
+static bool c_remove(const Cache *c, void *key) {
+    CData *cd = (CData *)c->self;
+    CEntry *e = findKey(cd, key);
+
+    if (e == NULL || ! RESIDENT(e))
+        return false;
+    drop(cd, e);
+    return true;
+}
+
+static long c_size(const Cache *c) {
+    CData *cd = (CData *)c->self;
+
+    return cd->lists[T1].count + cd->lists[T2].count;
+}
+
+static bool c_isEmpty(const Cache *c) {
+    return (c_size(c) == 0L);
+}
+
+static long c_cost(const Cache *c) {
+    CData *cd = (CData *)c->self;
+
+    return residentCost(cd);
+}
+
+static long c_capacity(const Cache *c) {
+    CData *cd = (CData *)c->self;
+
+    return cd->capacity;
+}
+
+static void c_stats(const Cache *c, CacheStats *stats) {
+    CData *cd = (CData *)c->self;
+    long lookups = cd->stats.hits + cd->stats.misses;
+
+    *stats = cd->stats;
+    stats->hitRatio = (lookups > 0L) ? (double)cd->stats.hits / lookups : 0.0;
+}
+
+static void c_resetStats(const Cache *c) {
+    CData *cd = (CData *)c->self;
+
+    cd->stats.hits = 0L;
+    cd->stats.misses = 0L;
+    cd->stats.insertions = 0L;
+    cd->stats.evictions = 0L;
+    cd->stats.hitRatio = 0.0;
+}
+
+/*
+ * appends the keys on list `id', most recently used first, starting
+ * with `first'
+ */
+static long appendKeys(CData *cd, ListId id, CEntry *first, void **tmp,
+                       long n) {
+    CEntry *head = &(cd->lists[id].head), *p;
+    long i;
+
+    for (i = 0L, p = first; i < cd->lists[id].count; i++, p = p->next) {
+        if (p == head)
+            p = p->next;
+        tmp[n++] = p->key;
+    }
+    return n;
+}
+
+/*
+ * helper function for generating an array of keys from a cache: most
+ * recently used first for LRU and within each of T2 and T1 for ARC, and
+ * in the order that the hand will visit them for CLOCK
+ *
+ * returns pointer to the array or NULL if malloc failure
+ */
+static void **keys(CData *cd, long *len) {
+    long n = cd->lists[T1].count + cd->lists[T2].count;
+    void **tmp = NULL;
+
+    if (n > 0L) {
+        tmp = (void **)malloc(n * sizeof(void *));
+        if (tmp != NULL) {
+            CEntry *first = (cd->policy == CLOCK) ? cd->hand
+                                                  : cd->lists[T1].head.next;
+
+            n = appendKeys(cd, T2, cd->lists[T2].head.next, tmp, 0L);
+            n = appendKeys(cd, T1, first, tmp, n);
+            *len = n;
+        }
+    }
+    return tmp;
+}
+
+static void **c_keyArray(const Cache *c, long *len) {
+    CData *cd = (CData *)c->self;
+
+    return keys(cd, len);
+}
+
+static const Iterator *c_itCreate(const Cache *c) {
+    CData *cd = (CData *)c->self;
+    const Iterator *it = NULL;
+    long len;
+    void **tmp = keys(cd, &len);
+
+    if (tmp != NULL) {
+        it = Iterator_create(len, tmp);
+        if (it == NULL)
+            free(tmp);
+    }
+    return it;
+}
+
+static const Cache *c_create(const Cache *c);
+
+static Cache template = {
+    NULL, c_create, c_destroy, c_clear, c_containsKey, c_get, c_put,
+    c_remove, c_size, c_isEmpty, c_cost, c_capacity, c_stats, c_resetStats,
+    c_keyArray, c_itCreate
+};
+
+/*
+ * helper function to create a new Cache dispatch table
+ */
+static const Cache *newCache(Policy policy, long capacity,
+                             long (*hash)(void*, long), int (*cmp)(void*, void*),
+                             long (*costOf)(void*, void*),
+                             void (*freeK)(void*), void (*freeV)(void*)) {
+    Cache *c;
+    CData *cd;
+    CEntry **array;
+    long i;
+
+    if (capacity <= 0L)
+        return NULL;
+    c = (Cache *)malloc(sizeof(Cache));
+    cd = (CData *)malloc(sizeof(CData));
+    array = (CEntry **)malloc(DEFAULT_BUCKETS * sizeof(CEntry *));
+    if (c == NULL || cd == NULL || array == NULL) {
+        free(c); free(cd); free(array);
+        return NULL;
+    }
+    cd->policy = policy;
+    cd->hash = hash; cd->cmp = cmp; cd->costOf = costOf;
+    cd->freeK = freeK; cd->freeV = freeV;
+    cd->capacity = capacity;
+    cd->nbuckets = DEFAULT_BUCKETS;
+    cd->nentries = 0L;
+    cd->buckets = array;
+    for (i = 0L; i < DEFAULT_BUCKETS; i++)
+        array[i] = NULL;
+    for (i = 0L; i < NLISTS; i++)
+        listInit(&(cd->lists[i]));
+    cd->hand = NULL;
+    cd->target = 0L;
+    *c = template;
+    c->self = cd;
+    c_resetStats(c);
+    return c;
+}
+
+static const Cache *c_create(const Cache *c) {
+    CData *cd = (CData *)c->self;
+
+    return newCache(cd->policy, cd->capacity, cd->hash, cd->cmp, cd->costOf,
+                    cd->freeK, cd->freeV);
+}
+
+const Cache *LRUCache(long capacity,
+                      long (*hash)(void*, long N), int (*cmp)(void*, void*),
+                      long (*cost)(void *k, void *v),
+                      void (*freeK)(void *k), void (*freeV)(void *v)) {
+    return newCache(LRU, capacity, hash, cmp, cost, freeK, freeV);
+}
+
+const Cache *ClockCache(long capacity,
+                        long (*hash)(void*, long N), int (*cmp)(void*, void*),
+                        long (*cost)(void *k, void *v),
+                        void (*freeK)(void *k), void (*freeV)(void *v)) {
+    return newCache(CLOCK, capacity, hash, cmp, cost, freeK, freeV);
+}
+
+const Cache *ARCCache(long capacity,
+                      long (*hash)(void*, long N), int (*cmp)(void*, void*),
+                      long (*cost)(void *k, void *v),
+                      void (*freeK)(void *k), void (*freeV)(void *v)) {
+    return newCache(ARC, capacity, hash, cmp, cost, freeK, freeV);
+}
@@ -0,0 +1,92 @@
+#ifndef _HASHCACHE_H_
+#define _HASHCACHE_H_
+
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ADTs/ADTdefs.h"
+#include "ADTs/cache.h"
+
+/* constructors for hash-indexed caches
+ *
+ * each returns a pointer to the cache, or NULL if there are malloc errors
+ * or if capacity is <= 0L
+ *
+ * every cache keeps its entries in a hash table, for lookup, and on
+ * intrusive doubly-linked lists, for the eviction policy, so that get(),
+ * put(), remove() and each eviction take O(1) expected time
+ *
+ * capacity is the maximum total cost of the entries in the cache
+ *
+ * the hash function pointer is applied to a key to yield a bucket index
+ *
+ * the cmp function pointer is applied to a pair of keys, yielding <0 | 0 | >0
+ *
+ * the cost function pointer is applied to (key, value) by put() to yield
+ * the cost of the entry, typically its size in bytes; if it is NULL, each
+ * entry costs 1
+ *
+ * freeK is a function pointer that will be called by destroy(), clear(),
+ * put(), remove() and eviction on keys of relevant entry/entries in the cache
+ *
+ * freeV is a function pointer that will be called by destroy(), clear(),
+ * put(), remove() and eviction on values of relevant entry/entries in the
+ * cache
+ */
+
+/* evicts the least recently used entry */
+const Cache *LRUCache(long capacity,
+                      long (*hash)(void*, long N), int (*cmp)(void*, void*),
+                      long (*cost)(void *k, void *v),
+                      void (*freeK)(void *k), void (*freeV)(void *v));
+
+/* approximates LRU with a reference bit per entry, set by get(); the
+ * clock hand evicts the first entry it finds whose bit is clear, clearing
+ * the bits it passes, so a hit never reorders a list */
+const Cache *ClockCache(long capacity,
+                        long (*hash)(void*, long N), int (*cmp)(void*, void*),
+                        long (*cost)(void *k, void *v),
+                        void (*freeK)(void *k), void (*freeV)(void *v));
+
+/* adaptive replacement cache (Megiddo and Modha): entries used once and
+ * entries used more than once are kept on separate LRU lists, and the
+ * keys of recently evicted entries are remembered, without their values,
+ * to adapt the split of the capacity between the two lists; a scan of
+ * keys that are used once cannot flush the frequently used entries
+ *
+ * the remembered keys are only released, with freeK, when they age out,
+ * when they are put() again, or by clear() and destroy() */
+const Cache *ARCCache(long capacity,
+                      long (*hash)(void*, long N), int (*cmp)(void*, void*),
+                      long (*cost)(void *k, void *v),
+                      void (*freeK)(void *k), void (*freeV)(void *v));
+
+#endif /* _HASHCACHE_H_ */
@@ -42,11 +42,24 @@
 #define DEFAULT_LOAD_FACTOR 0.75
 #define TRIGGER 100	/* number of changes that will trigger a load check */
 
+typedef struct slab Slab;
+
 typedef struct node {
     struct node *next;
     MEntry entry;
+    Slab *slab;                 /* NULL if node and key malloc()ed singly */
 } Node;
 
+/*
+ * nodes relocated by HashCSKMap_compact() are carved from a slab, followed
+ * by their keys; the slab is returned to the heap when the last of them
+ * is freed
+ */
+struct slab {
+    long live;
+    Node nodes[];
+};
+
 typedef struct m_data {
     long size;
     long capacity;
@@ -56,6 +69,7 @@ typedef struct m_data {
     double increment;
     Node **buckets;
     void (*freeValue)(void *v);
+    long cursor;                /* next bucket for compact() */
 } MData;
 
 /*
@@ -71,6 +85,14 @@ static long hash(char *key, long N) {
     return (long)(ans % N);
 }
 
+static void freeNode(Node *p) {
+    if (p->slab == NULL) {
+        free((p->entry).key);
+        free(p);
+    } else if (--p->slab->live == 0L)
+        free(p->slab);
+}
+
 /*
  * traverses the map, calling freeValue on each entry
  * then frees storage associated with the MEntry structure
@@ -82,10 +104,9 @@ static void purge(MData *md) {
         Node *p, *q;
         p = md->buckets[i];
         while (p != NULL) {
-            free((p->entry).key);
             md->freeValue((p->entry).value);
             q = p->next;
-            free(p);
+            freeNode(p);
             p = q;
         }
         md->buckets[i] = NULL;
@@ -179,6 +200,7 @@ static void resize(MData *md) {
     free(md->buckets);
     md->buckets = array;
     md->capacity = N;
+    md->cursor = 0L;
     md->load /= 2.0;
     md->changes = 0;
     md->increment = 1.0 / (double)N;
@@ -196,6 +218,7 @@ static bool insertEntry(MData *md, char *key, void *value, long i) {
         if (k != NULL) {
             (p->entry).key = k;
             (p->entry).value = value;
+            p->slab = NULL;
             p->next = md->buckets[i];
             md->buckets[i] = p;
             md->size++;
@@ -267,9 +290,8 @@ static bool m_remove(const CSKMap *m, char *key) {
         md->size--;
         md->load -= md->increment;
         md->changes++;
-        free((entry->entry).key);
         md->freeValue((entry->entry).value);
-        free(entry);
+        freeNode(entry);
         status = true;
     }
     return status;
@@ -401,6 +423,7 @@ static const CSKMap *newCSKMap(long capacity, double loadFactor,
                 md->increment = 1.0 / (double)N;
                 md->freeValue = freeValue;
                 md->buckets = array;
+                md->cursor = 0L;
                 for (i = 0; i < N; i++)
                     array[i] = NULL;
                 *m = template;
@@ -418,6 +441,80 @@ static const CSKMap *newCSKMap(long capacity, double loadFactor,
     return m;
 }
 
+bool HashCSKMap_get(const CSKMap *m, char *key, void **value) {
+    return m_get(m, key, value);
+}
+
+bool HashCSKMap_containsKey(const CSKMap *m, char *key) {
+    return m_containsKey(m, key);
+}
+
+bool HashCSKMap_put(const CSKMap *m, char *key, void *value) {
+    return m_put(m, key, value);
+}
+
+bool HashCSKMap_putUnique(const CSKMap *m, char *key, void *value) {
+    return m_putUnique(m, key, value);
+}
+
+bool HashCSKMap_remove(const CSKMap *m, char *key) {
+    return m_remove(m, key);
+}
+
+long HashCSKMap_size(const CSKMap *m) {
+    return ((MData *)m->self)->size;
+}
+
+bool HashCSKMap_isEmpty(const CSKMap *m) {
+    return (((MData *)m->self)->size == 0L);
+}
+
+long HashCSKMap_compact(const CSKMap *m, long max) {
+    MData *md = (MData *)m->self;
+    long i, end, n = 0L;
+    size_t bytes = 0;
+    Node *p, *q, *next, **tail;
+    char *k;
+    Slab *s;
+
+    if (m->put != m_put)
+        return -1L;
+    if (md->cursor >= md->capacity)	/* start a new pass */
+        md->cursor = 0L;
+    for (end = md->cursor; end < md->capacity && (max <= 0L || n < max); end++)
+        for (p = md->buckets[end]; p != NULL; p = p->next) {
+            bytes += strlen((p->entry).key) + 1;
+            n++;
+        }
+    if (n > 0L) {
+        s = (Slab *)malloc(sizeof(Slab) + n * sizeof(Node) + bytes);
+        if (s == NULL)
+            return -1L;
+        s->live = n;
+        q = s->nodes;
+        k = (char *)(s->nodes + n);
+        for (i = md->cursor; i < end; i++) {
+            tail = &md->buckets[i];
+            for (p = md->buckets[i]; p != NULL; p = next) {
+                size_t len = strlen((p->entry).key) + 1;
+                next = p->next;
+                memcpy(k, (p->entry).key, len);
+                (q->entry).key = k;
+                (q->entry).value = (p->entry).value;
+                q->slab = s;
+                *tail = q;
+                tail = &q->next;
+                q++;
+                k += len;
+                freeNode(p);
+            }
+            *tail = NULL;
+        }
+    }
+    md->cursor = end;
+    return md->capacity - end;
+}
+
 static const CSKMap *m_create(const CSKMap *m) {
     MData *md = (MData *)m->self;
 
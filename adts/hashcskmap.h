@@ -48,4 +48,39 @@
 const CSKMap *HashCSKMap(long capacity, double loadFactor,
                          void (*freeValue)(void *v));
 
+/* direct-call API
+ *
+ * the functions below behave exactly like the dispatch table methods of
+ * the same names, but may only be applied to a map created by HashCSKMap()
+ * or CSKMap_create(); they call the implementation directly, so that a
+ * call site that knows the concrete type pays no indirect call; they are
+ * not inline, as the hash function is private to the implementation
+ *
+ * generic code should continue to use the dispatch table
+ */
+
+bool HashCSKMap_get(const CSKMap *m, char *key, void **value);
+bool HashCSKMap_containsKey(const CSKMap *m, char *key);
+bool HashCSKMap_put(const CSKMap *m, char *key, void *value);
+bool HashCSKMap_putUnique(const CSKMap *m, char *key, void *value);
+bool HashCSKMap_remove(const CSKMap *m, char *key);
+long HashCSKMap_size(const CSKMap *m);
+bool HashCSKMap_isEmpty(const CSKMap *m);
+
+/* relocates the nodes of the next buckets of the map, in bucket order,
+ * into one contiguous block, together with their keys, freeing the storage
+ * they occupied; buckets are taken until at least `max' entries have been
+ * relocated, or all of them if max is <= 0L, so that repeated calls make
+ * passes over the whole map, a bounded step at a time; after many put()s
+ * and remove()s, this restores the locality of a freshly built map
+ *
+ * the keys and MEntry pointers returned by keyArray(), entryArray() and
+ * iterators are no longer valid for the buckets relocated
+ *
+ * returns the number of buckets left in the current pass, 0L if it is
+ * complete (the next call starts a new pass), or -1L if malloc failure or
+ * if `m' was not created by HashCSKMap()
+ */
+long HashCSKMap_compact(const CSKMap *m, long max);
+
 #endif /* _HASHCSKMAP_H_ */
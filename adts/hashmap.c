@@ -41,59 +41,211 @@
 #define DEFAULT_LOAD_FACTOR 0.75
 #define TRIGGER 100	/* number of changes that will trigger a load check */
 
-typedef struct node {
-    struct node *next;
-    MEntry entry;
-} Node;
-
-typedef struct m_data {
-    long (*hash)(void *, long N);
-    int (*cmp)(void *, void *);
-    long size;
-    long capacity;
-    long changes;
-    double load;
-    double loadFactor;
-    double increment;
-    Node **buckets;
-    void (*freeK)(void *k);
-    void (*freeV)(void *v);
-} MData;
+typedef struct hashmap_node Node;         /* declared in hashmap.h */
+typedef struct hashmap_data MData;
+
+typedef struct hashmap_saved Saved;      /* declared in hashmap.h */
+typedef struct hashmap_slab Slab;        /* declared in hashmap.h */
+
+/*
+ * nodes relocated by HashMap_compact() are carved from a slab, which is
+ * returned to the heap when the last of them is freed
+ */
+struct hashmap_slab {
+    long live;
+    Node nodes[];
+};
+
+static void freeNode(Node *p) {
+    if (p->slab == NULL)
+        free(p);
+    else if (--p->slab->live == 0L)
+        free(p->slab);
+}
+
+/*
+ * copy-on-write support for iterators
+ *
+ * each iterator has a generation, md->gen being that of the newest; the
+ * first time that bucket i is changed after an iterator has been created,
+ * its chain is saved for the iterators created since it was last saved,
+ * i.e. those whose generations are in (after, upto], and the bucket is
+ * given copies of the nodes; an iterator visiting bucket i uses the
+ * version saved for its generation, if any, and the bucket itself if not
+ *
+ * saved versions, and entries that were replaced or removed while
+ * iterators existed, are returned to the heap by the destroy() of the
+ * last iterator
+ */
+struct hashmap_saved {
+    struct hashmap_saved *older;        /* same bucket, saved earlier */
+    struct hashmap_saved *link;         /* next in md->saved */
+    long bucket;
+    long after;
+    long upto;
+    bool owns;                          /* true if it must free entries */
+    Node *chain;
+};
+
+static void freeChain(MData *md, Node *p, bool entries) {
+    Node *q;
+
+    for (; p != NULL; p = q) {
+        q = p->next;
+        if (entries) {
+            md->freeK((p->entry).key);
+            md->freeV((p->entry).value);
+        }
+        freeNode(p);
+    }
+}
+
+/*
+ * returns the chain of bucket i as it was when the iterator of generation
+ * `gen' was created
+ */
+static Node *chainFor(MData *md, long i, long gen) {
+    Saved *s;
+
+    for (s = md->shadow[i]; s != NULL; s = s->older)
+        if (s->after < gen && gen <= s->upto)
+            return s->chain;
+    return md->buckets[i];
+}
+
+/*
+ * saves the chain of bucket i for the iterators that have not yet saved
+ * it, unless there are none; if `copy', the bucket is given copies of the
+ * nodes, otherwise it is emptied and the saved version owns the entries
+ *
+ * returns false if malloc failure, in which case nothing has changed
+ */
+static bool save(MData *md, long i, bool copy) {
+    long after;
+    Saved *s;
+    Node *p, *head = NULL, **tail = &head;
+
+    if (md->pins == 0L)
+        return true;
+    after = (md->shadow[i] != NULL) ? md->shadow[i]->upto : 0L;
+    if (after == md->gen)
+        return true;
+    if ((s = (Saved *)malloc(sizeof(Saved))) == NULL)
+        return false;
+    for (p = (copy ? md->buckets[i] : NULL); p != NULL; p = p->next) {
+        Node *q = (Node *)malloc(sizeof(Node));
+        if (q == NULL) {
+            *tail = NULL;
+            freeChain(md, head, false);
+            free(s);
+            return false;
+        }
+        q->entry = p->entry;
+        q->slab = NULL;
+        *tail = q;
+        tail = &q->next;
+    }
+    *tail = NULL;
+    s->bucket = i; s->after = after; s->upto = md->gen;
+    s->owns = ! copy;
+    s->chain = md->buckets[i];
+    s->older = md->shadow[i];
+    md->shadow[i] = s;
+    s->link = md->saved;
+    md->saved = s;
+    md->buckets[i] = head;
+    return true;
+}
+
+/*
+ * applies freeK and freeV to the entry in p and frees p, unless there are
+ * iterators, in which case p is kept until the last one is destroyed
+ */
+static void dispose(MData *md, Node *p) {
+    if (md->pins > 0L) {
+        p->next = md->graves;
+        md->graves = p;
+    } else {
+        p->next = NULL;
+        freeChain(md, p, true);
+    }
+}
+
+/*
+ * returns the saved versions and disposed entries to the heap; called
+ * when the last iterator is destroyed
+ */
+static void reclaim(MData *md) {
+    Saved *s;
+
+    while ((s = md->saved) != NULL) {
+        md->saved = s->link;
+        md->shadow[s->bucket] = NULL;
+        freeChain(md, s->chain, s->owns);
+        free(s);
+    }
+    freeChain(md, md->graves, true);
+    md->graves = NULL;
+}
 
 /*
  * traverses the map, calling freeK and freeV on each entry
  * then frees storage associated with the MEntry structure
+ *
+ * while there are iterators, a bucket whose chain cannot be saved for them
+ * because of malloc failure is left as it is
+ *
+ * returns the number of entries left
  */
-static void purge(MData *md) {
-    long i;
+static long purge(MData *md) {
+    long i, left = 0L;
+    Node *p;
 
     for (i = 0L; i < md->capacity; i++) {
-        Node *p, *q;
-        p = md->buckets[i];
-        while (p != NULL) {
-            md->freeK((p->entry).key);
-            md->freeV((p->entry).value);
-            q = p->next;
-            free(p);
-            p = q;
+        if (md->pins > 0L) {
+            if (! save(md, i, false)) {
+                for (p = md->buckets[i]; p != NULL; p = p->next)
+                    left++;
+                continue;
+            }
+            while ((p = md->buckets[i]) != NULL) {
+                md->buckets[i] = p->next;
+                dispose(md, p);
+            }
+        } else {
+            freeChain(md, md->buckets[i], true);
+            md->buckets[i] = NULL;
         }
-        md->buckets[i] = NULL;
     }
+    return left;
 }
 
-static void m_destroy(const Map *m) {
-    MData *md = (MData *)m->self;
+/*
+ * returns the entries and the private data to the heap; called by
+ * destroy(), or, if there were iterators, by the last one's destroy()
+ */
+static void teardown(MData *md) {
     purge(md);
+    free(md->shadow);
     free(md->buckets);
     free(md);
+}
+
+static void m_destroy(const Map *m) {
+    MData *md = (MData *)m->self;
+
+    if (md->pins > 0L)
+        md->orphaned = true;	/* the iterators still use md */
+    else
+        teardown(md);
     free((void *)m);
 }
 
 static void m_clear(const Map *m) {
     MData *md = (MData *)m->self;
-    purge(md);
-    md->size = 0;
-    md->load = 0.0;
+
+    md->size = purge(md);
+    md->load = md->size * md->increment;
     md->changes = 0;
 }
 
@@ -164,8 +316,11 @@ static void resize(MData *md) {
         }
     }
     free(md->buckets);
+    free(md->shadow);			/* no iterators, so all NULL */
+    md->shadow = NULL;
     md->buckets = array;
     md->capacity = N;
+    md->cursor = 0L;
     md->load /= 2.0;
     md->changes = 0;
     md->increment = 1.0 / (double)N;
@@ -181,6 +336,7 @@ static bool insertEntry(MData *md, void *key, void *value, long i) {
     if (status) {
         (p->entry).key = key;
         (p->entry).value = value;
+        p->slab = NULL;
         p->next = md->buckets[i];
         md->buckets[i] = p;
         md->size++;
@@ -198,13 +354,29 @@ static bool m_put(const Map *m, void *key, void *value) {
 
     if (md->changes > TRIGGER) {
         md->changes = 0;
-        if (md->load > md->loadFactor)
+        if (md->load > md->loadFactor && md->pins == 0L)
             resize(md);
     }
     p = findKey(md, key, &i);
-    if (p != NULL) {
+    if (md->pins > 0L) {
+        Node *g = NULL;
+        if (p != NULL && (g = (Node *)malloc(sizeof(Node))) == NULL)
+            return false;
+        if (! save(md, i, true)) {
+            free(g);
+            return false;
+        }
+        if (g != NULL) {		/* old entry, for dispose() */
+            p = findKey(md, key, &i);
+            g->entry = p->entry;
+            g->slab = NULL;
+            dispose(md, g);
+        }
+    } else if (p != NULL) {
         md->freeK((p->entry).key);
         md->freeV((p->entry).value);
+    }
+    if (p != NULL) {
         (p->entry).key = key;
         (p->entry).value = value;
         status = true;
@@ -222,11 +394,11 @@ static bool m_putUnique(const Map *m, void *key, void *value) {
 
     if (md->changes > TRIGGER) {
         md->changes = 0;
-        if (md->load > md->loadFactor)
+        if (md->load > md->loadFactor && md->pins == 0L)
             resize(md);
     }
     p = findKey(md, key, &i);
-    if (p == NULL) {
+    if (p == NULL && save(md, i, true)) {
         status = insertEntry(md, key, value, i);
     }
     return status;
@@ -238,6 +410,11 @@ static bool m_remove(const Map *m, void *key) {
     Node *entry = findKey(md, key, &i);
     int status = (entry != NULL);
 
+    if (status && md->pins > 0L) {
+        if (! save(md, i, true))
+            return false;
+        entry = findKey(md, key, &i);
+    }
     if (status) {
         Node *p, *c;
         /* determine where the entry lives in the singly linked list */
@@ -250,9 +427,7 @@ static bool m_remove(const Map *m, void *key) {
         md->size--;
         md->load -= md->increment;
         md->changes++;
-        md->freeK((entry->entry).key);
-        md->freeV((entry->entry).value);
-        free(entry);
+        dispose(md, entry);
     }
     return status;
 }
@@ -333,16 +508,95 @@ static MEntry **m_entryArray(const Map *m, long *len) {
     return tmp;
 }
 
+/*
+ * iterator over the version of the map pinned by itCreate(); the buckets
+ * are visited lazily, each through chainFor()
+ */
+typedef struct it_data {
+    MData *md;
+    long gen;
+    long bucket;			/* bucket of `next' */
+    Node *next;				/* NULL if not yet found */
+} ItData;
+
+static Node *advance(ItData *itd) {
+    while (itd->next == NULL && itd->bucket < itd->md->capacity - 1) {
+        itd->bucket++;
+        itd->next = chainFor(itd->md, itd->bucket, itd->gen);
+    }
+    return itd->next;
+}
+
+static bool it_hasNext(const Iterator *it) {
+    ItData *itd = (ItData *)(it->self);
+    return (advance(itd) != NULL);
+}
+
+static bool it_next(const Iterator *it, void **element) {
+    ItData *itd = (ItData *)(it->self);
+    Node *p = advance(itd);
+
+    if (p == NULL)
+        return false;
+    *element = &(p->entry);
+    itd->next = p->next;
+    return true;
+}
+
+static long it_nextBatch(const Iterator *it, void **buf, long n) {
+    ItData *itd = (ItData *)(it->self);
+    long i;
+    Node *p;
+
+    for (i = 0L; i < n && (p = advance(itd)) != NULL; i++) {
+        buf[i] = &(p->entry);
+        itd->next = p->next;
+    }
+    return i;
+}
+
+static void it_destroy(const Iterator *it) {
+    ItData *itd = (ItData *)(it->self);
+    MData *md = itd->md;
+
+    if (--md->pins == 0L) {
+        reclaim(md);
+        if (md->orphaned)
+            teardown(md);
+    }
+    free(itd);
+    free((void *)it);
+}
+
+static Iterator itTemplate = {
+    NULL, it_hasNext, it_next, it_nextBatch, it_destroy
+};
+
 static const Iterator *m_itCreate(const Map *m) {
     MData *md = (MData *)m->self;
-    const Iterator *it = NULL;
-    void **tmp = (void **)entries(md);
-
-    if (tmp != NULL) {
-        it = Iterator_create(md->size, tmp);
-        if (it == NULL)
-            free(tmp);
+    Iterator *it;
+    ItData *itd;
+
+    if (md->size == 0L)
+        return NULL;
+    if (md->shadow == NULL) {
+        md->shadow = (Saved **)calloc(md->capacity, sizeof(Saved *));
+        if (md->shadow == NULL)
+            return NULL;
+    }
+    if ((it = (Iterator *)malloc(sizeof(Iterator))) == NULL)
+        return NULL;
+    if ((itd = (ItData *)malloc(sizeof(ItData))) == NULL) {
+        free(it);
+        return NULL;
     }
+    itd->md = md;
+    itd->gen = ++md->gen;
+    itd->bucket = -1L;
+    itd->next = NULL;
+    md->pins++;
+    *it = itTemplate;
+    it->self = itd;
     return it;
 }
 
@@ -382,6 +636,9 @@ static const Map *newMap(long capacity, double loadFactor,
                 md->freeK = freeK;
                 md->freeV = freeV;
                 md->buckets = array;
+                md->pins = 0L; md->gen = 0L;
+                md->shadow = NULL; md->saved = NULL; md->graves = NULL;
+                md->cursor = 0L; md->orphaned = false;
                 for (i = 0; i < N; i++)
                     array[i] = NULL;
                 *m = template;
@@ -396,6 +653,54 @@ static const Map *newMap(long capacity, double loadFactor,
     return m;
 }
 
+bool HashMap_put(const Map *m, void *key, void *value) {
+    return m_put(m, key, value);
+}
+
+bool HashMap_putUnique(const Map *m, void *key, void *value) {
+    return m_putUnique(m, key, value);
+}
+
+bool HashMap_remove(const Map *m, void *key) {
+    return m_remove(m, key);
+}
+
+long HashMap_compact(const Map *m, long max) {
+    MData *md = (MData *)m->self;
+    long i, end, n = 0L;
+    Node *p, *q, *next, **tail;
+    Slab *s;
+
+    if (m->put != m_put || md->pins > 0L)
+        return -1L;
+    if (md->cursor >= md->capacity)	/* start a new pass */
+        md->cursor = 0L;
+    for (end = md->cursor; end < md->capacity && (max <= 0L || n < max); end++)
+        for (p = md->buckets[end]; p != NULL; p = p->next)
+            n++;
+    if (n > 0L) {
+        if ((s = (Slab *)malloc(sizeof(Slab) + n * sizeof(Node))) == NULL)
+            return -1L;
+        s->live = n;
+        q = s->nodes;
+        for (i = md->cursor; i < end; i++) {
+            tail = &md->buckets[i];
+            for (p = md->buckets[i]; p != NULL; p = next) {
+                next = p->next;
+                q->entry = p->entry;
+                q->slab = s;
+                *tail = q;
+                tail = &q->next;
+                q++;
+                freeNode(p);
+            }
+            *tail = NULL;
+        }
+    }
+    md->cursor = end;
+    return md->capacity - end;
+}
+
 static const Map *m_create(const Map *m) {
     MData *md = (MData *)m->self;
 
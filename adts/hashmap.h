@@ -34,6 +34,7 @@
 
 #include "ADTs/ADTdefs.h"
 #include "ADTs/map.h"
+#include <stddef.h>                     /* needed for NULL */
 
 /* constructor for generic hashmap */
 
@@ -50,9 +51,111 @@
  *
  * freeV is a function pointer that will be called by destroy(),
  * clear(), put(), and remove() on values of relevant entry/entries in the Map
+ *
+ * itCreate() takes a snapshot in O(1): the iterator pins the current
+ * version of the buckets, and a later put() or remove() copies only the
+ * bucket that it changes before changing it; while any iterator exists the
+ * table is not resized, and freeK/freeV on replaced or removed entries are
+ * deferred until the last iterator is destroyed
  */
 const Map *HashMap(long capacity, double loadFactor,
                    long (*hash)(void*, long N), int (*cmp)(void*, void*),
                    void (*freeK)(void *k), void (*freeV)(void *v));
 
+/* direct-call API
+ *
+ * the functions below behave exactly like the dispatch table methods of
+ * the same names, but may only be applied to a map created by HashMap();
+ * they call the implementation directly, and the lookups are defined
+ * inline, so that a call site that knows the concrete type pays no
+ * indirect call other than those to hash() and cmp()
+ *
+ * generic code should continue to use the dispatch table
+ */
+
+bool HashMap_put(const Map *m, void *key, void *value);
+bool HashMap_putUnique(const Map *m, void *key, void *value);
+bool HashMap_remove(const Map *m, void *key);
+
+/* relocates the nodes of the next buckets of the map, in bucket order,
+ * into one contiguous block, freeing the nodes they occupied; buckets are
+ * taken until at least `max' nodes have been relocated, or all of them if
+ * max is <= 0L, so that repeated calls make passes over the whole map, a
+ * bounded step at a time; after many put()s and remove()s, this restores
+ * the locality of a freshly built map
+ *
+ * the MEntry pointers returned by entryArray() are no longer valid for
+ * the buckets relocated
+ *
+ * returns the number of buckets left in the current pass, 0L if it is
+ * complete (the next call starts a new pass), or -1L if malloc failure, if
+ * there are iterators, or if `m' was not created by HashMap()
+ */
+long HashMap_compact(const Map *m, long max);
+
+/* the private data of a hashmap; declared here only for the inline
+ * functions below, and not to be used directly
+ */
+struct hashmap_slab;                    /* defined in hashmap.c */
+
+struct hashmap_node {
+    struct hashmap_node *next;
+    MEntry entry;
+    struct hashmap_slab *slab;          /* NULL if malloc()ed singly */
+};
+
+struct hashmap_saved;                   /* defined in hashmap.c */
+
+struct hashmap_data {
+    long (*hash)(void *, long N);
+    int (*cmp)(void *, void *);
+    long size;
+    long capacity;
+    long changes;
+    double load;
+    double loadFactor;
+    double increment;
+    struct hashmap_node **buckets;
+    void (*freeK)(void *k);
+    void (*freeV)(void *v);
+    long pins;                          /* iterators in existence */
+    long gen;                           /* generation of newest iterator */
+    struct hashmap_saved **shadow;      /* per bucket, versions saved */
+    struct hashmap_saved *saved;        /* every version saved */
+    struct hashmap_node *graves;        /* entries whose free is deferred */
+    long cursor;                        /* next bucket for compact() */
+    bool orphaned;                      /* destroy() while pinned */
+};
+
+/* returns the node holding `key', or NULL */
+static inline struct hashmap_node *hashmapFind(const Map *m, void *key) {
+    struct hashmap_data *md = (struct hashmap_data *)m->self;
+    struct hashmap_node *p = md->buckets[md->hash(key, md->capacity)];
+
+    while (p != NULL && md->cmp((p->entry).key, key) != 0)
+        p = p->next;
+    return p;
+}
+
+static inline bool HashMap_get(const Map *m, void *key, void **value) {
+    struct hashmap_node *p = hashmapFind(m, key);
+
+    if (p == NULL)
+        return false;
+    *value = (p->entry).value;
+    return true;
+}
+
+static inline bool HashMap_containsKey(const Map *m, void *key) {
+    return (hashmapFind(m, key) != NULL);
+}
+
+static inline long HashMap_size(const Map *m) {
+    return ((struct hashmap_data *)m->self)->size;
+}
+
+static inline bool HashMap_isEmpty(const Map *m) {
+    return (((struct hashmap_data *)m->self)->size == 0L);
+}
+
 #endif /* _HASHMAP_H_ */
@@ -53,6 +53,7 @@ typedef struct pq_data {
     PQEntry *heap;
     void (*freePrio)(void *p);
     void (*freeValue)(void *v);
+    long *(*slot)(void *v);     /* NULL unless entries are tracked */
 } PqData;
 
 /*
@@ -68,6 +69,17 @@ static int realCmp(PqData *pqd, PQEntry *p1, PQEntry *p2) {
     return ans;
 }
 
+/*
+ * helper function to store an entry at heap[i]
+ *
+ * if entries are tracked, the entry's position is recorded in its value
+ */
+static void place(PqData *pqd, long i, PQEntry *e) {
+    pqd->heap[i] = *e;
+    if (pqd->slot != NULL)
+        *(pqd->slot(e->value)) = i;
+}
+
 /*
  * traverses the heap, calling freeP on each priority and freeV on each entry
  */
@@ -95,23 +107,27 @@ static void pq_clear(const PrioQueue *pq) {
 }
 
 /*
- *  the siftup function restores the heap property after adding a new entry
- *  preconditions: last > 0 && heap(1,last-1)
+ *  the siftup function restores the heap property after the entry at i
+ *  has been added or has had its priority decreased
+ *  preconditions: 1 <= i <= last && heap(1,last) except at i
  *  postcondition: heap(1,last)
  */
-static void siftup(PqData *pqd) {
-    long p, i = pqd->last;
+static void siftupFrom(PqData *pqd, long i) {
+    PQEntry hn = pqd->heap[i];
+    long p;
 
     while (i > 1) {
-        PQEntry hn;
         p = i / 2;
-        if (realCmp(pqd, &(pqd->heap[p]), &(pqd->heap[i])) <= 0)
+        if (realCmp(pqd, &(pqd->heap[p]), &hn) <= 0)
             break;
-        hn = pqd->heap[p];
-        pqd->heap[p] = pqd->heap[i];
-        pqd->heap[i] = hn;
+        place(pqd, i, &(pqd->heap[p]));
         i = p;
     }
+    place(pqd, i, &hn);
+}
+
+static void siftup(PqData *pqd) {
+    siftupFrom(pqd, pqd->last);
 }
 
 static bool pq_insert(const PrioQueue *pq, void *priority, void *value) {
@@ -130,9 +146,11 @@ static bool pq_insert(const PrioQueue *pq, void *priority, void *value) {
         }
     }
     if (status) {
-        pqd->heap[i].priority = priority;
-        pqd->heap[i].value = value;
-        pqd->heap[i].sequenceNo = pqd->sequenceNo++;
+        PQEntry e;
+        e.priority = priority;
+        e.value = value;
+        e.sequenceNo = pqd->sequenceNo++;
+        pqd->heap[i] = e;
         pqd->last = i;
         siftup(pqd);
     }
@@ -151,30 +169,36 @@ static bool pq_min(const PrioQueue *pq, void **priority, void **value) {
 }
 
 /*
- *  the siftdown function restores the heap property after removing
- *  the top element, and replacing it by the previous last element
- *  preconditions: heap(2,last) && last >= 0
- *  postcondition: heap(1,last-1)
+ *  the siftdown function restores the heap property after the entry at i
+ *  has been replaced (e.g. the top element by the previous last element)
+ *  or has had its priority increased
+ *  preconditions: 1 <= i && heap(1,last) except at i
+ *  postcondition: heap(1,last)
  */
-static void siftdown(PqData *pqd) {
-    long c, i;
+static void siftdownFrom(PqData *pqd, long i) {
+    PQEntry hn;
+    long c;
 
-    i = 1;
+    if (i > pqd->last)
+        return;
+    hn = pqd->heap[i];
     for(;;) {
-        PQEntry hn;
         c = 2 * i;
         if (c > pqd->last)
             break;
         if ((c+1) <= pqd->last &&
             realCmp(pqd, &(pqd->heap[c+1]), &(pqd->heap[c])) < 0)
             c++;
-        if (realCmp(pqd, &(pqd->heap[i]), &(pqd->heap[c])) <= 0)
+        if (realCmp(pqd, &hn, &(pqd->heap[c])) <= 0)
             break;
-        hn = pqd->heap[i];
-        pqd->heap[i] = pqd->heap[c];
-        pqd->heap[c] = hn;
+        place(pqd, i, &(pqd->heap[c]));
         i = c;
     }
+    place(pqd, i, &hn);
+}
+
+static void siftdown(PqData *pqd) {
+    siftdownFrom(pqd, 1L);
 }
 
 static bool pq_removeMin(const PrioQueue *pq, void **priority, void **value) {
@@ -184,6 +208,8 @@ static bool pq_removeMin(const PrioQueue *pq, void **priority, void **value) {
     if (status) {
         *priority = (pqd->heap[1].priority);
         *value = (pqd->heap[1].value);
+        if (pqd->slot != NULL)
+            *(pqd->slot(pqd->heap[1].value)) = 0L;
         pqd->heap[1] = pqd->heap[pqd->last];
         pqd->last--;
         siftdown(pqd);
@@ -191,6 +217,182 @@ static bool pq_removeMin(const PrioQueue *pq, void **priority, void **value) {
     return status;
 }
 
+/*
+ * helper function to locate value in the heap
+ *
+ * tracked entries are found through their slot; otherwise the heap is
+ * searched linearly
+ *
+ * returns the index of the entry, or 0 if value is not in the heap
+ */
+static long findValue(PqData *pqd, void *value) {
+    long i;
+
+    if (pqd->slot != NULL) {
+        i = *(pqd->slot(value));
+        if (i >= 1 && i <= pqd->last && pqd->heap[i].value == value)
+            return i;
+        return 0L;
+    }
+    for (i = 1; i <= pqd->last; i++)
+        if (pqd->heap[i].value == value)
+            return i;
+    return 0L;
+}
+
+static bool pq_changePriority(const PrioQueue *pq, void *value,
+                              void *priority) {
+    PqData *pqd = (PqData *)pq->self;
+    long i = findValue(pqd, value);
+    bool status = (i != 0L);
+
+    if (status) {
+        PQEntry *e = &(pqd->heap[i]);
+        pqd->freePrio(e->priority);
+        e->priority = priority;
+        e->sequenceNo = pqd->sequenceNo++;
+        if (i > 1 && realCmp(pqd, e, &(pqd->heap[i / 2])) < 0)
+            siftupFrom(pqd, i);
+        else
+            siftdownFrom(pqd, i);
+    }
+    return status;
+}
+
+/*
+ * helper function to locate the maximum entry; it must be a leaf, so only
+ * the second half of the heap is searched
+ */
+static long maxIndex(PqData *pqd) {
+    long i, m = pqd->last / 2 + 1;
+
+    for (i = m + 1; i <= pqd->last; i++)
+        if (realCmp(pqd, &(pqd->heap[i]), &(pqd->heap[m])) > 0)
+            m = i;
+    return m;
+}
+
+static bool pq_max(const PrioQueue *pq, void **priority, void **value) {
+    PqData *pqd = (PqData *)pq->self;
+    bool status = (pqd->last > 0L);
+
+    if (status) {
+        long m = maxIndex(pqd);
+        *priority = (pqd->heap[m].priority);
+        *value = (pqd->heap[m].value);
+    }
+    return status;
+}
+
+static bool pq_removeMax(const PrioQueue *pq, void **priority, void **value) {
+    PqData *pqd = (PqData *)pq->self;
+    bool status = (pqd->last > 0L);
+
+    if (status) {
+        long m = maxIndex(pqd);
+        *priority = (pqd->heap[m].priority);
+        *value = (pqd->heap[m].value);
+        if (pqd->slot != NULL)
+            *(pqd->slot(pqd->heap[m].value)) = 0L;
+        pqd->heap[m] = pqd->heap[pqd->last];
+        pqd->last--;
+        if (m <= pqd->last)     /* the moved entry can only need to rise */
+            siftupFrom(pqd, m);
+    }
+    return status;
+}
+
+/*
+ * helper function to grow the heap array so that it can hold n entries
+ *
+ * returns true if successful, false if realloc() fails
+ */
+static bool reserve(PqData *pqd, long n) {
+    long size = pqd->size;
+    PQEntry *tmp;
+
+    if (n < size)
+        return true;
+    while (size <= n)
+        size *= 2;
+    tmp = (PQEntry *)realloc(pqd->heap, size * sizeof(PQEntry));
+    if (tmp == NULL)
+        return false;
+    pqd->heap = tmp;
+    pqd->size = size;
+    return true;
+}
+
+/*
+ * Floyd's construction: sifting down every internal node, from the last
+ * to the root, makes heap(1,last) from arbitrary contents in O(n)
+ */
+static void heapify(PqData *pqd) {
+    long i;
+
+    if (pqd->slot != NULL)      /* entries that do not move need a slot */
+        for (i = 1; i <= pqd->last; i++)
+            *(pqd->slot(pqd->heap[i].value)) = i;
+    for (i = pqd->last / 2; i >= 1; i--)
+        siftdownFrom(pqd, i);
+}
+
+/*
+ * helper function to merge by removing each entry of other and inserting
+ * it into pq; used when other is not a HeapPrioQueue
+ */
+static bool mergeByRemoval(const PrioQueue *pq, const PrioQueue *other) {
+    void *priority, *value;
+
+    while (other->removeMin(other, &priority, &value))
+        if (! pq->insert(pq, priority, value)) {
+            (void)other->insert(other, priority, value);
+            return false;
+        }
+    return true;
+}
+
+static bool pq_merge(const PrioQueue *pq, const PrioQueue *other) {
+    PqData *pqd = (PqData *)pq->self;
+    PqData *opd = (PqData *)other->self;
+    long i, n, m, bits;
+
+    if (pq == other)
+        return true;
+    if (other->merge != pq->merge || opd->cmp != pqd->cmp ||
+        opd->slot != pqd->slot)
+        return mergeByRemoval(pq, other);
+    n = pqd->last;
+    m = opd->last;
+    if (m == 0L)
+        return true;
+    if (! reserve(pqd, n + m))
+        return false;
+    /*
+     * other's entries follow pq's in FIFO order, so their sequence numbers
+     * are shifted past every number that pq has issued
+     */
+    for (i = 1; i <= m; i++) {
+        PQEntry e = opd->heap[i];
+        e.sequenceNo += pqd->sequenceNo;
+        pqd->heap[n + i] = e;
+    }
+    pqd->sequenceNo += opd->sequenceNo;
+    pqd->last = n + m;
+    opd->last = 0L;
+    /*
+     * m siftups cost O(m log(n+m)); rebuilding costs O(n+m)
+     */
+    for (bits = 0, i = n + m; i > 1; i /= 2)
+        bits++;
+    if (m * bits > n + m)
+        heapify(pqd);
+    else
+        for (i = n + 1; i <= n + m; i++)
+            siftupFrom(pqd, i);
+    return true;
+}
+
 static long pq_size(const PrioQueue *pq) {
     PqData *pqd = (PqData *)pq->self;
     return pqd->last;
@@ -216,6 +418,7 @@ static void **genArray(PqData *pqd) {
                 for (i = 0; i < pqd->last + 1; i++)  /* copy the heap */
                     tmp[i] = pqd->heap[i];
                 npqd.heap = tmp;
+                npqd.slot = NULL;       /* copy must not disturb the slots */
                 /* copy min element into theArray, swap first with last
                    and siftdown */
                 for (i = 0; i < pqd->last; i++) {
@@ -254,7 +457,8 @@ static const PrioQueue *pq_create(const PrioQueue *pq);
 
 static PrioQueue template = {
     NULL, pq_create, pq_destroy, pq_clear, pq_insert, pq_min, pq_removeMin,
-    pq_size, pq_isEmpty, pq_toArray, pq_itCreate
+    pq_size, pq_isEmpty, pq_toArray, pq_itCreate, pq_changePriority,
+    pq_max, pq_removeMax, pq_merge
 };
 
 /*
@@ -262,23 +466,26 @@ static PrioQueue template = {
  */
 static const PrioQueue *newPrioQueue(int (*cmp)(void*, void*),
                                      void (*freeP)(void*),
-                                     void (*freeV)(void*)) {
+                                     void (*freeV)(void*),
+                                     long *(*slot)(void*),
+                                     long capacity) {
     PrioQueue *pq = (PrioQueue *)malloc(sizeof(PrioQueue));
 
     if (pq != NULL) {
         PqData *pqd = (PqData *)malloc(sizeof(PqData));
 
         if (pqd != NULL) {
-            PQEntry *p = (PQEntry *)malloc(DEFAULT_HEAP_SIZE * sizeof(PQEntry));
+            PQEntry *p = (PQEntry *)malloc(capacity * sizeof(PQEntry));
 
             if (p != NULL) {
                 pqd->cmp = cmp;
                 pqd->sequenceNo = 0L;
-                pqd->size = DEFAULT_HEAP_SIZE;
+                pqd->size = capacity;
                 pqd->last = 0L;
                 pqd->heap = p;
                 pqd->freePrio = freeP;
                 pqd->freeValue = freeV;
+                pqd->slot = slot;
                 *pq = template;
                 pq->self = pqd;
             } else {
@@ -297,17 +504,50 @@ static const PrioQueue *newPrioQueue(int (*cmp)(void*, void*),
 static const PrioQueue *pq_create(const PrioQueue *pq) {
     PqData *pqd = (PqData *)pq->self;
 
-    return newPrioQueue(pqd->cmp, pqd->freePrio, pqd->freeValue);
+    return newPrioQueue(pqd->cmp, pqd->freePrio, pqd->freeValue, pqd->slot,
+                        DEFAULT_HEAP_SIZE);
 }
 
 const PrioQueue *HeapPrioQueue(int (*cmp)(void *p1, void *p2),
                                void (*freePrio)(void *prio),
                                void (*freeValue)(void *value)) {
-    return newPrioQueue(cmp, freePrio, freeValue);
+    return newPrioQueue(cmp, freePrio, freeValue, NULL, DEFAULT_HEAP_SIZE);
+}
+
+const PrioQueue *TrackedHeapPrioQueue(int (*cmp)(void *p1, void *p2),
+                                      void (*freePrio)(void *prio),
+                                      void (*freeValue)(void *value),
+                                      long *(*slot)(void *value)) {
+    return newPrioQueue(cmp, freePrio, freeValue, slot, DEFAULT_HEAP_SIZE);
+}
+
+const PrioQueue *BulkHeapPrioQueue(int (*cmp)(void *p1, void *p2),
+                                   void (*freePrio)(void *prio),
+                                   void (*freeValue)(void *value),
+                                   void *prios[], void *values[], long n) {
+    long capacity = (n < DEFAULT_HEAP_SIZE) ? DEFAULT_HEAP_SIZE : n + 1;
+    const PrioQueue *pq = newPrioQueue(cmp, freePrio, freeValue, NULL,
+                                       capacity);
+
+    if (pq != NULL) {
+        PqData *pqd = (PqData *)pq->self;
+        long i;
+
+        for (i = 0; i < n; i++) {
+            PQEntry *e = &(pqd->heap[i + 1]);
+            e->priority = prios[i];
+            e->value = values[i];
+            e->sequenceNo = i;
+        }
+        pqd->sequenceNo = n;
+        pqd->last = n;
+        heapify(pqd);
+    }
+    return pq;
 }
 
 const PrioQueue *PrioQueue_create(int (*cmp)(void *p1, void *p2),
                                   void (*freePrio)(void *prio),
                                   void (*freeValue)(void *value)) {
-    return newPrioQueue(cmp, freePrio, freeValue);
+    return newPrioQueue(cmp, freePrio, freeValue, NULL, DEFAULT_HEAP_SIZE);
 }
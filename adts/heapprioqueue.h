@@ -53,4 +53,37 @@ const PrioQueue *HeapPrioQueue(int (*cmp)(void*, void*),
                                void (*freeValue)(void *value)
                               );
 
+/* create a priority queue using a heap whose entries are tracked, so that
+ * changePriority() locates an entry in O(1) instead of searching the heap
+ *
+ * cmp, freePrio, and freeValue are as for HeapPrioQueue()
+ *
+ * slot is a function pointer that returns the address of a long within
+ * `value'; the heap keeps the value's current heap position in that long,
+ * storing 0 there when the value is removed by removeMin() or removeMax().
+ * Every value inserted must therefore be distinct, non-NULL, and not
+ * inserted in another tracked priority queue that uses the same slot.
+ *
+ * returns a pointer to the priority queue, or NULL if malloc errors */
+const PrioQueue *TrackedHeapPrioQueue(int (*cmp)(void*, void*),
+                                      void (*freePrio)(void *prio),
+                                      void (*freeValue)(void *value),
+                                      long *(*slot)(void *value)
+                                     );
+
+/* create a priority queue using a heap, loaded with n entries in O(n)
+ *
+ * cmp, freePrio, and freeValue are as for HeapPrioQueue()
+ *
+ * the i'th entry has priority prios[i] and value values[i]; entries with
+ * equal priorities are removed in array order, as if they had been
+ * inserted in that order
+ *
+ * returns a pointer to the priority queue, or NULL if malloc errors */
+const PrioQueue *BulkHeapPrioQueue(int (*cmp)(void*, void*),
+                                   void (*freePrio)(void *prio),
+                                   void (*freeValue)(void *value),
+                                   void *prios[], void *values[], long n
+                                  );
+
 #endif /* _HEAPPRIOQUEUE_H_ */
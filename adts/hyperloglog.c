@@ -0,0 +1,345 @@
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * implementation of a HyperLogLog sketch
+ *
+ * a sparse entry is (index << 6) | rho, index being the top SP bits of the
+ * hash and rho the position of the first 1 in the remaining bits; sorted
+ * by value, the entries for one index are in order of rho, so merging
+ * keeps the last of each; new entries are appended to a small unsorted
+ * buffer, which is sorted and merged into the list when it fills
+ *
+ * the dense rho of an item is recovered from its sparse entry, since the
+ * bits that follow the top p bits of the hash are the low SP - p bits of
+ * the sparse index followed by the bits that the sparse rho describes
+ */
+
+#include "ADTs/hyperloglog.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define HASH_N (1L << 60)
+#define SP 25                   /* precision of the sparse representation */
+#define BUFFER 128
+#define SPARSE_MIN (BUFFER * (long)sizeof(unsigned int))   /* bytes */
+
+typedef struct hll_data {
+    long (*hash)(void *, long N);
+    int p;
+    long m;
+    unsigned char *registers;           /* NULL while sparse */
+    unsigned int *list;                 /* sorted, one entry per index */
+    long nlist;
+    unsigned int buffer[BUFFER];
+    long nbuf;
+} HLLData;
+
+static unsigned long mix(unsigned long x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdUL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53UL;
+    x ^= x >> 33;
+    return x;
+}
+
+/* position of the first 1 in the `width' bits below the top `top' bits */
+static int rho(unsigned long x, int top, int width) {
+    unsigned long w = x << top;
+
+    return (w == 0UL) ? width + 1 : __builtin_clzl(w) + 1;
+}
+
+static unsigned int sparseEntry(unsigned long x) {
+    return (unsigned int)((x >> (64 - SP)) << 6) | rho(x, SP, 64 - SP);
+}
+
+static void setRegister(HLLData *hd, unsigned int e) {
+    unsigned int index = e >> 6, low, r;
+    int width = SP - hd->p;
+
+    low = index & ((1U << width) - 1U);
+    if (low != 0U)
+        r = width - (31 - __builtin_clz(low));
+    else
+        r = width + (e & 63U);
+    index >>= width;
+    if (hd->registers[index] < r)
+        hd->registers[index] = (unsigned char)r;
+}
+
+static int cmpEntry(const void *p1, const void *p2) {
+    unsigned int a = *(const unsigned int *)p1;
+    unsigned int b = *(const unsigned int *)p2;
+
+    return (a < b) ? -1 : (a > b);
+}
+
+/*
+ * makes the sketch dense
+ *
+ * returns false if malloc failure, in which case nothing has changed
+ */
+static bool toDense(HLLData *hd) {
+    long i;
+
+    if ((hd->registers = (unsigned char *)calloc(hd->m, 1)) == NULL)
+        return false;
+    for (i = 0; i < hd->nlist; i++)
+        setRegister(hd, hd->list[i]);
+    for (i = 0; i < hd->nbuf; i++)
+        setRegister(hd, hd->buffer[i]);
+    free(hd->list);
+    hd->list = NULL;
+    hd->nlist = 0L;
+    hd->nbuf = 0L;
+    return true;
+}
+
+/*
+ * merges the buffer into the list, making the sketch dense if the list
+ * has grown too long
+ *
+ * returns false if malloc failure, in which case nothing has changed
+ */
+static bool flush(HLLData *hd) {
+    unsigned int *list;
+    long i = 0L, j = 0L, n = 0L;
+
+    if (hd->nbuf == 0L)
+        return true;
+    qsort(hd->buffer, hd->nbuf, sizeof(unsigned int), cmpEntry);
+    list = (unsigned int *)malloc((hd->nlist + hd->nbuf) * sizeof(unsigned int));
+    if (list == NULL)
+        return false;
+    while (i < hd->nlist || j < hd->nbuf) {
+        unsigned int e;
+        if (j == hd->nbuf || (i < hd->nlist && hd->list[i] < hd->buffer[j]))
+            e = hd->list[i++];
+        else
+            e = hd->buffer[j++];
+        if (n > 0 && (list[n - 1] >> 6) == (e >> 6))
+            list[n - 1] = e;            /* same index, rho at least as big */
+        else
+            list[n++] = e;
+    }
+    free(hd->list);
+    hd->list = list;
+    hd->nlist = n;
+    hd->nbuf = 0L;
+    if (n * (long)sizeof(unsigned int) > hd->m)
+        (void)toDense(hd);              /* if it fails, stay sparse */
+    return true;
+}
+
+/*
+ * records sparse entry e
+ *
+ * returns false if malloc failure
+ */
+static bool addEntry(HLLData *hd, unsigned int e) {
+    if (hd->registers != NULL) {
+        setRegister(hd, e);
+        return true;
+    }
+    if (hd->nbuf == BUFFER && ! flush(hd))
+        return false;
+    if (hd->registers != NULL)
+        setRegister(hd, e);
+    else
+        hd->buffer[hd->nbuf++] = e;
+    return true;
+}
+
+static void h_destroy(const HyperLogLog *h) {
+    HLLData *hd = (HLLData *)h->self;
+    free(hd->registers);
+    free(hd->list);
+    free(hd);
+    free((void *)h);
+}
+
+static void h_clear(const HyperLogLog *h) {
+    HLLData *hd = (HLLData *)h->self;
+    if (hd->m <= SPARSE_MIN) {          /* never sparse */
+        memset(hd->registers, 0, hd->m);
+        return;
+    }
+    free(hd->registers);
+    free(hd->list);
+    hd->registers = NULL;
+    hd->list = NULL;
+    hd->nlist = 0L;
+    hd->nbuf = 0L;
+}
+
+static bool h_add(const HyperLogLog *h, void *item) {
+    HLLData *hd = (HLLData *)h->self;
+    unsigned long x = mix((unsigned long)hd->hash(item, HASH_N));
+
+    if (hd->registers != NULL) {
+        unsigned char r = (unsigned char)rho(x, hd->p, 64 - hd->p);
+        unsigned long index = x >> (64 - hd->p);
+        if (hd->registers[index] < r)
+            hd->registers[index] = r;
+        return true;
+    }
+    return addEntry(hd, sparseEntry(x));
+}
+
+/*
+ * returns true if the list holds an entry for the index of e
+ */
+static bool listed(HLLData *hd, unsigned int e) {
+    long lo = 0L, hi = hd->nlist - 1L;
+
+    e >>= 6;
+    while (lo <= hi) {
+        long mid = (lo + hi) / 2;
+        unsigned int x = hd->list[mid] >> 6;
+        if (x == e)
+            return true;
+        if (x < e)
+            lo = mid + 1;
+        else
+            hi = mid - 1;
+    }
+    return false;
+}
+
+static long h_estimate(const HyperLogLog *h) {
+    HLLData *hd = (HLLData *)h->self;
+    double m = (double)hd->m, sum = 0.0, alpha, e;
+    long i, zeros = 0L;
+
+    if (hd->registers == NULL) {        /* linear counting at precision SP */
+        long n = hd->nlist;
+        double ms = (double)(1L << SP);
+
+        qsort(hd->buffer, hd->nbuf, sizeof(unsigned int), cmpEntry);
+        for (i = 0; i < hd->nbuf; i++)
+            if ((i == 0 || (hd->buffer[i] >> 6) != (hd->buffer[i - 1] >> 6))
+                && ! listed(hd, hd->buffer[i]))
+                n++;
+        return (long)(ms * log(ms / (ms - n)) + 0.5);
+    }
+    for (i = 0; i < hd->m; i++) {
+        sum += 1.0 / (double)(1UL << hd->registers[i]);
+        if (hd->registers[i] == 0)
+            zeros++;
+    }
+    switch (hd->m) {
+    case 16: alpha = 0.673; break;
+    case 32: alpha = 0.697; break;
+    case 64: alpha = 0.709; break;
+    default: alpha = 0.7213 / (1.0 + 1.079 / m); break;
+    }
+    e = alpha * m * m / sum;
+    if (e <= 2.5 * m && zeros > 0L)     /* small range correction */
+        e = m * log(m / (double)zeros);
+    return (long)(e + 0.5);
+}
+
+static bool h_merge(const HyperLogLog *h, const HyperLogLog *other) {
+    HLLData *hd = (HLLData *)h->self;
+    HLLData *od = (HLLData *)other->self;
+    long i;
+
+    if (hd == od)                       /* would add the list to itself */
+        return true;
+    if (hd->p != od->p)
+        return false;
+    if (od->registers != NULL) {
+        if (hd->registers == NULL && ! toDense(hd))
+            return false;
+        for (i = 0; i < hd->m; i++)
+            if (hd->registers[i] < od->registers[i])
+                hd->registers[i] = od->registers[i];
+        return true;
+    }
+    for (i = 0; i < od->nlist; i++)
+        if (! addEntry(hd, od->list[i]))
+            return false;
+    for (i = 0; i < od->nbuf; i++)
+        if (! addEntry(hd, od->buffer[i]))
+            return false;
+    return true;
+}
+
+static bool h_isSparse(const HyperLogLog *h) {
+    HLLData *hd = (HLLData *)h->self;
+    return (hd->registers == NULL);
+}
+
+static long h_bytes(const HyperLogLog *h) {
+    HLLData *hd = (HLLData *)h->self;
+
+    if (hd->registers != NULL)
+        return hd->m;
+    return (hd->nlist + BUFFER) * sizeof(unsigned int);
+}
+
+static HyperLogLog template = {
+    NULL, h_destroy, h_clear, h_add, h_estimate, h_merge, h_isSparse, h_bytes
+};
+
+const HyperLogLog *HyperLogLog_create(int precision,
+                                      long (*hash)(void *item, long N)) {
+    HyperLogLog *h;
+    HLLData *hd;
+
+    if (precision < 4 || precision > 18)
+        return NULL;
+    if ((h = (HyperLogLog *)malloc(sizeof(HyperLogLog))) == NULL)
+        return NULL;
+    if ((hd = (HLLData *)malloc(sizeof(HLLData))) == NULL) {
+        free(h);
+        return NULL;
+    }
+    hd->hash = hash;
+    hd->p = precision;
+    hd->m = 1L << precision;
+    hd->registers = NULL;
+    hd->list = NULL;
+    hd->nlist = 0L;
+    hd->nbuf = 0L;
+    /* the sparse form cannot be smaller than its buffer */
+    if (hd->m <= SPARSE_MIN && ! toDense(hd)) {
+        free(hd);
+        free(h);
+        return NULL;
+    }
+    *h = template;
+    h->self = hd;
+    return h;
+}
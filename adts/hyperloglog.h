@@ -0,0 +1,123 @@
+#ifndef _HYPERLOGLOG_H_
+#define _HYPERLOGLOG_H_
+
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * interface definition for a HyperLogLog sketch, which estimates the
+ * number of distinct items seen in a stream
+ *
+ * the dense representation has 2^precision one-byte registers, each of
+ * which holds the longest run of leading zeros seen in the hashes of the
+ * items that fall into it; its standard error is 1.04 / sqrt(2^precision),
+ * e.g. 0.8% for a precision of 14, in 16 KB
+ *
+ * a new sketch is sparse: it keeps a sorted list of the registers that
+ * are set, at a precision of 25, and is exact to within hash collisions
+ * for small cardinalities; it becomes dense once the list would take more
+ * room than the registers; at precisions up to 9 the registers take no
+ * more room than the empty list, so the sketch is dense from the start
+ *
+ * programs using it must also be linked with -lm
+ */
+
+#include "ADTs/ADTdefs.h"
+
+typedef struct hyperloglog HyperLogLog;         /* forward reference */
+
+/*
+ * create a sketch with 2^precision registers; precision is in [4, 18]
+ *
+ * the hash function pointer is applied to an item with N = 2^60; the
+ * registers are indexed by the result, so it should use as many of its
+ * bits as it can
+ *
+ * returns a pointer to the sketch, or NULL if precision is out of range
+ * or if malloc errors
+ */
+const HyperLogLog *HyperLogLog_create(int precision,
+                                      long (*hash)(void *item, long N));
+
+/*
+ * now define dispatch table
+ */
+struct hyperloglog {
+/*
+ * the private data of the sketch
+ */
+    void *self;
+
+/*
+ * returns the storage associated with the sketch to the heap
+ */
+    void (*destroy)(const HyperLogLog *h);
+
+/*
+ * forgets every item; the sketch is sparse again, unless its precision
+ * is 9 or less
+ */
+    void (*clear)(const HyperLogLog *h);
+
+/*
+ * records `item'
+ *
+ * returns true if successful, false if malloc failure, in which case
+ * the item has not been recorded
+ */
+    bool (*add)(const HyperLogLog *h, void *item);
+
+/*
+ * returns the estimated number of distinct items recorded
+ */
+    long (*estimate)(const HyperLogLog *h);
+
+/*
+ * records in `h' every item recorded in `other', as if each had been
+ * add()ed; the two must have the same precision and hash function
+ *
+ * returns true if successful, false if the precisions differ or if malloc
+ * failure
+ */
+    bool (*merge)(const HyperLogLog *h, const HyperLogLog *other);
+
+/*
+ * returns true if the sketch is still sparse, false if dense
+ */
+    bool (*isSparse)(const HyperLogLog *h);
+
+/*
+ * returns the number of bytes used by the sketch's registers or list
+ */
+    long (*bytes)(const HyperLogLog *h);
+};
+
+#endif /* _HYPERLOGLOG_H_ */
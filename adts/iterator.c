@@ -31,6 +31,7 @@
 
 #include "ADTs/iterator.h"
 #include <stdlib.h>
+#include <string.h>
 
 /*
  * implementation for generic iterator
@@ -58,6 +59,20 @@ static bool it_next(const Iterator *it, void **element) {
     return status;
 }
 
+static long it_nextBatch(const Iterator *it, void **buf, long n) {
+    ItData *itd = (ItData *)(it->self);
+    long left = itd->size - itd->next;
+
+    if (n > left)
+        n = left;
+    if (n > 0L) {
+        memcpy(buf, itd->elements + itd->next, n * sizeof(void *));
+        itd->next += n;
+    } else
+        n = 0L;
+    return n;
+}
+
 static void it_destroy(const Iterator *it) {
     ItData *itd = (ItData *)(it->self);
     free(itd->elements);
@@ -65,7 +80,9 @@ static void it_destroy(const Iterator *it) {
     free((void *)it);
 }
 
-static Iterator template = {NULL, it_hasNext, it_next, it_destroy};
+static Iterator template = {
+    NULL, it_hasNext, it_next, it_nextBatch, it_destroy
+};
 
 const Iterator *Iterator_create(long size, void **elements) {
     Iterator *it = (Iterator *)malloc(sizeof(Iterator));
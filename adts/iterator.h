@@ -65,6 +65,13 @@ struct iterator {
      */
     bool (*next)(const Iterator *self, void **element);
 
+    /* copies up to `n' of the next elements from the iterator into buf[],
+     * in order; this costs one call per batch rather than two per element
+     *
+     * returns the number of elements copied, 0 if there are none left
+     */
+    long (*nextBatch)(const Iterator *self, void **buf, long n);
+
     /* destroys the iterator */
     void (*destroy)(const Iterator *self);
 };
@@ -92,43 +92,52 @@ static void pq_clear(const PrioQueue *pq) {
     pqd->size = 0L;
 }
 
+/*
+ * helper function to link `new' into the list after all entries whose
+ * priority is <= its own
+ */
+static void linkNode(PqData *pqd, PQNode *new) {
+    PQNode *prev = NULL, *next;
+
+    new->next = NULL;
+    for (next = pqd->head; next != NULL; prev = next, next = next->next)
+        if (pqd->cmp(new->priority, next->priority) < 0)
+            break;
+/*
+ * when we reach this point, the following situations can be true:
+ *      prev==NULL, next==NULL: linked list was empty
+ *      prev==NULL, next!=NULL: insert new at head
+ *      prev!=NULL, next!=NULL: insert new between prev and next
+ *      prev!=NULL, next==NULL: insert new at tail
+ */
+    if (prev == NULL)
+        if (next == NULL) {
+            pqd->head = new;
+            pqd->tail = new;
+        } else {
+            new->next = pqd->head;
+            pqd->head = new;
+        }
+    else
+        if (next == NULL) {
+            prev->next = new;
+            pqd->tail = new;
+        } else {
+            new->next = next;
+            prev->next = new;
+        }
+    pqd->size++;
+}
+
 static bool pq_insert(const PrioQueue *pq, void *priority, void *value) {
     PqData *pqd = (PqData *)pq->self;
     PQNode *new = (PQNode *)malloc(sizeof(PQNode));
     bool status = (new != NULL);
     
     if (status) {
-        PQNode *prev = NULL, *next;
-        new->next = NULL;
         new->priority = priority;
         new->value = value;
-        for (next = pqd->head; next != NULL; prev = next, next = next->next)
-            if (pqd->cmp(priority, next->priority) < 0)
-                break;
-/*
- * when we reach this point, the following situations can be true:
- *      prev==NULL, next==NULL: linked list was empty
- *      prev==NULL, next!=NULL: insert new at head
- *      prev!=NULL, next!=NULL: insert new between prev and next
- *      prev!=NULL, next==NULL: insert new at tail
- */
-        if (prev == NULL)
-            if (next == NULL) {
-                pqd->head = new;
-                pqd->tail = new;
-            } else {
-                new->next = pqd->head;
-                pqd->head = new;
-            }
-        else
-            if (next == NULL) {
-                prev->next = new;
-                pqd->tail = new;
-            } else {
-                new->next = next;
-                prev->next = new;
-            }
-        pqd->size++;
+        linkNode(pqd, new);
     }
     return status;
 }
@@ -160,6 +169,115 @@ static bool pq_removeMin(const PrioQueue *pq, void **priority, void **value) {
     return status;
 }
 
+static bool pq_changePriority(const PrioQueue *pq, void *value,
+                              void *priority) {
+    PqData *pqd = (PqData *)pq->self;
+    PQNode *prev = NULL, *p;
+    bool status;
+
+    for (p = pqd->head; p != NULL; prev = p, p = p->next)
+        if (p->value == value)
+            break;
+    status = (p != NULL);
+    if (status) {
+        if (prev == NULL)
+            pqd->head = p->next;
+        else
+            prev->next = p->next;
+        if (pqd->tail == p)
+            pqd->tail = prev;
+        pqd->size--;
+        pqd->freePrio(p->priority);
+        p->priority = priority;
+        linkNode(pqd, p);
+    }
+    return status;
+}
+
+static bool pq_max(const PrioQueue *pq, void **priority, void **value) {
+    PqData *pqd = (PqData *)pq->self;
+    bool status = (pqd->size > 0L);
+
+    if (status) {
+        *priority = pqd->tail->priority;
+        *value = pqd->tail->value;
+    }
+    return status;
+}
+
+static bool pq_removeMax(const PrioQueue *pq, void **priority, void **value) {
+    PqData *pqd = (PqData *)pq->self;
+    bool status = (pqd->size > 0L);
+
+    if (status) {
+        PQNode *prev = NULL, *p;
+        for (p = pqd->head; p != pqd->tail; prev = p, p = p->next)
+            ;
+        if (prev == NULL)
+            pqd->head = NULL;
+        else
+            prev->next = NULL;
+        pqd->tail = prev;
+        *priority = p->priority;
+        *value = p->value;
+        pqd->size--;
+        free(p);
+    }
+    return status;
+}
+
+/*
+ * helper function to merge by removing each entry of other and inserting
+ * it into pq; used when other is not a LListPrioQueue
+ */
+static bool mergeByRemoval(const PrioQueue *pq, const PrioQueue *other) {
+    void *priority, *value;
+
+    while (other->removeMin(other, &priority, &value))
+        if (! pq->insert(pq, priority, value)) {
+            (void)other->insert(other, priority, value);
+            return false;
+        }
+    return true;
+}
+
+/*
+ * both lists are sorted, so they are spliced together in one pass; on
+ * equal priorities pq's node is taken first
+ */
+static bool pq_merge(const PrioQueue *pq, const PrioQueue *other) {
+    PqData *pqd = (PqData *)pq->self;
+    PqData *opd = (PqData *)other->self;
+    PQNode head, *tail = &head, *p, *q;
+
+    if (pq == other)
+        return true;
+    if (other->merge != pq->merge || opd->cmp != pqd->cmp)
+        return mergeByRemoval(pq, other);
+    if (opd->size == 0L)
+        return true;
+    p = pqd->head;
+    q = opd->head;
+    while (p != NULL && q != NULL) {
+        if (pqd->cmp(q->priority, p->priority) < 0) {
+            tail->next = q;
+            q = q->next;
+        } else {
+            tail->next = p;
+            p = p->next;
+        }
+        tail = tail->next;
+    }
+    tail->next = (p != NULL) ? p : q;
+    pqd->head = head.next;
+    if (q != NULL)
+        pqd->tail = opd->tail;
+    pqd->size += opd->size;
+    opd->head = opd->tail = NULL;
+    opd->size = 0L;
+    return true;
+}
+
 static long pq_size(const PrioQueue *pq) {
     PqData *pqd = (PqData *)pq->self;
     return pqd->size;
@@ -211,7 +329,8 @@ static const PrioQueue *pq_create(const PrioQueue *pq);
 
 static PrioQueue template = {
     NULL, pq_create, pq_destroy, pq_clear, pq_insert, pq_min, pq_removeMin,
-    pq_size, pq_isEmpty, pq_toArray, pq_itCreate
+    pq_size, pq_isEmpty, pq_toArray, pq_itCreate, pq_changePriority,
+    pq_max, pq_removeMax, pq_merge
 };
 
 /*
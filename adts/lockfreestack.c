@@ -0,0 +1,278 @@
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * implementation for lock-free, linked-list-based generic stack
+ *
+ * the top of the stack is a tagged pointer: on 64-bit systems the top
+ * 16 bits hold a counter that is bumped by every successful push or pop,
+ * so that a compare-and-swap cannot succeed against a top that has been
+ * popped and pushed again in the meantime (the ABA problem); popped nodes
+ * are retired through the epoch module, so a node is never freed while
+ * another thread may still be reading its `next' field
+ */
+
+#include "ADTs/lockfreestack.h"
+#include "ADTs/epoch.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#if UINTPTR_MAX == 0xffffffffffffffffUL
+#define PTR_BITS 48
+#define NODE(t) ((Node *)((t) & ((((uintptr_t)1) << PTR_BITS) - 1)))
+#define TAGGED(n, t) ((uintptr_t)(n) | ((((t) >> PTR_BITS) + 1) << PTR_BITS))
+#else                           /* no spare bits; epochs alone prevent ABA */
+#define NODE(t) ((Node *)(t))
+#define TAGGED(n, t) ((uintptr_t)(n))
+#endif
+
+typedef struct node {
+    struct node *next;
+    void *value;
+} Node;
+
+typedef struct st_data {
+    _Atomic(uintptr_t) top;     /* tagged pointer to the top node */
+    atomic_long count;
+    void (*freeValue)(void *e);
+} StData;
+
+/*
+ * helper function to pop the top node, retiring it
+ *
+ * returns true if successful, false if the stack was empty
+ */
+static bool popNode(StData *std, void **element) {
+    uintptr_t old;
+    Node *p;
+
+    if (! Epoch_enter())
+        return false;
+    old = atomic_load(&std->top);
+    do {
+        if ((p = NODE(old)) == NULL)
+            break;
+    } while (! atomic_compare_exchange_weak(&std->top, &old,
+                                            TAGGED(p->next, old)));
+    if (p != NULL) {
+        *element = p->value;
+        atomic_fetch_sub(&std->count, 1L);
+        Epoch_retire(p, free);
+    }
+    Epoch_exit();
+    return (p != NULL);
+}
+
+/*
+ * helper function to free all nodes in the linked list, applying freeValue
+ * to each element; only called when no other thread can access the stack
+ */
+static void freeList(StData *std) {
+    Node *p, *q = NULL;
+
+    for (p = NODE(atomic_load(&std->top)); p != NULL; p = q) {
+        q = p->next;
+        std->freeValue(p->value);
+        free(p);
+    }
+}
+
+static void st_destroy(const Stack *st) {
+    StData *std = (StData *)st->self;
+
+    freeList(std);
+    free(std);                          /* free structure with instance data */
+    free((void *)st);                   /* free dispatch table */
+}
+
+static void st_clear(const Stack *st) {
+    StData *std = (StData *)st->self;
+    void *element;
+
+    while (popNode(std, &element))
+        std->freeValue(element);
+}
+
+static bool st_push(const Stack *st, void *element) {
+    StData *std = (StData *)st->self;
+    Node *p = (Node *)malloc(sizeof(Node));
+    bool status = (p != NULL);
+
+    if (status) {
+        uintptr_t old = atomic_load(&std->top);
+
+        p->value = element;
+        do {
+            p->next = NODE(old);
+        } while (! atomic_compare_exchange_weak(&std->top, &old,
+                                                TAGGED(p, old)));
+        atomic_fetch_add(&std->count, 1L);
+    }
+    return status;
+}
+
+static bool st_pop(const Stack *st, void **element) {
+    StData *std = (StData *)st->self;
+
+    return popNode(std, element);
+}
+
+static bool st_peek(const Stack *st, void **element) {
+    StData *std = (StData *)st->self;
+    Node *p;
+
+    if (! Epoch_enter())
+        return false;
+    if ((p = NODE(atomic_load(&std->top))) != NULL)
+        *element = p->value;
+    Epoch_exit();
+    return (p != NULL);
+}
+
+static long st_size(const Stack *st) {
+    StData *std = (StData *)st->self;
+    long n = atomic_load(&std->count);
+
+    return (n < 0L) ? 0L : n;   /* a pop can be counted before its push */
+}
+
+static bool st_isEmpty(const Stack *st) {
+    StData *std = (StData *)st->self;
+
+    return (NODE(atomic_load(&std->top)) == NULL);
+}
+
+/*
+ * helper function - generates array of void * pointers on the heap
+ *
+ * with concurrent pushes and pops the array is not a snapshot, but each
+ * element in it was on the stack at some point during the traversal
+ *
+ * returns pointer to the array or NULL if malloc failure or empty
+ */
+static void **genArray(StData *std, long *len) {
+    long n = 0L, size = atomic_load(&std->count) + 1L;
+    void **tmp;
+    Node *p;
+
+    if (size < 1L)
+        size = 1L;
+    if (! Epoch_enter())
+        return NULL;
+    if ((tmp = (void **)malloc(size * sizeof(void *))) != NULL) {
+        for (p = NODE(atomic_load(&std->top)); p != NULL; p = p->next) {
+            if (n == size) {
+                void **t = (void **)realloc(tmp, 2 * size * sizeof(void *));
+
+                if (t == NULL) {
+                    free(tmp);
+                    tmp = NULL;
+                    break;
+                }
+                tmp = t;
+                size *= 2;
+            }
+            tmp[n++] = p->value;
+        }
+    }
+    Epoch_exit();
+    if (tmp != NULL && n == 0L) {
+        free(tmp);
+        tmp = NULL;
+    }
+    *len = n;
+    return tmp;
+}
+
+static void **st_toArray(const Stack *st, long *len) {
+    StData *std = (StData *)st->self;
+    long n;
+    void **tmp = genArray(std, &n);
+
+    if (tmp != NULL)
+        *len = n;
+    return tmp;
+}
+
+static const Iterator *st_itCreate(const Stack *st) {
+    StData *std = (StData *)st->self;
+    const Iterator *it = NULL;
+    long n;
+    void **tmp = genArray(std, &n);
+
+    if (tmp != NULL) {
+        it = Iterator_create(n, tmp);
+        if (it == NULL)
+            free(tmp);
+    }
+    return it;
+}
+
+static const Stack *st_create(const Stack *st);
+
+static Stack template = {
+    NULL, st_create, st_destroy, st_clear, st_push, st_pop, st_peek, st_size,
+    st_isEmpty, st_toArray, st_itCreate
+};
+
+/*
+ * helper function to create a new Stack dispatch table
+ */
+static const Stack *newStack(void (*freeValue)(void *e)){
+    Stack *st = (Stack *)malloc(sizeof(Stack));
+
+    if (st != NULL) {
+        StData *std = (StData *)malloc(sizeof(StData));
+
+        if (std != NULL) {
+            atomic_init(&std->top, (uintptr_t)0);
+            atomic_init(&std->count, 0L);
+            std->freeValue = freeValue;
+            *st = template;
+            st->self = std;
+        } else {
+            free(st);
+            st = NULL;
+        }
+    }
+    return st;
+}
+
+static const Stack *st_create(const Stack *st) {
+    StData *std = (StData *)st->self;
+
+    return newStack(std->freeValue);
+}
+
+const Stack *LockFreeStack(void (*freeValue)(void *e)) {
+    return newStack(freeValue);
+}
@@ -0,0 +1,1341 @@
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * implementation of a log-structured store of C string keys and values
+ *
+ * the directory holds:
+ *   MANIFEST     the file number to use next, then the numbers of the live
+ *                SSTables, newest first; replaced atomically by rename()
+ *   <n>.log      a write-ahead log; records are <klen><vlen><key><value>
+ *                <check>, where vlen is TOMBSTONE for a remove() and check
+ *                is a hash of the rest, so a torn final record is ignored
+ *   <n>.sst      an SSTable: data blocks of <klen><vlen><key><value>
+ *                records in key order, then the index (<nblocks>, then
+ *                <offset><klen><first key> per block), then the Bloom
+ *                filter (<bits><bytes>), then a fixed-size footer
+ *
+ * every field is native-endian; lengths are 32 bits, offsets 64
+ *
+ * the lock guards everything but the SSTable files themselves; a Table is
+ * reference counted, so get() reads from a snapshot of the table list
+ * without the lock, and a table replaced by a merge is closed and unlinked
+ * when its last reader lets go of it
+ *
+ * group commit: a writer appends its record to `pend' and waits until the
+ * log is durable up to the end of its record; whichever waiting writer
+ * finds no write in progress takes everything in `pend', writes it and
+ * calls fdatasync() without the lock, then applies the records to the
+ * memtable in log order and wakes the others, so a reader never sees a
+ * write that could be lost in a crash
+ *
+ * the flusher thread writes the frozen memtable `imm' as an SSTable; the
+ * merger thread merges tables in tiers: a table's tier is about log4 of
+ * its size in memtables, and once the four newest tables share a tier,
+ * all the newest tables of that tier are merged into one; removed keys
+ * are dropped only by a merge that includes the oldest table; a flush
+ * does not wait for a merge, so writers are not held up by a long one
+ */
+
+#include "ADTs/lsmstore.h"
+#include "ADTs/hashcskmap.h"
+#include "ADTs/mergeiterator.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#define DEFAULT_MEMTABLE (4L << 20)
+#define ENTRY_OVERHEAD 64L      /* memtable bytes per entry beyond the data */
+#define BLOCK 4096L             /* target size of an SSTable data block */
+#define WBUF (1L << 20)         /* SSTable write buffer */
+#define BLOOM_BITS 10L          /* per key, for a false positive rate of 1% */
+#define BLOOM_HASHES 7
+#define TIER_RUN 4L             /* tables of one tier that trigger a merge */
+#define MAX_TABLES 24L          /* writers wait while there are more */
+#define TOMBSTONE 0xFFFFFFFFU
+#define MAGIC 0x4C534D31U       /* "LSM1" */
+#define FOOTER 32L              /* index offset, bloom offset, keys, magic */
+
+typedef struct table {
+    atomic_long refs;
+    bool obsolete;              /* unlink when the last reference goes */
+    long num;
+    int fd;
+    long bytes;
+    long nblocks;
+    long *offsets;              /* of each block, then of the index */
+    char **firsts;              /* first key of each block */
+    unsigned char *bloom;
+    long bits;
+} Table;
+
+typedef struct l_data {
+    char *dir;
+    long memBytes;              /* memtable limit */
+    long used;                  /* memtable bytes used */
+    const CSKMap *mem;
+    const CSKMap *imm;          /* memtable being written, or NULL */
+    long logNum;
+    long immLog;                /* log of imm */
+    int logFd;
+    Table **tables;             /* newest first */
+    long ntables;
+    long maxTables;
+    long nextNum;
+    char *pend;                 /* log records not yet written */
+    long pendLen;
+    long pendCap;
+    char *spare;                /* buffer for pend after the next write */
+    long spareCap;
+    long appended;              /* log bytes appended since opening */
+    long durable;               /* ... of which written and synced */
+    bool writing;               /* a writer is writing pend */
+    bool failed;                /* log, flush or merge I/O failed */
+    long compactWanted;         /* compact() calls made */
+    long compactDone;           /* ... and finished */
+    bool stopping;
+    pthread_t flusher;
+    pthread_t merger;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;        /* broadcast on every change of state */
+} LData;
+
+static char tombstone[1];       /* memtable value of a removed key */
+
+static void freeValue(void *v) {
+    if (v != tombstone)
+        free(v);
+}
+
+/* FNV-1a */
+static uint64_t hash64(const char *p, long len) {
+    uint64_t h = 14695981039346656037UL;
+    long i;
+
+    for (i = 0L; i < len; i++)
+        h = (h ^ (unsigned char)p[i]) * 1099511628211UL;
+    return h;
+}
+
+static void path(LData *ld, char *buf, long num, const char *ext) {
+    sprintf(buf, "%s/%06ld.%s", ld->dir, num, ext);
+}
+
+static bool writeAll(int fd, const char *buf, long len) {
+    while (len > 0L) {
+        ssize_t n = write(fd, buf, len);
+        if (n <= 0)
+            return false;
+        buf += n;
+        len -= n;
+    }
+    return true;
+}
+
+static bool readAll(int fd, char *buf, long len, long offset) {
+    while (len > 0L) {
+        ssize_t n = pread(fd, buf, len, offset);
+        if (n <= 0)
+            return false;
+        buf += n;
+        len -= n;
+        offset += n;
+    }
+    return true;
+}
+
+static void syncDir(LData *ld) {
+    int fd = open(ld->dir, O_RDONLY);
+
+    if (fd >= 0) {
+        (void)fsync(fd);
+        close(fd);
+    }
+}
+
+/*
+ * Bloom filter of `bits' bits; the probes are h1 + i*h2, i = 0 .. 6
+ */
+static void bloomAdd(unsigned char *bloom, long bits, const char *key) {
+    uint64_t h = hash64(key, strlen(key)), h2 = (h >> 33) | 1UL;
+    int i;
+
+    for (i = 0; i < BLOOM_HASHES; i++, h += h2)
+        bloom[(h % bits) / 8] |= 1 << (h % bits) % 8;
+}
+
+static bool bloomHas(unsigned char *bloom, long bits, const char *key) {
+    uint64_t h = hash64(key, strlen(key)), h2 = (h >> 33) | 1UL;
+    int i;
+
+    for (i = 0; i < BLOOM_HASHES; i++, h += h2)
+        if (! (bloom[(h % bits) / 8] & 1 << (h % bits) % 8))
+            return false;
+    return true;
+}
+
+/*
+ * ---------------- SSTables ----------------
+ */
+
+static void freeTable(Table *t) {
+    long i;
+
+    if (t->fd >= 0)
+        close(t->fd);
+    if (t->firsts != NULL)
+        for (i = 0L; i < t->nblocks; i++)
+            free(t->firsts[i]);
+    free(t->firsts);
+    free(t->offsets);
+    free(t->bloom);
+    free(t);
+}
+
+static void unref(LData *ld, Table *t) {
+    if (atomic_fetch_sub(&t->refs, 1L) == 1L) {
+        if (t->obsolete) {
+            char buf[strlen(ld->dir) + 32];
+            path(ld, buf, t->num, "sst");
+            unlink(buf);
+        }
+        freeTable(t);
+    }
+}
+
+/*
+ * opens SSTable `num', loading its index and Bloom filter
+ */
+static Table *openTable(LData *ld, long num) {
+    char buf[strlen(ld->dir) + 32], *index = NULL, *p;
+    Table *t = (Table *)calloc(1, sizeof(Table));
+    uint64_t footer[4], indexOff, bloomOff, n;
+    struct stat st;
+    long i;
+
+    if (t == NULL)
+        return NULL;
+    atomic_init(&t->refs, 1L);
+    t->num = num;
+    path(ld, buf, num, "sst");
+    if ((t->fd = open(buf, O_RDONLY)) < 0 || fstat(t->fd, &st) < 0 ||
+        st.st_size < FOOTER ||
+        ! readAll(t->fd, (char *)footer, FOOTER, st.st_size - FOOTER) ||
+        (uint32_t)footer[3] != MAGIC)
+        goto fail;
+    t->bytes = st.st_size;
+    indexOff = footer[0];
+    bloomOff = footer[1];
+    if (indexOff > bloomOff || bloomOff + 8 > (uint64_t)(st.st_size - FOOTER))
+        goto fail;
+    if ((index = (char *)malloc(bloomOff - indexOff)) == NULL ||
+        ! readAll(t->fd, index, bloomOff - indexOff, indexOff))
+        goto fail;
+    memcpy(&n, index, 8);
+    t->offsets = (long *)malloc((n + 1) * sizeof(long));
+    t->firsts = (char **)calloc(n + 1, sizeof(char *));
+    if (t->offsets == NULL || t->firsts == NULL)
+        goto fail;
+    for (i = 0L, p = index + 8; i < (long)n; i++) {
+        uint64_t off;
+        uint32_t klen;
+        memcpy(&off, p, 8);
+        memcpy(&klen, p + 8, 4);
+        t->offsets[i] = off;
+        if ((t->firsts[i] = strndup(p + 12, klen)) == NULL)
+            goto fail;
+        t->nblocks++;
+        p += 12 + klen;
+    }
+    t->offsets[n] = indexOff;
+    if (! readAll(t->fd, (char *)&n, 8, bloomOff) || n == 0 ||
+        (n + 7) / 8 != st.st_size - FOOTER - bloomOff - 8)
+        goto fail;
+    t->bits = n;
+    if ((t->bloom = (unsigned char *)malloc((n + 7) / 8)) == NULL ||
+        ! readAll(t->fd, (char *)t->bloom, (n + 7) / 8, bloomOff + 8))
+        goto fail;
+    free(index);
+    return t;
+fail:
+    free(index);
+    freeTable(t);
+    return NULL;
+}
+
+/*
+ * looks `key' up in table t
+ *
+ * returns 1 and a copy of the value in `*value' if found, 2 if found
+ * removed, 0 if not present, or -1 if I/O or malloc errors
+ */
+static int tableGet(Table *t, char *key, char **value) {
+    long lo = 0L, hi = t->nblocks - 1, len, klen = strlen(key);
+    char *block, *p, *end;
+    int result = 0;
+
+    if (! bloomHas(t->bloom, t->bits, key))
+        return 0;
+    if (t->nblocks == 0L || strcmp(key, t->firsts[0]) < 0)
+        return 0;
+    while (lo < hi) {           /* the last block whose first key <= key */
+        long mid = (lo + hi + 1) / 2;
+        if (strcmp(t->firsts[mid], key) <= 0)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+    len = t->offsets[lo + 1] - t->offsets[lo];
+    if ((block = (char *)malloc(len)) == NULL)
+        return -1;
+    if (! readAll(t->fd, block, len, t->offsets[lo])) {
+        free(block);
+        return -1;
+    }
+    for (p = block, end = block + len; p + 8 <= end; ) {
+        uint32_t kl, vl;
+        int c;
+        memcpy(&kl, p, 4);
+        memcpy(&vl, p + 4, 4);
+        c = memcmp(p + 8, key, (kl < klen) ? kl : klen);
+        if (c == 0)
+            c = (kl > klen) - (kl < klen);
+        if (c == 0) {
+            if (vl == TOMBSTONE)
+                result = 2;
+            else if ((*value = strndup(p + 8 + kl, vl)) != NULL)
+                result = 1;
+            else
+                result = -1;
+            break;
+        }
+        if (c > 0)
+            break;
+        p += 8 + kl + ((vl == TOMBSTONE) ? 0 : vl);
+    }
+    free(block);
+    return result;
+}
+
+/*
+ * a writer for a new SSTable, into which records are added in key order
+ */
+typedef struct twriter {
+    int fd;
+    long num;
+    char *buf;
+    long fill;
+    long off;                   /* file offset of buf[fill] */
+    long blockStart;
+    long nblocks;
+    long maxBlocks;
+    long *offsets;
+    char **firsts;
+    unsigned char *bloom;
+    long bits;
+    bool ok;
+} TWriter;
+
+static void tw_write(TWriter *w, const void *data, long len) {
+    if (w->fill + len > WBUF) {
+        w->ok = w->ok && writeAll(w->fd, w->buf, w->fill);
+        w->fill = 0L;
+    }
+    if (len > WBUF) {
+        w->ok = w->ok && writeAll(w->fd, data, len);
+    } else {
+        memcpy(w->buf + w->fill, data, len);
+        w->fill += len;
+    }
+    w->off += len;
+}
+
+/*
+ * starts SSTable `num', for at most `keys' keys
+ */
+static bool tw_begin(LData *ld, TWriter *w, long num, long keys) {
+    char buf[strlen(ld->dir) + 32];
+
+    memset(w, 0, sizeof(TWriter));
+    w->num = num;
+    w->maxBlocks = 16L;
+    w->bits = BLOOM_BITS * keys;
+    if (w->bits < 64L)
+        w->bits = 64L;
+    path(ld, buf, w->num, "sst");
+    w->fd = open(buf, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    w->buf = (char *)malloc(WBUF);
+    w->offsets = (long *)malloc(w->maxBlocks * sizeof(long));
+    w->firsts = (char **)malloc(w->maxBlocks * sizeof(char *));
+    w->bloom = (unsigned char *)calloc((w->bits + 7) / 8, 1);
+    w->ok = (w->fd >= 0 && w->buf != NULL && w->offsets != NULL &&
+             w->firsts != NULL && w->bloom != NULL);
+    return w->ok;
+}
+
+/*
+ * adds (key, value) to the table; a NULL value records a removed key
+ */
+static void tw_add(TWriter *w, char *key, char *value) {
+    uint32_t len[2];
+
+    if (! w->ok)
+        return;
+    if (w->nblocks == 0L || w->off - w->blockStart >= BLOCK) {
+        if (w->nblocks == w->maxBlocks) {
+            long n = 2 * w->maxBlocks;
+            long *o = (long *)realloc(w->offsets, n * sizeof(long));
+            char **f = (o == NULL) ? NULL :
+                       (char **)realloc(w->firsts, n * sizeof(char *));
+            if (o != NULL)
+                w->offsets = o;
+            if (f == NULL) {
+                w->ok = false;
+                return;
+            }
+            w->firsts = f;
+            w->maxBlocks = n;
+        }
+        if ((w->firsts[w->nblocks] = strdup(key)) == NULL) {
+            w->ok = false;
+            return;
+        }
+        w->offsets[w->nblocks++] = w->blockStart = w->off;
+    }
+    len[0] = strlen(key);
+    len[1] = (value == NULL) ? TOMBSTONE : strlen(value);
+    tw_write(w, len, 8);
+    tw_write(w, key, len[0]);
+    if (value != NULL)
+        tw_write(w, value, len[1]);
+    bloomAdd(w->bloom, w->bits, key);
+}
+
+/*
+ * writes the index, filter and footer, syncs the file, and opens it
+ *
+ * returns the table, or NULL if errors, in which case the file is removed
+ */
+static Table *tw_end(LData *ld, TWriter *w) {
+    char buf[strlen(ld->dir) + 32];
+    uint64_t footer[4], n = w->nblocks, bits = w->bits;
+    Table *t = NULL;
+    long i;
+
+    footer[0] = w->off;
+    tw_write(w, &n, 8);
+    for (i = 0L; i < w->nblocks; i++) {
+        uint64_t off = w->offsets[i];
+        uint32_t klen = strlen(w->firsts[i]);
+        tw_write(w, &off, 8);
+        tw_write(w, &klen, 4);
+        tw_write(w, w->firsts[i], klen);
+    }
+    footer[1] = w->off;
+    tw_write(w, &bits, 8);
+    tw_write(w, w->bloom, (w->bits + 7) / 8);
+    footer[2] = 0;
+    footer[3] = MAGIC;
+    tw_write(w, footer, FOOTER);
+    if (w->ok)
+        w->ok = writeAll(w->fd, w->buf, w->fill) && fdatasync(w->fd) == 0;
+    if (w->fd >= 0)
+        close(w->fd);
+    if (w->ok)
+        t = openTable(ld, w->num);
+    if (t == NULL && w->fd >= 0) {
+        path(ld, buf, w->num, "sst");
+        unlink(buf);
+    }
+    for (i = 0L; i < w->nblocks; i++)
+        free(w->firsts[i]);
+    free(w->firsts);
+    free(w->offsets);
+    free(w->bloom);
+    free(w->buf);
+    return t;
+}
+
+static int entryCmp(const void *p1, const void *p2) {
+    return strcmp((*(MEntry **)p1)->key, (*(MEntry **)p2)->key);
+}
+
+/*
+ * writes memtable m as SSTable `num'; returns it, or NULL if errors
+ */
+static Table *writeMemtable(LData *ld, const CSKMap *m, long num) {
+    MEntry **entries;
+    TWriter w;
+    long n, i;
+
+    if ((entries = m->entryArray(m, &n)) == NULL)
+        return NULL;
+    qsort(entries, n, sizeof(MEntry *), entryCmp);
+    if (tw_begin(ld, &w, num, n))
+        for (i = 0L; i < n; i++)
+            tw_add(&w, entries[i]->key, (entries[i]->value == tombstone) ?
+                                        NULL : (char *)entries[i]->value);
+    free(entries);
+    return tw_end(ld, &w);
+}
+
+/*
+ * an Iterator over the records of a table in order, for merging; each
+ * element is an MEntry whose key and value (NULL if removed) are heap
+ * copies, which the consumer frees
+ *
+ * NB - a read error ends the iteration early, and sets `failed'
+ */
+typedef struct scan {
+    Table *t;
+    long block;                 /* next block to read */
+    char *buf;
+    long len;
+    long pos;
+    bool *failed;
+} Scan;
+
+static bool loadBlock(Scan *s) {
+    long len;
+    char *tmp;
+
+    while (s->pos >= s->len) {
+        if (s->block >= s->t->nblocks)
+            return false;
+        len = s->t->offsets[s->block + 1] - s->t->offsets[s->block];
+        if ((tmp = (char *)realloc(s->buf, len)) == NULL ||
+            ! readAll(s->t->fd, (s->buf = tmp), len,
+                      s->t->offsets[s->block])) {
+            *s->failed = true;
+            return false;
+        }
+        s->block++;
+        s->len = len;
+        s->pos = 0L;
+    }
+    return true;
+}
+
+static bool s_hasNext(const Iterator *it) {
+    return loadBlock((Scan *)(it->self));
+}
+
+static bool s_next(const Iterator *it, void **element) {
+    Scan *s = (Scan *)(it->self);
+    MEntry *e;
+    uint32_t kl, vl;
+    char *p;
+
+    if (! loadBlock(s))
+        return false;
+    p = s->buf + s->pos;
+    memcpy(&kl, p, 4);
+    memcpy(&vl, p + 4, 4);
+    if ((e = (MEntry *)malloc(sizeof(MEntry))) == NULL ||
+        (e->key = strndup(p + 8, kl)) == NULL) {
+        free(e);
+        *s->failed = true;
+        return false;
+    }
+    e->value = NULL;
+    if (vl != TOMBSTONE && (e->value = strndup(p + 8 + kl, vl)) == NULL) {
+        free(e->key);
+        free(e);
+        *s->failed = true;
+        return false;
+    }
+    s->pos += 8 + kl + ((vl == TOMBSTONE) ? 0 : vl);
+    *element = e;
+    return true;
+}
+
+static long s_nextBatch(const Iterator *it, void **buf, long n) {
+    long i;
+
+    for (i = 0L; i < n && s_next(it, buf + i); i++)
+        ;
+    return i;
+}
+
+static void s_destroy(const Iterator *it) {
+    Scan *s = (Scan *)(it->self);
+    free(s->buf);
+    free(s);
+    free((void *)it);
+}
+
+static Iterator scanTemplate = {
+    NULL, s_hasNext, s_next, s_nextBatch, s_destroy
+};
+
+static const Iterator *scanCreate(Table *t, bool *failed) {
+    Iterator *it = (Iterator *)malloc(sizeof(Iterator));
+    Scan *s = (Scan *)calloc(1, sizeof(Scan));
+
+    if (it == NULL || s == NULL) {
+        free(s);
+        free(it);
+        return NULL;
+    }
+    s->t = t;
+    s->failed = failed;
+    *it = scanTemplate;
+    it->self = s;
+    return it;
+}
+
+static int mentryCmp(void *p1, void *p2) {
+    return strcmp(((MEntry *)p1)->key, ((MEntry *)p2)->key);
+}
+
+/*
+ * merges tables t[0 .. n-1], newest first, into a new SSTable numbered
+ * `num'; for a key in several tables, the newest record is kept; removed
+ * keys are dropped if `dropRemoved'
+ *
+ * returns the new table, or NULL if errors
+ */
+static Table *mergeTables(LData *ld, Table **t, long n, long num,
+                          bool dropRemoved) {
+    const Iterator **sources = (const Iterator **)calloc(n,
+                                                   sizeof(Iterator *));
+    const Iterator *it = NULL;
+    bool failed = false;
+    char *last = NULL;
+    long i, keys = 0L;
+    TWriter w;
+    Table *result = NULL;
+    MEntry *e;
+
+    if (sources == NULL)
+        return NULL;
+    for (i = 0L; i < n; i++) {
+        keys += t[i]->bits / BLOOM_BITS;
+        if ((sources[i] = scanCreate(t[i], &failed)) == NULL)
+            goto done;
+    }
+    if ((it = MergeIterator(mentryCmp, sources, n)) == NULL)
+        goto done;
+    if (! tw_begin(ld, &w, num, keys)) {
+        (void)tw_end(ld, &w);
+        goto done;
+    }
+    while (it->next(it, (void **)&e)) {
+        if (last != NULL && strcmp(last, e->key) == 0) {    /* older */
+            free(e->key);
+        } else {
+            if (e->value != NULL || ! dropRemoved)
+                tw_add(&w, e->key, e->value);
+            free(last);
+            last = e->key;
+        }
+        free(e->value);
+        free(e);
+    }
+    free(last);
+    if (failed)
+        w.ok = false;
+    result = tw_end(ld, &w);
+done:
+    if (it != NULL)
+        it->destroy(it);
+    else
+        for (i = 0L; i < n; i++)
+            if (sources[i] != NULL)
+                sources[i]->destroy(sources[i]);
+    free(sources);
+    return result;
+}
+
+/*
+ * ---------------- the manifest and the log ----------------
+ */
+
+/*
+ * writes the manifest for the current table list; called with the lock
+ */
+static bool writeManifest(LData *ld) {
+    char tmp[strlen(ld->dir) + 32], name[strlen(ld->dir) + 32];
+    FILE *fp;
+    long i;
+    bool ok;
+
+    sprintf(tmp, "%s/MANIFEST.tmp", ld->dir);
+    sprintf(name, "%s/MANIFEST", ld->dir);
+    if ((fp = fopen(tmp, "w")) == NULL)
+        return false;
+    fprintf(fp, "%ld\n", ld->nextNum);
+    for (i = 0L; i < ld->ntables; i++)
+        fprintf(fp, "%ld\n", ld->tables[i]->num);
+    ok = (fflush(fp) == 0 && fsync(fileno(fp)) == 0);
+    ok = (fclose(fp) == 0) && ok;
+    if (ok && rename(tmp, name) == 0) {
+        syncDir(ld);
+        return true;
+    }
+    unlink(tmp);
+    return false;
+}
+
+/*
+ * replaces tables[at .. at+n-1] by t (if not NULL); called with the lock
+ */
+static bool install(LData *ld, long at, long n, Table *t) {
+    long delta = (t != NULL) - n;
+
+    if (ld->ntables + delta > ld->maxTables) {
+        long cap = 2 * ld->maxTables;
+        Table **tmp = (Table **)realloc(ld->tables, cap * sizeof(Table *));
+        if (tmp == NULL)
+            return false;
+        ld->tables = tmp;
+        ld->maxTables = cap;
+    }
+    memmove(ld->tables + at + n + delta, ld->tables + at + n,
+            (ld->ntables - at - n) * sizeof(Table *));
+    ld->ntables += delta;
+    if (t != NULL)
+        ld->tables[at] = t;
+    return true;
+}
+
+/*
+ * appends a log record for (key, value) to buf, which has room for it; a
+ * NULL value records a removal
+ */
+static long logRecord(char *buf, char *key, char *value) {
+    uint32_t kl = strlen(key), vl = (value == NULL) ? TOMBSTONE
+                                                    : strlen(value), check;
+    long len = 8 + kl + ((value == NULL) ? 0 : vl);
+
+    memcpy(buf, &kl, 4);
+    memcpy(buf + 4, &vl, 4);
+    memcpy(buf + 8, key, kl);
+    if (value != NULL)
+        memcpy(buf + 8 + kl, value, vl);
+    check = (uint32_t)hash64(buf, len);
+    memcpy(buf + len, &check, 4);
+    return len + 4;
+}
+
+/*
+ * applies (key, value) to memtable m; called with the lock
+ */
+static bool apply(LData *ld, const CSKMap *m, char *key, char *value) {
+    char *v = (value == NULL) ? tombstone : strdup(value);
+
+    if (v == NULL || ! m->put(m, key, v)) {
+        freeValue(v);
+        return false;
+    }
+    ld->used += strlen(key) + ((value == NULL) ? 0 : strlen(value)) +
+                ENTRY_OVERHEAD;
+    return true;
+}
+
+/*
+ * applies the log records in buf[0 .. len-1] to the memtable, in order; a
+ * torn or corrupt record ends the records; called with the lock
+ */
+static bool applyRecords(LData *ld, char *buf, long len) {
+    char *p, *end;
+
+    for (p = buf, end = buf + len; p + 12 <= end; ) {
+        uint32_t kl, vl, check;
+        long n;
+        char *key, *value = NULL;
+        bool ok;
+
+        memcpy(&kl, p, 4);
+        memcpy(&vl, p + 4, 4);
+        n = 8L + kl + ((vl == TOMBSTONE) ? 0L : (long)vl);
+        if (n + 4 > end - p)
+            break;
+        memcpy(&check, p + n, 4);
+        if (check != (uint32_t)hash64(p, n))
+            break;
+        key = strndup(p + 8, kl);
+        if (vl != TOMBSTONE)
+            value = strndup(p + 8 + kl, vl);
+        ok = (key != NULL && (vl == TOMBSTONE || value != NULL) &&
+              apply(ld, ld->mem, key, value));
+        free(key);
+        free(value);
+        if (! ok)
+            return false;
+        p += n + 4;
+    }
+    return true;
+}
+
+/*
+ * replays log `num' into the memtable; a torn or corrupt final record
+ * ends the replay
+ */
+static bool replay(LData *ld, long num) {
+    char name[strlen(ld->dir) + 32], *buf;
+    struct stat st;
+    bool ok;
+    int fd;
+
+    path(ld, name, num, "log");
+    if ((fd = open(name, O_RDONLY)) < 0)
+        return false;
+    if (fstat(fd, &st) < 0 || (buf = (char *)malloc(st.st_size + 1)) == NULL) {
+        close(fd);
+        return false;
+    }
+    if (st.st_size > 0 && ! readAll(fd, buf, st.st_size, 0)) {
+        free(buf);
+        close(fd);
+        return false;
+    }
+    close(fd);
+    ok = applyRecords(ld, buf, st.st_size);
+    free(buf);
+    return ok;
+}
+
+/*
+ * freezes the memtable and starts a new log, waiting first for the
+ * previous memtable to be written and for the log to be durable; called
+ * with the lock
+ */
+static bool rotate(LData *ld) {
+    char name[strlen(ld->dir) + 32];
+    const CSKMap *m;
+    int fd;
+
+    while (! ld->failed &&
+           (ld->imm != NULL || ld->writing || ld->pendLen > 0L ||
+            ld->ntables > MAX_TABLES))
+        pthread_cond_wait(&ld->cond, &ld->lock);
+    if (ld->failed)
+        return false;
+    if ((m = ld->mem->create(ld->mem)) == NULL)
+        return false;
+    path(ld, name, ld->nextNum, "log");
+    if ((fd = open(name, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0) {
+        m->destroy(m);
+        return false;
+    }
+    syncDir(ld);
+    close(ld->logFd);
+    ld->logFd = fd;
+    ld->immLog = ld->logNum;
+    ld->logNum = ld->nextNum++;
+    ld->imm = ld->mem;
+    ld->mem = m;
+    ld->used = 0L;
+    pthread_cond_broadcast(&ld->cond);
+    return true;
+}
+
+/*
+ * logs (key, value), and applies it once the record is durable
+ */
+static bool update(LData *ld, char *key, char *value) {
+    long need = 12L + strlen(key) + ((value == NULL) ? 0L : strlen(value));
+    long end;
+    bool ok;
+
+    pthread_mutex_lock(&ld->lock);
+    while (! ld->failed && ld->used >= ld->memBytes)
+        if (ld->imm == NULL && ! ld->writing && ld->pendLen == 0L) {
+            if (! rotate(ld))
+                break;
+        } else
+            pthread_cond_wait(&ld->cond, &ld->lock);
+    if (ld->failed) {
+        pthread_mutex_unlock(&ld->lock);
+        return false;
+    }
+    if (ld->pendLen + need > ld->pendCap) {
+        long cap = 2 * (ld->pendLen + need);
+        char *tmp = (char *)realloc(ld->pend, cap);
+        if (tmp == NULL) {
+            pthread_mutex_unlock(&ld->lock);
+            return false;
+        }
+        ld->pend = tmp;
+        ld->pendCap = cap;
+    }
+    ld->pendLen += logRecord(ld->pend + ld->pendLen, key, value);
+    ld->appended += need;
+    end = ld->appended;
+    while (! ld->failed && ld->durable < end) {
+        if (ld->writing) {
+            pthread_cond_wait(&ld->cond, &ld->lock);
+            continue;
+        }
+        /* lead a group commit of everything pending */
+        char *buf = ld->pend;
+        long len = ld->pendLen, cap = ld->pendCap, upto = ld->appended;
+        ld->pend = ld->spare;
+        ld->pendCap = ld->spareCap;
+        ld->pendLen = 0L;
+        ld->writing = true;
+        pthread_mutex_unlock(&ld->lock);
+        ok = writeAll(ld->logFd, buf, len) && fdatasync(ld->logFd) == 0;
+        pthread_mutex_lock(&ld->lock);
+        /* rotate() waits for this write, so the records belong to mem */
+        ok = ok && applyRecords(ld, buf, len);
+        ld->spare = buf;
+        ld->spareCap = cap;
+        ld->writing = false;
+        if (ok)
+            ld->durable = upto;
+        else
+            ld->failed = true;
+        pthread_cond_broadcast(&ld->cond);
+    }
+    ok = (ld->durable >= end);
+    pthread_mutex_unlock(&ld->lock);
+    return ok;
+}
+
+/*
+ * ---------------- the flusher and the merger ----------------
+ */
+
+static int tier(LData *ld, Table *t) {
+    long size = ld->memBytes;
+    int n = 0;
+
+    while (t->bytes > size) {
+        size *= 4;
+        n++;
+    }
+    return n;
+}
+
+/*
+ * returns the number of newest tables to merge, or 0; called with the lock
+ */
+static long pickMerge(LData *ld, bool all) {
+    long n;
+    int t;
+
+    if (all)
+        return ld->ntables;
+    if (ld->ntables < TIER_RUN)
+        return 0L;
+    t = tier(ld, ld->tables[TIER_RUN - 1]);
+    for (n = 0L; n < TIER_RUN; n++)
+        if (tier(ld, ld->tables[n]) != t)
+            return 0L;
+    while (n < ld->ntables && tier(ld, ld->tables[n]) == t)
+        n++;
+    return n;
+}
+
+/*
+ * writes the frozen memtable as an SSTable, then drops it and its log;
+ * called with the lock, which is released while writing
+ */
+static void flush(LData *ld) {
+    char name[strlen(ld->dir) + 32];
+    long num = ld->nextNum++;
+    Table *t;
+
+    pthread_mutex_unlock(&ld->lock);
+    t = writeMemtable(ld, ld->imm, num);
+    pthread_mutex_lock(&ld->lock);
+    if (t == NULL || ! install(ld, 0L, 0L, t)) {
+        ld->failed = true;
+        if (t != NULL) {
+            t->obsolete = true;
+            unref(ld, t);
+        }
+        return;
+    }
+    /* if the manifest cannot be written, the log is kept for replay */
+    if (writeManifest(ld)) {
+        path(ld, name, ld->immLog, "log");
+        unlink(name);
+    } else
+        ld->failed = true;
+    ld->imm->destroy(ld->imm);
+    ld->imm = NULL;
+}
+
+/*
+ * merges the newest n tables into one; called with the lock, which is
+ * released while merging; tables flushed meanwhile go in front of them
+ */
+static void merge(LData *ld, long n) {
+    Table **old = (Table **)malloc(n * sizeof(Table *)), *t;
+    long num = ld->nextNum++, before = ld->ntables, at, i;
+    bool drop = (n == ld->ntables);
+
+    if (old == NULL) {
+        ld->failed = true;
+        return;
+    }
+    memcpy(old, ld->tables, n * sizeof(Table *));
+    pthread_mutex_unlock(&ld->lock);
+    t = mergeTables(ld, old, n, num, drop);
+    pthread_mutex_lock(&ld->lock);
+    at = ld->ntables - before;
+    if (t == NULL || ! install(ld, at, n, t)) {
+        ld->failed = true;
+        if (t != NULL) {
+            t->obsolete = true;
+            unref(ld, t);
+        }
+    } else {
+        /* if the manifest cannot be written, it still lists old[] */
+        bool ok = writeManifest(ld);
+        for (i = 0L; i < n; i++) {
+            old[i]->obsolete = ok;
+            unref(ld, old[i]);
+        }
+        if (! ok)
+            ld->failed = true;
+    }
+    free(old);
+}
+
+static void *flushWork(void *arg) {
+    LData *ld = (LData *)arg;
+
+    pthread_mutex_lock(&ld->lock);
+    while (! ld->failed) {
+        if (ld->imm != NULL)
+            flush(ld);
+        else if (ld->stopping)
+            break;
+        else {
+            pthread_cond_wait(&ld->cond, &ld->lock);
+            continue;
+        }
+        pthread_cond_broadcast(&ld->cond);
+    }
+    pthread_cond_broadcast(&ld->cond);
+    pthread_mutex_unlock(&ld->lock);
+    return NULL;
+}
+
+static void *mergeWork(void *arg) {
+    LData *ld = (LData *)arg;
+
+    pthread_mutex_lock(&ld->lock);
+    while (! ld->failed) {
+        bool all = (ld->compactDone < ld->compactWanted);
+        long n, want = ld->compactWanted;
+
+        if (all && ld->imm != NULL) {       /* compact() includes imm */
+            pthread_cond_wait(&ld->cond, &ld->lock);
+            continue;
+        }
+        if ((n = pickMerge(ld, all)) > 1L || (all && n == 1L)) {
+            merge(ld, n);
+            if (all)
+                ld->compactDone = want;
+        } else if (all) {
+            ld->compactDone = want;
+        } else if (ld->stopping) {
+            break;
+        } else {
+            pthread_cond_wait(&ld->cond, &ld->lock);
+            continue;
+        }
+        pthread_cond_broadcast(&ld->cond);
+    }
+    pthread_cond_broadcast(&ld->cond);
+    pthread_mutex_unlock(&ld->lock);
+    return NULL;
+}
+
+/*
+ * ---------------- the store ----------------
+ */
+
+/*
+ * returns the storage of the store's data to the heap; the flusher and the
+ * merger have stopped, or were never started
+ */
+static void freeData(LData *ld) {
+    long i;
+
+    for (i = 0L; i < ld->ntables; i++)
+        unref(ld, ld->tables[i]);
+    if (ld->logFd >= 0)
+        close(ld->logFd);
+    if (ld->mem != NULL)
+        ld->mem->destroy(ld->mem);
+    if (ld->imm != NULL)
+        ld->imm->destroy(ld->imm);
+    pthread_mutex_destroy(&ld->lock);
+    pthread_cond_destroy(&ld->cond);
+    free(ld->tables);
+    free(ld->pend);
+    free(ld->spare);
+    free(ld->dir);
+    free(ld);
+}
+
+static bool l_close(const LSMStore *s) {
+    LData *ld = (LData *)s->self;
+    char name[strlen(ld->dir) + 32];
+    bool ok = true;
+
+    pthread_mutex_lock(&ld->lock);
+    if (! ld->failed && ! ld->mem->isEmpty(ld->mem))
+        ok = rotate(ld);
+    ld->stopping = true;
+    pthread_cond_broadcast(&ld->cond);
+    pthread_mutex_unlock(&ld->lock);
+    pthread_join(ld->flusher, NULL);
+    pthread_join(ld->merger, NULL);
+    ok = ok && ! ld->failed;
+    if (ok) {                           /* the current log is empty */
+        path(ld, name, ld->logNum, "log");
+        unlink(name);
+    }
+    freeData(ld);
+    free((void *)s);
+    return ok;
+}
+
+static bool l_put(const LSMStore *s, char *key, char *value) {
+    return update((LData *)s->self, key, value);
+}
+
+static bool l_remove(const LSMStore *s, char *key) {
+    return update((LData *)s->self, key, NULL);
+}
+
+static bool l_get(const LSMStore *s, char *key, char **value) {
+    LData *ld = (LData *)s->self;
+    long n, i;
+    int r = 0;
+    void *v;
+
+    pthread_mutex_lock(&ld->lock);
+    if (ld->mem->get(ld->mem, key, &v) ||
+        (ld->imm != NULL && ld->imm->get(ld->imm, key, &v))) {
+        bool found = (v != tombstone && (*value = strdup((char *)v)) != NULL);
+        pthread_mutex_unlock(&ld->lock);
+        return found;
+    }
+    n = ld->ntables;
+    Table *snap[(n > 0L) ? n : 1L];
+    for (i = 0L; i < n; i++) {
+        snap[i] = ld->tables[i];
+        atomic_fetch_add(&snap[i]->refs, 1L);
+    }
+    pthread_mutex_unlock(&ld->lock);
+    for (i = 0L; i < n && r == 0; i++)
+        r = tableGet(snap[i], key, value);
+    for (i = 0L; i < n; i++)
+        unref(ld, snap[i]);
+    return (r == 1);
+}
+
+static bool l_compact(const LSMStore *s) {
+    LData *ld = (LData *)s->self;
+    bool ok = true;
+    long want;
+
+    pthread_mutex_lock(&ld->lock);
+    if (! ld->failed && ! ld->mem->isEmpty(ld->mem))
+        ok = rotate(ld);
+    want = ++ld->compactWanted;
+    pthread_cond_broadcast(&ld->cond);
+    while (! ld->failed && (ld->compactDone < want || ld->imm != NULL))
+        pthread_cond_wait(&ld->cond, &ld->lock);
+    ok = ok && ! ld->failed;
+    pthread_mutex_unlock(&ld->lock);
+    return ok;
+}
+
+static long l_tables(const LSMStore *s, long *bytes) {
+    LData *ld = (LData *)s->self;
+    long n, i;
+
+    pthread_mutex_lock(&ld->lock);
+    n = ld->ntables;
+    for (*bytes = 0L, i = 0L; i < n; i++)
+        *bytes += ld->tables[i]->bytes;
+    pthread_mutex_unlock(&ld->lock);
+    return n;
+}
+
+static LSMStore template = {
+    NULL, l_close, l_put, l_remove, l_get, l_compact, l_tables
+};
+
+static int longCmp(const void *p1, const void *p2) {
+    long a = *(long *)p1, b = *(long *)p2;
+
+    return (a < b) ? -1 : (a > b);
+}
+
+/*
+ * reads the manifest, if any, opening the tables it lists
+ *
+ * returns false if the manifest names a table that cannot be opened
+ */
+static bool readManifest(LData *ld) {
+    char name[strlen(ld->dir) + 32];
+    FILE *fp;
+    long num;
+    bool ok = true;
+
+    sprintf(name, "%s/MANIFEST", ld->dir);
+    if ((fp = fopen(name, "r")) == NULL)
+        return true;
+    if (fscanf(fp, "%ld", &ld->nextNum) != 1)
+        ok = false;
+    while (ok && fscanf(fp, "%ld", &num) == 1) {
+        Table *t = openTable(ld, num);
+        ok = (t != NULL && install(ld, ld->ntables, 0L, t));
+    }
+    fclose(fp);
+    return ok;
+}
+
+/*
+ * removes SSTables that the manifest does not list, left by a merge or
+ * flush that did not finish, and replays the logs, oldest first, writing
+ * what they held as an SSTable
+ */
+static bool recover(LData *ld) {
+    char name[strlen(ld->dir) + 32];
+    long *logs = NULL, nlogs = 0L, i;
+    DIR *d = opendir(ld->dir);
+    struct dirent *de;
+    bool ok = true;
+
+    if (d == NULL)
+        return false;
+    while (ok && (de = readdir(d)) != NULL) {
+        char *end;
+        long num = strtol(de->d_name, &end, 10), j;
+        bool listed = false;
+
+        if (end == de->d_name)
+            continue;
+        if (num >= ld->nextNum)
+            ld->nextNum = num + 1;
+        if (strcmp(end, ".log") == 0) {
+            long *tmp = (long *)realloc(logs, (nlogs + 1) * sizeof(long));
+            if ((ok = (tmp != NULL)))
+                (logs = tmp)[nlogs++] = num;
+        } else if (strcmp(end, ".sst") == 0) {
+            for (j = 0L; j < ld->ntables; j++)
+                listed = listed || (ld->tables[j]->num == num);
+            if (! listed) {
+                path(ld, name, num, "sst");
+                unlink(name);
+            }
+        }
+    }
+    closedir(d);
+    if (nlogs > 0L)
+        qsort(logs, nlogs, sizeof(long), longCmp);
+    for (i = 0L; ok && i < nlogs; i++)
+        ok = replay(ld, logs[i]);
+    if (ok && ! ld->mem->isEmpty(ld->mem)) {
+        Table *t = writeMemtable(ld, ld->mem, ld->nextNum++);
+        ok = (t != NULL && install(ld, 0L, 0L, t));
+        if (! ok && t != NULL) {
+            t->obsolete = true;
+            unref(ld, t);
+        }
+        ld->mem->clear(ld->mem);
+        ld->used = 0L;
+    }
+    ok = ok && writeManifest(ld);
+    for (i = 0L; ok && i < nlogs; i++) {
+        path(ld, name, logs[i], "log");
+        unlink(name);
+    }
+    free(logs);
+    return ok;
+}
+
+const LSMStore *LSMStore_create(const char *dir, long memtableBytes) {
+    LSMStore *s = (LSMStore *)malloc(sizeof(LSMStore));
+    LData *ld = (LData *)calloc(1, sizeof(LData));
+    char name[strlen(dir) + 32];
+
+    if (s == NULL || ld == NULL) {
+        free(ld);
+        free(s);
+        return NULL;
+    }
+    pthread_mutex_init(&ld->lock, NULL);
+    pthread_cond_init(&ld->cond, NULL);
+    ld->logFd = -1;
+    ld->memBytes = (memtableBytes > 0L) ? memtableBytes : DEFAULT_MEMTABLE;
+    ld->maxTables = 16L;
+    ld->dir = strdup(dir);
+    ld->tables = (Table **)malloc(ld->maxTables * sizeof(Table *));
+    ld->mem = HashCSKMap(0L, 0.0, freeValue);
+    if (ld->dir == NULL || ld->tables == NULL || ld->mem == NULL ||
+        (mkdir(dir, 0755) < 0 && access(dir, W_OK) < 0) ||
+        ! readManifest(ld) || ! recover(ld))
+        goto fail;
+    ld->logNum = ld->nextNum++;
+    path(ld, name, ld->logNum, "log");
+    if ((ld->logFd = open(name, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0)
+        goto fail;
+    syncDir(ld);
+    if (pthread_create(&ld->flusher, NULL, flushWork, ld) != 0) {
+        unlink(name);
+        goto fail;
+    }
+    if (pthread_create(&ld->merger, NULL, mergeWork, ld) != 0) {
+        pthread_mutex_lock(&ld->lock);
+        ld->stopping = true;
+        pthread_cond_broadcast(&ld->cond);
+        pthread_mutex_unlock(&ld->lock);
+        pthread_join(ld->flusher, NULL);
+        unlink(name);
+        goto fail;
+    }
+    *s = template;
+    s->self = ld;
+    return s;
+fail:
+    freeData(ld);
+    free(s);
+    return NULL;
+}
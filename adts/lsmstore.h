@@ -0,0 +1,133 @@
+#ifndef _LSMSTORE_H_
+#define _LSMSTORE_H_
+
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * interface definition for an embedded, log-structured store of C string
+ * keys and C string values, kept in a directory of the local file system
+ *
+ * put() and remove() append a record to a write-ahead log and, once it is
+ * durable, apply it to the memtable, a CSKMap; concurrent writers share
+ * each write and fdatasync() of the log (group commit), so a put() returns
+ * only once its record is durable, and writes cost about one sequential
+ * append; get() never returns a write that a crash could lose
+ *
+ * a full memtable is frozen and written by a flusher thread as an SSTable:
+ * an immutable file of sorted data blocks, followed by an index of the
+ * first key of each block and a Bloom filter of its keys; the index and
+ * filter of every SSTable are kept in memory, so get() reads at most one
+ * block from each SSTable whose filter admits the key, usually none or one
+ *
+ * once there are more than a few SSTables, a merger thread merges them
+ * into one, dropping overwritten values and removed keys; memtables are
+ * flushed while a merge is in progress
+ *
+ * a store's methods may be called from any number of threads at once; a
+ * directory must be opened by only one store at a time
+ */
+
+#include "ADTs/ADTdefs.h"
+
+typedef struct lsmstore LSMStore;               /* forward reference */
+
+/*
+ * open the store in directory `dir', creating the directory if needed;
+ * SSTables listed in its manifest are reopened, and any write-ahead logs
+ * left by a store that was not closed are replayed
+ *
+ * memtableBytes is roughly the memory the memtable may use before it is
+ * written as an SSTable; if <= 0L, 4 MB is used
+ *
+ * returns a pointer to the store, or NULL if the directory cannot be used,
+ * if I/O or malloc errors, or if the threads cannot be started
+ */
+const LSMStore *LSMStore_create(const char *dir, long memtableBytes);
+
+/*
+ * now define dispatch table
+ */
+struct lsmstore {
+/*
+ * the private data of the store
+ */
+    void *self;
+
+/*
+ * waits for the flusher and the merger to finish, writes the memtable as an SSTable, and
+ * returns the storage associated with the store to the heap
+ *
+ * returns true if everything was written, false if I/O errors; in the
+ * latter case, the write-ahead log is kept, and is replayed on reopening
+ */
+    bool (*close)(const LSMStore *s);
+
+/*
+ * associates a copy of `value' with a copy of `key', durably
+ *
+ * returns true if successful, false if I/O or malloc errors
+ */
+    bool (*put)(const LSMStore *s, char *key, char *value);
+
+/*
+ * removes any value associated with `key', durably
+ *
+ * returns true if successful, false if I/O or malloc errors; removing a
+ * key that is not present succeeds
+ */
+    bool (*remove)(const LSMStore *s, char *key);
+
+/*
+ * returns in `*value' a copy of the value associated with `key'
+ *
+ * returns true if key was found, false if not, or if I/O or malloc errors
+ *
+ * NB - the caller is responsible for freeing the copy when finished with it
+ */
+    bool (*get)(const LSMStore *s, char *key, char **value);
+
+/*
+ * writes the memtable as an SSTable, then merges all of the SSTables into
+ * one, and waits for both to finish
+ *
+ * returns true if successful, false if I/O or malloc errors
+ */
+    bool (*compact)(const LSMStore *s);
+
+/*
+ * returns the number of SSTables, and the number of bytes in them in
+ * `*bytes'
+ */
+    long (*tables)(const LSMStore *s, long *bytes);
+};
+
+#endif /* _LSMSTORE_H_ */
@@ -0,0 +1,255 @@
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * implementation of an iterator that merges sorted sources
+ *
+ * tree[1 .. k-1] are the internal nodes of a complete binary tree whose
+ * leaves, k .. 2k-1, are the sources 0 .. k-1; each internal node holds
+ * the source that lost the match played there, and tree[0] holds the
+ * overall winner, whose current element is the next to be yielded
+ *
+ * a source that is exhausted loses every match, so the merge is over once
+ * the winner is exhausted
+ */
+
+#include "ADTs/mergeiterator.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define BATCH 32L               /* elements taken from an iterator at once */
+
+typedef struct source {
+    void *head;                 /* current element, if live */
+    const Iterator *it;         /* NULL if an array */
+    void **elements;            /* buf, or the array */
+    long pos;                   /* next element in elements[] */
+    long len;
+    bool live;                  /* false once exhausted */
+} Source;
+
+typedef struct m_data {
+    int (*cmp)(void*, void*);
+    long k;
+    Source *src;
+    long *tree;
+    void **bufs;                /* BATCH for each iterator; NULL if arrays */
+} MData;
+
+/*
+ * returns true if source a's element should be yielded before source b's
+ */
+static bool beats(MData *md, long a, long b) {
+    int c;
+
+    if (! md->src[b].live)
+        return true;
+    if (! md->src[a].live)
+        return false;
+    c = (*md->cmp)(md->src[a].head, md->src[b].head);
+    return (c < 0 || (c == 0 && a < b));
+}
+
+/*
+ * moves source s on to its next element
+ */
+static void advance(Source *s) {
+    if (++s->pos >= s->len && s->it != NULL) {
+        s->len = s->it->nextBatch(s->it, s->elements, BATCH);
+        s->pos = 0L;
+    }
+    if ((s->live = (s->pos < s->len)))
+        s->head = s->elements[s->pos];
+}
+
+/*
+ * plays the matches from source w's leaf to the root
+ */
+static void replay(MData *md, long w) {
+    long n;
+
+    for (n = (w + md->k) / 2; n > 0L; n /= 2)
+        if (beats(md, md->tree[n], w)) {
+            long t = md->tree[n];
+            md->tree[n] = w;
+            w = t;
+        }
+    md->tree[0] = w;
+}
+
+static bool m_hasNext(const Iterator *it) {
+    MData *md = (MData *)(it->self);
+    return (md->k > 0L && md->src[md->tree[0]].live);
+}
+
+static bool m_next(const Iterator *it, void **element) {
+    MData *md = (MData *)(it->self);
+    Source *s;
+    long w;
+
+    if (md->k == 0L || ! md->src[(w = md->tree[0])].live)
+        return false;
+    s = &md->src[w];
+    *element = s->head;
+    advance(s);
+    replay(md, w);
+    return true;
+}
+
+static long m_nextBatch(const Iterator *it, void **buf, long n) {
+    long i;
+
+    for (i = 0L; i < n && m_next(it, buf + i); i++)
+        ;
+    return i;
+}
+
+static void purge(MData *md) {
+    long i;
+
+    for (i = 0L; i < md->k; i++)
+        if (md->src[i].it != NULL)
+            md->src[i].it->destroy(md->src[i].it);
+}
+
+static void m_destroy(const Iterator *it) {
+    MData *md = (MData *)(it->self);
+    purge(md);
+    free(md->src);
+    free(md->tree);
+    free(md->bufs);
+    free(md);
+    free((void *)it);
+}
+
+static Iterator template = {
+    NULL, m_hasNext, m_next, m_nextBatch, m_destroy
+};
+
+/*
+ * allocates the iterator for k sources, with batch buffers if `batches',
+ * and in `*win' the scratch space for build(); the caller fills in
+ * md->src[]
+ */
+static Iterator *newIterator(int (*cmp)(void*, void*), long k, bool batches,
+                             long **win) {
+    long n = (k > 0L) ? k : 1L;
+    Iterator *it = (Iterator *)malloc(sizeof(Iterator));
+    MData *md = (MData *)malloc(sizeof(MData));
+    Source *src = (Source *)calloc(n, sizeof(Source));
+    long *tree = (long *)malloc(n * sizeof(long));
+    void **bufs = NULL;
+
+    if (batches)
+        bufs = (void **)malloc(n * BATCH * sizeof(void *));
+    *win = (long *)malloc(2 * n * sizeof(long));
+    if (it == NULL || md == NULL || src == NULL || tree == NULL ||
+        (batches && bufs == NULL) || *win == NULL) {
+        free(*win);
+        free(bufs);
+        free(tree);
+        free(src);
+        free(md);
+        free(it);
+        return NULL;
+    }
+    md->cmp = cmp;
+    md->k = k;
+    md->src = src;
+    md->tree = tree;
+    md->bufs = bufs;
+    *it = template;
+    it->self = md;
+    return it;
+}
+
+/*
+ * plays the initial tournament, bottom up; win[] holds the winner of
+ * each match until the match above it is played, and is then freed
+ */
+static void build(MData *md, long *win) {
+    long k = md->k, n;
+
+    for (n = 0L; n < k; n++)
+        win[k + n] = n;
+    for (n = k - 1; n > 0L; n--) {
+        long a = win[2 * n], b = win[2 * n + 1];
+        if (beats(md, a, b)) {
+            win[n] = a;
+            md->tree[n] = b;
+        } else {
+            win[n] = b;
+            md->tree[n] = a;
+        }
+    }
+    md->tree[0] = (k > 1L) ? win[1] : 0L;
+    free(win);
+}
+
+const Iterator *MergeIterator(int (*cmp)(void*, void*),
+                              const Iterator *sources[], long k) {
+    long i, *win;
+    Iterator *it = newIterator(cmp, k, true, &win);
+    MData *md;
+
+    if (it == NULL)
+        return NULL;
+    md = (MData *)(it->self);
+    for (i = 0L; i < k; i++) {
+        Source *s = &md->src[i];
+        s->it = sources[i];
+        s->elements = md->bufs + i * BATCH;
+        s->pos = -1L;           /* so that advance() takes a batch */
+        advance(s);
+    }
+    build(md, win);
+    return it;
+}
+
+const Iterator *MergeIterator_arrays(int (*cmp)(void*, void*),
+                                     void **arrays[], long lens[], long k) {
+    long i, *win;
+    Iterator *it = newIterator(cmp, k, false, &win);
+    MData *md;
+
+    if (it == NULL)
+        return NULL;
+    md = (MData *)(it->self);
+    for (i = 0L; i < k; i++) {
+        Source *s = &md->src[i];
+        s->elements = arrays[i];
+        s->len = lens[i];
+        s->pos = -1L;           /* so that advance() takes arrays[i][0] */
+        advance(s);
+    }
+    build(md, win);
+    return it;
+}
@@ -0,0 +1,75 @@
+#ifndef _MERGEITERATOR_H_
+#define _MERGEITERATOR_H_
+
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ADTs/ADTdefs.h"
+#include "ADTs/iterator.h"
+
+/* constructors for an iterator that merges sorted sources */
+
+/* create an iterator that yields, in order, the elements of k sources,
+ * each of which yields its elements in ascending order according to cmp;
+ * elements that compare equal are yielded in source order, so the merge
+ * is stable
+ *
+ * the sources are held in a tournament (loser) tree: each internal node
+ * remembers the source that lost the match played there, so that after an
+ * element is yielded, only the matches on the path from its source to the
+ * root are replayed; this costs about log2(k) comparisons per element,
+ * and O(k) memory beyond the sources themselves
+ *
+ * elements are taken from the sources only as the merge needs them, a
+ * small batch at a time, so merging is streaming
+ *
+ * the cmp function pointer is applied to a pair of elements, yielding
+ * <0 | 0 | >0
+ *
+ * NB - if create is successful, the merge iterator assumes responsibility
+ *      for the iterators in sources[], i.e. its destroy() destroys them;
+ *      sources[] itself is copied
+ *
+ * returns pointer to iterator if successful, NULL otherwise
+ */
+const Iterator *MergeIterator(int (*cmp)(void*, void*),
+                              const Iterator *sources[], long k);
+
+/* as above, but the k sources are the sorted arrays arrays[0], arrays[1],
+ * ..., of lens[0], lens[1], ... elements, as returned by toArray()
+ *
+ * the arrays are not copied, and must not be changed or freed until the
+ * iterator has been destroyed; the iterator does not free them
+ */
+const Iterator *MergeIterator_arrays(int (*cmp)(void*, void*),
+                                     void **arrays[], long lens[], long k);
+
+#endif /* _MERGEITERATOR_H_ */
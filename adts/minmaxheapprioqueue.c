@@ -0,0 +1,495 @@
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * implementation for generic double-ended priority queue, for generic
+ * priorities, implemented using a min-max heap that expands when needed
+ *
+ * entries on even levels of the heap (the root is on level 0) are <= all of
+ * their descendants; entries on odd levels are >= all of their descendants;
+ * the minimum is thus at the root, and the maximum is one of its children
+ */
+
+#include "ADTs/minmaxheapprioqueue.h"
+#include <stdlib.h>
+
+#define DEFAULT_HEAP_SIZE 25
+
+typedef struct pqentry {
+    void *priority;
+    void *value;
+    long sequenceNo;
+} PQEntry;
+
+typedef struct pq_data {
+    int (*cmp)(void *p1, void *p2);
+    long sequenceNo;
+    long last;
+    long size;
+    PQEntry *heap;
+    void (*freePrio)(void *p);
+    void (*freeValue)(void *v);
+} PqData;
+
+/*
+ * helper function to perform comparisons
+ *
+ * in order to guarantee FIFO, we first compare priorities using cmp() - if
+ * that yields 0, then we return the difference in sequenceNo values
+ */
+static int realCmp(PqData *pqd, long i, long j) {
+    int ans;
+    PQEntry *p1 = &(pqd->heap[i]), *p2 = &(pqd->heap[j]);
+    if ((ans = pqd->cmp(p1->priority, p2->priority)) == 0)
+        ans =  (int)(p1->sequenceNo - p2->sequenceNo);
+    return ans;
+}
+
+static void swap(PqData *pqd, long i, long j) {
+    PQEntry hn = pqd->heap[i];
+    pqd->heap[i] = pqd->heap[j];
+    pqd->heap[j] = hn;
+}
+
+/*
+ * returns true if index i is on a min level of the heap
+ */
+static bool isMinLevel(long i) {
+    int level = 0;
+
+    while (i > 1) {
+        i /= 2;
+        level++;
+    }
+    return (level % 2 == 0);
+}
+
+/*
+ * traverses the heap, calling freeP on each priority and freeV on each entry
+ */
+static void purge(PqData *pqd) {
+    long i;
+
+    for (i = 1; i <= pqd->last; i++) {
+        pqd->freePrio(pqd->heap[i].priority);
+        pqd->freeValue(pqd->heap[i].value);
+    }
+}
+
+static void pq_destroy(const PrioQueue *pq) {
+    PqData *pqd = (PqData *)pq->self;
+    purge(pqd);
+    free(pqd->heap);
+    free(pqd);
+    free((void *)pq);
+}
+
+static void pq_clear(const PrioQueue *pq) {
+    PqData *pqd = (PqData *)pq->self;
+    purge(pqd);
+    pqd->last = 0L;
+}
+
+/*
+ * move the entry at i up through its grandparents; `sense' is -1 to move
+ * smaller entries up the min levels, +1 to move larger entries up the max
+ * levels
+ */
+static long bubbleUpLevels(PqData *pqd, long i, int sense) {
+    while (i > 3) {
+        long g = i / 4;
+        if (sense * realCmp(pqd, i, g) <= 0)
+            break;
+        swap(pqd, i, g);
+        i = g;
+    }
+    return i;
+}
+
+/*
+ *  the bubbleUp function restores the min-max heap property after the
+ *  entry at i has been added, or replaced by an entry that may be too
+ *  small or too large for its ancestors
+ *  returns the index at which the entry came to rest
+ */
+static long bubbleUp(PqData *pqd, long i) {
+    long p = i / 2;
+
+    if (i == 1)
+        return i;
+    if (isMinLevel(i)) {
+        if (realCmp(pqd, i, p) > 0) {
+            swap(pqd, i, p);
+            i = bubbleUpLevels(pqd, p, +1);
+        } else
+            i = bubbleUpLevels(pqd, i, -1);
+    } else {
+        if (realCmp(pqd, i, p) < 0) {
+            swap(pqd, i, p);
+            i = bubbleUpLevels(pqd, p, -1);
+        } else
+            i = bubbleUpLevels(pqd, i, +1);
+    }
+    return i;
+}
+
+/*
+ *  the trickleDown function restores the min-max heap property below i
+ *  after the entry at i has been replaced; `sense' is -1 if i is on a min
+ *  level, +1 if i is on a max level
+ */
+static void trickleDown(PqData *pqd, long i, int sense) {
+    for (;;) {
+        long c = 2 * i, m, j, end;
+
+        if (c > pqd->last)
+            break;
+        /* find the extreme entry among children and grandchildren */
+        m = c;
+        if (c + 1 <= pqd->last && sense * realCmp(pqd, c + 1, m) > 0)
+            m = c + 1;
+        end = 4 * i + 3;
+        if (end > pqd->last)
+            end = pqd->last;
+        for (j = 4 * i; j <= end; j++)
+            if (sense * realCmp(pqd, j, m) > 0)
+                m = j;
+        if (sense * realCmp(pqd, m, i) <= 0)
+            break;
+        swap(pqd, i, m);
+        if (m <= c + 1)                 /* a child - nothing below it */
+            break;
+        if (sense * realCmp(pqd, m, m / 2) < 0)
+            swap(pqd, m, m / 2);
+        i = m;
+    }
+}
+
+/*
+ * restore the heap after the entry at i has been replaced by an arbitrary
+ * entry; whatever ends up at i once the new entry has moved up (the new
+ * entry itself, or an ancestor that has moved down) is then moved down
+ */
+static void fixAt(PqData *pqd, long i) {
+    (void)bubbleUp(pqd, i);
+    trickleDown(pqd, i, isMinLevel(i) ? -1 : +1);
+}
+
+static bool pq_insert(const PrioQueue *pq, void *priority, void *value) {
+    PqData *pqd = (PqData *)pq->self;
+    long i = pqd->last + 1;
+    bool status = (i < pqd->size);
+    
+    if (! status) {       /* need to resize the array */
+        size_t nbytes = (2 * pqd->size) * sizeof(PQEntry);
+        PQEntry *tmp = (PQEntry *)realloc(pqd->heap, nbytes);
+
+        if (tmp != NULL) {
+            status = true;
+            pqd->heap = tmp;
+            pqd->size *= 2;
+        }
+    }
+    if (status) {
+        pqd->heap[i].priority = priority;
+        pqd->heap[i].value = value;
+        pqd->heap[i].sequenceNo = pqd->sequenceNo++;
+        pqd->last = i;
+        (void)bubbleUp(pqd, i);
+    }
+    return status;
+}
+
+/*
+ * helper function to locate the maximum entry
+ */
+static long maxIndex(PqData *pqd) {
+    if (pqd->last < 3)
+        return pqd->last;
+    return (realCmp(pqd, 2, 3) >= 0) ? 2 : 3;
+}
+
+/*
+ * helper function to remove the entry at i, returning it in *e
+ */
+static void removeAt(PqData *pqd, long i, PQEntry *e) {
+    *e = pqd->heap[i];
+    pqd->heap[i] = pqd->heap[pqd->last];
+    pqd->last--;
+    if (i <= pqd->last)
+        fixAt(pqd, i);
+}
+
+static bool pq_min(const PrioQueue *pq, void **priority, void **value) {
+    PqData *pqd = (PqData *)pq->self;
+    bool status = (pqd->last > 0L);
+
+    if (status) {
+        *priority = (pqd->heap[1].priority);
+        *value = (pqd->heap[1].value);
+    }
+    return status;
+}
+
+static bool pq_removeMin(const PrioQueue *pq, void **priority, void **value) {
+    PqData *pqd = (PqData *)pq->self;
+    bool status = (pqd->last > 0L);
+
+    if (status) {
+        PQEntry e;
+        removeAt(pqd, 1L, &e);
+        *priority = e.priority;
+        *value = e.value;
+    }
+    return status;
+}
+
+static bool pq_max(const PrioQueue *pq, void **priority, void **value) {
+    PqData *pqd = (PqData *)pq->self;
+    bool status = (pqd->last > 0L);
+
+    if (status) {
+        long m = maxIndex(pqd);
+        *priority = (pqd->heap[m].priority);
+        *value = (pqd->heap[m].value);
+    }
+    return status;
+}
+
+static bool pq_removeMax(const PrioQueue *pq, void **priority, void **value) {
+    PqData *pqd = (PqData *)pq->self;
+    bool status = (pqd->last > 0L);
+
+    if (status) {
+        PQEntry e;
+        removeAt(pqd, maxIndex(pqd), &e);
+        *priority = e.priority;
+        *value = e.value;
+    }
+    return status;
+}
+
+static bool pq_changePriority(const PrioQueue *pq, void *value,
+                              void *priority) {
+    PqData *pqd = (PqData *)pq->self;
+    long i;
+
+    for (i = 1; i <= pqd->last; i++)
+        if (pqd->heap[i].value == value)
+            break;
+    if (i > pqd->last)
+        return false;
+    pqd->freePrio(pqd->heap[i].priority);
+    pqd->heap[i].priority = priority;
+    pqd->heap[i].sequenceNo = pqd->sequenceNo++;
+    fixAt(pqd, i);
+    return true;
+}
+
+/*
+ * helper function to merge by removing each entry of other and inserting
+ * it into pq; used when other is not a MinMaxHeapPrioQueue
+ */
+static bool mergeByRemoval(const PrioQueue *pq, const PrioQueue *other) {
+    void *priority, *value;
+
+    while (other->removeMin(other, &priority, &value))
+        if (! pq->insert(pq, priority, value)) {
+            (void)other->insert(other, priority, value);
+            return false;
+        }
+    return true;
+}
+
+static bool pq_merge(const PrioQueue *pq, const PrioQueue *other) {
+    PqData *pqd = (PqData *)pq->self;
+    PqData *opd = (PqData *)other->self;
+    long i, n, m, bits, size;
+
+    if (pq == other)
+        return true;
+    if (other->merge != pq->merge || opd->cmp != pqd->cmp)
+        return mergeByRemoval(pq, other);
+    n = pqd->last;
+    m = opd->last;
+    if (m == 0L)
+        return true;
+    for (size = pqd->size; size <= n + m; size *= 2)
+        ;
+    if (size != pqd->size) {
+        PQEntry *tmp = (PQEntry *)realloc(pqd->heap, size * sizeof(PQEntry));
+
+        if (tmp == NULL)
+            return false;
+        pqd->heap = tmp;
+        pqd->size = size;
+    }
+    /*
+     * other's entries follow pq's in FIFO order, so their sequence numbers
+     * are shifted past every number that pq has issued
+     */
+    for (i = 1; i <= m; i++) {
+        PQEntry e = opd->heap[i];
+        e.sequenceNo += pqd->sequenceNo;
+        pqd->heap[n + i] = e;
+    }
+    pqd->sequenceNo += opd->sequenceNo;
+    pqd->last = n + m;
+    opd->last = 0L;
+    /*
+     * m bubbleUps cost O(m log(n+m)); trickling down every internal node,
+     * from the last to the root, rebuilds the heap in O(n+m)
+     */
+    for (bits = 0, i = n + m; i > 1; i /= 2)
+        bits++;
+    if (m * bits > n + m)
+        for (i = pqd->last / 2; i >= 1; i--)
+            trickleDown(pqd, i, isMinLevel(i) ? -1 : +1);
+    else
+        for (i = n + 1; i <= n + m; i++)
+            (void)bubbleUp(pqd, i);
+    return true;
+}
+
+static long pq_size(const PrioQueue *pq) {
+    PqData *pqd = (PqData *)pq->self;
+    return pqd->last;
+}
+
+static bool pq_isEmpty(const PrioQueue *pq) {
+    PqData *pqd = (PqData *)pq->self;
+    return (pqd->last == 0L);
+}
+
+/*
+ * helper function to generate array of void *'s for toArray and itCreate
+ */
+static void **genArray(PqData *pqd) {
+    void **theArray = NULL;
+    if (pqd->last >0L) {
+        PqData npqd = *pqd;
+        PQEntry *tmp = (PQEntry *)malloc((pqd->last+1)*sizeof(PQEntry));
+        if (tmp != NULL) {
+            long i;
+            theArray = (void **)malloc(pqd->last*sizeof(void *));
+            if (theArray != NULL) {
+                for (i = 0; i < pqd->last + 1; i++)  /* copy the heap */
+                    tmp[i] = pqd->heap[i];
+                npqd.heap = tmp;
+                /* repeatedly remove the min element of the copy */
+                for (i = 0; i < pqd->last; i++) {
+                    PQEntry e;
+                    removeAt(&npqd, 1L, &e);
+                    theArray[i] = e.value;
+                }
+            }
+            free(tmp);
+        }
+    }
+    return theArray;
+}
+
+static void **pq_toArray(const PrioQueue *pq, long *len) {
+    PqData *pqd = (PqData *)pq->self;
+    void **tmp = genArray(pqd);
+    if (tmp != NULL)
+        *len = pqd->last;
+    return tmp;
+}
+
+static const Iterator *pq_itCreate(const PrioQueue *pq) {
+    PqData *pqd =(PqData *)pq->self;
+    const Iterator *it = NULL;
+    void **tmp = genArray(pqd);
+    if (tmp != NULL) {
+        it = Iterator_create(pqd->last, tmp);
+        if (it == NULL)
+            free(tmp);
+    }
+    return it;
+}
+
+static const PrioQueue *pq_create(const PrioQueue *pq);
+
+static PrioQueue template = {
+    NULL, pq_create, pq_destroy, pq_clear, pq_insert, pq_min, pq_removeMin,
+    pq_size, pq_isEmpty, pq_toArray, pq_itCreate, pq_changePriority,
+    pq_max, pq_removeMax, pq_merge
+};
+
+/*
+ * helper function to create a new Priority Queue dispatch table
+ */
+static const PrioQueue *newPrioQueue(int (*cmp)(void*, void*),
+                                     void (*freeP)(void*),
+                                     void (*freeV)(void*)) {
+    PrioQueue *pq = (PrioQueue *)malloc(sizeof(PrioQueue));
+
+    if (pq != NULL) {
+        PqData *pqd = (PqData *)malloc(sizeof(PqData));
+
+        if (pqd != NULL) {
+            PQEntry *p = (PQEntry *)malloc(DEFAULT_HEAP_SIZE * sizeof(PQEntry));
+
+            if (p != NULL) {
+                pqd->cmp = cmp;
+                pqd->sequenceNo = 0L;
+                pqd->size = DEFAULT_HEAP_SIZE;
+                pqd->last = 0L;
+                pqd->heap = p;
+                pqd->freePrio = freeP;
+                pqd->freeValue = freeV;
+                *pq = template;
+                pq->self = pqd;
+            } else {
+                free(pqd);
+                free(pq);
+                pq = NULL;
+            }
+        } else {
+            free(pq);
+            pq = NULL;
+        }
+    }
+    return pq;
+}
+
+static const PrioQueue *pq_create(const PrioQueue *pq) {
+    PqData *pqd = (PqData *)pq->self;
+
+    return newPrioQueue(pqd->cmp, pqd->freePrio, pqd->freeValue);
+}
+
+const PrioQueue *MinMaxHeapPrioQueue(int (*cmp)(void *p1, void *p2),
+                                     void (*freePrio)(void *prio),
+                                     void (*freeValue)(void *value)) {
+    return newPrioQueue(cmp, freePrio, freeValue);
+}
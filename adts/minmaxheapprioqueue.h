@@ -0,0 +1,58 @@
+#ifndef _MINMAXHEAPPRIOQUEUE_H_
+#define _MINMAXHEAPPRIOQUEUE_H_
+
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ADTs/ADTdefs.h"
+#include "ADTs/prioqueue.h"
+
+/* constructor for min-max heap priority queue */
+
+/* create a double-ended priority queue using a min-max heap; min(), max(),
+ * removeMin(), and removeMax() are all O(1) or O(log n), so a bounded
+ * queue can cheaply evict its largest element when it overflows
+ *
+ * cmp is a function pointer to a comparator function between two priorities
+ *
+ * freePrio is a function pointer that will be called by
+ * destroy() and clear() for the priority of each entry in the PrioQueue.
+ *
+ * freeValue is a function pointer that will be called by
+ * destroy() and clear() for the value of each entry in the PrioQueue.
+ *
+ * returns a pointer to the priority queue, or NULL if malloc errors */
+const PrioQueue *MinMaxHeapPrioQueue(int (*cmp)(void*, void*),
+                                     void (*freePrio)(void *prio),
+                                     void (*freeValue)(void *value)
+                                    );
+
+#endif /* _MINMAXHEAPPRIOQUEUE_H_ */
@@ -0,0 +1,492 @@
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * implementation for relaxed concurrent priority queue (a MultiQueue, after
+ * Rihani, Sanders and Dementiev)
+ *
+ * each shard is a HeapPrioQueue with its own spin lock, padded to a cache
+ * line so that threads working on different shards do not share lines;
+ * insert() and removeMin() only ever try-lock a shard, so a thread never
+ * waits for a lock while holding another, and the whole-queue methods,
+ * which lock every shard, take the locks in index order; merge(), which
+ * holds a shard of each queue at once, takes the two locks in address
+ * order, so that a.merge(b) and b.merge(a) cannot deadlock
+ */
+
+#include "ADTs/multiqueue.h"
+#include "ADTs/heapprioqueue.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <sched.h>
+#include <unistd.h>
+
+#define CACHE_LINE 64
+
+typedef struct shard {
+    atomic_flag lock;
+    const PrioQueue *heap;
+} __attribute__((aligned(CACHE_LINE))) Shard;
+
+typedef struct pq_data {
+    int (*cmp)(void *p1, void *p2);
+    long nshards;
+    Shard *shards;
+    atomic_long size;
+    void (*freePrio)(void *p);
+    void (*freeValue)(void *v);
+} PqData;
+
+static bool tryLock(Shard *s) {
+    return ! atomic_flag_test_and_set_explicit(&s->lock, memory_order_acquire);
+}
+
+static void lock(Shard *s) {
+    while (! tryLock(s))
+        sched_yield();
+}
+
+static void unlock(Shard *s) {
+    atomic_flag_clear_explicit(&s->lock, memory_order_release);
+}
+
+/*
+ * helper function to lock two shards, in address order
+ */
+static void lockPair(Shard *a, Shard *b) {
+    if ((uintptr_t)a > (uintptr_t)b) {
+        Shard *t = a;
+
+        a = b;
+        b = t;
+    }
+    lock(a);
+    lock(b);
+}
+
+static void lockAll(PqData *pqd) {
+    long i;
+
+    for (i = 0; i < pqd->nshards; i++)
+        lock(&pqd->shards[i]);
+}
+
+static void unlockAll(PqData *pqd) {
+    long i;
+
+    for (i = 0; i < pqd->nshards; i++)
+        unlock(&pqd->shards[i]);
+}
+
+/*
+ * helper function to pick a shard at random, using a per-thread xorshift
+ * generator
+ */
+static long randomShard(PqData *pqd) {
+    static __thread uint64_t seed = 0;
+    uint64_t x;
+
+    if (seed == 0)
+        seed = (uint64_t)(uintptr_t)&x | 1U;
+    x = seed;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    seed = x;
+    return (long)(x % (uint64_t)pqd->nshards);
+}
+
+/*
+ * helper function called after a failed try-lock; once as many shards as
+ * there are have been found busy, their holders may have been preempted,
+ * so give up the CPU
+ */
+static void backoff(PqData *pqd, long *busy) {
+    if (++(*busy) % pqd->nshards == 0)
+        sched_yield();
+}
+
+static void pq_destroy(const PrioQueue *pq) {
+    PqData *pqd = (PqData *)pq->self;
+    long i;
+
+    for (i = 0; i < pqd->nshards; i++)
+        pqd->shards[i].heap->destroy(pqd->shards[i].heap);
+    free(pqd->shards);
+    free(pqd);
+    free((void *)pq);
+}
+
+static void pq_clear(const PrioQueue *pq) {
+    PqData *pqd = (PqData *)pq->self;
+    long i;
+
+    lockAll(pqd);
+    for (i = 0; i < pqd->nshards; i++) {
+        const PrioQueue *h = pqd->shards[i].heap;
+        atomic_fetch_sub(&pqd->size, h->size(h));
+        h->clear(h);
+    }
+    unlockAll(pqd);
+}
+
+static bool pq_insert(const PrioQueue *pq, void *priority, void *value) {
+    PqData *pqd = (PqData *)pq->self;
+    Shard *s;
+    bool status;
+    long busy = 0L;
+
+    while (! tryLock(s = &pqd->shards[randomShard(pqd)]))
+        backoff(pqd, &busy);
+    status = s->heap->insert(s->heap, priority, value);
+    unlock(s);
+    if (status)
+        atomic_fetch_add(&pqd->size, 1L);
+    return status;
+}
+
+/*
+ * helper function to find the shard holding the overall minimum (sense
+ * -1) or maximum (sense +1); must be called with every shard locked
+ *
+ * returns the shard, or NULL if every shard is empty
+ */
+static Shard *extremeShard(PqData *pqd, int sense) {
+    Shard *best = NULL;
+    void *bestPrio = NULL, *prio, *value;
+    long i;
+
+    for (i = 0; i < pqd->nshards; i++) {
+        Shard *s = &pqd->shards[i];
+        bool found = (sense < 0) ? s->heap->min(s->heap, &prio, &value)
+                                 : s->heap->max(s->heap, &prio, &value);
+        if (found &&
+            (best == NULL || sense * pqd->cmp(prio, bestPrio) > 0)) {
+            best = s;
+            bestPrio = prio;
+        }
+    }
+    return best;
+}
+
+static bool pq_min(const PrioQueue *pq, void **priority, void **value) {
+    PqData *pqd = (PqData *)pq->self;
+    Shard *s;
+
+    lockAll(pqd);
+    if ((s = extremeShard(pqd, -1)) != NULL)
+        (void)s->heap->min(s->heap, priority, value);
+    unlockAll(pqd);
+    return (s != NULL);
+}
+
+/*
+ * two-choice deletion: lock two random shards and remove the smaller of
+ * their minima; if either is busy, or both are empty, try another pair;
+ * after finding as many empty pairs as there are shards, sweep every
+ * shard in turn
+ */
+static bool pq_removeMin(const PrioQueue *pq, void **priority, void **value) {
+    PqData *pqd = (PqData *)pq->self;
+    long tries, i, busy = 0L;
+
+    for (tries = 0; tries < pqd->nshards; ) {
+        Shard *a = &pqd->shards[randomShard(pqd)];
+        Shard *b = &pqd->shards[randomShard(pqd)];
+        void *pa, *pb, *v;
+        bool ha, hb;
+
+        if (atomic_load(&pqd->size) <= 0L)
+            return false;
+        if (! tryLock(a)) {
+            backoff(pqd, &busy);
+            continue;
+        }
+        if (b != a && ! tryLock(b)) {
+            unlock(a);
+            backoff(pqd, &busy);
+            continue;
+        }
+        ha = a->heap->min(a->heap, &pa, &v);
+        hb = (b != a) && b->heap->min(b->heap, &pb, &v);
+        if (hb && (! ha || pqd->cmp(pb, pa) < 0)) {
+            Shard *t = a;       /* remove from b instead */
+            a = b;
+            b = t;
+        }
+        if (b != a)
+            unlock(b);
+        if (ha || hb) {
+            (void)a->heap->removeMin(a->heap, priority, value);
+            unlock(a);
+            atomic_fetch_sub(&pqd->size, 1L);
+            return true;
+        }
+        unlock(a);
+        tries++;
+    }
+    for (i = 0; i < pqd->nshards; i++) {
+        Shard *s = &pqd->shards[i];
+        bool status;
+
+        lock(s);
+        status = s->heap->removeMin(s->heap, priority, value);
+        unlock(s);
+        if (status) {
+            atomic_fetch_sub(&pqd->size, 1L);
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool pq_max(const PrioQueue *pq, void **priority, void **value) {
+    PqData *pqd = (PqData *)pq->self;
+    Shard *s;
+
+    lockAll(pqd);
+    if ((s = extremeShard(pqd, +1)) != NULL)
+        (void)s->heap->max(s->heap, priority, value);
+    unlockAll(pqd);
+    return (s != NULL);
+}
+
+static bool pq_removeMax(const PrioQueue *pq, void **priority, void **value) {
+    PqData *pqd = (PqData *)pq->self;
+    Shard *s;
+
+    lockAll(pqd);
+    if ((s = extremeShard(pqd, +1)) != NULL) {
+        (void)s->heap->removeMax(s->heap, priority, value);
+        atomic_fetch_sub(&pqd->size, 1L);
+    }
+    unlockAll(pqd);
+    return (s != NULL);
+}
+
+static bool pq_changePriority(const PrioQueue *pq, void *value,
+                              void *priority) {
+    PqData *pqd = (PqData *)pq->self;
+    bool status = false;
+    long i;
+
+    for (i = 0; ! status && i < pqd->nshards; i++) {
+        Shard *s = &pqd->shards[i];
+        lock(s);
+        status = s->heap->changePriority(s->heap, value, priority);
+        unlock(s);
+    }
+    return status;
+}
+
+static bool pq_merge(const PrioQueue *pq, const PrioQueue *other) {
+    PqData *pqd = (PqData *)pq->self;
+    void *priority, *value;
+
+    if (pq == other)
+        return true;
+    if (other->merge == pq->merge) {    /* spread other's shards over pq's */
+        PqData *opd = (PqData *)other->self;
+        bool status = true;
+        long i;
+
+        for (i = 0; status && i < opd->nshards; i++) {
+            Shard *s = &pqd->shards[i % pqd->nshards];
+            Shard *o = &opd->shards[i];
+            long n;
+
+            lockPair(s, o);
+            n = o->heap->size(o->heap);
+            status = s->heap->merge(s->heap, o->heap);
+            if (status) {
+                atomic_fetch_add(&pqd->size, n);
+                atomic_fetch_sub(&opd->size, n);
+            }
+            unlock(s);
+            unlock(o);
+        }
+        return status;
+    }
+    while (other->removeMin(other, &priority, &value)) {
+        if (! pq_insert(pq, priority, value)) {
+            (void)other->insert(other, priority, value);
+            return false;
+        }
+    }
+    return true;
+}
+
+static long pq_size(const PrioQueue *pq) {
+    PqData *pqd = (PqData *)pq->self;
+    long n = atomic_load(&pqd->size);
+
+    return (n < 0L) ? 0L : n;
+}
+
+static bool pq_isEmpty(const PrioQueue *pq) {
+    return (pq_size(pq) == 0L);
+}
+
+/*
+ * helper function to generate array of void *'s for toArray and itCreate
+ *
+ * every shard is emptied, in its own priority order, into a pair of
+ * arrays, from which a temporary heap yields the values in overall
+ * priority order; each shard is then refilled from its part of the
+ * arrays, which cannot fail, since its heap already had room for them
+ */
+static void **genArray(PqData *pqd, long *len) {
+    void **theArray = NULL, **prios, **values;
+    long i, j, n;
+
+    lockAll(pqd);
+    for (i = 0, n = 0L; i < pqd->nshards; i++)
+        n += pqd->shards[i].heap->size(pqd->shards[i].heap);
+    prios = (void **)malloc((n + 1) * sizeof(void *));
+    values = (void **)malloc((n + 1) * sizeof(void *));
+    if (n > 0L && prios != NULL && values != NULL) {
+        const PrioQueue *all;
+        long *counts = (long *)malloc(pqd->nshards * sizeof(long));
+
+        if (counts != NULL) {
+            for (i = 0, j = 0; i < pqd->nshards; i++) {
+                const PrioQueue *h = pqd->shards[i].heap;
+                counts[i] = 0L;
+                while (h->removeMin(h, &prios[j], &values[j])) {
+                    j++;
+                    counts[i]++;
+                }
+            }
+            all = BulkHeapPrioQueue(pqd->cmp, doNothing, doNothing,
+                                    prios, values, j);
+            if (all != NULL) {
+                theArray = all->toArray(all, len);
+                all->destroy(all);
+            }
+            for (i = 0, j = 0; i < pqd->nshards; i++) {
+                const PrioQueue *h = pqd->shards[i].heap;
+                long k;
+                for (k = 0; k < counts[i]; k++, j++)
+                    (void)h->insert(h, prios[j], values[j]);
+            }
+            free(counts);
+        }
+    }
+    unlockAll(pqd);
+    free(prios);
+    free(values);
+    return theArray;
+}
+
+static void **pq_toArray(const PrioQueue *pq, long *len) {
+    PqData *pqd = (PqData *)pq->self;
+
+    return genArray(pqd, len);
+}
+
+static const Iterator *pq_itCreate(const PrioQueue *pq) {
+    PqData *pqd = (PqData *)pq->self;
+    const Iterator *it = NULL;
+    long len;
+    void **tmp = genArray(pqd, &len);
+
+    if (tmp != NULL) {
+        it = Iterator_create(len, tmp);
+        if (it == NULL)
+            free(tmp);
+    }
+    return it;
+}
+
+static const PrioQueue *pq_create(const PrioQueue *pq);
+
+static PrioQueue template = {
+    NULL, pq_create, pq_destroy, pq_clear, pq_insert, pq_min, pq_removeMin,
+    pq_size, pq_isEmpty, pq_toArray, pq_itCreate, pq_changePriority,
+    pq_max, pq_removeMax, pq_merge
+};
+
+/*
+ * helper function to create a new Priority Queue dispatch table
+ */
+static const PrioQueue *newPrioQueue(long nshards, int (*cmp)(void*, void*),
+                                     void (*freeP)(void*),
+                                     void (*freeV)(void*)) {
+    PrioQueue *pq = (PrioQueue *)malloc(sizeof(PrioQueue));
+    PqData *pqd = (PqData *)malloc(sizeof(PqData));
+    Shard *shards = NULL;
+    long i = 0L;
+
+    if (nshards <= 0L)
+        nshards = 2L * sysconf(_SC_NPROCESSORS_ONLN);
+    if (nshards <= 0L)
+        nshards = 1L;
+    if (pq != NULL && pqd != NULL &&
+        posix_memalign((void **)&shards, CACHE_LINE,
+                       nshards * sizeof(Shard)) == 0) {
+        for (i = 0; i < nshards; i++) {
+            atomic_flag_clear(&shards[i].lock);
+            if ((shards[i].heap = HeapPrioQueue(cmp, freeP, freeV)) == NULL)
+                break;
+        }
+    }
+    if (shards == NULL || i < nshards) {
+        while (--i >= 0)
+            shards[i].heap->destroy(shards[i].heap);
+        free(shards);
+        free(pqd);
+        free(pq);
+        return NULL;
+    }
+    pqd->cmp = cmp;
+    pqd->nshards = nshards;
+    pqd->shards = shards;
+    atomic_init(&pqd->size, 0L);
+    pqd->freePrio = freeP;
+    pqd->freeValue = freeV;
+    *pq = template;
+    pq->self = pqd;
+    return pq;
+}
+
+static const PrioQueue *pq_create(const PrioQueue *pq) {
+    PqData *pqd = (PqData *)pq->self;
+
+    return newPrioQueue(pqd->nshards, pqd->cmp, pqd->freePrio,
+                        pqd->freeValue);
+}
+
+const PrioQueue *MultiQueue(long shards, int (*cmp)(void *p1, void *p2),
+                            void (*freePrio)(void *prio),
+                            void (*freeValue)(void *value)) {
+    return newPrioQueue(shards, cmp, freePrio, freeValue);
+}
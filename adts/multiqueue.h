@@ -0,0 +1,63 @@
+#ifndef _MULTIQUEUE_H_
+#define _MULTIQUEUE_H_
+
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ADTs/ADTdefs.h"
+#include "ADTs/prioqueue.h"
+
+/* constructor for relaxed concurrent priority queue */
+
+/* create a MultiQueue: a priority queue that may be used by many threads
+ * at once without external locking, built from `shards' heaps, each with
+ * its own lock; insert() adds to a random shard, and removeMin() locks two
+ * random shards and removes the smaller of their two minima
+ *
+ * the ordering is relaxed: removeMin() does not always return the
+ * minimum; the rank of the entry it returns (0 for the true minimum) is
+ * O(shards) in expectation, with an exponentially small chance of a rank
+ * much larger than that; entries with equal priorities are not FIFO
+ * unless shards is 1, in which case the queue behaves exactly like a
+ * HeapPrioQueue
+ *
+ * shards is the number of heaps; if <= 0, twice the number of online CPUs
+ * is used
+ *
+ * cmp, freePrio, and freeValue are as for HeapPrioQueue()
+ *
+ * returns a pointer to the priority queue, or NULL if malloc errors */
+const PrioQueue *MultiQueue(long shards, int (*cmp)(void*, void*),
+                            void (*freePrio)(void *prio),
+                            void (*freeValue)(void *value)
+                           );
+
+#endif /* _MULTIQUEUE_H_ */
@@ -0,0 +1,366 @@
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * implementation of the data-parallel array operations
+ *
+ * an operation is planned as a number of chunks: every chunk but the
+ * first starts on a cache line boundary of the array being written, and
+ * each holds at least MIN_CHUNK elements, so that the cost of a task is
+ * amortized; the chunks are then handed to parallelFor() with a grain
+ * of one chunk
+ *
+ * per-chunk results (partial reductions, filter counts) are kept in
+ * slots that are each a cache line long, so that threads finishing
+ * neighbouring chunks do not write to the same line
+ */
+
+#include "ADTs/parallel.h"
+#include <stdlib.h>
+#include <stdint.h>
+
+#define CACHE_LINE 64
+#define LINE_ELEMENTS ((long)(CACHE_LINE / sizeof(void *)))
+#define MIN_CHUNK 4096L         /* smallest chunk worth a task */
+#define CHUNKS_PER_WORKER 4L
+
+typedef struct slot {
+    long count;
+    void *value;
+} __attribute__((aligned(CACHE_LINE))) Slot;
+
+typedef struct job {
+    void **in;
+    void **out;
+    long n;
+    long chunk;                 /* elements per chunk */
+    long skew;                  /* elements before the first line boundary */
+    long nchunks;
+    void (*each)(void *e, void *arg);
+    void *(*map)(void *e, void *arg);
+    bool (*pred)(void *e, void *arg);
+    void *(*combine)(void *x, void *y, void *arg);
+    void *arg;
+    void *identity;
+    Slot *slots;
+} Job;
+
+/*
+ * decides how to split the n elements of `aligned'; if the work is not
+ * worth splitting, there is a single chunk
+ */
+static void plan(Job *j, const ThreadPool *tp, void **aligned) {
+    long per;
+
+    j->skew = ((uintptr_t)aligned % CACHE_LINE) / sizeof(void *);
+    j->chunk = j->n + j->skew;
+    j->nchunks = 1L;
+    if (tp == NULL || j->n < 2 * MIN_CHUNK)
+        return;
+    per = (j->n + j->skew) / (CHUNKS_PER_WORKER * tp->size(tp)) + 1;
+    if (per < MIN_CHUNK)
+        per = MIN_CHUNK;
+    per = (per + LINE_ELEMENTS - 1) / LINE_ELEMENTS * LINE_ELEMENTS;
+    j->chunk = per;
+    j->nchunks = (j->n + j->skew + per - 1) / per;
+}
+
+/*
+ * allocates one slot per chunk, falling back to a single chunk and the
+ * caller's slot if malloc fails
+ */
+static void allocSlots(Job *j, Slot *one) {
+    void *tmp;
+
+    j->slots = one;
+    if (j->nchunks == 1L)
+        return;
+    if (posix_memalign(&tmp, CACHE_LINE, j->nchunks * sizeof(Slot)) == 0)
+        j->slots = (Slot *)tmp;
+    else {
+        j->chunk = j->n + j->skew;
+        j->nchunks = 1L;
+    }
+}
+
+static void freeSlots(Job *j, Slot *one) {
+    if (j->slots != one)
+        free(j->slots);
+}
+
+static void bounds(Job *j, long c, long *lo, long *hi) {
+    long l = c * j->chunk - j->skew;
+    long h = l + j->chunk;
+
+    *lo = (l < 0L) ? 0L : l;
+    *hi = (h > j->n) ? j->n : h;
+}
+
+/*
+ * calls body() for every chunk, in parallel if there is more than one
+ */
+static void run(const ThreadPool *tp, Job *j,
+                void (*body)(long lo, long hi, void *arg)) {
+    if (j->nchunks == 1L)
+        body(0L, 1L, j);
+    else
+        tp->parallelFor(tp, 0L, j->nchunks, 1L, body, j);
+}
+
+static void eachBody(long c, long last, void *arg) {
+    Job *j = (Job *)arg;
+
+    for (; c < last; c++) {
+        long i, lo, hi;
+
+        bounds(j, c, &lo, &hi);
+        for (i = lo; i < hi; i++)
+            j->each(j->in[i], j->arg);
+    }
+}
+
+void Parallel_forEach(const ThreadPool *tp, void **a, long n,
+                      void (*fxn)(void *e, void *arg), void *arg) {
+    Job j;
+
+    j.in = a;
+    j.n = n;
+    j.each = fxn;
+    j.arg = arg;
+    plan(&j, tp, a);
+    run(tp, &j, eachBody);
+}
+
+static void mapBody(long c, long last, void *arg) {
+    Job *j = (Job *)arg;
+
+    for (; c < last; c++) {
+        long i, lo, hi;
+
+        bounds(j, c, &lo, &hi);
+        for (i = lo; i < hi; i++)
+            j->out[i] = j->map(j->in[i], j->arg);
+    }
+}
+
+void Parallel_map(const ThreadPool *tp, void **in, void **out, long n,
+                  void *(*fxn)(void *e, void *arg), void *arg) {
+    Job j;
+
+    j.in = in;
+    j.out = out;
+    j.n = n;
+    j.map = fxn;
+    j.arg = arg;
+    plan(&j, tp, out);
+    run(tp, &j, mapBody);
+}
+
+static void countBody(long c, long last, void *arg) {
+    Job *j = (Job *)arg;
+
+    for (; c < last; c++) {
+        long i, lo, hi, count = 0L;
+
+        bounds(j, c, &lo, &hi);
+        for (i = lo; i < hi; i++)
+            if (j->pred(j->in[i], j->arg))
+                count++;
+        j->slots[c].count = count;
+    }
+}
+
+static void copyBody(long c, long last, void *arg) {
+    Job *j = (Job *)arg;
+
+    for (; c < last; c++) {
+        long i, lo, hi, k = j->slots[c].count;
+
+        bounds(j, c, &lo, &hi);
+        for (i = lo; i < hi; i++)
+            if (j->pred(j->in[i], j->arg))
+                j->out[k++] = j->in[i];
+    }
+}
+
+/*
+ * the predicate is evaluated twice per element when there is more than
+ * one chunk: once to count each chunk's survivors, so that the chunks'
+ * offsets in `out' are known, and again to copy them
+ */
+long Parallel_filter(const ThreadPool *tp, void **in, void **out, long n,
+                     bool (*pred)(void *e, void *arg), void *arg) {
+    Job j;
+    Slot one;
+    long c, total = 0L;
+
+    j.in = in;
+    j.out = out;
+    j.n = n;
+    j.pred = pred;
+    j.arg = arg;
+    plan(&j, tp, in);
+    allocSlots(&j, &one);
+    if (j.nchunks == 1L) {
+        long i;
+
+        for (i = 0; i < n; i++)
+            if (pred(in[i], arg))
+                out[total++] = in[i];
+        return total;
+    }
+    run(tp, &j, countBody);
+    for (c = 0; c < j.nchunks; c++) {
+        long count = j.slots[c].count;
+
+        j.slots[c].count = total;
+        total += count;
+    }
+    run(tp, &j, copyBody);
+    freeSlots(&j, &one);
+    return total;
+}
+
+void *Parallel_sumLong(void *x, void *y, void *arg) {
+    (void)arg;
+    return (void *)((unsigned long)x + (unsigned long)y);
+}
+
+void *Parallel_minLong(void *x, void *y, void *arg) {
+    (void)arg;
+    return ((long)y < (long)x) ? y : x;
+}
+
+void *Parallel_maxLong(void *x, void *y, void *arg) {
+    (void)arg;
+    return ((long)y > (long)x) ? y : x;
+}
+
+/*
+ * reductions of a[lo, hi) for the known combine functions; the loops
+ * have no calls and no early exits, and keep four independent
+ * accumulators, so that the compiler can vectorize them (or at least
+ * overlap the additions) at -O2; sums are accumulated unsigned, so that
+ * overflow wraps instead of being undefined
+ */
+static long sumLong(void **a, long lo, long hi) {
+    unsigned long s0 = 0UL, s1 = 0UL, s2 = 0UL, s3 = 0UL;
+    long i;
+
+    for (i = lo; i + 4 <= hi; i += 4) {
+        s0 += (unsigned long)a[i];
+        s1 += (unsigned long)a[i + 1];
+        s2 += (unsigned long)a[i + 2];
+        s3 += (unsigned long)a[i + 3];
+    }
+    for (; i < hi; i++)
+        s0 += (unsigned long)a[i];
+    return (long)((s0 + s1) + (s2 + s3));
+}
+
+#define MIN(x, y) (((y) < (x)) ? (y) : (x))
+#define MAX(x, y) (((y) > (x)) ? (y) : (x))
+
+static long minLong(void **a, long lo, long hi, long m) {
+    long i, m0 = m, m1 = m, m2 = m, m3 = m;
+
+    for (i = lo; i + 4 <= hi; i += 4) {
+        m0 = MIN(m0, (long)a[i]);
+        m1 = MIN(m1, (long)a[i + 1]);
+        m2 = MIN(m2, (long)a[i + 2]);
+        m3 = MIN(m3, (long)a[i + 3]);
+    }
+    for (; i < hi; i++)
+        m0 = MIN(m0, (long)a[i]);
+    m0 = MIN(m0, m1);
+    m2 = MIN(m2, m3);
+    return MIN(m0, m2);
+}
+
+static long maxLong(void **a, long lo, long hi, long m) {
+    long i, m0 = m, m1 = m, m2 = m, m3 = m;
+
+    for (i = lo; i + 4 <= hi; i += 4) {
+        m0 = MAX(m0, (long)a[i]);
+        m1 = MAX(m1, (long)a[i + 1]);
+        m2 = MAX(m2, (long)a[i + 2]);
+        m3 = MAX(m3, (long)a[i + 3]);
+    }
+    for (; i < hi; i++)
+        m0 = MAX(m0, (long)a[i]);
+    m0 = MAX(m0, m1);
+    m2 = MAX(m2, m3);
+    return MAX(m0, m2);
+}
+
+static void reduceBody(long c, long last, void *arg) {
+    Job *j = (Job *)arg;
+
+    for (; c < last; c++) {
+        long i, lo, hi;
+        void *acc = j->identity;
+
+        bounds(j, c, &lo, &hi);
+        if (j->combine == Parallel_sumLong)
+            acc = (void *)((long)acc + sumLong(j->in, lo, hi));
+        else if (j->combine == Parallel_minLong)
+            acc = (void *)minLong(j->in, lo, hi, (long)acc);
+        else if (j->combine == Parallel_maxLong)
+            acc = (void *)maxLong(j->in, lo, hi, (long)acc);
+        else
+            for (i = lo; i < hi; i++)
+                acc = j->combine(acc, j->in[i], j->arg);
+        j->slots[c].value = acc;
+    }
+}
+
+void *Parallel_reduce(const ThreadPool *tp, void **a, long n, void *identity,
+                      void *(*combine)(void *x, void *y, void *arg),
+                      void *arg) {
+    Job j;
+    Slot one;
+    void *result;
+    long c;
+
+    j.in = a;
+    j.n = n;
+    j.combine = combine;
+    j.arg = arg;
+    j.identity = identity;
+    plan(&j, tp, a);
+    allocSlots(&j, &one);
+    run(tp, &j, reduceBody);
+    result = j.slots[0].value;
+    for (c = 1; c < j.nchunks; c++)
+        result = combine(result, j.slots[c].value, arg);
+    freeSlots(&j, &one);
+    return result;
+}
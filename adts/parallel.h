@@ -0,0 +1,97 @@
+#ifndef _PARALLEL_H_
+#define _PARALLEL_H_
+
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * data-parallel operations over arrays of void * elements, such as the
+ * arrays returned by every ADT's toArray() method
+ *
+ * the array is cut into chunks whose boundaries fall on cache line
+ * boundaries, so that no two threads write to the same cache line, and
+ * the chunks are run on a ThreadPool; if `tp' is NULL, or the array is
+ * too short to be worth splitting, the calling thread does all of the work
+ *
+ * `fxn', `pred' and `combine' may be called from several threads at once
+ */
+
+#include "ADTs/ADTdefs.h"
+#include "ADTs/threadpool.h"
+
+/*
+ * calls fxn(a[i], arg) for every i in [0, n)
+ */
+void Parallel_forEach(const ThreadPool *tp, void **a, long n,
+                      void (*fxn)(void *e, void *arg), void *arg);
+
+/*
+ * sets out[i] = fxn(in[i], arg) for every i in [0, n); `out' may be `in'
+ */
+void Parallel_map(const ThreadPool *tp, void **in, void **out, long n,
+                  void *(*fxn)(void *e, void *arg), void *arg);
+
+/*
+ * copies the elements of in[0, n) for which pred(e, arg) is true to the
+ * start of `out', in their original order; `out' must not overlap `in'
+ *
+ * returns the number of elements copied
+ */
+long Parallel_filter(const ThreadPool *tp, void **in, void **out, long n,
+                     bool (*pred)(void *e, void *arg), void *arg);
+
+/*
+ * combines the elements of a[0, n), starting from `identity', with
+ * combine(x, y, arg); combine() must be associative, with `identity' as
+ * its identity, since each chunk is reduced separately and the chunk
+ * results are then combined in order
+ *
+ * returns the result, which is `identity' if n is 0
+ */
+void *Parallel_reduce(const ThreadPool *tp, void **a, long n, void *identity,
+                      void *(*combine)(void *x, void *y, void *arg),
+                      void *arg);
+
+/*
+ * combine functions for elements that are longs (stored with ADT_VALUE);
+ * Parallel_reduce() recognizes these and reduces each chunk with a loop
+ * that the compiler can vectorize, without a call per element
+ *
+ * identities: 0L for sum, LONG_MAX for min, LONG_MIN for max
+ *
+ * a sum that overflows wraps modulo 2^64, as unsigned arithmetic does,
+ * whatever the order in which the chunks are added
+ */
+void *Parallel_sumLong(void *x, void *y, void *arg);
+void *Parallel_minLong(void *x, void *y, void *arg);
+void *Parallel_maxLong(void *x, void *y, void *arg);
+
+#endif /* _PARALLEL_H_ */
@@ -116,6 +116,40 @@ struct prioqueue {
  *
  * returns pointer to the Iterator or NULL if malloc failure */
     const Iterator *(*itCreate)(const PrioQueue *pq);
+
+/* changes the priority of the element whose value is `value' (compared by
+ * pointer equality) to `priority', as if the element had been removed and
+ * re-inserted with the new priority;
+ * applies the constructor-specified freePrio to the old priority
+ *
+ * returns true if successful, false if value is not in the priority queue */
+    bool (*changePriority)(const PrioQueue *pq, void *value, void *priority);
+
+/* returns the maximum element's priority in *priority, value *value;
+ * of elements with equal priorities, the most recently inserted is maximum
+ *
+ * returns true if successful, false if the priority queue is empty */
+    bool (*max)(const PrioQueue *pq, void **priority, void **value);
+
+/* removes the maximum element of the priority queue
+ *
+ * returns the value in *value
+ * returns the priority in *priority
+ *
+ * returns true if successful, false if the priority queue is empty */
+    bool (*removeMax)(const PrioQueue *pq, void **priority, void **value);
+
+/* moves every element of other into pq, leaving other empty; elements of
+ * pq precede elements of other with equal priorities, and each queue's
+ * own FIFO order is kept
+ *
+ * when other uses the same implementation and comparator as pq, the
+ * entries are moved wholesale; otherwise they are removed from other and
+ * inserted one at a time
+ *
+ * returns true if successful, false if malloc errors; after a failure,
+ * every element is in exactly one of the two queues */
+    bool (*merge)(const PrioQueue *pq, const PrioQueue *other);
 };
 
 #endif /* _PRIOQUEUE_H_ */
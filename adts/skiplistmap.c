@@ -0,0 +1,587 @@
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * implementation for concurrent, ordered skip-list map
+ *
+ * this is the "lazy" skip list of Herlihy, Lev, Luchangco and Shavit:
+ * searches never lock; an insertion locks the predecessors of the new
+ * node, validates that they are still unmarked and still point to the
+ * expected successors, and links the node bottom-up, setting fullyLinked
+ * when done; a removal first marks the victim (the linearization point),
+ * then locks and validates the predecessors and unlinks it top-down
+ *
+ * locks are always taken in descending key order (the victim before its
+ * predecessors, and a node's predecessors from level 0 upward), so the
+ * locking cannot deadlock
+ *
+ * unlinked nodes, and keys and values that have been replaced or removed,
+ * are freed through the epoch module once no search can be reading them
+ */
+
+#include "ADTs/skiplistmap.h"
+#include "ADTs/epoch.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <sched.h>
+
+#define MAX_LEVEL 24            /* enough for 2^24 entries at p = 1/2 */
+
+typedef struct node {
+    _Atomic(void *) key;
+    _Atomic(void *) value;
+    int topLevel;
+    atomic_bool marked;         /* logically removed */
+    atomic_bool fullyLinked;    /* linked at every level */
+    atomic_flag lock;
+    _Atomic(struct node *) next[];
+} Node;
+
+typedef struct m_data {
+    int (*cmp)(void *, void *);
+    atomic_long size;
+    Node *head;                 /* sentinel; the end of each level is NULL */
+    void (*freeK)(void *k);
+    void (*freeV)(void *v);
+} MData;
+
+static void lock(Node *p) {
+    while (atomic_flag_test_and_set_explicit(&p->lock, memory_order_acquire))
+        sched_yield();
+}
+
+static void unlock(Node *p) {
+    atomic_flag_clear_explicit(&p->lock, memory_order_release);
+}
+
+/*
+ * helper function to allocate a node linked at levels 0 .. topLevel
+ */
+static Node *newNode(void *key, void *value, int topLevel) {
+    size_t nbytes = sizeof(Node) + (topLevel + 1) * sizeof(Node *);
+    Node *p = (Node *)malloc(nbytes);
+
+    if (p != NULL) {
+        int i;
+        atomic_init(&p->key, key);
+        atomic_init(&p->value, value);
+        p->topLevel = topLevel;
+        atomic_init(&p->marked, false);
+        atomic_init(&p->fullyLinked, false);
+        atomic_flag_clear(&p->lock);
+        for (i = 0; i <= topLevel; i++)
+            atomic_init(&p->next[i], NULL);
+    }
+    return p;
+}
+
+/*
+ * helper function to pick a level with P(level >= i) = 2^-i, using a
+ * per-thread xorshift generator
+ */
+static int randomLevel(void) {
+    static __thread uint32_t seed = 0;
+    int level = 0;
+    uint32_t x;
+
+    if (seed == 0)
+        seed = (uint32_t)(uintptr_t)&level | 1U;
+    x = seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    seed = x;
+    while ((x & 1U) && level < MAX_LEVEL - 1) {
+        level++;
+        x >>= 1;
+    }
+    return level;
+}
+
+/*
+ * helper function to hand a key/value pair to freeK/freeV once it cannot
+ * be read by any other thread; must be called inside a critical section
+ */
+static void retireEntry(MData *md, void *key, void *value) {
+    if (md->freeK != doNothing)
+        Epoch_retire(key, md->freeK);
+    if (md->freeV != doNothing)
+        Epoch_retire(value, md->freeV);
+}
+
+/*
+ * search for key, filling in the predecessor and successor at each level;
+ * must be called inside a critical section
+ *
+ * returns the highest level at which a node with key was found, or -1
+ */
+static int find(MData *md, void *key, Node *preds[], Node *succs[]) {
+    int level, found = -1;
+    Node *pred = md->head;
+
+    for (level = MAX_LEVEL - 1; level >= 0; level--) {
+        Node *curr = atomic_load(&pred->next[level]);
+        int c = -1;
+
+        while (curr != NULL &&
+               (c = md->cmp(atomic_load(&curr->key), key)) < 0) {
+            pred = curr;
+            curr = atomic_load(&pred->next[level]);
+        }
+        if (found == -1 && curr != NULL && c == 0)
+            found = level;
+        preds[level] = pred;
+        succs[level] = curr;
+    }
+    return found;
+}
+
+/*
+ * helper function to locate a node that is in the map
+ *
+ * returns the node, or NULL if not found; must be called inside a
+ * critical section
+ */
+static Node *findNode(MData *md, void *key) {
+    Node *preds[MAX_LEVEL], *succs[MAX_LEVEL];
+    int found = find(md, key, preds, succs);
+
+    if (found != -1) {
+        Node *p = succs[found];
+        if (atomic_load(&p->fullyLinked) && ! atomic_load(&p->marked))
+            return p;
+    }
+    return NULL;
+}
+
+/*
+ * traverses the map, calling freeK and freeV on each entry
+ * then frees storage associated with the Node structure; only called when
+ * no other thread can access the map
+ */
+static void purge(MData *md) {
+    Node *p, *q = NULL;
+
+    for (p = atomic_load(&md->head->next[0]); p != NULL; p = q) {
+        q = atomic_load(&p->next[0]);
+        md->freeK(atomic_load(&p->key));
+        md->freeV(atomic_load(&p->value));
+        free(p);
+    }
+}
+
+static void m_destroy(const Map *m) {
+    MData *md = (MData *)m->self;
+    purge(md);
+    free(md->head);
+    free(md);
+    free((void *)m);
+}
+
+static bool m_containsKey(const Map *m, void *key) {
+    MData *md = (MData *)m->self;
+    bool status;
+
+    if (! Epoch_enter())
+        return false;
+    status = (findNode(md, key) != NULL);
+    Epoch_exit();
+    return status;
+}
+
+static bool m_get(const Map *m, void *key, void **value) {
+    MData *md = (MData *)m->self;
+    Node *p;
+
+    if (! Epoch_enter())
+        return false;
+    if ((p = findNode(md, key)) != NULL)
+        *value = atomic_load(&p->value);
+    Epoch_exit();
+    return (p != NULL);
+}
+
+/*
+ * helper function to unlock the distinct predecessors locked at levels
+ * 0 .. highest
+ */
+static void unlockPreds(Node *preds[], int highest) {
+    Node *prev = NULL;
+    int level;
+
+    for (level = 0; level <= highest; level++)
+        if (preds[level] != prev) {
+            unlock(preds[level]);
+            prev = preds[level];
+        }
+}
+
+/*
+ * helper function to insert key, or to replace the entry for key if
+ * `replace'; must be called inside a critical section
+ *
+ * returns true if (key,value) was stored, false if key was present and
+ * !replace, or if malloc errors
+ */
+static bool insert(MData *md, void *key, void *value, bool replace) {
+    int topLevel = randomLevel();
+    Node *preds[MAX_LEVEL], *succs[MAX_LEVEL];
+
+    for (;;) {
+        int found = find(md, key, preds, succs);
+        int level, highest = -1;
+        Node *p, *prev = NULL;
+        bool valid = true;
+
+        if (found != -1) {
+            p = succs[found];
+            if (atomic_load(&p->marked))
+                continue;       /* being removed; retry once it is gone */
+            while (! atomic_load(&p->fullyLinked))
+                sched_yield();
+            if (! replace)
+                return false;
+            lock(p);
+            if (atomic_load(&p->marked)) {
+                unlock(p);
+                continue;
+            }
+            retireEntry(md, atomic_exchange(&p->key, key),
+                        atomic_exchange(&p->value, value));
+            unlock(p);
+            return true;
+        }
+        for (level = 0; valid && level <= topLevel; level++) {
+            Node *pred = preds[level], *succ = succs[level];
+            if (pred != prev) {
+                lock(pred);
+                prev = pred;
+            }
+            highest = level;
+            valid = ! atomic_load(&pred->marked) &&
+                    (succ == NULL || ! atomic_load(&succ->marked)) &&
+                    atomic_load(&pred->next[level]) == succ;
+        }
+        if (! valid) {
+            unlockPreds(preds, highest);
+            continue;
+        }
+        if ((p = newNode(key, value, topLevel)) == NULL) {
+            unlockPreds(preds, highest);
+            return false;
+        }
+        for (level = 0; level <= topLevel; level++)
+            atomic_init(&p->next[level], succs[level]);
+        for (level = 0; level <= topLevel; level++)
+            atomic_store(&preds[level]->next[level], p);
+        atomic_store(&p->fullyLinked, true);
+        unlockPreds(preds, highest);
+        atomic_fetch_add(&md->size, 1L);
+        return true;
+    }
+}
+
+static bool m_put(const Map *m, void *key, void *value) {
+    MData *md = (MData *)m->self;
+    bool status;
+
+    if (! Epoch_enter())
+        return false;
+    status = insert(md, key, value, true);
+    Epoch_exit();
+    return status;
+}
+
+static bool m_putUnique(const Map *m, void *key, void *value) {
+    MData *md = (MData *)m->self;
+    bool status;
+
+    if (! Epoch_enter())
+        return false;
+    status = insert(md, key, value, false);
+    Epoch_exit();
+    return status;
+}
+
+/*
+ * helper function to remove key; must be called inside a critical section
+ *
+ * returns true if key was present and removed, false if not
+ */
+static bool removeKey(MData *md, void *key) {
+    Node *preds[MAX_LEVEL], *succs[MAX_LEVEL];
+    Node *victim = NULL;
+    bool isMarked = false;
+    int topLevel = -1;
+
+    for (;;) {
+        int found = find(md, key, preds, succs);
+        int level, highest = -1;
+        Node *prev = NULL;
+        bool valid = true;
+
+        if (! isMarked) {
+            if (found == -1)
+                return false;
+            victim = succs[found];
+            if (! atomic_load(&victim->fullyLinked) ||
+                victim->topLevel != found || atomic_load(&victim->marked))
+                return false;
+            topLevel = victim->topLevel;
+            lock(victim);
+            if (atomic_load(&victim->marked)) {
+                unlock(victim);
+                return false;
+            }
+            atomic_store(&victim->marked, true);
+            isMarked = true;
+        }
+        for (level = 0; valid && level <= topLevel; level++) {
+            Node *pred = preds[level];
+            if (pred != prev) {
+                lock(pred);
+                prev = pred;
+            }
+            highest = level;
+            valid = ! atomic_load(&pred->marked) &&
+                    atomic_load(&pred->next[level]) == victim;
+        }
+        if (! valid) {
+            unlockPreds(preds, highest);
+            continue;
+        }
+        for (level = topLevel; level >= 0; level--)
+            atomic_store(&preds[level]->next[level],
+                         atomic_load(&victim->next[level]));
+        unlock(victim);
+        unlockPreds(preds, highest);
+        atomic_fetch_sub(&md->size, 1L);
+        retireEntry(md, atomic_load(&victim->key),
+                    atomic_load(&victim->value));
+        Epoch_retire(victim, free);
+        return true;
+    }
+}
+
+static bool m_remove(const Map *m, void *key) {
+    MData *md = (MData *)m->self;
+    bool status;
+
+    if (! Epoch_enter())
+        return false;
+    status = removeKey(md, key);
+    Epoch_exit();
+    return status;
+}
+
+/*
+ * removes every entry, one at a time, so that it is safe to call while
+ * other threads are using the map
+ */
+static void m_clear(const Map *m) {
+    MData *md = (MData *)m->self;
+    Node *p;
+
+    if (! Epoch_enter())
+        return;
+    while ((p = atomic_load(&md->head->next[0])) != NULL)
+        (void)removeKey(md, atomic_load(&p->key));
+    Epoch_exit();
+}
+
+static long m_size(const Map *m) {
+    MData *md = (MData *)m->self;
+    long n = atomic_load(&md->size);
+    return (n < 0L) ? 0L : n;
+}
+
+static bool m_isEmpty(const Map *m) {
+    MData *md = (MData *)m->self;
+    return (atomic_load(&md->head->next[0]) == NULL);
+}
+
+/*
+ * helper function to copy the entries in the map, in ascending key order;
+ * entries that are being inserted or removed are skipped
+ *
+ * returns pointer to a heap-allocated array of copies, or NULL if malloc
+ * failure or empty
+ */
+static MEntry *copyEntries(MData *md, long *len) {
+    long n = 0L, size = atomic_load(&md->size) + 1L;
+    MEntry *tmp;
+    Node *p;
+
+    if (size < 1L)
+        size = 1L;
+    if (! Epoch_enter())
+        return NULL;
+    tmp = (MEntry *)malloc(size * sizeof(MEntry));
+    for (p = atomic_load(&md->head->next[0]); tmp != NULL && p != NULL;
+         p = atomic_load(&p->next[0])) {
+        if (atomic_load(&p->marked) || ! atomic_load(&p->fullyLinked))
+            continue;
+        if (n == size) {
+            MEntry *t = (MEntry *)realloc(tmp, 2 * size * sizeof(MEntry));
+            if (t == NULL) {
+                free(tmp);
+                tmp = NULL;
+                break;
+            }
+            tmp = t;
+            size *= 2;
+        }
+        tmp[n].key = atomic_load(&p->key);
+        tmp[n].value = atomic_load(&p->value);
+        n++;
+    }
+    Epoch_exit();
+    if (tmp != NULL && n == 0L) {
+        free(tmp);
+        tmp = NULL;
+    }
+    *len = n;
+    return tmp;
+}
+
+static void **m_keyArray(const Map *m, long *len) {
+    MData *md = (MData *)m->self;
+    long i, n;
+    MEntry *copies = copyEntries(md, &n);
+    void **tmp = NULL;
+
+    if (copies != NULL) {
+        if ((tmp = (void **)malloc(n * sizeof(void *))) != NULL) {
+            for (i = 0; i < n; i++)
+                tmp[i] = copies[i].key;
+            *len = n;
+        }
+        free(copies);
+    }
+    return tmp;
+}
+
+/*
+ * helper function for generating an array of MEntry * from a map
+ *
+ * since entries can be removed by other threads at any time, the array
+ * points at copies of the entries; the copies follow the array in the
+ * same heap block, so that freeing the array frees them too
+ *
+ * returns pointer to the array or NULL if malloc failure or empty
+ */
+static MEntry **entries(MData *md, long *len) {
+    long i, n;
+    MEntry *copies = copyEntries(md, &n);
+    MEntry **tmp = NULL;
+
+    if (copies != NULL) {
+        size_t nbytes = n * (sizeof(MEntry *) + sizeof(MEntry));
+        if ((tmp = (MEntry **)malloc(nbytes)) != NULL) {
+            MEntry *block = (MEntry *)(tmp + n);
+            for (i = 0; i < n; i++) {
+                block[i] = copies[i];
+                tmp[i] = &block[i];
+            }
+            *len = n;
+        }
+        free(copies);
+    }
+    return tmp;
+}
+
+static MEntry **m_entryArray(const Map *m, long *len) {
+    MData *md = (MData *)m->self;
+
+    return entries(md, len);
+}
+
+static const Iterator *m_itCreate(const Map *m) {
+    MData *md = (MData *)m->self;
+    const Iterator *it = NULL;
+    long n;
+    void **tmp = (void **)entries(md, &n);
+
+    if (tmp != NULL) {
+        it = Iterator_create(n, tmp);
+        if (it == NULL)
+            free(tmp);
+    }
+    return it;
+}
+
+static const Map *m_create(const Map *m);
+
+static Map template = {
+    NULL, m_create, m_destroy, m_clear, m_containsKey, m_get, m_put,
+    m_putUnique, m_remove, m_size, m_isEmpty, m_keyArray, m_entryArray,
+    m_itCreate
+};
+
+/*
+ * helper function to create a new Map dispatch table
+ */
+static const Map *newMap(int (*cmp)(void*, void*), void (*freeK)(void*),
+                         void (*freeV)(void *)) {
+    Map *m = (Map *)malloc(sizeof(Map));
+
+    if (m != NULL) {
+        MData *md = (MData *)malloc(sizeof(MData));
+
+        if (md != NULL && (md->head = newNode(NULL, NULL, MAX_LEVEL - 1))
+                          != NULL) {
+            atomic_init(&md->size, 0L);
+            atomic_store(&md->head->fullyLinked, true);
+            md->cmp = cmp;
+            md->freeK = freeK;
+            md->freeV = freeV;
+            *m = template;
+            m->self = md;
+        } else {
+            free(md);
+            free(m);
+            m = NULL;
+        }
+    }
+    return m;
+}
+
+static const Map *m_create(const Map *m) {
+    MData *md = (MData *)m->self;
+
+    return newMap(md->cmp, md->freeK, md->freeV);
+}
+
+const Map *SkipListMap(int (*cmp)(void*, void*), void (*freeK)(void *k),
+                       void (*freeV)(void *v)) {
+    return newMap(cmp, freeK, freeV);
+}
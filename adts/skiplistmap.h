@@ -0,0 +1,64 @@
+#ifndef _SKIPLISTMAP_H_
+#define _SKIPLISTMAP_H_
+
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ADTs/ADTdefs.h"
+#include "ADTs/map.h"
+
+/* constructor for concurrent, ordered skip-list map */
+
+/* create a skip-list map that may be used by many threads at once without
+ * external locking; get() and containsKey() never block, and put(),
+ * putUnique(), and remove() only lock the nodes adjacent to the key
+ *
+ * keyArray(), entryArray() and itCreate() return the entries in ascending
+ * key order; under concurrent updates, each entry returned was in the map
+ * at some point during the call, and no key is returned twice
+ *
+ * returns a pointer to the skip-list map, or NULL if there are malloc errors
+ *
+ * the cmp function pointer is applied to a pair of keys, yielding <0 | 0 | >0
+ *
+ * freeK is a function pointer that will be called by destroy(),
+ * clear(), put(), and remove() on keys of relevant entry/entries in the Map;
+ * for put() and remove() the call is deferred until no other thread can be
+ * reading the key (see epoch.h)
+ *
+ * freeV is a function pointer that will be called by destroy(),
+ * clear(), put(), and remove() on values of relevant entry/entries in the Map;
+ * it is deferred in the same way as freeK
+ */
+const Map *SkipListMap(int (*cmp)(void*, void*), void (*freeK)(void *k),
+                       void (*freeV)(void *v));
+
+#endif /* _SKIPLISTMAP_H_ */
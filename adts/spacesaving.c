@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * implementation of a Space-Saving sketch
+ *
+ * each counter is a value in a tracked HeapPrioQueue whose priority is
+ * its count, so that the counter of a monitored item is raised in place
+ * with changePriority(), and the counter to be reused is removeMin()
+ */
+
+#include "ADTs/spacesaving.h"
+#include "ADTs/heapprioqueue.h"
+#include "ADTs/hashmap.h"
+#include <stdlib.h>
+
+typedef struct counter {
+    SSEntry entry;
+    long index;                 /* heap position, maintained by the heap */
+} Counter;
+
+typedef struct ss_data {
+    long k;
+    long total;
+    const PrioQueue *heap;      /* Counter *'s, by count */
+    const Map *index;           /* item -> Counter * */
+    void *(*dupK)(void *item);
+    void (*freeK)(void *item);
+} SSData;
+
+static int cmpCount(void *p1, void *p2) {
+    long a = (long)p1;
+    long b = (long)p2;
+
+    return (a < b) ? -1 : (a > b);
+}
+
+static long *slot(void *v) {
+    return &(((Counter *)v)->index);
+}
+
+/*
+ * drops every counter
+ */
+static void purge(SSData *sd) {
+    void *prio;
+    Counter *c;
+
+    while (sd->heap->removeMin(sd->heap, &prio, (void **)&c)) {
+        sd->freeK(c->entry.item);
+        free(c);
+    }
+    sd->index->clear(sd->index);
+}
+
+static void ss_destroy(const SpaceSaving *ss) {
+    SSData *sd = (SSData *)ss->self;
+    purge(sd);
+    sd->heap->destroy(sd->heap);
+    sd->index->destroy(sd->index);
+    free(sd);
+    free((void *)ss);
+}
+
+static void ss_clear(const SpaceSaving *ss) {
+    SSData *sd = (SSData *)ss->self;
+    purge(sd);
+    sd->total = 0L;
+}
+
+/*
+ * starts monitoring `item' in counter c, whose count and error have been
+ * set; returns false if malloc failure, in which case c has been freed
+ */
+static bool monitor(SSData *sd, Counter *c, void *item) {
+    c->entry.item = item;
+    if (sd->dupK != NULL && (c->entry.item = sd->dupK(item)) == NULL) {
+        free(c);
+        return false;
+    }
+    if (! HashMap_put(sd->index, c->entry.item, c)) {
+        sd->freeK(c->entry.item);
+        free(c);
+        return false;
+    }
+    if (! sd->heap->insert(sd->heap, (void *)c->entry.count, c)) {
+        HashMap_remove(sd->index, c->entry.item);
+        sd->freeK(c->entry.item);
+        free(c);
+        return false;
+    }
+    return true;
+}
+
+static long ss_add(const SpaceSaving *ss, void *item, long count) {
+    SSData *sd = (SSData *)ss->self;
+    Counter *c;
+    void *prio;
+
+    sd->total += count;
+    if (HashMap_get(sd->index, item, (void **)&c)) {
+        c->entry.count += count;
+        sd->heap->changePriority(sd->heap, c, (void *)c->entry.count);
+        return c->entry.count;
+    }
+    if (sd->heap->size(sd->heap) < sd->k) {
+        if ((c = (Counter *)malloc(sizeof(Counter))) == NULL)
+            return -1L;
+        c->entry.count = count;
+        c->entry.error = 0L;
+    } else {                            /* replace the smallest count */
+        sd->heap->removeMin(sd->heap, &prio, (void **)&c);
+        HashMap_remove(sd->index, c->entry.item);
+        sd->freeK(c->entry.item);
+        c->entry.error = c->entry.count;
+        c->entry.count += count;
+    }
+    if (! monitor(sd, c, item))
+        return -1L;
+    return c->entry.count;
+}
+
+static bool ss_estimate(const SpaceSaving *ss, void *item, long *count,
+                        long *error) {
+    SSData *sd = (SSData *)ss->self;
+    Counter *c;
+
+    if (! HashMap_get(sd->index, item, (void **)&c))
+        return false;
+    *count = c->entry.count;
+    *error = c->entry.error;
+    return true;
+}
+
+static int cmpDescending(const void *p1, const void *p2) {
+    long a = (*(SSEntry * const *)p1)->count;
+    long b = (*(SSEntry * const *)p2)->count;
+
+    return (a > b) ? -1 : (a < b);
+}
+
+static SSEntry **ss_top(const SpaceSaving *ss, long *len) {
+    SSData *sd = (SSData *)ss->self;
+    void **tmp = sd->heap->toArray(sd->heap, len);
+
+    /* a Counter begins with its SSEntry, so the pointers serve as is */
+    if (tmp != NULL)
+        qsort(tmp, *len, sizeof(void *), cmpDescending);
+    return (SSEntry **)tmp;
+}
+
+static long ss_size(const SpaceSaving *ss) {
+    SSData *sd = (SSData *)ss->self;
+    return sd->heap->size(sd->heap);
+}
+
+static long ss_total(const SpaceSaving *ss) {
+    SSData *sd = (SSData *)ss->self;
+    return sd->total;
+}
+
+static SpaceSaving template = {
+    NULL, ss_destroy, ss_clear, ss_add, ss_estimate, ss_top, ss_size,
+    ss_total
+};
+
+const SpaceSaving *SpaceSaving_create(long k,
+                                      long (*hash)(void *item, long N),
+                                      int (*cmp)(void *, void *),
+                                      void *(*dupK)(void *item),
+                                      void (*freeK)(void *item)) {
+    SpaceSaving *ss;
+    SSData *sd;
+
+    if (k <= 0L)
+        return NULL;
+    if ((ss = (SpaceSaving *)malloc(sizeof(SpaceSaving))) == NULL)
+        return NULL;
+    if ((sd = (SSData *)malloc(sizeof(SSData))) == NULL) {
+        free(ss);
+        return NULL;
+    }
+    sd->k = k;
+    sd->total = 0L;
+    sd->dupK = dupK;
+    sd->freeK = freeK;
+    sd->heap = TrackedHeapPrioQueue(cmpCount, doNothing, doNothing, slot);
+    sd->index = HashMap(2 * k, 0.0, hash, cmp, doNothing, doNothing);
+    if (sd->heap == NULL || sd->index == NULL) {
+        if (sd->heap != NULL)
+            sd->heap->destroy(sd->heap);
+        if (sd->index != NULL)
+            sd->index->destroy(sd->index);
+        free(sd);
+        free(ss);
+        return NULL;
+    }
+    *ss = template;
+    ss->self = sd;
+    return ss;
+}
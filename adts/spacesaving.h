@@ -0,0 +1,143 @@
+#ifndef _SPACESAVING_H_
+#define _SPACESAVING_H_
+
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * interface definition for a Space-Saving sketch, which finds the most
+ * frequent items in a stream using k counters
+ *
+ * the sketch monitors at most k items; when an item that is not monitored
+ * arrives and all k counters are in use, the item with the smallest count
+ * is replaced by it, and the new item inherits that count as its error
+ *
+ * an item's count is never less than its true count, and exceeds it by
+ * at most its error, which is at most total() / k; every item whose true
+ * count exceeds total() / k is monitored
+ *
+ * the counters are kept in a HeapPrioQueue ordered by count, and indexed
+ * by a HashMap
+ */
+
+#include "ADTs/ADTdefs.h"
+
+typedef struct spacesaving SpaceSaving;         /* forward reference */
+
+typedef struct ssentry {
+    void *item;
+    long count;                 /* estimated count */
+    long error;                 /* count - error <= true count */
+} SSEntry;
+
+/*
+ * create a sketch with `k' counters
+ *
+ * the hash function pointer is applied to an item to yield a bucket index
+ * for the HashMap, and the cmp function pointer to a pair of items,
+ * yielding <0 | 0 | >0
+ *
+ * dupK is a function pointer that is called on an item when it starts to
+ * be monitored, returning the copy to be kept, or NULL if malloc failure;
+ * if dupK is NULL, the item itself is kept
+ *
+ * freeK is a function pointer that will be called on a kept item when it
+ * stops being monitored, by add(), clear() and destroy()
+ *
+ * returns a pointer to the sketch, or NULL if k <= 0 or if malloc errors
+ */
+const SpaceSaving *SpaceSaving_create(long k,
+                                      long (*hash)(void *item, long N),
+                                      int (*cmp)(void *, void *),
+                                      void *(*dupK)(void *item),
+                                      void (*freeK)(void *item));
+
+/*
+ * now define dispatch table
+ */
+struct spacesaving {
+/*
+ * the private data of the sketch
+ */
+    void *self;
+
+/*
+ * returns the storage associated with the sketch to the heap
+ */
+    void (*destroy)(const SpaceSaving *ss);
+
+/*
+ * stops monitoring every item
+ */
+    void (*clear)(const SpaceSaving *ss);
+
+/*
+ * records `count' more occurrences of `item'; count must be positive
+ *
+ * returns the item's new count, or -1L if malloc failure, in which case
+ * the occurrences, and the item evicted for it, if any, are lost
+ */
+    long (*add)(const SpaceSaving *ss, void *item, long count);
+
+/*
+ * returns the count and error of `item' in `*count' and `*error'
+ *
+ * returns true if the item is monitored, false if not, in which case its
+ * true count is at most the smallest count of the monitored items
+ */
+    bool (*estimate)(const SpaceSaving *ss, void *item, long *count,
+                     long *error);
+
+/*
+ * returns an array of the monitored items, in descending order of count;
+ * the number of elements in the array is returned in `*len'
+ *
+ * returns a pointer to the array, or NULL if malloc failure OR IF NO ITEM
+ * IS MONITORED
+ *
+ * NB - the caller is responsible for freeing the array of SSEntry *
+ *      elements; the entries themselves remain the sketch's, and are
+ *      valid until the next add() or clear()
+ */
+    SSEntry **(*top)(const SpaceSaving *ss, long *len);
+
+/*
+ * returns the number of items monitored
+ */
+    long (*size)(const SpaceSaving *ss);
+
+/*
+ * returns the sum of the counts passed to add()
+ */
+    long (*total)(const SpaceSaving *ss);
+};
+
+#endif /* _SPACESAVING_H_ */
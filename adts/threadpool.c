@@ -0,0 +1,571 @@
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * implementation of a work-stealing thread pool
+ *
+ * every worker owns an ArrayDeque of tasks, guarded by a spin lock; the
+ * owner pushes and pops at the tail, so that the task it runs next is the
+ * one most likely to still be in its cache, while thieves take from the
+ * head, where the oldest - and, for divide and conquer, largest - tasks
+ * are; tasks submitted from threads outside the pool go on a shared
+ * ArrayQueue
+ *
+ * idle workers sleep on one condition variable, and threads waiting in
+ * get(), parallelFor() or waitAll() on another; a queued task signals an
+ * idle worker, or a waiter if no worker is asleep, while a finished job
+ * or parallelFor() wakes only the waiters, and only if there are any, so
+ * a busy pool makes no system calls; the workers are broadcast only when
+ * the pool is shut down
+ */
+
+#include "ADTs/threadpool.h"
+#include "ADTs/arraydeque.h"
+#include "ADTs/arrayqueue.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#define CACHE_LINE 64
+#define SPLITS_PER_WORKER 8L    /* default parallelFor() subranges/worker */
+
+typedef struct tp_data TpData;
+typedef struct task Task;
+
+struct task {
+    void (*run)(TpData *tpd, Task *t);
+};
+
+typedef struct job {            /* a task from submit() or execute() */
+    Task task;
+    Future future;
+    atomic_long pending;        /* 1 until the task has run */
+    atomic_int refs;            /* the pool, plus the Future if any */
+    void *(*fxn)(void *arg);    /* set by submit() */
+    void (*proc)(void *arg);    /* set by execute() */
+    void *arg;
+    void *result;
+    TpData *tpd;
+} Job;
+
+typedef struct loop {           /* the state of one parallelFor() */
+    atomic_long pending;        /* indices not yet visited */
+    long grain;
+    void (*body)(long lo, long hi, void *arg);
+    void *arg;
+} Loop;
+
+typedef struct chunk {          /* a subrange of a parallelFor() */
+    Task task;
+    Loop *loop;
+    long lo;
+    long hi;
+} Chunk;
+
+typedef struct worker {
+    atomic_flag lock;
+    const Deque *tasks;
+    TpData *tpd;
+    pthread_t tid;
+} __attribute__((aligned(CACHE_LINE))) Worker;
+
+struct tp_data {
+    Worker *workers;
+    long nworkers;
+    atomic_flag lock;           /* guards shared */
+    const Queue *shared;        /* tasks queued by non-pool threads */
+    atomic_long queued;         /* tasks in the deques and shared */
+    atomic_long active;         /* jobs queued or running */
+    atomic_long sleepers;       /* workers waiting on wake */
+    atomic_long waiters;        /* threads waiting on done */
+    pthread_mutex_t sleep;
+    pthread_cond_t wake;
+    pthread_cond_t done;
+    bool shutdown;              /* guarded by sleep */
+};
+
+static __thread Worker *current = NULL;        /* set in pool threads */
+
+static void lock(atomic_flag *l) {
+    while (atomic_flag_test_and_set_explicit(l, memory_order_acquire))
+        sched_yield();
+}
+
+static bool tryLock(atomic_flag *l) {
+    return ! atomic_flag_test_and_set_explicit(l, memory_order_acquire);
+}
+
+static void unlock(atomic_flag *l) {
+    atomic_flag_clear_explicit(l, memory_order_release);
+}
+
+/*
+ * wakes one thread to run a newly queued task: an idle worker if there
+ * is one, else a waiter, which will run it while it waits
+ *
+ * a sleeper increments its count before re-checking its condition, and
+ * the caller has changed that condition before reading the counts, so
+ * one of them sees the other
+ */
+static void notifyTask(TpData *tpd) {
+    pthread_cond_t *cv;
+
+    if (atomic_load(&tpd->sleepers) > 0L)
+        cv = &tpd->wake;
+    else if (atomic_load(&tpd->waiters) > 0L)
+        cv = &tpd->done;
+    else
+        return;
+    pthread_mutex_lock(&tpd->sleep);
+    pthread_cond_signal(cv);
+    pthread_mutex_unlock(&tpd->sleep);
+}
+
+/*
+ * wakes the threads waiting for a count to drop to 0, after one has;
+ * they wait on different counts, so all of them are woken
+ */
+static void notifyDone(TpData *tpd) {
+    if (atomic_load(&tpd->waiters) == 0L)
+        return;
+    pthread_mutex_lock(&tpd->sleep);
+    pthread_cond_broadcast(&tpd->done);
+    pthread_mutex_unlock(&tpd->sleep);
+}
+
+/*
+ * queues `t' on the calling worker's deque, or on the shared queue if
+ * the caller is not one of this pool's workers
+ */
+static bool push(TpData *tpd, Task *t) {
+    Worker *w = current;
+    bool status;
+
+    if (w != NULL && w->tpd == tpd) {
+        lock(&w->lock);
+        status = w->tasks->insertLast(w->tasks, t);
+        unlock(&w->lock);
+    } else {
+        lock(&tpd->lock);
+        status = tpd->shared->enqueue(tpd->shared, t);
+        unlock(&tpd->lock);
+    }
+    if (status) {
+        atomic_fetch_add(&tpd->queued, 1L);
+        notifyTask(tpd);
+    }
+    return status;
+}
+
+/*
+ * helper function to pick a victim at random, using a per-thread
+ * xorshift generator
+ */
+static long randomWorker(TpData *tpd) {
+    static __thread uint64_t seed = 0;
+    uint64_t x;
+
+    if (seed == 0)
+        seed = (uint64_t)(uintptr_t)&x | 1U;
+    x = seed;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    seed = x;
+    return (long)(x % (uint64_t)tpd->nworkers);
+}
+
+/*
+ * takes a task from the caller's own deque, then from the shared queue,
+ * then from the head of another worker's deque
+ *
+ * returns NULL if no task was found
+ */
+static Task *findTask(TpData *tpd) {
+    Worker *w = current;
+    Task *t = NULL;
+    long i, start;
+
+    if (atomic_load(&tpd->queued) <= 0L)
+        return NULL;
+    if (w != NULL && w->tpd == tpd) {
+        lock(&w->lock);
+        if (! w->tasks->removeLast(w->tasks, (void **)&t))
+            t = NULL;
+        unlock(&w->lock);
+    } else
+        w = NULL;
+    if (t == NULL) {
+        lock(&tpd->lock);
+        if (! tpd->shared->dequeue(tpd->shared, (void **)&t))
+            t = NULL;
+        unlock(&tpd->lock);
+    }
+    start = randomWorker(tpd);
+    for (i = 0; t == NULL && i < tpd->nworkers; i++) {
+        Worker *v = &tpd->workers[(start + i) % tpd->nworkers];
+
+        if (v == w || ! tryLock(&v->lock))
+            continue;
+        if (! v->tasks->removeFirst(v->tasks, (void **)&t))
+            t = NULL;
+        unlock(&v->lock);
+    }
+    if (t != NULL)
+        atomic_fetch_sub(&tpd->queued, 1L);
+    return t;
+}
+
+/*
+ * called when findTask() came up empty; sleeps until a task is queued,
+ * `*count' (if non-NULL) drops to 0, or the pool is shut down
+ *
+ * if tasks are queued but were not found (they are in flight, or their
+ * deques were locked), yields instead of sleeping
+ */
+static void idle(TpData *tpd, atomic_long *count) {
+    atomic_long *n = (count == NULL) ? &tpd->sleepers : &tpd->waiters;
+    bool waited = false;
+
+    pthread_mutex_lock(&tpd->sleep);
+    atomic_fetch_add(n, 1L);
+    if (! tpd->shutdown && (count == NULL || atomic_load(count) > 0L) &&
+        atomic_load(&tpd->queued) <= 0L) {
+        pthread_cond_wait((count == NULL) ? &tpd->wake : &tpd->done,
+                          &tpd->sleep);
+        waited = true;
+    }
+    atomic_fetch_sub(n, 1L);
+    pthread_mutex_unlock(&tpd->sleep);
+    if (! waited)
+        sched_yield();
+}
+
+/*
+ * runs queued tasks until `*count' drops to 0
+ *
+ * the wakeup that ended the last idle() may have been meant for a
+ * thread that would run a newly queued task, so it is passed on
+ */
+static void helpUntil(TpData *tpd, atomic_long *count) {
+    while (atomic_load(count) > 0L) {
+        Task *t = findTask(tpd);
+
+        if (t != NULL)
+            t->run(tpd, t);
+        else
+            idle(tpd, count);
+    }
+    if (atomic_load(&tpd->queued) > 0L)
+        notifyTask(tpd);
+}
+
+static void *workerMain(void *arg) {
+    Worker *w = (Worker *)arg;
+    TpData *tpd = w->tpd;
+    bool done = false;
+
+    current = w;
+    while (! done) {
+        Task *t = findTask(tpd);
+
+        if (t != NULL) {
+            t->run(tpd, t);
+            continue;
+        }
+        pthread_mutex_lock(&tpd->sleep);
+        done = tpd->shutdown;
+        pthread_mutex_unlock(&tpd->sleep);
+        if (! done)
+            idle(tpd, NULL);
+    }
+    return NULL;
+}
+
+static void release(Job *j) {
+    if (atomic_fetch_sub(&j->refs, 1) == 1)
+        free(j);
+}
+
+static void runJob(TpData *tpd, Task *t) {
+    Job *j = (Job *)t;
+
+    if (j->fxn != NULL)
+        j->result = j->fxn(j->arg);
+    else
+        j->proc(j->arg);
+    atomic_store(&j->pending, 0L);
+    release(j);
+    atomic_fetch_sub(&tpd->active, 1L);
+    notifyDone(tpd);            /* for get() and waitAll() */
+}
+
+static bool f_get(const Future *f, void **result) {
+    Job *j = (Job *)f->self;
+
+    if (atomic_load(&j->pending) > 0L)
+        helpUntil(j->tpd, &j->pending);
+    *result = j->result;
+    return true;
+}
+
+static bool f_isDone(const Future *f) {
+    Job *j = (Job *)f->self;
+
+    return (atomic_load(&j->pending) == 0L);
+}
+
+static void f_destroy(const Future *f) {
+    release((Job *)f->self);
+}
+
+static Future futureTemplate = {
+    NULL, f_get, f_isDone, f_destroy
+};
+
+static Job *newJob(TpData *tpd, void *(*fxn)(void *), void (*proc)(void *),
+                   void *arg, int refs) {
+    Job *j = (Job *)malloc(sizeof(Job));
+
+    if (j != NULL) {
+        j->task.run = runJob;
+        j->future = futureTemplate;
+        j->future.self = j;
+        atomic_init(&j->pending, 1L);
+        atomic_init(&j->refs, refs);
+        j->fxn = fxn;
+        j->proc = proc;
+        j->arg = arg;
+        j->result = NULL;
+        j->tpd = tpd;
+        atomic_fetch_add(&tpd->active, 1L);
+        if (! push(tpd, &j->task)) {
+            atomic_fetch_sub(&tpd->active, 1L);
+            notifyDone(tpd);
+            free(j);
+            j = NULL;
+        }
+    }
+    return j;
+}
+
+static const Future *tp_submit(const ThreadPool *tp, void *(*fxn)(void *arg),
+                               void *arg) {
+    Job *j = newJob((TpData *)tp->self, fxn, NULL, arg, 2);
+
+    return (j == NULL) ? NULL : &j->future;
+}
+
+static bool tp_execute(const ThreadPool *tp, void (*fxn)(void *arg),
+                       void *arg) {
+    return (newJob((TpData *)tp->self, NULL, fxn, arg, 1) != NULL);
+}
+
+static void runChunk(TpData *tpd, Task *t);
+
+/*
+ * visits [lo, hi): the upper half is queued for another thread, and the
+ * lower half split again, until the range is no larger than the grain;
+ * a half that cannot be queued is visited by the caller
+ */
+static void forRange(TpData *tpd, Loop *l, long lo, long hi) {
+    while (hi - lo > l->grain) {
+        long mid = lo + (hi - lo) / 2;
+        Chunk *c = (Chunk *)malloc(sizeof(Chunk));
+
+        if (c == NULL)
+            break;
+        c->task.run = runChunk;
+        c->loop = l;
+        c->lo = mid;
+        c->hi = hi;
+        if (! push(tpd, &c->task)) {
+            free(c);
+            break;
+        }
+        hi = mid;
+    }
+    l->body(lo, hi, l->arg);
+    if (atomic_fetch_sub(&l->pending, hi - lo) == hi - lo)
+        notifyDone(tpd);        /* `l' may be gone now */
+}
+
+static void runChunk(TpData *tpd, Task *t) {
+    Chunk *c = (Chunk *)t;
+    Loop *l = c->loop;
+    long lo = c->lo, hi = c->hi;
+
+    free(c);
+    forRange(tpd, l, lo, hi);
+}
+
+static void tp_parallelFor(const ThreadPool *tp, long lo, long hi, long grain,
+                           void (*body)(long lo, long hi, void *arg),
+                           void *arg) {
+    TpData *tpd = (TpData *)tp->self;
+    Loop l;
+
+    if (hi <= lo)
+        return;
+    if (grain <= 0L)
+        grain = (hi - lo) / (SPLITS_PER_WORKER * tpd->nworkers);
+    atomic_init(&l.pending, hi - lo);
+    l.grain = (grain < 1L) ? 1L : grain;
+    l.body = body;
+    l.arg = arg;
+    forRange(tpd, &l, lo, hi);
+    helpUntil(tpd, &l.pending);
+}
+
+static void tp_waitAll(const ThreadPool *tp) {
+    TpData *tpd = (TpData *)tp->self;
+
+    helpUntil(tpd, &tpd->active);
+}
+
+static long tp_size(const ThreadPool *tp) {
+    TpData *tpd = (TpData *)tp->self;
+
+    return tpd->nworkers;
+}
+
+/*
+ * stops and joins the first `n' workers, then frees everything
+ */
+static void teardown(TpData *tpd, long n) {
+    long i;
+
+    pthread_mutex_lock(&tpd->sleep);
+    tpd->shutdown = true;
+    pthread_cond_broadcast(&tpd->wake);
+    pthread_cond_broadcast(&tpd->done);
+    pthread_mutex_unlock(&tpd->sleep);
+    for (i = 0; i < n; i++)
+        pthread_join(tpd->workers[i].tid, NULL);
+    for (i = 0; i < tpd->nworkers; i++)
+        if (tpd->workers[i].tasks != NULL)
+            tpd->workers[i].tasks->destroy(tpd->workers[i].tasks);
+    if (tpd->shared != NULL)
+        tpd->shared->destroy(tpd->shared);
+    pthread_cond_destroy(&tpd->wake);
+    pthread_cond_destroy(&tpd->done);
+    pthread_mutex_destroy(&tpd->sleep);
+    free(tpd->workers);
+    free(tpd);
+}
+
+static void tp_destroy(const ThreadPool *tp) {
+    TpData *tpd = (TpData *)tp->self;
+
+    helpUntil(tpd, &tpd->active);
+    teardown(tpd, tpd->nworkers);
+    free((void *)tp);
+}
+
+static ThreadPool template = {
+    NULL, tp_destroy, tp_submit, tp_execute, tp_parallelFor, tp_waitAll,
+    tp_size
+};
+
+/*
+ * helper function to allocate the pool's data and its queues; the
+ * workers are not started
+ */
+static TpData *newTpData(long nworkers) {
+    TpData *tpd = (TpData *)malloc(sizeof(TpData));
+    void *tmp;
+    long i;
+
+    if (tpd == NULL)
+        return NULL;
+    if (posix_memalign(&tmp, CACHE_LINE, nworkers * sizeof(Worker)) != 0) {
+        free(tpd);
+        return NULL;
+    }
+    tpd->workers = (Worker *)tmp;
+    tpd->nworkers = nworkers;
+    atomic_flag_clear(&tpd->lock);
+    atomic_init(&tpd->queued, 0L);
+    atomic_init(&tpd->active, 0L);
+    atomic_init(&tpd->sleepers, 0L);
+    atomic_init(&tpd->waiters, 0L);
+    pthread_mutex_init(&tpd->sleep, NULL);
+    pthread_cond_init(&tpd->wake, NULL);
+    pthread_cond_init(&tpd->done, NULL);
+    tpd->shutdown = false;
+    tpd->shared = ArrayQueue(0L, doNothing);
+    for (i = 0; i < nworkers; i++) {
+        Worker *w = &tpd->workers[i];
+
+        atomic_flag_clear(&w->lock);
+        w->tasks = ArrayDeque(0L, doNothing);
+        w->tpd = tpd;
+    }
+    return tpd;
+}
+
+const ThreadPool *ThreadPool_create(long nthreads) {
+    ThreadPool *tp = (ThreadPool *)malloc(sizeof(ThreadPool));
+    TpData *tpd;
+    long i;
+
+    if (tp == NULL)
+        return NULL;
+    if (nthreads <= 0L)
+        nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+    if ((tpd = newTpData((nthreads < 1L) ? 1L : nthreads)) == NULL) {
+        free(tp);
+        return NULL;
+    }
+    for (i = 0; i < tpd->nworkers; i++)
+        if (tpd->workers[i].tasks == NULL)
+            break;
+    if (tpd->shared == NULL || i < tpd->nworkers) {
+        teardown(tpd, 0L);
+        free(tp);
+        return NULL;
+    }
+    for (i = 0; i < tpd->nworkers; i++) {
+        Worker *w = &tpd->workers[i];
+
+        if (pthread_create(&w->tid, NULL, workerMain, w) != 0) {
+            teardown(tpd, i);
+            free(tp);
+            return NULL;
+        }
+    }
+    *tp = template;
+    tp->self = tpd;
+    return tp;
+}
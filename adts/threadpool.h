@@ -0,0 +1,151 @@
+#ifndef _THREADPOOL_H_
+#define _THREADPOOL_H_
+
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * interface definition for a pool of worker threads that run tasks
+ *
+ * each worker keeps its own deque of tasks; a task submitted by a worker
+ * goes on that worker's deque, which the worker runs newest first, while
+ * idle workers steal the oldest tasks from other workers' deques; tasks
+ * submitted by other threads go on a shared queue
+ *
+ * a thread that waits on a Future, in parallelFor() or in waitAll() runs
+ * queued tasks while it waits, so tasks may themselves submit tasks and
+ * wait for them without tying up the pool
+ */
+
+#include "ADTs/ADTdefs.h"
+
+typedef struct future Future;           /* forward reference */
+typedef struct threadpool ThreadPool;   /* forward reference */
+
+/*
+ * create a pool of `nthreads' worker threads; if nthreads is <= 0L, one
+ * worker is started for each online CPU
+ *
+ * returns a pointer to the pool, or NULL if errors
+ */
+const ThreadPool *ThreadPool_create(long nthreads);
+
+/*
+ * dispatch table for the completion handle of a submitted task
+ */
+struct future {
+/*
+ * the private data of the future
+ */
+    void *self;
+
+/*
+ * waits for the task to finish, returning the value returned by the task
+ * in `*result'
+ *
+ * returns true
+ */
+    bool (*get)(const Future *f, void **result);
+
+/*
+ * returns true if the task has finished, false if not
+ */
+    bool (*isDone)(const Future *f);
+
+/*
+ * releases the handle; if the task has not yet finished, it still runs,
+ * and its result is discarded
+ */
+    void (*destroy)(const Future *f);
+};
+
+/*
+ * dispatch table for a thread pool
+ */
+struct threadpool {
+/*
+ * the private data of the pool
+ */
+    void *self;
+
+/*
+ * waits for every task submitted to the pool to finish, then stops the
+ * workers and returns the storage associated with the pool to the heap
+ *
+ * no other thread may submit tasks to the pool once destroy() is called
+ */
+    void (*destroy)(const ThreadPool *tp);
+
+/*
+ * queues fxn(arg) to be run by the pool
+ *
+ * returns a Future from which the result of fxn(arg) can be retrieved,
+ * or NULL if unsuccessful (malloc failure)
+ *
+ * NB - it is the caller's responsibility to destroy the Future when
+ *      finished with it
+ */
+    const Future *(*submit)(const ThreadPool *tp, void *(*fxn)(void *arg),
+                            void *arg);
+
+/*
+ * queues fxn(arg) to be run by the pool, without a Future
+ *
+ * returns true if successful, false if unsuccessful (malloc failure)
+ */
+    bool (*execute)(const ThreadPool *tp, void (*fxn)(void *arg), void *arg);
+
+/*
+ * calls body(l, h, arg) for disjoint subranges [l, h) that together
+ * cover [lo, hi), in parallel, and waits for all of the calls to return;
+ * the range is split in halves until subranges hold at most `grain'
+ * indices; if grain is <= 0L, a grain is chosen that gives each worker
+ * several subranges
+ *
+ * subranges that cannot be queued (malloc failure) are run by the caller,
+ * so every index is always visited exactly once
+ */
+    void (*parallelFor)(const ThreadPool *tp, long lo, long hi, long grain,
+                        void (*body)(long lo, long hi, void *arg), void *arg);
+
+/*
+ * waits until every task submitted to the pool, including tasks
+ * submitted while waiting, has finished
+ */
+    void (*waitAll)(const ThreadPool *tp);
+
+/*
+ * returns the number of worker threads in the pool
+ */
+    long (*size)(const ThreadPool *tp);
+};
+
+#endif /* _THREADPOOL_H_ */
@@ -0,0 +1,584 @@
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * implementation of a CSK hash map whose entries expire
+ *
+ * each entry is on a hash chain and, if it can expire, on one slot of a
+ * hashed timing wheel: an entry that expires at time t is on slot
+ * ceil(t / tick) % WHEEL_SLOTS, and `cursor' is the next tick whose slot
+ * has not been swept; sweeping a slot evicts its entries that have
+ * expired and leaves those due on a later revolution; a sweep that stops
+ * part way through a slot records the next entry in `resume', so that
+ * the next sweep carries on from there rather than re-examining the
+ * entries at the head of the slot
+ *
+ * the slot lists are doubly linked through `wpp', the address of the
+ * pointer to the entry, so that an entry leaves the wheel in O(1) when it
+ * is removed or put() again
+ */
+
+#include "ADTs/ttlcskmap.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define DEFAULT_CAPACITY 16
+#define MAX_CAPACITY 134217728L
+#define DEFAULT_LOAD_FACTOR 0.75
+#define TRIGGER 100	/* number of changes that will trigger a load check */
+#define WHEEL_SLOTS 256
+#define TICKS_PER_TTL 64	/* so a default TTL is a quarter revolution */
+#define DEFAULT_TICK 16L	/* msecs, if there is no default TTL */
+#define SLICE 8L		/* entries examined by each put() and get() */
+#define NEVER -1L
+
+typedef struct node {
+    struct node *next;		/* hash chain */
+    struct node *wnext;		/* wheel slot */
+    struct node **wpp;		/* NULL if not on the wheel */
+    long expires;		/* NEVER, or msecs */
+    MEntry entry;
+} Node;
+
+typedef struct m_data {
+    long size;
+    long capacity;
+    long changes;
+    double load;
+    double loadFactor;
+    double increment;
+    Node **buckets;
+    void (*freeValue)(void *v);
+    long ttl;
+    long tick;
+    long cursor;
+    Node *resume;		/* next entry of slot cursor to examine */
+    bool resuming;		/* false to start slot cursor at its head */
+    long (*clock)(void);
+    Node *wheel[WHEEL_SLOTS];
+} MData;
+
+/*
+ * generate hash value from key; value returned in range of 0..N-1
+ */
+#define SHIFT 31L /* should be prime */
+static long hash(char *key, long N) {
+    unsigned long ans = 0L;
+    char *sp;
+
+    for (sp = key; *sp != '\0'; sp++)
+        ans = SHIFT * ans + (unsigned long)*sp;
+    return (long)(ans % N);
+}
+
+static long monotonic(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+static bool expired(Node *p, long now) {
+    return (p->expires != NEVER && p->expires <= now);
+}
+
+/*
+ * wheel helpers
+ */
+static void wheelRemove(MData *md, Node *p) {
+    if (p->wpp != NULL) {
+        if (md->resuming && md->resume == p)
+            md->resume = p->wnext;
+        *(p->wpp) = p->wnext;
+        if (p->wnext != NULL)
+            p->wnext->wpp = p->wpp;
+        p->wpp = NULL;
+    }
+}
+
+/*
+ * sets p to expire `ttl' msecs after `now', moving it on the wheel
+ */
+static void schedule(MData *md, Node *p, long ttl, long now) {
+    wheelRemove(md, p);
+    if (ttl <= 0L) {
+        p->expires = NEVER;
+    } else {
+        Node **slot;
+
+        p->expires = now + ttl;
+        slot = &(md->wheel[((p->expires + md->tick - 1) / md->tick)
+                           % WHEEL_SLOTS]);
+        p->wnext = *slot;
+        if (*slot != NULL)
+            (*slot)->wpp = &(p->wnext);
+        *slot = p;
+        p->wpp = slot;
+    }
+}
+
+/*
+ * unlinks p from its hash chain and the wheel, and frees it
+ */
+static void removeNode(MData *md, Node *p) {
+    Node **pp = &(md->buckets[hash((p->entry).key, md->capacity)]);
+
+    while (*pp != p)
+        pp = &((*pp)->next);
+    *pp = p->next;
+    wheelRemove(md, p);
+    md->size--;
+    md->load -= md->increment;
+    md->changes++;
+    free((p->entry).key);
+    md->freeValue((p->entry).value);
+    free(p);
+}
+
+/*
+ * sweeps the wheel up to `now', examining at most `max' entries, or
+ * every entry due if max <= 0L; returns the number evicted
+ */
+static long advance(MData *md, long now, long max) {
+    long nowTick = now / md->tick, examined = 0L, evicted = 0L;
+
+    if (nowTick - md->cursor >= WHEEL_SLOTS) {
+        md->cursor = nowTick - WHEEL_SLOTS + 1;     /* one revolution will do */
+        md->resuming = false;
+    }
+    while (md->cursor <= nowTick) {
+        Node *p, *q;
+
+        p = md->resuming ? md->resume : md->wheel[md->cursor % WHEEL_SLOTS];
+        md->resuming = false;
+        for (; p != NULL; p = q) {
+            if (max > 0L && examined >= max) {
+                md->resume = p;
+                md->resuming = true;
+                return evicted;
+            }
+            examined++;
+            q = p->wnext;
+            if (expired(p, now)) {
+                removeNode(md, p);
+                evicted++;
+            }
+        }
+        md->cursor++;
+    }
+    return evicted;
+}
+
+/*
+ * traverses the map, calling freeValue on each entry
+ * then frees storage associated with the MEntry structure
+ */
+static void purge(MData *md) {
+    long i;
+
+    for (i = 0L; i < md->capacity; i++) {
+        Node *p, *q;
+        p = md->buckets[i];
+        while (p != NULL) {
+            free((p->entry).key);
+            md->freeValue((p->entry).value);
+            q = p->next;
+            free(p);
+            p = q;
+        }
+        md->buckets[i] = NULL;
+    }
+    for (i = 0L; i < WHEEL_SLOTS; i++)
+        md->wheel[i] = NULL;
+    md->resuming = false;
+}
+
+static void m_destroy(const CSKMap *m) {
+    MData *md = (MData *)m->self;
+    purge(md);
+    free(md->buckets);
+    free(md);
+    free((void *)m);
+}
+
+static void m_clear(const CSKMap *m) {
+    MData *md = (MData *)m->self;
+    purge(md);
+    md->size = 0;
+    md->load = 0.0;
+    md->changes = 0;
+}
+
+/*
+ * helper function to locate key in a map; an expired entry is evicted
+ * and not found
+ *
+ * returns pointer to entry, if found, as function value; NULL if not found
+ * returns bucket index in `bucket'
+ */
+static Node *findKey(MData *md, char *key, long now, long *bucket) {
+    long i = hash(key, md->capacity);
+    Node *p;
+
+    *bucket = i;
+    for (p = md->buckets[i]; p != NULL; p = p->next) {
+        if (strcmp((p->entry).key, key) == 0) {
+            break;
+        }
+    }
+    if (p != NULL && expired(p, now)) {
+        removeNode(md, p);
+        p = NULL;
+    }
+    return p;
+}
+
+static bool m_containsKey(const CSKMap *m, char *key) {
+    MData *md = (MData *)m->self;
+    long bucket;
+
+    return (findKey(md, key, md->clock(), &bucket) != NULL);
+}
+
+static bool m_get(const CSKMap *m, char *key, void **value) {
+    MData *md = (MData *)m->self;
+    long i, now = md->clock();
+    Node *p;
+    bool status;
+
+    advance(md, now, SLICE);
+    p = findKey(md, key, now, &i);
+    status = (p != NULL);
+    if (status)
+        *value = (p->entry).value;
+    return status;
+}
+
+/*
+ * helper function that resizes the hash table
+ */
+static void resize(MData *md) {
+    long N;
+    Node *p, *q, **array;
+    long i, j;
+
+/* double capacity, unless exceeds max capacity;
+ * if already at max capacity, simply return */
+    N = 2 * md->capacity;
+    if (N > MAX_CAPACITY)
+        N = MAX_CAPACITY;
+    if (N == md->capacity)
+        return;
+    array = (Node **)malloc(N * sizeof(Node *));
+    if (array == NULL)
+        return;
+    for (j = 0; j < N; j++)
+        array[j] = NULL;
+    /*
+     * now redistribute the entries into the new set of buckets
+     */
+    for (i = 0; i < md->capacity; i++) {
+        for (p = md->buckets[i]; p != NULL; p = q) {
+            q = p->next;
+            j = hash((p->entry).key, N);
+            p->next = array[j];
+            array[j] = p;
+        }
+    }
+    free(md->buckets);
+    md->buckets = array;
+    md->capacity = N;
+    md->load /= 2.0;
+    md->changes = 0;
+    md->increment = 1.0 / (double)N;
+}
+
+/*
+ * helper function to insert new (key, value) into table
+ */
+static bool insertEntry(MData *md, char *key, void *value, long i, long ttl,
+                        long now) {
+    Node *p = (Node *)malloc(sizeof(Node));
+    bool status = (p != NULL);
+
+    if (status) {
+        char *k = strdup(key);
+        if (k != NULL) {
+            (p->entry).key = k;
+            (p->entry).value = value;
+            p->next = md->buckets[i];
+            md->buckets[i] = p;
+            p->wpp = NULL;
+            schedule(md, p, ttl, now);
+            md->size++;
+            md->load += md->increment;
+            md->changes++;
+        } else {
+            free(p);
+            status = false;
+        }
+    }
+    return status;
+}
+
+/*
+ * common code for put(), putUnique() and TTLCSKMap_putTTL()
+ */
+static bool putEntry(MData *md, char *key, void *value, long ttl,
+                     bool unique) {
+    long i, now = md->clock();
+    Node *p;
+    bool status = true;
+
+    advance(md, now, SLICE);
+    if (md->changes > TRIGGER) {
+        md->changes = 0;
+        if (md->load > md->loadFactor)
+            resize(md);
+    }
+    p = findKey(md, key, now, &i);
+    if (p == NULL) {
+        status = insertEntry(md, key, value, i, ttl, now);
+    } else if (unique) {
+        status = false;
+    } else {
+        md->freeValue((p->entry).value);
+        (p->entry).value = value;
+        schedule(md, p, ttl, now);
+    }
+    return status;
+}
+
+static bool m_put(const CSKMap *m, char *key, void *value) {
+    MData *md = (MData *)m->self;
+
+    return putEntry(md, key, value, md->ttl, false);
+}
+
+static bool m_putUnique(const CSKMap *m, char *key, void *value) {
+    MData *md = (MData *)m->self;
+
+    return putEntry(md, key, value, md->ttl, true);
+}
+
+static bool m_remove(const CSKMap *m, char *key) {
+    MData *md = (MData *)m->self;
+    long i;
+    Node *entry = findKey(md, key, md->clock(), &i);
+    bool status = (entry != NULL);
+
+    if (status)
+        removeNode(md, entry);
+    return status;
+}
+
+static long m_size(const CSKMap *m) {
+    MData *md = (MData *)m->self;
+    return md->size;
+}
+
+static bool m_isEmpty(const CSKMap *m) {
+    MData *md = (MData *)m->self;
+    return (md->size == 0L);
+}
+
+/*
+ * helper function for generating an array of the unexpired entries in a
+ * map; the number of entries is returned in *len
+ *
+ * returns pointer to the array or NULL if malloc failure or if there are
+ * no unexpired entries
+ */
+static MEntry **entries(MData *md, long *len) {
+    MEntry **tmp = NULL;
+    long now = md->clock();
+
+    if (md->size > 0L) {
+        size_t nbytes = md->size * sizeof(MEntry *);
+        tmp = (MEntry **)malloc(nbytes);
+        if (tmp != NULL) {
+            long i, n = 0L;
+            for (i = 0L; i < md->capacity; i++) {
+                Node *p = md->buckets[i];
+                while (p != NULL) {
+                    if (! expired(p, now))
+                        tmp[n++] = &(p->entry);
+                    p = p->next;
+                }
+            }
+            if (n == 0L) {
+                free(tmp);
+                tmp = NULL;
+            }
+            *len = n;
+        }
+    }
+    return tmp;
+}
+
+static char **m_keyArray(const CSKMap *m, long *len) {
+    MData *md = (MData *)m->self;
+    MEntry **tmp = entries(md, len);
+    char **keys = (char **)tmp;
+    long i;
+
+    if (tmp != NULL)
+        for (i = 0L; i < *len; i++)
+            keys[i] = tmp[i]->key;
+    return keys;
+}
+
+static MEntry **m_entryArray(const CSKMap *m, long *len) {
+    MData *md = (MData *)m->self;
+
+    return entries(md, len);
+}
+
+static const Iterator *m_itCreate(const CSKMap *m) {
+    MData *md = (MData *)m->self;
+    const Iterator *it = NULL;
+    long len;
+    void **tmp = (void **)entries(md, &len);
+
+    if (tmp != NULL) {
+        it = Iterator_create(len, tmp);
+        if (it == NULL)
+            free(tmp);
+    }
+    return it;
+}
+
+static const CSKMap *m_create(const CSKMap *m);
+
+static CSKMap template = {
+    NULL, m_create, m_destroy, m_clear, m_containsKey, m_get, m_put,
+    m_putUnique, m_remove, m_size, m_isEmpty, m_keyArray, m_entryArray,
+    m_itCreate
+};
+
+/*
+ * helper function to create a new CSKMap dispatch table
+ */
+static const CSKMap *newCSKMap(long capacity, double loadFactor, long ttl,
+                               long (*clock)(void),
+                               void (*freeValue)(void *)) {
+    CSKMap *m = (CSKMap *)malloc(sizeof(CSKMap));
+    long N;
+    double lf;
+    Node **array;
+    long i;
+
+    if (m != NULL) {
+        MData *md = (MData *)malloc(sizeof(MData));
+
+        if (md != NULL) {
+            N = ((capacity > 0) ? capacity : DEFAULT_CAPACITY);
+            if (N > MAX_CAPACITY)
+                N = MAX_CAPACITY;
+            lf = ((loadFactor > 0.000001) ? loadFactor : DEFAULT_LOAD_FACTOR);
+            array = (Node **)malloc(N * sizeof(Node *));
+            if (array != NULL) {
+                md->capacity = N;
+                md->loadFactor = lf;
+                md->size = 0L;
+                md->load = 0.0;
+                md->changes = 0L;
+                md->increment = 1.0 / (double)N;
+                md->freeValue = freeValue;
+                md->buckets = array;
+                for (i = 0; i < N; i++)
+                    array[i] = NULL;
+                md->ttl = ttl;
+                md->tick = (ttl > 0L) ? ttl / TICKS_PER_TTL : DEFAULT_TICK;
+                if (md->tick < 1L)
+                    md->tick = 1L;
+                md->clock = (clock != NULL) ? clock : monotonic;
+                md->cursor = md->clock() / md->tick;
+                md->resuming = false;
+                for (i = 0; i < WHEEL_SLOTS; i++)
+                    md->wheel[i] = NULL;
+                *m = template;
+                m->self = md;
+            } else {
+                free(md);
+                free(m);
+                m = NULL;
+            }
+        } else {
+            free(m);
+            m = NULL;
+        }
+    }
+    return m;
+}
+
+static const CSKMap *m_create(const CSKMap *m) {
+    MData *md = (MData *)m->self;
+
+    return newCSKMap(DEFAULT_CAPACITY, md->loadFactor, md->ttl, md->clock,
+                     md->freeValue);
+}
+
+const CSKMap *TTLCSKMap(long capacity, double loadFactor, long ttl,
+                        long (*clock)(void), void (*freeValue)(void *v)) {
+    return newCSKMap(capacity, loadFactor, ttl, clock, freeValue);
+}
+
+bool TTLCSKMap_putTTL(const CSKMap *m, char *key, void *value, long ttl) {
+    if (m->put != m_put)
+        return false;
+    return putEntry((MData *)m->self, key, value, ttl, false);
+}
+
+bool TTLCSKMap_touch(const CSKMap *m, char *key, long ttl) {
+    MData *md;
+    Node *p;
+    long i, now;
+
+    if (m->put != m_put)
+        return false;
+    md = (MData *)m->self;
+    now = md->clock();
+    p = findKey(md, key, now, &i);
+    if (p != NULL)
+        schedule(md, p, ttl, now);
+    return (p != NULL);
+}
+
+long TTLCSKMap_expire(const CSKMap *m, long max) {
+    MData *md;
+
+    if (m->put != m_put)
+        return -1L;
+    md = (MData *)m->self;
+    return advance(md, md->clock(), max);
+}
@@ -0,0 +1,90 @@
+#ifndef _TTLCSKMAP_H_
+#define _TTLCSKMAP_H_
+
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ADTs/ADTdefs.h"
+#include "ADTs/cskmap.h"
+
+/* constructor for a CSK hash map whose entries expire */
+
+/* create a hashmap in which the keys are C strings, and in which each
+ * entry expires `ttl' milliseconds after it was last put(); if ttl is
+ * <= 0L, entries put() expire only if given a TTL by TTLCSKMap_putTTL()
+ *
+ * an expired entry is never returned; it is evicted, applying freeValue,
+ * either when it is next looked up, or by a hashed timing wheel that is
+ * advanced a bounded slice at a time by each put() and get(), and by
+ * TTLCSKMap_expire(); no operation scans the whole map; the wheel turns
+ * in ticks of ttl/64 milliseconds, so a swept entry is evicted within a
+ * tick of expiring
+ *
+ * clock is a function pointer that returns the current time in
+ * milliseconds; if it is NULL, CLOCK_MONOTONIC is used
+ *
+ * freeValue is a function pointer that will be called by destroy(),
+ * clear(), put(), remove() and eviction on each relevant entry/entries
+ * in the Map
+ *
+ * size() includes entries that have expired but have not yet been
+ * evicted; keyArray(), entryArray() and itCreate() skip them
+ *
+ * returns a pointer to the map, or NULL if there are malloc errors
+ */
+const CSKMap *TTLCSKMap(long capacity, double loadFactor, long ttl,
+                        long (*clock)(void), void (*freeValue)(void *v));
+
+/* puts (key,value) into the map, to expire `ttl' milliseconds from now;
+ * if ttl is <= 0L, the entry never expires
+ *
+ * returns true if successful, false if malloc failure or if `m' was not
+ * created by TTLCSKMap()
+ */
+bool TTLCSKMap_putTTL(const CSKMap *m, char *key, void *value, long ttl);
+
+/* sets the entry associated with key to expire `ttl' milliseconds from
+ * now, without changing its value; if ttl is <= 0L, the entry never expires
+ *
+ * returns true if successful, false if key is not in the map, or if `m'
+ * was not created by TTLCSKMap()
+ */
+bool TTLCSKMap_touch(const CSKMap *m, char *key, long ttl);
+
+/* advances the timing wheel to the current time, examining at most `max'
+ * entries; if max is <= 0L, the wheel is brought fully up to date
+ *
+ * returns the number of expired entries evicted, or -1L if `m' was not
+ * created by TTLCSKMap()
+ */
+long TTLCSKMap_expire(const CSKMap *m, long max);
+
+#endif /* _TTLCSKMAP_H_ */
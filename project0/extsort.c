@@ -0,0 +1,608 @@
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * implementation of an external merge sort
+ *
+ * the runs are kept in two unlinked temporary files, so that the sort
+ * holds two descriptors however many runs there are: spills append runs
+ * to file[cur], each run being a span of it; a merge pass reads the spans
+ * of file[cur] and appends the merged runs to file[cur ^ 1], which then
+ * becomes file[cur], and the other file is truncated
+ *
+ * an IOJob is one transfer between a buffer and a file; jobs are queued
+ * on an ArrayBlockingQueue to the I/O thread, which performs them in the
+ * order queued; a job's `done' flag is guarded by the sort's lock
+ *
+ * a run being merged has two read jobs: the front buffer is being merged
+ * while the back one is being filled with the next chunk of the run;
+ * when the front is used up, it is queued to read the chunk after the
+ * back, and the two swap
+ */
+
+#include "extsort.h"
+#include "sort.h"
+#include "ADTs/arrayblockingqueue.h"
+#include "ADTs/heapprioqueue.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#define IOSIZE (1L << 20)       /* largest transfer, in bytes */
+#define PATHLEN 4096
+
+typedef struct iojob {
+    int fd;
+    off_t off;                  /* file offset, or -1 to read()/write() */
+    char *buf;
+    size_t len;                 /* to transfer; for a read, the bytes read */
+    bool write;
+    bool done;
+    bool failed;
+} IOJob;
+
+typedef struct span {           /* a run: bytes [start, start+len) */
+    off_t start;
+    off_t len;
+} Span;
+
+typedef struct run {
+    off_t next;                 /* offset of the next chunk to read */
+    off_t end;
+    IOJob job[2];
+    int front;                  /* job whose buffer is being merged */
+    size_t pos;                 /* next record in the front buffer */
+} Run;
+
+struct extsort {
+    size_t recSize;
+    size_t budget;
+    size_t bufSize;             /* bytes per transfer, whole records */
+    int (*cmp)(void *, void *);
+    char tmpdir[PATHLEN];
+    char *records;              /* records not yet spilled */
+    void **ptrs;                /* pointers to them, for sort() */
+    long capacity;
+    long count;
+    long next;                  /* next of them for es_next() */
+    int file[2];                /* temporary files, -1 until needed */
+    int cur;                    /* file holding the runs */
+    off_t end;                  /* bytes written to file[cur] by spills */
+    Span *spans;                /* runs in file[cur], not yet merged */
+    long nspans;
+    long maxSpans;
+    long runs;
+    long passes;
+    long fanIn;                 /* most runs merged at once */
+    IOJob out[2];               /* for spills and intermediate merges */
+    Run *merging;               /* runs of the merge under way */
+    long nmerging;
+    const PrioQueue *heap;      /* record pointer -> Run * */
+    const BlockingQueue *jobs;
+    pthread_t io;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    bool finished;
+    bool failed;
+};
+
+static IOJob stop;              /* queued to stop the I/O thread */
+
+/*
+ * performs job j; returns false if I/O errors
+ */
+static bool transfer(IOJob *j) {
+    size_t n = 0;
+
+    while (n < j->len) {
+        ssize_t k;
+
+        if (j->off < 0)
+            k = j->write ? write(j->fd, j->buf + n, j->len - n)
+                         : read(j->fd, j->buf + n, j->len - n);
+        else
+            k = j->write ? pwrite(j->fd, j->buf + n, j->len - n, j->off + n)
+                         : pread(j->fd, j->buf + n, j->len - n, j->off + n);
+        if (k < 0)
+            return false;
+        if (k == 0)             /* end of file */
+            break;
+        n += k;
+    }
+    if (j->write)
+        return (n == j->len);
+    j->len = n;
+    return true;
+}
+
+static void *ioThread(void *arg) {
+    ExtSort *es = (ExtSort *)arg;
+    IOJob *j;
+
+    while (es->jobs->dequeue(es->jobs, (void **)&j) && j != &stop) {
+        bool ok = transfer(j);
+        pthread_mutex_lock(&es->lock);
+        j->failed = ! ok;
+        j->done = true;
+        pthread_cond_broadcast(&es->cond);
+        pthread_mutex_unlock(&es->lock);
+    }
+    return NULL;
+}
+
+static bool submit(ExtSort *es, IOJob *j, int fd, off_t off, size_t len,
+                   bool write) {
+    j->fd = fd;
+    j->off = off;
+    j->len = len;
+    j->write = write;
+    j->done = false;
+    j->failed = false;
+    if (es->jobs->enqueue(es->jobs, j))
+        return true;
+    j->done = j->failed = true;
+    return false;
+}
+
+/*
+ * waits for job j to finish; returns false if it failed
+ */
+static bool await(ExtSort *es, IOJob *j) {
+    pthread_mutex_lock(&es->lock);
+    while (! j->done)
+        pthread_cond_wait(&es->cond, &es->lock);
+    pthread_mutex_unlock(&es->lock);
+    return ! j->failed;
+}
+
+/*
+ * returns a descriptor for a new, already unlinked, temporary file, or -1
+ */
+static int tempFile(ExtSort *es) {
+    char path[PATHLEN + 32];
+    int fd;
+
+    snprintf(path, sizeof path, "%s/extsortXXXXXX", es->tmpdir);
+    if ((fd = mkstemp(path)) >= 0)
+        unlink(path);
+    return fd;
+}
+
+static bool addSpan(ExtSort *es, off_t start, off_t len) {
+    if (es->nspans == es->maxSpans) {
+        long n = 2 * es->maxSpans;
+        Span *tmp = (Span *)realloc(es->spans, n * sizeof(Span));
+        if (tmp == NULL)
+            return false;
+        es->spans = tmp;
+        es->maxSpans = n;
+    }
+    es->spans[es->nspans].start = start;
+    es->spans[es->nspans++].len = len;
+    return true;
+}
+
+/*
+ * a writer gathers records into the out buffers, queueing each one to be
+ * written at the end of a file as it fills, and waiting for the other to
+ * be written before filling it in turn
+ */
+typedef struct writer {
+    int fd;
+    off_t off;                  /* where the next buffer goes */
+    int cur;
+    size_t fill;
+    bool ok;
+} Writer;
+
+static void wBegin(ExtSort *es, Writer *w, int fd, off_t off) {
+    w->fd = fd;
+    w->off = off;
+    w->cur = 0;
+    w->fill = 0;
+    w->ok = await(es, &es->out[0]) & await(es, &es->out[1]);
+}
+
+static void wPut(ExtSort *es, Writer *w, void *record) {
+    if (w->fill + es->recSize > es->bufSize) {
+        w->ok &= submit(es, &es->out[w->cur], w->fd, w->off, w->fill, true);
+        w->off += w->fill;
+        w->cur ^= 1;
+        w->ok &= await(es, &es->out[w->cur]);
+        w->fill = 0;
+    }
+    memcpy(es->out[w->cur].buf + w->fill, record, es->recSize);
+    w->fill += es->recSize;
+}
+
+static bool wEnd(ExtSort *es, Writer *w) {
+    if (w->fill > 0)
+        w->ok &= submit(es, &es->out[w->cur], w->fd, w->off, w->fill, true);
+    w->off += w->fill;
+    w->ok &= await(es, &es->out[0]) & await(es, &es->out[1]);
+    return w->ok;
+}
+
+/*
+ * sorts the records in memory and appends them to file[cur] as a new run
+ */
+static bool spill(ExtSort *es) {
+    Writer w;
+    long i;
+
+    if (es->file[es->cur] < 0 && (es->file[es->cur] = tempFile(es)) < 0)
+        return false;
+    sort(es->ptrs, es->count, es->cmp);
+    wBegin(es, &w, es->file[es->cur], es->end);
+    for (i = 0; i < es->count; i++)
+        wPut(es, &w, es->ptrs[i]);
+    es->count = 0L;
+    es->runs++;
+    if (! wEnd(es, &w) || ! addSpan(es, es->end, w.off - es->end))
+        return false;
+    es->end = w.off;
+    return true;
+}
+
+/*
+ * queues job j of run r to read the run's next chunk, if any
+ */
+static bool readChunk(ExtSort *es, Run *r, IOJob *j) {
+    size_t len = es->bufSize;
+
+    if ((off_t)len > r->end - r->next)
+        len = r->end - r->next;
+    if (len == 0) {                     /* nothing left: an empty read */
+        j->len = 0;
+        j->done = true;
+        j->failed = false;
+        return true;
+    }
+    r->next += len;
+    return submit(es, j, es->file[es->cur], r->next - len, len, false);
+}
+
+/*
+ * starts merging the first n runs in es->spans, which are removed from it
+ */
+static bool openMerge(ExtSort *es, long n) {
+    long i;
+
+    es->merging = (Run *)calloc(n, sizeof(Run));
+    es->heap = HeapPrioQueue(es->cmp, doNothing, doNothing);
+    if (es->merging == NULL || es->heap == NULL)
+        return false;
+    for (i = 0; i < n; i++) {
+        Run *r = &es->merging[i];
+        r->next = es->spans[i].start;
+        r->end = es->spans[i].start + es->spans[i].len;
+        r->job[0].done = r->job[1].done = true;
+    }
+    es->nmerging = n;
+    memmove(es->spans, es->spans + n, (es->nspans - n) * sizeof(Span));
+    es->nspans -= n;
+    for (i = 0; i < n; i++) {
+        Run *r = &es->merging[i];
+        r->job[0].buf = (char *)malloc(es->bufSize);
+        r->job[1].buf = (char *)malloc(es->bufSize);
+        if (r->job[0].buf == NULL || r->job[1].buf == NULL)
+            return false;
+        if (! readChunk(es, r, &r->job[0]) || ! readChunk(es, r, &r->job[1]))
+            return false;
+    }
+    for (i = 0; i < n; i++) {
+        Run *r = &es->merging[i];
+        r->front = 0;
+        r->pos = 0;
+        if (! await(es, &r->job[0]))
+            return false;
+        if (r->job[0].len > 0 &&
+            ! es->heap->insert(es->heap, r->job[0].buf, r))
+            return false;
+    }
+    return true;
+}
+
+/*
+ * copies the smallest record of the merge under way to `record'
+ *
+ * returns false if the merge is over, or if errors, which set es->failed
+ */
+static bool mergeNext(ExtSort *es, void *record) {
+    void *prio;
+    Run *r;
+
+    if (! es->heap->removeMin(es->heap, &prio, (void **)&r))
+        return false;
+    memcpy(record, prio, es->recSize);
+    r->pos += es->recSize;
+    if (r->pos >= r->job[r->front].len) {
+        if (! readChunk(es, r, &r->job[r->front]))
+            es->failed = true;
+        r->front ^= 1;
+        r->pos = 0;
+        if (! await(es, &r->job[r->front]))
+            es->failed = true;
+    }
+    if (r->job[r->front].len > 0 &&
+        ! es->heap->insert(es->heap, r->job[r->front].buf + r->pos, r))
+        es->failed = true;
+    return ! es->failed;
+}
+
+static void closeMerge(ExtSort *es) {
+    long i;
+
+    for (i = 0; i < es->nmerging; i++) {
+        Run *r = &es->merging[i];
+        (void)await(es, &r->job[0]);
+        (void)await(es, &r->job[1]);
+        free(r->job[0].buf);
+        free(r->job[1].buf);
+    }
+    free(es->merging);
+    es->merging = NULL;
+    es->nmerging = 0L;
+    if (es->heap != NULL)
+        es->heap->destroy(es->heap);
+    es->heap = NULL;
+}
+
+/*
+ * merges the first n runs in es->spans onto the end of the other file,
+ * at offset `*off', which is advanced past the new run; its span is saved
+ * in `*merged'
+ */
+static bool mergeRuns(ExtSort *es, long n, off_t *off, Span *merged) {
+    char record[es->recSize];
+    Writer w;
+
+    if (! openMerge(es, n)) {
+        closeMerge(es);
+        return false;
+    }
+    wBegin(es, &w, es->file[es->cur ^ 1], *off);
+    while (mergeNext(es, record))
+        wPut(es, &w, record);
+    closeMerge(es);
+    if (! wEnd(es, &w) || es->failed)
+        return false;
+    merged->start = *off;
+    merged->len = w.off - *off;
+    *off = w.off;
+    return true;
+}
+
+/*
+ * merges the runs in groups of fanIn, from file[cur] to the other file,
+ * which then becomes file[cur]
+ */
+static bool mergePass(ExtSort *es) {
+    long groups = (es->nspans + es->fanIn - 1) / es->fanIn, i;
+    Span *merged = (Span *)malloc(groups * sizeof(Span));
+    int other = es->cur ^ 1;
+    off_t off = 0;
+
+    if (merged == NULL)
+        return false;
+    if ((es->file[other] < 0 && (es->file[other] = tempFile(es)) < 0) ||
+        ftruncate(es->file[other], 0) < 0) {
+        free(merged);
+        return false;
+    }
+    for (i = 0; i < groups; i++)
+        if (! mergeRuns(es, (es->nspans < es->fanIn) ? es->nspans : es->fanIn,
+                        &off, &merged[i])) {
+            free(merged);
+            return false;
+        }
+    (void)ftruncate(es->file[es->cur], 0);      /* free the old runs */
+    es->cur = other;
+    for (i = 0; i < groups; i++)        /* cannot fail: nspans was larger */
+        (void)addSpan(es, merged[i].start, merged[i].len);
+    free(merged);
+    return true;
+}
+
+ExtSort *es_create(size_t recordSize, size_t budget,
+                   int (*cmp)(void *r1, void *r2), const char *tmpdir) {
+    ExtSort *es;
+    size_t perRecord = recordSize + 2 * sizeof(void *);
+    size_t bufSize = budget / 8;
+    long capacity, fanIn;
+
+    if (bufSize > IOSIZE)
+        bufSize = IOSIZE;
+    if (recordSize == 0 || bufSize < recordSize)
+        return NULL;
+    bufSize -= bufSize % recordSize;
+    /* the out buffers are kept throughout; sort() takes a pointer each */
+    capacity = (budget - 2 * bufSize) / perRecord;
+    fanIn = budget / (2 * bufSize) - 1;
+    if (capacity < 1L || fanIn < 2L)    /* the budget is too small */
+        return NULL;
+    if ((es = (ExtSort *)calloc(1, sizeof(ExtSort))) == NULL)
+        return NULL;
+    es->recSize = recordSize;
+    es->budget = budget;
+    es->bufSize = bufSize;
+    es->cmp = cmp;
+    snprintf(es->tmpdir, PATHLEN, "%s", (tmpdir != NULL) ? tmpdir : "/tmp");
+    es->capacity = capacity;
+    es->fanIn = fanIn;
+    es->file[0] = es->file[1] = -1;
+    es->maxSpans = 16L;
+    es->records = (char *)malloc(es->capacity * recordSize);
+    es->ptrs = (void **)malloc(es->capacity * sizeof(void *));
+    es->spans = (Span *)malloc(es->maxSpans * sizeof(Span));
+    es->out[0].buf = (char *)malloc(bufSize);
+    es->out[1].buf = (char *)malloc(bufSize);
+    es->out[0].done = es->out[1].done = true;
+    es->jobs = ArrayBlockingQueue(8L, doNothing);
+    pthread_mutex_init(&es->lock, NULL);
+    pthread_cond_init(&es->cond, NULL);
+    if (es->records == NULL || es->ptrs == NULL || es->spans == NULL ||
+        es->out[0].buf == NULL || es->out[1].buf == NULL ||
+        es->jobs == NULL || pthread_create(&es->io, NULL, ioThread, es)) {
+        if (es->jobs != NULL)
+            es->jobs->destroy(es->jobs);
+        es->jobs = NULL;
+        es_destroy(es);
+        return NULL;
+    }
+    return es;
+}
+
+bool es_add(ExtSort *es, void *record) {
+    char *p;
+
+    if (es->finished || es->failed)
+        return false;
+    if (es->count == es->capacity && ! spill(es)) {
+        es->failed = true;
+        return false;
+    }
+    p = es->records + es->count * es->recSize;
+    memcpy(p, record, es->recSize);
+    es->ptrs[es->count++] = p;
+    return true;
+}
+
+bool es_finish(ExtSort *es) {
+    if (es->finished || es->failed)
+        return ! es->failed;
+    es->finished = true;
+    if (es->nspans == 0L) {             /* everything fitted in memory */
+        sort(es->ptrs, es->count, es->cmp);
+        return true;
+    }
+    if (es->count > 0L && ! spill(es))
+        return ! (es->failed = true);
+    free(es->records);                  /* the budget now goes to merging */
+    free(es->ptrs);
+    es->records = NULL;
+    es->ptrs = NULL;
+    es->count = 0L;
+    while (es->nspans > es->fanIn) {    /* a pass over all of the runs */
+        if (! mergePass(es))
+            return ! (es->failed = true);
+        es->passes++;
+    }
+    if (! openMerge(es, es->nspans))
+        return ! (es->failed = true);
+    return true;
+}
+
+bool es_next(ExtSort *es, void *record) {
+    if (! es->finished || es->failed)
+        return false;
+    if (es->heap != NULL)
+        return mergeNext(es, record);
+    if (es->next >= es->count)
+        return false;
+    memcpy(record, es->ptrs[es->next++], es->recSize);
+    return true;
+}
+
+long es_runs(ExtSort *es, long *passes) {
+    *passes = es->passes;
+    return es->runs;
+}
+
+void es_destroy(ExtSort *es) {
+    if (es->jobs != NULL) {
+        closeMerge(es);
+        (void)await(es, &es->out[0]);
+        (void)await(es, &es->out[1]);
+        es->jobs->enqueue(es->jobs, &stop);
+        pthread_join(es->io, NULL);
+        es->jobs->destroy(es->jobs);
+    }
+    if (es->file[0] >= 0)
+        close(es->file[0]);
+    if (es->file[1] >= 0)
+        close(es->file[1]);
+    pthread_mutex_destroy(&es->lock);
+    pthread_cond_destroy(&es->cond);
+    free(es->out[0].buf);
+    free(es->out[1].buf);
+    free(es->spans);
+    free(es->ptrs);
+    free(es->records);
+    free(es);
+}
+
+bool es_sortFile(int in, int out, size_t recordSize, size_t budget,
+                 int (*cmp)(void *r1, void *r2), const char *tmpdir) {
+    ExtSort *es = es_create(recordSize, budget, cmp, tmpdir);
+    char *buf, record[recordSize];
+    size_t i, bufSize;
+    bool ok = true;
+    IOJob j;
+
+    if (es == NULL)
+        return false;
+    bufSize = es->bufSize;
+    if ((buf = (char *)malloc(bufSize)) == NULL) {
+        es_destroy(es);
+        return false;
+    }
+    j.buf = buf;
+    for (;;) {
+        j.fd = in; j.off = -1; j.len = bufSize; j.write = false;
+        if (! transfer(&j) || j.len % recordSize != 0) {
+            ok = false;
+            break;
+        }
+        if (j.len == 0)
+            break;
+        for (i = 0; ok && i < j.len; i += recordSize)
+            ok = es_add(es, buf + i);
+    }
+    ok = ok && es_finish(es);
+    j.fd = out; j.off = -1; j.write = true; j.len = 0;
+    while (ok && es_next(es, record)) {
+        memcpy(buf + j.len, record, recordSize);
+        j.len += recordSize;
+        if (j.len == bufSize) {
+            ok = transfer(&j);
+            j.len = 0;
+        }
+    }
+    if (ok && j.len > 0)
+        ok = transfer(&j);
+    ok = ok && ! es->failed;
+    free(buf);
+    es_destroy(es);
+    return ok;
+}
@@ -0,0 +1,115 @@
+#ifndef _EXTSORT_H_
+#define _EXTSORT_H_
+
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * external merge sort of fixed-size records, for data sets larger than
+ * the memory that may be used to sort them
+ *
+ * records are collected in a buffer that fits in the memory budget; each
+ * time it fills, it is sorted with sort() and appended to a temporary file
+ * as a sorted run; es_finish() then merges the runs with a HeapPrioQueue,
+ * in several passes if there are more runs than the budget can hold
+ * buffers for; a pass writes its merged runs to a second temporary file,
+ * so the sort holds two descriptors however many runs there are, and may
+ * need disk space for about twice the data during a pass
+ *
+ * all file I/O is done in large sequential transfers by a separate I/O
+ * thread; each run being merged has two buffers, one being merged while
+ * the other is filled, and spills are written from a pair of buffers in
+ * the same way, so merging overlaps the I/O
+ *
+ * cmp is applied to pointers to two records, yielding <0 | 0 | >0
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct extsort ExtSort;
+
+/*
+ * es_create - create a sort of records of `recordSize' bytes that uses at
+ * most about `budget' bytes of memory, and puts its temporary files in
+ * `tmpdir' (if NULL, "/tmp")
+ *
+ * returns NULL if the budget is too small, if malloc errors, or if the
+ * I/O thread cannot be started
+ */
+ExtSort *es_create(size_t recordSize, size_t budget,
+                   int (*cmp)(void *r1, void *r2), const char *tmpdir);
+
+/*
+ * es_add - add a copy of the record at `record' to the sort
+ *
+ * returns true if successful, false if malloc or I/O errors
+ */
+bool es_add(ExtSort *es, void *record);
+
+/*
+ * es_finish - no more records will be added; merges the runs until they
+ * can all be merged at once by es_next()
+ *
+ * returns true if successful, false if malloc or I/O errors
+ */
+bool es_finish(ExtSort *es);
+
+/*
+ * es_next - copies the next record in sorted order to `record'
+ *
+ * returns true if successful, false if there are no more records or if
+ * I/O errors
+ */
+bool es_next(ExtSort *es, void *record);
+
+/*
+ * es_runs - returns the number of sorted runs spilled to temporary files,
+ * and the number of merge passes made before the final one in `*passes'
+ */
+long es_runs(ExtSort *es, long *passes);
+
+/*
+ * es_destroy - stop the I/O thread, remove the temporary files and return
+ * the storage associated with the sort to the heap
+ */
+void es_destroy(ExtSort *es);
+
+/*
+ * es_sortFile - sort the records read from file descriptor `in' onto file
+ * descriptor `out'; the input must be a whole number of records
+ *
+ * returns true if successful, false if errors
+ */
+bool es_sortFile(int in, int out, size_t recordSize, size_t budget,
+                 int (*cmp)(void *r1, void *r2), const char *tmpdir);
+
+#endif /* _EXTSORT_H_ */
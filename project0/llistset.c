@@ -1,67 +1,334 @@
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * implementation of an ordered set as a skip list
+ *
+ * every element has a node with a tower of 1 .. MAX_LEVEL forward
+ * pointers; level 0 links all of the nodes in ascending order, and each
+ * higher level links about a quarter of the nodes of the level below, so
+ * that add(), contains() and remove() take O(log n) comparisons, and
+ * toArray() and itCreate() walk level 0 to yield the elements in order
+ *
+ * each node and its tower are carved as one block from an arena of
+ * ARENA_BYTES chunks, so that neighbouring nodes are usually adjacent in
+ * memory; the nodes of removed elements are kept on a free list for their
+ * height and reused by later add()s; the chunks are returned to the heap
+ * only by clear() and destroy()
+ */
+
 #include "llistset.h"  /* the .h file does NOT reside in /usr/local/include/ADTs */
 #include <stdlib.h>
-/* any other includes needed by your code */
-#define UNUSED __attribute__((unused))
+
+#define MAX_LEVEL 32			/* enough for 4^32 elements */
+#define ARENA_BYTES 65536L
+
+typedef struct node {
+    void *value;
+    int level;				/* height of the tower */
+    struct node *next[];		/* next[0 .. level-1] */
+} Node;
+
+typedef struct chunk {
+    struct chunk *next;
+} Chunk;
 
 typedef struct s_data {
-    /* definitions of the data members of self */
+    long size;
+    int level;				/* levels in use, >= 1 */
+    unsigned long seed;			/* xorshift state for tower heights */
+    Node *head;				/* tower of MAX_LEVEL, no value */
+    Node *free[MAX_LEVEL + 1];		/* removed nodes, by height */
+    Chunk *chunks;			/* arena chunks, newest first */
+    char *avail;			/* unused part of the newest chunk */
+    long left;				/* bytes at avail */
+    void (*freeValue)(void *v);
+    int (*cmp)(void *, void *);
 } SData;
 
+#define NODE_BYTES(level) (sizeof(Node) + (level) * sizeof(Node *))
+
 /*
- * important - remove UNUSED Attribute in signatures when you flesh out methods
+ * returns a tower height of h with probability 3/4^h, from the number of
+ * trailing pairs of zero bits of the next pseudo-random number
  */
+static int randomLevel(SData *sd) {
+    unsigned long x = sd->seed;
+    int level = 1;
 
-static void s_destroy(UNUSED const Set *s) {
-    /* implement the destroy() method */
-    return;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    sd->seed = x;
+    while ((x & 3UL) == 0UL && level < MAX_LEVEL) {
+        level++;
+        x >>= 2;
+    }
+    return level;
 }
 
-static void s_clear(UNUSED const Set *s) {
-    /* implement the clear() method */
-    return;
+/*
+ * returns a node with a tower of `level', reusing a removed node of that
+ * height if there is one, or NULL if malloc failure
+ */
+static Node *newNode(SData *sd, int level) {
+    long bytes = NODE_BYTES(level);
+    Node *n = sd->free[level];
+
+    if (n != NULL) {
+        sd->free[level] = n->next[0];
+        return n;
+    }
+    if (sd->left < bytes) {
+        Chunk *c = (Chunk *)malloc(ARENA_BYTES);
+
+        if (c == NULL)
+            return NULL;
+        c->next = sd->chunks;
+        sd->chunks = c;
+        sd->avail = (char *)c + sizeof(Chunk);
+        sd->left = ARENA_BYTES - sizeof(Chunk);
+    }
+    n = (Node *)sd->avail;
+    sd->avail += bytes;
+    sd->left -= bytes;
+    n->level = level;
+    return n;
 }
 
-static bool s_add(UNUSED const Set *s, UNUSED void *member) {
-    /* implement the add() method */
-    return 0;
+/*
+ * finds the last node before `member' at each level, storing them in
+ * update[0 .. sd->level-1]
+ *
+ * returns the first node whose value is >= member, or NULL if none
+ *
+ * a node that has been compared with `member' at one level is not compared
+ * again at the levels below
+ */
+static Node *search(SData *sd, void *member, Node *update[]) {
+    Node *x = sd->head, *n = NULL, *stop = NULL;
+    int i;
+
+    for (i = sd->level - 1; i >= 0; i--) {
+        while ((n = x->next[i]) != stop && sd->cmp(n->value, member) < 0)
+            x = n;
+        stop = n;
+        update[i] = x;
+    }
+    return n;
 }
 
-static bool s_contains(UNUSED const Set *s, UNUSED void *member) {
-    /* implement the contains() method */
-    return 0;
+static void purge(SData *sd) {
+    Node *n;
+    int i;
+
+    for (n = sd->head->next[0]; n != NULL; n = n->next[0])
+        sd->freeValue(n->value);
+    while (sd->chunks != NULL) {
+        Chunk *c = sd->chunks;
+
+        sd->chunks = c->next;
+        free(c);
+    }
+    for (i = 0; i < MAX_LEVEL; i++)
+        sd->head->next[i] = NULL;
+    for (i = 0; i <= MAX_LEVEL; i++)
+        sd->free[i] = NULL;
+    sd->avail = NULL;
+    sd->left = 0L;
+    sd->level = 1;
+    sd->size = 0L;
 }
 
-static bool s_isEmpty(UNUSED const Set *s) {
-    /* implement the isEmpty() method */
-    return 1;
+static void s_destroy(const Set *s) {
+    SData *sd = (SData *)s->self;
+
+    purge(sd);
+    free(sd->head);
+    free(sd);
+    free((void *)s);
 }
 
-static bool s_remove(UNUSED const Set *s, UNUSED void *member) {
-    /* implement the remove() method */
-    return 0;
+static void s_clear(const Set *s) {
+    SData *sd = (SData *)s->self;
+
+    purge(sd);
 }
 
-static long s_size(UNUSED const Set *s) {
-    /* implement the size() method */
-    return 0L;
+static bool s_add(const Set *s, void *member) {
+    SData *sd = (SData *)s->self;
+    Node *update[MAX_LEVEL], *n;
+    int i, level;
+
+    n = search(sd, member, update);
+    if (n != NULL && sd->cmp(n->value, member) == 0)
+        return false;
+    level = randomLevel(sd);
+    if ((n = newNode(sd, level)) == NULL)
+        return false;
+    for (i = sd->level; i < level; i++)
+        update[i] = sd->head;
+    if (level > sd->level)
+        sd->level = level;
+    n->value = member;
+    for (i = 0; i < level; i++) {
+        n->next[i] = update[i]->next[i];
+        update[i]->next[i] = n;
+    }
+    sd->size++;
+    return true;
+}
+
+static bool s_contains(const Set *s, void *member) {
+    SData *sd = (SData *)s->self;
+    Node *x = sd->head, *n = NULL, *stop = NULL;
+    int i;
+
+    for (i = sd->level - 1; i >= 0; i--) {
+        while ((n = x->next[i]) != stop && sd->cmp(n->value, member) < 0)
+            x = n;
+        stop = n;
+    }
+    return (n != NULL && sd->cmp(n->value, member) == 0);
+}
+
+static bool s_isEmpty(const Set *s) {
+    SData *sd = (SData *)s->self;
+
+    return (sd->size == 0L);
+}
+
+static bool s_remove(const Set *s, void *member) {
+    SData *sd = (SData *)s->self;
+    Node *update[MAX_LEVEL], *n;
+    int i;
+
+    n = search(sd, member, update);
+    if (n == NULL || sd->cmp(n->value, member) != 0)
+        return false;
+    for (i = 0; i < n->level; i++)
+        update[i]->next[i] = n->next[i];
+    while (sd->level > 1 && sd->head->next[sd->level - 1] == NULL)
+        sd->level--;
+    sd->freeValue(n->value);
+    n->next[0] = sd->free[n->level];
+    sd->free[n->level] = n;
+    sd->size--;
+    return true;
+}
+
+static long s_size(const Set *s) {
+    SData *sd = (SData *)s->self;
+
+    return sd->size;
 }
 
-static void **s_toArray(UNUSED const Set *s, UNUSED long *len) {
-    /* implement the toArray() method */
-    return NULL;
+/*
+ * helper function for generating an array of the elements in ascending
+ * order
+ *
+ * returns pointer to the array or NULL if malloc failure or if the set is
+ * empty
+ */
+static void **entries(SData *sd) {
+    void **tmp = NULL;
+
+    if (sd->size > 0L) {
+        tmp = (void **)malloc(sd->size * sizeof(void *));
+        if (tmp != NULL) {
+            Node *n;
+            long i = 0L;
+
+            for (n = sd->head->next[0]; n != NULL; n = n->next[0])
+                tmp[i++] = n->value;
+        }
+    }
+    return tmp;
 }
 
-static const Iterator *s_itCreate(UNUSED const Set *s) {
-    /* implement the itCreate() method */
-    return NULL;
+static void **s_toArray(const Set *s, long *len) {
+    SData *sd = (SData *)s->self;
+    void **tmp = entries(sd);
+
+    if (tmp != NULL)
+        *len = sd->size;
+    return tmp;
 }
 
-static UNUSED Set template = {
+static const Iterator *s_itCreate(const Set *s) {
+    SData *sd = (SData *)s->self;
+    const Iterator *it = NULL;
+    void **tmp = entries(sd);
+
+    if (tmp != NULL) {
+        it = Iterator_create(sd->size, tmp);
+        if (it == NULL)
+            free(tmp);
+    }
+    return it;
+}
+
+static Set template = {
     NULL, s_destroy, s_clear, s_add, s_contains, s_isEmpty, s_remove,
     s_size, s_toArray, s_itCreate
 };
 
-const Set *LListSet(UNUSED void (*freeValue)(void*), UNUSED int (*cmpFxn)(void*, void*)) {
-    /* construct a Set instance and return to the caller */
-    return NULL;
+const Set *LListSet(void (*freeValue)(void*), int (*cmpFxn)(void*, void*)) {
+    Set *s = (Set *)malloc(sizeof(Set));
+    SData *sd = (SData *)malloc(sizeof(SData));
+    Node *head = (Node *)malloc(NODE_BYTES(MAX_LEVEL));
+    int i;
+
+    if (s == NULL || sd == NULL || head == NULL) {
+        free(s);
+        free(sd);
+        free(head);
+        return NULL;
+    }
+    head->value = NULL;
+    head->level = MAX_LEVEL;
+    for (i = 0; i < MAX_LEVEL; i++)
+        head->next[i] = NULL;
+    for (i = 0; i <= MAX_LEVEL; i++)
+        sd->free[i] = NULL;
+    sd->size = 0L;
+    sd->level = 1;
+    sd->seed = 0x9E3779B97F4A7C15UL;
+    sd->head = head;
+    sd->chunks = NULL;
+    sd->avail = NULL;
+    sd->left = 0L;
+    sd->freeValue = freeValue;
+    sd->cmp = cmpFxn;
+    *s = template;
+    s->self = sd;
+    return s;
 }
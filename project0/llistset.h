@@ -39,14 +39,16 @@
 #include "set.h"             /* dispatch table */
 
 /*
- * create a LListSet
+ * create a LListSet, an ordered set kept as a skip list; add(), contains()
+ * and remove() take O(log n) comparisons, and toArray() and itCreate()
+ * return the elements in ascending order
  *
  * freeValue is a function that returns any heap memory associated with
  * a set element to the heap; if specified as doNothing, nothing is done to
  * the elements before they are deleted
  *
- * cmp is used to determine equality between two objects, with
- * `cmp(first, second)' returning 0 if first==second, <>0 otherwise
+ * cmp is used to order two objects, with `cmp(first, second)' returning
+ * <0 if first<second, 0 if first==second, >0 if first>second
  *
  * returns a pointer to the set, or NULL if there are malloc() errors
  */
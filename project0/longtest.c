@@ -1,6 +1,8 @@
 #include "hashset.h"
 #include "llistset.h"
+#include "roaringset.h"
 #include "sort.h"
+#include "extsort.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -10,6 +12,11 @@ int ncmp(void *x1, void *x2) {
     return ((long)x1 - (long)x2);
 }
 
+int rcmp(void *r1, void *r2) {
+    long a = *(long *)r1, b = *(long *)r2;
+    return (a < b) ? -1 : (a > b);
+}
+
 int scmp(void *x1, void *x2) {
     return strcmp((char *)x1, (char *)x2);
 }
@@ -45,31 +52,34 @@ int findStr(char *v, char *array[], long size) {
     return 0;
 }
 
-const Set *create(int dohash, void (*freeV)(void*), int (*cmp)(void*, void*),
+#define HASH 1
+#define LLIST 2
+#define ROARING 3
+#define USAGE "usage: %s -h|-l|-r test# . . .\n"
+
+const Set *create(int which, void (*freeV)(void*), int (*cmp)(void*, void*),
                   long cap, double lf, long (*hash)(void*, long)) {
     const Set *s;
-    if (dohash)
+    if (which == HASH)
         s = HashSet(freeV, cmp, cap, lf, hash);
+    else if (which == ROARING)
+        s = RoaringSet();
     else
         s = LListSet(freeV, cmp);
     return s;
 }
 
-#define HASH 1
-#define LLIST 2
-#define USAGE "usage: %s -h|-l test# . . .\n"
-
 int main(int argc, char *argv[]) {
     int i;
     int which = 0;
     int opt;
-    int dohash;
 
     opterr = 0;
-    while ((opt = getopt(argc, argv, "hl")) != -1) {
+    while ((opt = getopt(argc, argv, "hlr")) != -1) {
         switch (opt) {
         case 'h': which = HASH; break;
         case 'l': which = LLIST; break;
+        case 'r': which = ROARING; break;
         default:
             fprintf(stderr, "%s: illegal option, '-%c'\n", argv[0], optopt);
             fprintf(stderr, USAGE, argv[0]);
@@ -78,18 +88,17 @@ int main(int argc, char *argv[]) {
         }
     }
     if (which == 0) {
-        fprintf(stderr, "%s: you must specify either -h or -l\n", argv[0]);
+        fprintf(stderr, "%s: you must specify one of -h, -l or -r\n", argv[0]);
         fprintf(stderr, USAGE, argv[0]);
         return EXIT_FAILURE;
     }
-    dohash = (which == HASH);
     for (i = optind; i < argc; i++) {
         int test;
         sscanf(argv[i], "%d", &test);
         switch(test) {
           case 1: {
             printf("Test creation and destruction of a set ... ");
-            const Set *s = create(dohash, doNothing, ncmp, 0L, 0.0, nhash);
+            const Set *s = create(which, doNothing, ncmp, 0L, 0.0, nhash);
             if (s != NULL) {
                 printf("success\n");
                 s->destroy(s);
@@ -99,7 +108,7 @@ int main(int argc, char *argv[]) {
           }
           case 2: {
             printf("Test addition of a single value ... ");
-            const Set *s = create(dohash, doNothing, ncmp, 0L, 0.0, nhash);
+            const Set *s = create(which, doNothing, ncmp, 0L, 0.0, nhash);
             if (s->add(s, (void *)42))
                 printf("success\n");
             else
@@ -109,7 +118,7 @@ int main(int argc, char *argv[]) {
           }
           case 3: {
             printf("Test addition of a duplicate value ... ");
-            const Set *s = create(dohash, doNothing, ncmp, 0L, 0.0, nhash);
+            const Set *s = create(which, doNothing, ncmp, 0L, 0.0, nhash);
             (void)s->add(s, (void *)42);
             if (! s->add(s, (void *)42))
                 printf("success\n");
@@ -120,7 +129,7 @@ int main(int argc, char *argv[]) {
           }
           case 4: {
             printf("Test isEmpty() on an empty set ... ");
-            const Set *s = create(dohash, doNothing, ncmp, 0L, 0.0, nhash);
+            const Set *s = create(which, doNothing, ncmp, 0L, 0.0, nhash);
             if (s->isEmpty(s))
                 printf("success\n");
             else
@@ -130,7 +139,7 @@ int main(int argc, char *argv[]) {
           }
           case 5: {
             printf("Test isEmpty() on a non-empty set ... ");
-            const Set *s = create(dohash, doNothing, ncmp, 0L, 0.0, nhash);
+            const Set *s = create(which, doNothing, ncmp, 0L, 0.0, nhash);
             (void)s->add(s, (void *)42);
             if (! s->isEmpty(s))
                 printf("success\n");
@@ -141,7 +150,7 @@ int main(int argc, char *argv[]) {
           }
           case 6: {
             printf("Test contains() on an empty set ... ");
-            const Set *s = create(dohash, doNothing, ncmp, 0L, 0.0, nhash);
+            const Set *s = create(which, doNothing, ncmp, 0L, 0.0, nhash);
             if (! s->contains(s, (void *)42))
                 printf("success\n");
             else
@@ -151,7 +160,7 @@ int main(int argc, char *argv[]) {
           }
           case 7: {
             printf("Test contains() on a non-empty set and value is present ... ");
-            const Set *s = create(dohash, doNothing, ncmp, 0L, 0.0, nhash);
+            const Set *s = create(which, doNothing, ncmp, 0L, 0.0, nhash);
             (void)s->add(s, (void *)42);
             if (s->contains(s, (void *)42))
                 printf("success\n");
@@ -162,7 +171,7 @@ int main(int argc, char *argv[]) {
           }
           case 8: {
             printf("Test contains() on a non-empty set and value is not present ... ");
-            const Set *s = create(dohash, doNothing, ncmp, 0L, 0.0, nhash);
+            const Set *s = create(which, doNothing, ncmp, 0L, 0.0, nhash);
             (void)s->add(s, (void *)42);
             if (! s->contains(s, (void *)99))
                 printf("success\n");
@@ -173,7 +182,7 @@ int main(int argc, char *argv[]) {
           }
           case 9: {
             printf("Test remove() on an empty set ... ");
-            const Set *s = create(dohash, doNothing, ncmp, 0L, 0.0, nhash);
+            const Set *s = create(which, doNothing, ncmp, 0L, 0.0, nhash);
             if (! s->remove(s, (void *)99))
                 printf("success\n");
             else
@@ -183,7 +192,7 @@ int main(int argc, char *argv[]) {
           }
           case 10: {
             printf("Test remove() on a non-empty set and value is present ... ");
-            const Set *s = create(dohash, doNothing, ncmp, 0L, 0.0, nhash);
+            const Set *s = create(which, doNothing, ncmp, 0L, 0.0, nhash);
             (void)s->add(s, (void *)42);
             if (s->remove(s, (void *)42))
                 printf("success\n");
@@ -194,7 +203,7 @@ int main(int argc, char *argv[]) {
           }
           case 11: {
             printf("Test remove() on a non-empty set and value is not present ... ");
-            const Set *s = create(dohash, doNothing, ncmp, 0L, 0.0, nhash);
+            const Set *s = create(which, doNothing, ncmp, 0L, 0.0, nhash);
             (void)s->add(s, (void *)42);
             if (! s->remove(s, (void *)99))
                 printf("success\n");
@@ -205,7 +214,7 @@ int main(int argc, char *argv[]) {
           }
           case 12: {
             printf("Test size() on an empty set ... ");
-            const Set *s = create(dohash, doNothing, ncmp, 0L, 0.0, nhash);
+            const Set *s = create(which, doNothing, ncmp, 0L, 0.0, nhash);
             if (s->size(s) == 0L)
                 printf("success\n");
             else
@@ -215,7 +224,7 @@ int main(int argc, char *argv[]) {
           }
           case 13: {
             printf("Test size() on a non-empty set ... ");
-            const Set *s = create(dohash, doNothing, ncmp, 0L, 0.0, nhash);
+            const Set *s = create(which, doNothing, ncmp, 0L, 0.0, nhash);
             (void)s->add(s, (void *)42);
             if (s->size(s) != 0L)
                 printf("success\n");
@@ -226,7 +235,7 @@ int main(int argc, char *argv[]) {
           }
           case 14: {
             printf("Test addition of multiple, unique values ... ");
-            const Set *s = create(dohash, doNothing, ncmp, 0L, 0.0, nhash);
+            const Set *s = create(which, doNothing, ncmp, 0L, 0.0, nhash);
             long values[] = {1, 2, 3, 4, 5};
             int i, success = 1;
             for (i = 0; i < 5; i++) {
@@ -244,7 +253,7 @@ int main(int argc, char *argv[]) {
           }
           case 15: {
             printf("Test toArray() ... ");
-            const Set *s = create(dohash, doNothing, ncmp, 0L, 0.0, nhash);
+            const Set *s = create(which, doNothing, ncmp, 0L, 0.0, nhash);
             long len, values[] = {1, 2, 3, 4, 5};
             int i, success = 0;
             long *array;
@@ -267,7 +276,7 @@ int main(int argc, char *argv[]) {
           }
           case 16: {
             printf("Test itCreate() ... ");
-            const Set *s = create(dohash, doNothing, ncmp, 0L, 0.0, nhash);
+            const Set *s = create(which, doNothing, ncmp, 0L, 0.0, nhash);
             long values[] = {1, 2, 3, 4, 5};
             long v;
             int i, success = 0;
@@ -295,7 +304,7 @@ int main(int argc, char *argv[]) {
           }
           case 17: {
             printf("Test sorting of elements ");
-            const Set *s = create(dohash, doNothing, ncmp, 0L, 0.0, nhash);
+            const Set *s = create(which, doNothing, ncmp, 0L, 0.0, nhash);
             long len, values[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
             long i;
             long *array;
@@ -312,7 +321,7 @@ int main(int argc, char *argv[]) {
           }
           case 18: {
             printf("Test hashmap expansion ");
-            const Set *s = create(dohash, doNothing, ncmp, 0L, 0.0, nhash);
+            const Set *s = create(which, doNothing, ncmp, 0L, 0.0, nhash);
             long len, values[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20,
                                     21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31};
             long i;
@@ -330,6 +339,150 @@ int main(int argc, char *argv[]) {
             s->destroy(s);
             break;
           }
+          case 19: {
+            printf("Test union and intersection of large sets ... ");
+            if (which != ROARING) {
+                printf("only with -r\n");
+                break;
+            }
+            const Set *a = create(which, doNothing, ncmp, 0L, 0.0, nhash);
+            const Set *b = create(which, doNothing, ncmp, 0L, 0.0, nhash);
+            const Set *u, *n;
+            long i, success = 1;
+            /* a is every even value below 1M, b every multiple of 3 */
+            for (i = 0; i < 1000000L; i += 2)
+                (void)a->add(a, (void *)i);
+            for (i = 0; i < 1000000L; i += 3)
+                (void)b->add(b, (void *)i);
+            u = RoaringSet_union(a, b);
+            n = RoaringSet_intersection(a, b);
+            if (u == NULL || n == NULL)
+                success = 0;
+            for (i = 0; success && i < 1000000L; i++) {
+                bool inA = (i % 2 == 0), inB = (i % 3 == 0);
+                if (u->contains(u, (void *)i) != (inA || inB) ||
+                    n->contains(n, (void *)i) != (inA && inB))
+                    success = 0;
+            }
+            if (success && n->size(n) == 166667L &&
+                RoaringSet_intersectionSize(a, b) == 166667L &&
+                u->size(u) == 666667L)
+                printf("success\n");
+            else
+                printf("failure\n");
+            if (u != NULL)
+                u->destroy(u);
+            if (n != NULL)
+                n->destroy(n);
+            a->destroy(a);
+            b->destroy(b);
+            break;
+          }
+          case 20: {
+            printf("Test memory use of runs ... ");
+            if (which != ROARING) {
+                printf("only with -r\n");
+                break;
+            }
+            const Set *s = create(which, doNothing, ncmp, 0L, 0.0, nhash);
+            long i, before, after;
+            for (i = 0; i < 1000000L; i++)
+                (void)s->add(s, (void *)(i + 5000000L));
+            before = RoaringSet_bytes(s);
+            (void)RoaringSet_optimize(s);
+            after = RoaringSet_bytes(s);
+            printf("%ld bytes, %ld optimized ... ", before, after);
+            if (after < before && s->size(s) == 1000000L &&
+                s->contains(s, (void *)5999999L) &&
+                ! s->contains(s, (void *)6000000L) &&
+                s->remove(s, (void *)5500000L) &&
+                ! s->contains(s, (void *)5500000L))
+                printf("success\n");
+            else
+                printf("failure\n");
+            s->destroy(s);
+            break;
+          }
+          case 21: {
+            printf("Test external sort of 1M records in 256KB ... ");
+            ExtSort *es = es_create(sizeof(long), 256L * 1024L, rcmp, NULL);
+            long i, v, prev = -1L, n = 0L, sum = 0L, runs = 0L, passes = 0L;
+            int success = (es != NULL);
+            srand(415);
+            for (i = 0; success && i < 1000000L; i++) {
+                v = rand() % 1000000L;
+                sum += v;
+                success = es_add(es, &v);
+            }
+            success = success && es_finish(es);
+            while (success && es_next(es, &v)) {
+                if (v < prev)
+                    success = 0;
+                prev = v;
+                sum -= v;
+                n++;
+            }
+            if (es != NULL)
+                runs = es_runs(es, &passes);
+            printf("%ld runs, %ld passes ... ", runs, passes);
+            if (success && n == 1000000L && sum == 0L && passes > 0L)
+                printf("success\n");
+            else
+                printf("failure\n");
+            if (es != NULL)
+                es_destroy(es);
+            break;
+          }
+          case 22: {
+            printf("Test ordered set of 1M values ... ");
+            if (which != LLIST) {
+                printf("only with -l\n");
+                break;
+            }
+            const Set *s = create(which, doNothing, ncmp, 0L, 0.0, nhash);
+            const Iterator *it;
+            long i, v, n = 0L, success = 1;
+            /* 7919 is prime, so i * 7919 % 1M visits every value once */
+            for (i = 0; success && i < 1000000L; i++)
+                success = s->add(s, (void *)(i * 7919L % 1000000L));
+            if (success && (it = s->itCreate(s)) != NULL) {
+                while (it->next(it, (void **)&v))
+                    if (v != n++)
+                        success = 0;
+                it->destroy(it);
+            } else
+                success = 0;
+            for (i = 0; success && i < 1000000L; i += 2)
+                success = s->remove(s, (void *)i);
+            for (i = 0; success && i < 1000000L; i++)
+                if (s->contains(s, (void *)i) != (i % 2 == 1))
+                    success = 0;
+            if (success && n == 1000000L && s->size(s) == 500000L &&
+                ! s->add(s, (void *)999999L))
+                printf("success\n");
+            else
+                printf("failure\n");
+            s->destroy(s);
+            break;
+          }
+          case 23: {
+            printf("Test external sort rejects budgets too small to sort in ... ");
+            size_t budgets[] = {0, 7, 8, 16, 20};
+            int j, success = 1;
+
+            for (j = 0; j < 5; j++) {
+                ExtSort *es = es_create(1, budgets[j], rcmp, NULL);
+                if (es != NULL) {
+                    success = 0;
+                    es_destroy(es);
+                }
+            }
+            if (success)
+                printf("success\n");
+            else
+                printf("failure\n");
+            break;
+          }
           default: {
             printf("Undefined test\n");
             break;
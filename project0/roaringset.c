@@ -0,0 +1,965 @@
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * implementation of a compressed integer set (a Roaring bitmap)
+ *
+ * the set is a sorted array of containers, one for each chunk of 65536
+ * values that has at least one member; a container holds the low 16 bits
+ * of its values in one of three forms:
+ *
+ * - ARRAY: a sorted array of up to ARRAY_MAX values
+ * - BITMAP: 65536 bits, used once a chunk has more than ARRAY_MAX values
+ * - RUN: sorted (start, length - 1) pairs, made only by optimize()
+ *
+ * add() and remove() first turn a RUN container back into an ARRAY or
+ * BITMAP; the set operations work on a temporary ARRAY or BITMAP copy of
+ * a RUN container
+ *
+ * the bitmap AND and OR loops work a 64-bit word at a time, with no
+ * dependence from one word to the next; the Makefile builds this file
+ * with -O3, at which gcc vectorizes them with SSE2; the popcount loops
+ * stay scalar unless the build also enables a popcount instruction
+ */
+
+#include "roaringset.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define ARRAY_MAX 4096			/* ARRAY_MAX * 2 bytes == a bitmap */
+#define BITMAP_WORDS 1024		/* 65536 bits */
+#define DEFAULT_CONTAINERS 4L
+#define DEFAULT_ARRAY 4
+#define SKEW 32				/* sizes ratio at which to gallop */
+
+typedef enum { ARRAY, BITMAP, RUN } CType;
+
+typedef struct container {
+    unsigned long key;			/* high 48 bits of the values */
+    CType type;
+    int card;				/* number of values, 1 .. 65536 */
+    int n;				/* ARRAY: values used; RUN: runs used */
+    int cap;				/* ARRAY: values; RUN: runs allocated */
+    uint16_t *array;			/* ARRAY values or RUN pairs */
+    uint64_t *bitmap;
+} Container;
+
+typedef struct s_data {
+    long size;				/* number of values */
+    long n;				/* containers used */
+    long cap;				/* containers allocated */
+    Container *cs;
+} SData;
+
+#define KEY(v) (((unsigned long)(v)) >> 16)
+#define LOW(v) ((uint16_t)((unsigned long)(v) & 0xFFFFUL))
+#define VALUE(key, low) ((void *)(((key) << 16) | (unsigned long)(low)))
+#define TEST(bm, x) (((bm)[(x) >> 6] >> ((x) & 63)) & 1UL)
+#define SET(bm, x) ((bm)[(x) >> 6] |= (1UL << ((x) & 63)))
+#define CLEAR(bm, x) ((bm)[(x) >> 6] &= ~(1UL << ((x) & 63)))
+
+/*
+ * container helpers
+ */
+
+static void freeContainer(Container *c) {
+    free(c->array);
+    free(c->bitmap);
+    c->array = NULL;
+    c->bitmap = NULL;
+}
+
+/*
+ * binary search of a sorted array; returns the index of x, or -(i + 1)
+ * where i is the index at which x would be inserted
+ */
+static int search(const uint16_t *a, int n, uint16_t x) {
+    int lo = 0, hi = n - 1;
+
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+
+        if (a[mid] < x)
+            lo = mid + 1;
+        else if (a[mid] > x)
+            hi = mid - 1;
+        else
+            return mid;
+    }
+    return -(lo + 1);
+}
+
+static bool runContains(const Container *c, uint16_t x) {
+    int lo = 0, hi = c->n - 1;
+
+    /* find the last run starting at or before x */
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+
+        if (c->array[2 * mid] <= x)
+            lo = mid + 1;
+        else
+            hi = mid - 1;
+    }
+    return (hi >= 0 && x - c->array[2 * hi] <= c->array[2 * hi + 1]);
+}
+
+static bool containerContains(const Container *c, uint16_t x) {
+    switch (c->type) {
+    case ARRAY:  return (search(c->array, c->n, x) >= 0);
+    case BITMAP: return TEST(c->bitmap, x);
+    case RUN:    return runContains(c, x);
+    }
+    return false;
+}
+
+static int popcount(const uint64_t *bm) {
+    int i, card = 0;
+
+    for (i = 0; i < BITMAP_WORDS; i++)
+        card += __builtin_popcountll(bm[i]);
+    return card;
+}
+
+/*
+ * fills `out' with an ARRAY or BITMAP holding the values of c, whose type
+ * may be anything; returns false if malloc failure
+ */
+static bool materialize(const Container *c, Container *out) {
+    int i, j, k = 0;
+
+    out->key = c->key;
+    out->card = c->card;
+    out->array = NULL;
+    out->bitmap = NULL;
+    if (c->card <= ARRAY_MAX) {
+        out->type = ARRAY;
+        out->n = out->cap = c->card;
+        out->array = (uint16_t *)malloc(c->card * sizeof(uint16_t));
+        if (out->array == NULL)
+            return false;
+        if (c->type == ARRAY) {
+            memcpy(out->array, c->array, c->n * sizeof(uint16_t));
+        } else if (c->type == BITMAP) {
+            for (i = 0; i < BITMAP_WORDS; i++) {
+                uint64_t w = c->bitmap[i];
+
+                while (w != 0UL) {
+                    out->array[k++] = (uint16_t)(64 * i + __builtin_ctzll(w));
+                    w &= w - 1;
+                }
+            }
+        } else {
+            for (i = 0; i < c->n; i++)
+                for (j = 0; j <= c->array[2 * i + 1]; j++)
+                    out->array[k++] = (uint16_t)(c->array[2 * i] + j);
+        }
+    } else {
+        out->type = BITMAP;
+        out->n = out->cap = 0;
+        out->bitmap = (uint64_t *)calloc(BITMAP_WORDS, sizeof(uint64_t));
+        if (out->bitmap == NULL)
+            return false;
+        if (c->type == ARRAY) {
+            for (i = 0; i < c->n; i++)
+                SET(out->bitmap, c->array[i]);
+        } else if (c->type == BITMAP) {
+            memcpy(out->bitmap, c->bitmap, BITMAP_WORDS * sizeof(uint64_t));
+        } else {
+            for (i = 0; i < c->n; i++)
+                for (j = 0; j <= c->array[2 * i + 1]; j++)
+                    SET(out->bitmap, c->array[2 * i] + j);
+        }
+    }
+    return true;
+}
+
+/*
+ * replaces c by an ARRAY or BITMAP copy of itself; returns false if
+ * malloc failure, in which case c is unchanged
+ */
+static bool convert(Container *c) {
+    Container tmp;
+
+    if (! materialize(c, &tmp)) {
+        freeContainer(&tmp);
+        return false;
+    }
+    freeContainer(c);
+    *c = tmp;
+    return true;
+}
+
+/*
+ * returns 1 if x was added to c, 0 if it was already present, -1 if
+ * malloc failure
+ */
+static int containerAdd(Container *c, uint16_t x) {
+    int i;
+
+    if (c->type == RUN) {
+        if (runContains(c, x))
+            return 0;
+        if (! convert(c))
+            return -1;
+    }
+    if (c->type == BITMAP) {
+        if (TEST(c->bitmap, x))
+            return 0;
+        SET(c->bitmap, x);
+        c->card++;
+        return 1;
+    }
+    if ((i = search(c->array, c->n, x)) >= 0)
+        return 0;
+    i = -(i + 1);
+    if (c->n == ARRAY_MAX) {
+        Container tmp;
+
+        c->card = ARRAY_MAX + 1;	/* so materialize() makes a bitmap */
+        if (! materialize(c, &tmp)) {
+            c->card = ARRAY_MAX;
+            freeContainer(&tmp);
+            return -1;
+        }
+        freeContainer(c);
+        *c = tmp;
+        c->card = ARRAY_MAX;
+        SET(c->bitmap, x);
+        c->card++;
+        return 1;
+    }
+    if (c->n == c->cap) {
+        int cap = (2 * c->cap < ARRAY_MAX) ? 2 * c->cap : ARRAY_MAX;
+        uint16_t *a = (uint16_t *)realloc(c->array, cap * sizeof(uint16_t));
+
+        if (a == NULL)
+            return -1;
+        c->array = a;
+        c->cap = cap;
+    }
+    memmove(c->array + i + 1, c->array + i, (c->n - i) * sizeof(uint16_t));
+    c->array[i] = x;
+    c->n++;
+    c->card++;
+    return 1;
+}
+
+/*
+ * returns true if x was removed from c, false if it was not present or
+ * if malloc failure
+ */
+static bool containerRemove(Container *c, uint16_t x) {
+    int i;
+
+    if (c->type == RUN) {
+        if (! runContains(c, x) || ! convert(c))
+            return false;
+    }
+    if (c->type == BITMAP) {
+        if (! TEST(c->bitmap, x))
+            return false;
+        CLEAR(c->bitmap, x);
+        c->card--;
+        if (c->card <= ARRAY_MAX)
+            (void)convert(c);		/* if it fails, stay a bitmap */
+        return true;
+    }
+    if ((i = search(c->array, c->n, x)) < 0)
+        return false;
+    memmove(c->array + i, c->array + i + 1, (c->n - i - 1) * sizeof(uint16_t));
+    c->n--;
+    c->card--;
+    return true;
+}
+
+/*
+ * set helpers
+ */
+
+/*
+ * binary search of the containers; returns the index of the container
+ * for key, or -(i + 1) where i is the index at which it would be inserted
+ */
+static long findContainer(const SData *sd, unsigned long key) {
+    long lo = 0L, hi = sd->n - 1;
+
+    while (lo <= hi) {
+        long mid = (lo + hi) / 2;
+
+        if (sd->cs[mid].key < key)
+            lo = mid + 1;
+        else if (sd->cs[mid].key > key)
+            hi = mid - 1;
+        else
+            return mid;
+    }
+    return -(lo + 1);
+}
+
+/*
+ * makes room for a container at index i; returns NULL if malloc failure
+ */
+static Container *insertContainer(SData *sd, long i) {
+    if (sd->n == sd->cap) {
+        long cap = 2 * sd->cap;
+        Container *cs = (Container *)realloc(sd->cs, cap * sizeof(Container));
+
+        if (cs == NULL)
+            return NULL;
+        sd->cs = cs;
+        sd->cap = cap;
+    }
+    memmove(sd->cs + i + 1, sd->cs + i, (sd->n - i) * sizeof(Container));
+    sd->n++;
+    return &(sd->cs[i]);
+}
+
+static void removeContainer(SData *sd, long i) {
+    freeContainer(&(sd->cs[i]));
+    memmove(sd->cs + i, sd->cs + i + 1, (sd->n - i - 1) * sizeof(Container));
+    sd->n--;
+}
+
+/*
+ * appends c, which becomes the responsibility of sd; the containers must
+ * be appended in increasing order of key; returns false if malloc failure,
+ * in which case c is freed
+ */
+static bool appendContainer(SData *sd, Container *c) {
+    Container *p = insertContainer(sd, sd->n);
+
+    if (p == NULL) {
+        freeContainer(c);
+        return false;
+    }
+    *p = *c;
+    sd->size += c->card;
+    return true;
+}
+
+static void purge(SData *sd) {
+    long i;
+
+    for (i = 0L; i < sd->n; i++)
+        freeContainer(&(sd->cs[i]));
+    sd->n = 0L;
+    sd->size = 0L;
+}
+
+static void s_destroy(const Set *s) {
+    SData *sd = (SData *)s->self;
+
+    purge(sd);
+    free(sd->cs);
+    free(sd);
+    free((void *)s);
+}
+
+static void s_clear(const Set *s) {
+    SData *sd = (SData *)s->self;
+
+    purge(sd);
+}
+
+static bool s_add(const Set *s, void *element) {
+    SData *sd = (SData *)s->self;
+    unsigned long key = KEY(element);
+    long i = findContainer(sd, key);
+    int status;
+
+    if (i < 0) {
+        Container *c;
+        uint16_t *a = (uint16_t *)malloc(DEFAULT_ARRAY * sizeof(uint16_t));
+
+        if (a == NULL)
+            return false;
+        if ((c = insertContainer(sd, -(i + 1))) == NULL) {
+            free(a);
+            return false;
+        }
+        c->key = key;
+        c->type = ARRAY;
+        c->card = c->n = 0;
+        c->cap = DEFAULT_ARRAY;
+        c->array = a;
+        c->bitmap = NULL;
+        i = -(i + 1);
+    }
+    status = containerAdd(&(sd->cs[i]), LOW(element));
+    if (status > 0)
+        sd->size++;
+    else if (sd->cs[i].card == 0)	/* the new container could not grow */
+        removeContainer(sd, i);
+    return (status > 0);
+}
+
+static bool s_contains(const Set *s, void *element) {
+    SData *sd = (SData *)s->self;
+    long i = findContainer(sd, KEY(element));
+
+    return (i >= 0 && containerContains(&(sd->cs[i]), LOW(element)));
+}
+
+static bool s_isEmpty(const Set *s) {
+    SData *sd = (SData *)s->self;
+
+    return (sd->size == 0L);
+}
+
+static bool s_remove(const Set *s, void *element) {
+    SData *sd = (SData *)s->self;
+    long i = findContainer(sd, KEY(element));
+
+    if (i < 0 || ! containerRemove(&(sd->cs[i]), LOW(element)))
+        return false;
+    sd->size--;
+    if (sd->cs[i].card == 0)
+        removeContainer(sd, i);
+    return true;
+}
+
+static long s_size(const Set *s) {
+    SData *sd = (SData *)s->self;
+
+    return sd->size;
+}
+
+/*
+ * helper function for generating an array of the values in ascending
+ * order
+ *
+ * returns pointer to the array or NULL if malloc failure or if the set is
+ * empty
+ */
+static void **entries(SData *sd) {
+    void **tmp = NULL;
+
+    if (sd->size > 0L) {
+        tmp = (void **)malloc(sd->size * sizeof(void *));
+        if (tmp != NULL) {
+            long i, n = 0L;
+
+            for (i = 0L; i < sd->n; i++) {
+                Container *c = &(sd->cs[i]);
+                int j, k;
+
+                if (c->type == ARRAY) {
+                    for (j = 0; j < c->n; j++)
+                        tmp[n++] = VALUE(c->key, c->array[j]);
+                } else if (c->type == BITMAP) {
+                    for (j = 0; j < BITMAP_WORDS; j++) {
+                        uint64_t w = c->bitmap[j];
+
+                        while (w != 0UL) {
+                            tmp[n++] = VALUE(c->key,
+                                             64 * j + __builtin_ctzll(w));
+                            w &= w - 1;
+                        }
+                    }
+                } else {
+                    for (j = 0; j < c->n; j++)
+                        for (k = 0; k <= c->array[2 * j + 1]; k++)
+                            tmp[n++] = VALUE(c->key, c->array[2 * j] + k);
+                }
+            }
+        }
+    }
+    return tmp;
+}
+
+static void **s_toArray(const Set *s, long *len) {
+    SData *sd = (SData *)s->self;
+    void **tmp = entries(sd);
+
+    if (tmp != NULL)
+        *len = sd->size;
+    return tmp;
+}
+
+static const Iterator *s_itCreate(const Set *s) {
+    SData *sd = (SData *)s->self;
+    const Iterator *it = NULL;
+    void **tmp = entries(sd);
+
+    if (tmp != NULL) {
+        it = Iterator_create(sd->size, tmp);
+        if (it == NULL)
+            free(tmp);
+    }
+    return it;
+}
+
+static Set template = {
+    NULL, s_destroy, s_clear, s_add, s_contains, s_isEmpty, s_remove,
+    s_size, s_toArray, s_itCreate
+};
+
+const Set *RoaringSet(void) {
+    Set *s = (Set *)malloc(sizeof(Set));
+    SData *sd = (SData *)malloc(sizeof(SData));
+    Container *cs = (Container *)malloc(DEFAULT_CONTAINERS * sizeof(Container));
+
+    if (s == NULL || sd == NULL || cs == NULL) {
+        free(s);
+        free(sd);
+        free(cs);
+        return NULL;
+    }
+    sd->size = 0L;
+    sd->n = 0L;
+    sd->cap = DEFAULT_CONTAINERS;
+    sd->cs = cs;
+    *s = template;
+    s->self = sd;
+    return s;
+}
+
+/*
+ * set algebra helpers; the containers passed to andContainers(),
+ * orContainers() and countAnd() are ARRAY or BITMAP
+ */
+
+/*
+ * if c is a RUN, materializes it into *tmp and returns tmp; otherwise
+ * returns c; returns NULL if malloc failure
+ */
+static const Container *view(const Container *c, Container *tmp) {
+    tmp->array = NULL;
+    tmp->bitmap = NULL;
+    if (c->type != RUN)
+        return c;
+    return materialize(c, tmp) ? tmp : NULL;
+}
+
+/*
+ * deep copy of c, of any type, into *out; returns false if malloc failure
+ */
+static bool copyContainer(const Container *c, Container *out) {
+    *out = *c;
+    out->array = NULL;
+    out->bitmap = NULL;
+    if (c->bitmap != NULL) {
+        out->bitmap = (uint64_t *)malloc(BITMAP_WORDS * sizeof(uint64_t));
+        if (out->bitmap == NULL)
+            return false;
+        memcpy(out->bitmap, c->bitmap, BITMAP_WORDS * sizeof(uint64_t));
+    }
+    if (c->array != NULL) {
+        size_t nbytes = ((c->type == RUN) ? 2 * c->n : c->n) * sizeof(uint16_t);
+
+        out->cap = c->n;
+        out->array = (uint16_t *)malloc(nbytes);
+        if (out->array == NULL)
+            return false;
+        memcpy(out->array, c->array, nbytes);
+    }
+    return true;
+}
+
+/*
+ * turns a BITMAP container whose cardinality has been set into an ARRAY
+ * if it is small enough; returns false if malloc failure
+ */
+static bool shrink(Container *c) {
+    if (c->card == 0) {
+        freeContainer(c);
+        return true;
+    }
+    return (c->card > ARRAY_MAX || convert(c));
+}
+
+/*
+ * returns the size of the intersection of a and b
+ */
+static int countAnd(const Container *a, const Container *b) {
+    int i, j, card = 0;
+
+    if (a->type == BITMAP && b->type == BITMAP) {
+        for (i = 0; i < BITMAP_WORDS; i++)
+            card += __builtin_popcountll(a->bitmap[i] & b->bitmap[i]);
+    } else if (a->type == BITMAP || b->type == BITMAP) {
+        const Container *ar = (a->type == ARRAY) ? a : b;
+        const Container *bm = (a->type == ARRAY) ? b : a;
+
+        for (i = 0; i < ar->n; i++)
+            card += TEST(bm->bitmap, ar->array[i]);
+    } else {
+        for (i = 0, j = 0; i < a->n && j < b->n; ) {
+            if (a->array[i] < b->array[j])
+                i++;
+            else if (a->array[i] > b->array[j])
+                j++;
+            else {
+                card++;
+                i++;
+                j++;
+            }
+        }
+    }
+    return card;
+}
+
+/*
+ * intersection of two ARRAYs; when one is much smaller, each of its values
+ * is found in the other by binary search, else the two are merged
+ */
+static int andArrays(const Container *a, const Container *b, uint16_t *out) {
+    int i, j, k = 0;
+
+    if (a->n > b->n) {
+        const Container *t = a;
+        a = b;
+        b = t;
+    }
+    if (a->n * SKEW < b->n) {
+        for (i = 0, j = 0; i < a->n && j < b->n; i++) {
+            int r = search(b->array + j, b->n - j, a->array[i]);
+
+            if (r >= 0) {
+                out[k++] = a->array[i];
+                j += r + 1;
+            } else
+                j += -(r + 1);
+        }
+    } else {
+        for (i = 0, j = 0; i < a->n && j < b->n; ) {
+            if (a->array[i] < b->array[j])
+                i++;
+            else if (a->array[i] > b->array[j])
+                j++;
+            else {
+                out[k++] = a->array[i];
+                i++;
+                j++;
+            }
+        }
+    }
+    return k;
+}
+
+/*
+ * intersection of a and b into *out, which is left empty if the
+ * intersection is empty; returns false if malloc failure
+ */
+static bool andContainers(const Container *a, const Container *b,
+                          Container *out) {
+    int i;
+
+    out->key = a->key;
+    out->array = NULL;
+    out->bitmap = NULL;
+    out->card = out->n = out->cap = 0;
+    if (a->type == BITMAP && b->type == BITMAP) {
+        out->type = BITMAP;
+        out->bitmap = (uint64_t *)malloc(BITMAP_WORDS * sizeof(uint64_t));
+        if (out->bitmap == NULL)
+            return false;
+        for (i = 0; i < BITMAP_WORDS; i++)
+            out->bitmap[i] = a->bitmap[i] & b->bitmap[i];
+        out->card = popcount(out->bitmap);
+        return shrink(out);
+    }
+    out->type = ARRAY;
+    out->cap = (a->type == ARRAY) ? a->n : b->n;
+    if (b->type == ARRAY && b->n < out->cap)
+        out->cap = b->n;
+    out->array = (uint16_t *)malloc(out->cap * sizeof(uint16_t));
+    if (out->array == NULL)
+        return false;
+    if (a->type == BITMAP || b->type == BITMAP) {
+        const Container *ar = (a->type == ARRAY) ? a : b;
+        const Container *bm = (a->type == ARRAY) ? b : a;
+
+        for (i = 0; i < ar->n; i++)
+            if (TEST(bm->bitmap, ar->array[i]))
+                out->array[out->n++] = ar->array[i];
+    } else {
+        out->n = andArrays(a, b, out->array);
+    }
+    out->card = out->n;
+    if (out->card == 0)
+        freeContainer(out);
+    return true;
+}
+
+/*
+ * union of a and b into *out; returns false if malloc failure
+ */
+static bool orContainers(const Container *a, const Container *b,
+                         Container *out) {
+    int i, j;
+
+    out->key = a->key;
+    out->array = NULL;
+    out->bitmap = NULL;
+    out->card = out->n = out->cap = 0;
+    if (a->type == ARRAY && b->type == ARRAY && a->n + b->n <= ARRAY_MAX) {
+        out->type = ARRAY;
+        out->cap = a->n + b->n;
+        out->array = (uint16_t *)malloc(out->cap * sizeof(uint16_t));
+        if (out->array == NULL)
+            return false;
+        for (i = 0, j = 0; i < a->n || j < b->n; ) {
+            if (j == b->n || (i < a->n && a->array[i] < b->array[j]))
+                out->array[out->n++] = a->array[i++];
+            else if (i == a->n || a->array[i] > b->array[j])
+                out->array[out->n++] = b->array[j++];
+            else {
+                out->array[out->n++] = a->array[i++];
+                j++;
+            }
+        }
+        out->card = out->n;
+        return true;
+    }
+    out->type = BITMAP;
+    out->bitmap = (uint64_t *)calloc(BITMAP_WORDS, sizeof(uint64_t));
+    if (out->bitmap == NULL)
+        return false;
+    if (a->type == BITMAP && b->type == BITMAP) {
+        for (i = 0; i < BITMAP_WORDS; i++)
+            out->bitmap[i] = a->bitmap[i] | b->bitmap[i];
+    } else {
+        const Container *both[2];
+
+        both[0] = a;
+        both[1] = b;
+        for (j = 0; j < 2; j++) {
+            const Container *c = both[j];
+
+            if (c->type == BITMAP)
+                for (i = 0; i < BITMAP_WORDS; i++)
+                    out->bitmap[i] |= c->bitmap[i];
+            else
+                for (i = 0; i < c->n; i++)
+                    SET(out->bitmap, c->array[i]);
+        }
+    }
+    out->card = popcount(out->bitmap);
+    return shrink(out);
+}
+
+/*
+ * common code for union and intersection: walks the two sorted lists of
+ * containers in step
+ */
+static const Set *combine(const Set *a, const Set *b, bool isUnion) {
+    SData *ad, *bd, *rd;
+    const Set *r;
+    long i = 0L, j = 0L;
+
+    if (a->add != s_add || b->add != s_add || (r = RoaringSet()) == NULL)
+        return NULL;
+    ad = (SData *)a->self;
+    bd = (SData *)b->self;
+    rd = (SData *)r->self;
+    while (i < ad->n || j < bd->n) {
+        const Container *ca = (i < ad->n) ? &(ad->cs[i]) : NULL;
+        const Container *cb = (j < bd->n) ? &(bd->cs[j]) : NULL;
+        Container out, ta, tb;
+        bool ok = true;
+
+        out.array = NULL;
+        out.bitmap = NULL;
+        out.card = 0;
+        if (cb == NULL || (ca != NULL && ca->key < cb->key)) {
+            if (isUnion)
+                ok = copyContainer(ca, &out);
+            i++;
+        } else if (ca == NULL || cb->key < ca->key) {
+            if (isUnion)
+                ok = copyContainer(cb, &out);
+            j++;
+        } else {
+            const Container *va = view(ca, &ta), *vb = view(cb, &tb);
+
+            ok = (va != NULL && vb != NULL);
+            if (ok)
+                ok = isUnion ? orContainers(va, vb, &out)
+                             : andContainers(va, vb, &out);
+            freeContainer(&ta);
+            freeContainer(&tb);
+            i++;
+            j++;
+        }
+        if (! ok) {
+            freeContainer(&out);
+            r->destroy(r);
+            return NULL;
+        }
+        if (out.card > 0 && ! appendContainer(rd, &out)) {
+            r->destroy(r);
+            return NULL;
+        }
+    }
+    return r;
+}
+
+const Set *RoaringSet_union(const Set *a, const Set *b) {
+    return combine(a, b, true);
+}
+
+const Set *RoaringSet_intersection(const Set *a, const Set *b) {
+    return combine(a, b, false);
+}
+
+long RoaringSet_intersectionSize(const Set *a, const Set *b) {
+    SData *ad, *bd;
+    long i = 0L, j = 0L, card = 0L;
+
+    if (a->add != s_add || b->add != s_add)
+        return -1L;
+    ad = (SData *)a->self;
+    bd = (SData *)b->self;
+    while (i < ad->n && j < bd->n) {
+        const Container *ca = &(ad->cs[i]), *cb = &(bd->cs[j]);
+
+        if (ca->key < cb->key)
+            i++;
+        else if (cb->key < ca->key)
+            j++;
+        else {
+            Container ta, tb;
+            const Container *va = view(ca, &ta), *vb = view(cb, &tb);
+
+            if (va == NULL || vb == NULL) {
+                freeContainer(&ta);
+                freeContainer(&tb);
+                return -1L;
+            }
+            card += countAnd(va, vb);
+            freeContainer(&ta);
+            freeContainer(&tb);
+            i++;
+            j++;
+        }
+    }
+    return card;
+}
+
+/*
+ * returns the number of runs of consecutive values in c, an ARRAY or BITMAP
+ */
+static int countRuns(const Container *c) {
+    int i, runs = 0;
+
+    if (c->type == ARRAY) {
+        for (i = 0; i < c->n; i++)
+            if (i == 0 || c->array[i] != c->array[i - 1] + 1)
+                runs++;
+    } else {
+        uint64_t carry = 0UL;
+
+        for (i = 0; i < BITMAP_WORDS; i++) {
+            uint64_t w = c->bitmap[i];
+
+            runs += __builtin_popcountll(w & ~((w << 1) | carry));
+            carry = w >> 63;
+        }
+    }
+    return runs;
+}
+
+/*
+ * appends value x to the runs in `runs', of which there are *n
+ */
+static void extend(uint16_t *runs, int *n, int x) {
+    if (*n > 0 && runs[2 * (*n - 1)] + runs[2 * (*n - 1) + 1] + 1 == x)
+        runs[2 * (*n - 1) + 1]++;
+    else {
+        runs[2 * *n] = (uint16_t)x;
+        runs[2 * *n + 1] = 0;
+        (*n)++;
+    }
+}
+
+bool RoaringSet_optimize(const Set *s) {
+    SData *sd;
+    long i;
+
+    if (s->add != s_add)
+        return false;
+    sd = (SData *)s->self;
+    for (i = 0L; i < sd->n; i++) {
+        Container *c = &(sd->cs[i]);
+        int runs, n = 0, j;
+        long bytes;
+        uint16_t *a;
+
+        if (c->type == RUN)
+            continue;
+        runs = countRuns(c);
+        bytes = (c->type == ARRAY) ? c->n * 2L : BITMAP_WORDS * 8L;
+        if (runs * 4L >= bytes)
+            continue;
+        if ((a = (uint16_t *)malloc(runs * 2 * sizeof(uint16_t))) == NULL)
+            continue;			/* stay as it is */
+        if (c->type == ARRAY) {
+            for (j = 0; j < c->n; j++)
+                extend(a, &n, c->array[j]);
+        } else {
+            for (j = 0; j < BITMAP_WORDS; j++) {
+                uint64_t w = c->bitmap[j];
+
+                while (w != 0UL) {
+                    extend(a, &n, 64 * j + __builtin_ctzll(w));
+                    w &= w - 1;
+                }
+            }
+        }
+        freeContainer(c);
+        c->type = RUN;
+        c->array = a;
+        c->n = c->cap = runs;
+    }
+    return true;
+}
+
+long RoaringSet_bytes(const Set *s) {
+    SData *sd;
+    long i, bytes;
+
+    if (s->add != s_add)
+        return -1L;
+    sd = (SData *)s->self;
+    bytes = sizeof(Set) + sizeof(SData) + sd->cap * sizeof(Container);
+    for (i = 0L; i < sd->n; i++) {
+        Container *c = &(sd->cs[i]);
+
+        if (c->type == BITMAP)
+            bytes += BITMAP_WORDS * sizeof(uint64_t);
+        else
+            bytes += ((c->type == RUN) ? 2 : 1) * c->cap * sizeof(uint16_t);
+    }
+    return bytes;
+}
@@ -0,0 +1,89 @@
+#ifndef _ROARINGSET_H_
+#define _ROARINGSET_H_
+
+/*
+ * Copyright (c) 2021, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * constructor definition for a compressed integer set implementation
+ */
+
+#include "set.h"             /* dispatch table */
+
+/*
+ * create a RoaringSet, a set of long values cast to void *
+ *
+ * the values are split by their high 48 bits into chunks of 65536; each
+ * chunk present in the set has a container that holds the low 16 bits
+ * of its values as a sorted array (up to 4096 values), as a bitmap, or,
+ * after RoaringSet_optimize(), as a list of runs, whichever is smaller
+ *
+ * the elements are not on the heap, so there is no freeValue, and they are
+ * compared as unsigned longs, so there is no cmp; toArray() and itCreate()
+ * return the elements in ascending unsigned order
+ *
+ * returns a pointer to the set, or NULL if there are malloc() errors
+ */
+
+const Set *RoaringSet(void);
+
+/*
+ * set algebra on RoaringSets; the results are new RoaringSets
+ *
+ * returns NULL if there are malloc() errors, or if either argument was not
+ * created by RoaringSet()
+ */
+const Set *RoaringSet_union(const Set *a, const Set *b);
+const Set *RoaringSet_intersection(const Set *a, const Set *b);
+
+/*
+ * returns the size of the intersection of two RoaringSets without
+ * creating it, or -1L if there are malloc() errors or if either argument
+ * was not created by RoaringSet()
+ */
+long RoaringSet_intersectionSize(const Set *a, const Set *b);
+
+/*
+ * converts each container whose values are mostly consecutive into a list
+ * of runs, if that is smaller; the next add() or remove() on such a chunk
+ * converts it back
+ *
+ * returns false if `s' was not created by RoaringSet()
+ */
+bool RoaringSet_optimize(const Set *s);
+
+/*
+ * returns the number of bytes of heap used by a RoaringSet, or -1L if `s'
+ * was not created by RoaringSet()
+ */
+long RoaringSet_bytes(const Set *s);
+
+#endif /* _ROARINGSET_H_ */
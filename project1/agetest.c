@@ -0,0 +1,224 @@
+/*
+ * workload to check the wait bound of the priority scheduler in psched.c
+ *
+ * each test simulates a set of jobs without forking: every round the
+ * scheduler dispatches one job, which then either finishes or is
+ * requeued with a penalty; the test fails if any job waits more than
+ * max(maxWait, N-1) rounds, N being the number of jobs admitted
+ */
+
+#include "psched.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define UNUSED __attribute__((unused))
+#define USAGE "usage: %s [-w maxWait] [-a agePeriod] test# . . .\n"
+
+typedef struct simjob {
+    long penalty;		/* added to priority after each quantum */
+    long quanta;		/* quanta left before the job finishes */
+    long maxWaited;
+} SimJob;
+
+static void (*notify)(SJob *j) = NULL;	/* passed to sc_notify() */
+static long notified, misnotified;
+
+/*
+ * sc_notify() callback for test 5: the job must be waiting, and its
+ * priority must be the one it now has in the heap
+ */
+static void noted(SJob *j) {
+    notified++;
+    if (! j->waiting || (! j->urgent && j->priority < 0L))
+        misnotified++;
+}
+
+/*
+ * run `n' jobs for at most `rounds' rounds; returns the longest wait seen
+ */
+static long simulate(SimJob jobs[], long prio[], long n, long rounds,
+                     long maxWait, long agePeriod) {
+    Scheduler *s = sc_create(maxWait, agePeriod);
+    long i, worst = 0L;
+
+    if (s == NULL)
+        return -1L;
+    if (notify != NULL)
+        sc_notify(s, notify);
+    for (i = 0; i < n; i++) {
+        jobs[i].maxWaited = 0L;
+        sc_admit(s, &jobs[i], prio[i]);
+    }
+    for (i = 0; i < rounds && ! sc_isEmpty(s); i++) {
+        long waited;
+        SJob *j = sc_next(s, &waited);
+        SimJob *sj = (SimJob *)j->job;
+
+        if (waited > sj->maxWaited)
+            sj->maxWaited = waited;
+        if (waited > worst)
+            worst = waited;
+        if (--sj->quanta == 0)
+            sc_retire(s, j);
+        else
+            sc_requeue(s, j, sj->penalty);
+    }
+    sc_destroy(s);
+    return worst;
+}
+
+static int check(long worst, long n, long maxWait) {
+    long bound = (maxWait > n - 1) ? maxWait : n - 1;
+
+    printf("max wait %ld, bound %ld ... ", worst, bound);
+    if (worst >= 0 && worst <= bound) {
+        printf("success\n");
+        return 1;
+    }
+    printf("failure\n");
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    long maxWait = 20L, agePeriod = 16L;
+    int opt, i, failures = 0;
+
+    opterr = 0;
+    while ((opt = getopt(argc, argv, "w:a:")) != -1) {
+        switch (opt) {
+        case 'w': maxWait = atol(optarg); break;
+        case 'a': agePeriod = atol(optarg); break;
+        default:
+            fprintf(stderr, "%s: illegal option, '-%c'\n", argv[0], optopt);
+            fprintf(stderr, USAGE, argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    for (i = optind; i < argc; i++) {
+        int test;
+        sscanf(argv[i], "%d", &test);
+        switch (test) {
+          case 1: {
+            /* 8 jobs that never lose priority would starve a 9th forever */
+            SimJob jobs[9];
+            long prio[9];
+            long j;
+            printf("Test starvation of a low priority job ... ");
+            for (j = 0; j < 9; j++) {
+                jobs[j].penalty = 0L;
+                jobs[j].quanta = 100000L;
+                prio[j] = 0L;
+            }
+            jobs[8].penalty = 10L;
+            jobs[8].quanta = 50L;
+            prio[8] = 1000L;
+            failures += ! check(simulate(jobs, prio, 9, 5000L, maxWait,
+                                         agePeriod), 9, maxWait);
+            if (jobs[8].quanta != 0L) {
+                printf("  low priority job did not finish\n");
+                failures++;
+            }
+            break;
+          }
+          case 2: {
+            /* random priorities, penalties and lengths */
+            SimJob jobs[50];
+            long prio[50];
+            long j;
+            printf("Test random workload of 50 jobs ... ");
+            srand(415);
+            for (j = 0; j < 50; j++) {
+                jobs[j].penalty = rand() % 50;
+                jobs[j].quanta = 1 + rand() % 200;
+                prio[j] = rand() % 1000;
+            }
+            failures += ! check(simulate(jobs, prio, 50, 100000L, maxWait,
+                                         agePeriod), 50, maxWait);
+            break;
+          }
+          case 3: {
+            /* a bound below N-1 degrades to round robin */
+            SimJob jobs[30];
+            long prio[30];
+            long j;
+            printf("Test bound smaller than the number of jobs ... ");
+            for (j = 0; j < 30; j++) {
+                jobs[j].penalty = j;
+                jobs[j].quanta = 40L;
+                prio[j] = 30 - j;
+            }
+            failures += ! check(simulate(jobs, prio, 30, 100000L, 5L,
+                                         agePeriod), 30, 5L);
+            break;
+          }
+          case 4: {
+            /* aging disabled: the bound must hold on promotion alone */
+            SimJob jobs[20];
+            long prio[20];
+            long j;
+            printf("Test wait bound with aging disabled ... ");
+            for (j = 0; j < 20; j++) {
+                jobs[j].penalty = (j % 2) ? 100L : 0L;
+                jobs[j].quanta = 300L;
+                prio[j] = j * 10;
+            }
+            failures += ! check(simulate(jobs, prio, 20, 100000L, maxWait,
+                                         0L), 20, maxWait);
+            break;
+          }
+          case 5: {
+            /* promotion must be reported, for the journal */
+            SimJob jobs[20];
+            long prio[20];
+            long j;
+            printf("Test notification of promoted jobs ... ");
+            for (j = 0; j < 20; j++) {
+                jobs[j].penalty = (j % 2) ? 100L : 0L;
+                jobs[j].quanta = 300L;
+                prio[j] = j * 10;
+            }
+            notify = noted;
+            notified = misnotified = 0L;
+            (void)simulate(jobs, prio, 20, 100000L, maxWait, agePeriod);
+            notify = NULL;
+            printf("%ld notified ... ", notified);
+            if (notified > 0L && misnotified == 0L)
+                printf("success\n");
+            else {
+                printf("failure\n");
+                failures++;
+            }
+            break;
+          }
+          case 6: {
+            /* promotion disabled: aging alone must end the starvation */
+            SimJob jobs[9];
+            long prio[9];
+            long j;
+            printf("Test starvation with aging alone ... ");
+            for (j = 0; j < 9; j++) {
+                jobs[j].penalty = 0L;
+                jobs[j].quanta = 100000L;
+                prio[j] = 0L;
+            }
+            jobs[8].penalty = 10L;
+            jobs[8].quanta = 50L;
+            prio[8] = 1000L;
+            (void)simulate(jobs, prio, 9, 50000L, 100000L, agePeriod);
+            printf("%ld quanta left ... ", jobs[8].quanta);
+            if (jobs[8].quanta == 0L)
+                printf("success\n");
+            else {
+                printf("failure\n");
+                failures++;
+            }
+            break;
+          }
+          default:
+            fprintf(stderr, "%s: unknown test, %d\n", argv[0], test);
+            break;
+        }
+    }
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
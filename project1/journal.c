@@ -0,0 +1,97 @@
+/*
+ *	job journal for warm restart of interrupted USPS batches
+ *
+ *	file layout: an 8-byte magic string followed by one JRecord per job;
+ *	updates are single pwrite()s of one record, so a run that is killed
+ *	leaves every record either old or new, never torn across jobs
+ */
+
+#include "journal.h"
+#include "p1fxns.h"
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#define MAGIC "USPSJRN2"
+#define MAGIC_SIZE 8
+
+unsigned long jn_hash(char *line) {
+    unsigned long ans = 5381UL;
+
+    for (; *line != '\0'; line++)
+        ans = 33UL * ans + (unsigned char)*line;
+    return ans;
+}
+
+Journal *jn_open(char *path) {
+    Journal *j = (Journal *)malloc(sizeof(Journal));
+    struct stat sb;
+    char magic[MAGIC_SIZE];
+
+    if (j == NULL)
+        return NULL;
+    j->jobs = NULL;
+    j->njobs = 0;
+    if ((j->path = p1strdup(path)) == NULL) {
+        free(j);
+        return NULL;
+    }
+    if ((j->fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644)) < 0 ||
+        fstat(j->fd, &sb) < 0) {
+        if (j->fd >= 0)
+            close(j->fd);
+        free(j->path);
+        free(j);
+        return NULL;
+    }
+    if (sb.st_size >= MAGIC_SIZE &&
+        pread(j->fd, magic, MAGIC_SIZE, 0) == MAGIC_SIZE &&
+        p1strneq(magic, MAGIC, MAGIC_SIZE)) {
+        int n = (int)((sb.st_size - MAGIC_SIZE) / sizeof(JRecord));
+        size_t nbytes = n * sizeof(JRecord);
+
+        if (n > 0 && (j->jobs = (JRecord *)malloc(nbytes)) != NULL &&
+            pread(j->fd, j->jobs, nbytes, MAGIC_SIZE) == (ssize_t)nbytes)
+            j->njobs = n;
+    } else {				/* new, or not a journal: start over */
+        if (ftruncate(j->fd, 0) < 0 ||
+            pwrite(j->fd, MAGIC, MAGIC_SIZE, 0) != MAGIC_SIZE) {
+            close(j->fd);
+            free(j->path);
+            free(j);
+            return NULL;
+        }
+    }
+    return j;
+}
+
+bool jn_lookup(Journal *j, int job, unsigned long hash, JRecord *rec) {
+    if (job < 0 || job >= j->njobs || j->jobs[job].hash != hash)
+        return false;
+    *rec = j->jobs[job];
+    return true;
+}
+
+bool jn_update(Journal *j, int job, unsigned long hash, int state,
+               long order, long priority, double cpu) {
+    JRecord rec;
+    off_t off = MAGIC_SIZE + (off_t)job * sizeof(JRecord);
+
+    rec.hash = hash;
+    rec.order = order;
+    rec.priority = priority;
+    rec.cpu = cpu;
+    rec.state = state;
+    rec.unused = 0;
+    return (pwrite(j->fd, &rec, sizeof(rec), off) == sizeof(rec));
+}
+
+void jn_close(Journal *j, bool finished) {
+    close(j->fd);
+    if (finished)
+        unlink(j->path);
+    free(j->jobs);
+    free(j->path);
+    free(j);
+}
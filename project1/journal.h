@@ -0,0 +1,71 @@
+/*
+ *	job journal for warm restart of interrupted USPS batches
+ *
+ *	the journal is a file of fixed-size records, one per job in the
+ *	batch, indexed by the job's position among the non-blank command
+ *	lines; each state change overwrites that job's record in place
+ */
+
+#ifndef _JOURNAL_H_
+#define _JOURNAL_H_
+
+#include <stdbool.h>
+
+#define JOB_PENDING 0
+#define JOB_RUNNING 1
+#define JOB_DONE 2
+
+typedef struct jrecord {
+    unsigned long hash;		/* hash of the command line */
+    long order;			/* scheduler-defined admission order */
+    long priority;		/* scheduler priority, 0 if none */
+    double cpu;			/* cumulative CPU seconds */
+    int state;			/* JOB_PENDING, JOB_RUNNING, or JOB_DONE */
+    int unused;
+} JRecord;
+
+typedef struct journal {
+    int fd;
+    int njobs;			/* number of records loaded from the file */
+    JRecord *jobs;
+    char *path;
+} Journal;
+
+/*
+ *	jn_hash - hash a command line, so that a journal written for a
+ *	different batch file is not applied to this one
+ */
+unsigned long jn_hash(char *line);
+
+/*
+ *	jn_open - open the journal at `path', creating it if necessary
+ *
+ *	records left by an interrupted run are loaded into j->jobs
+ *
+ *	returns NULL if the file cannot be opened or malloc fails
+ */
+Journal *jn_open(char *path);
+
+/*
+ *	jn_lookup - fetch the record left for `job' by a previous run
+ *
+ *	returns false if there is no record, or if it was written for a
+ *	different command line
+ */
+bool jn_lookup(Journal *j, int job, unsigned long hash, JRecord *rec);
+
+/*
+ *	jn_update - overwrite the record for `job'
+ *
+ *	returns true if successful, false if the write fails
+ */
+bool jn_update(Journal *j, int job, unsigned long hash, int state,
+               long order, long priority, double cpu);
+
+/*
+ *	jn_close - close the journal; if `finished', the batch ran to
+ *	completion and the journal file is removed
+ */
+void jn_close(Journal *j, bool finished);
+
+#endif	/* _JOURNAL_H_ */
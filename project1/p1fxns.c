@@ -89,6 +89,67 @@ int p1getword(char buf[], int i, char word[]) {
     return i;
 }
 
+/*
+ *	nextword - locate the next word in buf without copying it
+ *
+ *	applies the same quoting rules as p1getword; the word occupies
+ *	buf[*start .. *start + *len - 1]
+ *
+ *	return value is index into buffer for next search or -1 if at end
+ */
+static int nextword(char buf[], int i, int *start, int *len) {
+    char *tc;
+
+    while(p1strchr(whitespace, buf[i]) != -1)
+        i++;
+    if (buf[i] == '\0')
+        return -1;
+    switch(buf[i]) {
+    case '\'': tc = singlequote; i++; break;
+    case '"': tc = doublequote; i++; break;
+    default: tc = whitespace; break;
+    }
+    *start = i;
+    while (buf[i] != '\0' && p1strchr(tc, buf[i]) == -1)
+        i++;
+    *len = i - *start;
+    if (buf[i] != '\0' && tc != whitespace)
+        i++;	/* skip over terminator */
+    return i;
+}
+
+/*
+ *	p1argv - split buf into blank-separated words, as p1getword does
+ *
+ *	the first pass sizes the block, the second copies the words in
+ *	behind the pointer table
+ */
+char **p1argv(char buf[], int *argc) {
+    int i, n, start, len, nbytes;
+    char **argv, *p;
+
+    n = 0;
+    nbytes = 0;
+    for (i = 0; (i = nextword(buf, i, &start, &len)) != -1; ) {
+        n++;
+        nbytes += len + 1;
+    }
+    argv = (char **)malloc((n + 1) * sizeof(char *) + nbytes);
+    if (argv == NULL)
+        return NULL;
+    p = (char *)(argv + n + 1);
+    n = 0;
+    for (i = 0; (i = nextword(buf, i, &start, &len)) != -1; ) {
+        argv[n++] = p;
+        for (int j = 0; j < len; j++)
+            *p++ = buf[start + j];
+        *p++ = '\0';
+    }
+    argv[n] = NULL;
+    *argc = n;
+    return argv;
+}
+
 /*
  *	p1strlen - return length of string
  */
@@ -31,6 +31,18 @@ int p1strchr(char buf[], char c);
  */
 int p1getword(char buf[], int i, char word[]);
 
+/*
+ *	p1argv - split buf into blank-separated words, as p1getword does
+ *
+ *	the NULL-terminated pointer table and the words are packed into a
+ *	single heap block sized to fit, so there is no limit on the number
+ *	or length of words and the whole argv is released with one free()
+ *
+ *	returns the argv, or NULL if malloc fails; the number of words is
+ *	returned in *argc
+ */
+char **p1argv(char buf[], int *argc);
+
 /*
  *	p1strlen - return length of string
  */
@@ -0,0 +1,448 @@
+/*
+ *	batched /proc/<pid>/stat sampling for the USPS monitor
+ *
+ *	the io_uring is driven through the raw system calls, so no library
+ *	beyond libc is needed; if io_uring_setup() fails (old kernel, or
+ *	blocked by a sandbox), or the kernel's io_uring cannot do
+ *	IORING_OP_READ (before 5.6), each refresh degrades to one pread()
+ *	per pid
+ */
+
+#include "procsample.h"
+#include "p1fxns.h"
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#define MAX_RING_ENTRIES 32768	/* kernel's IORING_MAX_ENTRIES */
+#define MAX_PROBE_OPS 256	/* opcodes are a __u8 */
+
+typedef struct ring {
+    int fd;
+    unsigned entries;
+    unsigned *sqHead, *sqTail, *sqMask, *sqArray;
+    unsigned *cqHead, *cqTail, *cqMask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sqMap, *cqMap;
+    size_t sqMapSize, cqMapSize, sqesSize;
+} Ring;
+
+static int ring_setup(unsigned entries, struct io_uring_params *p) {
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int ring_enter(int fd, unsigned toSubmit, unsigned minComplete) {
+    return (int)syscall(__NR_io_uring_enter, fd, toSubmit, minComplete,
+                        IORING_ENTER_GETEVENTS, NULL, 0);
+}
+
+/*
+ *	ask the kernel whether ring fd supports IORING_OP_READ; kernels
+ *	that predate the opcode also predate IORING_REGISTER_PROBE, so a
+ *	failed probe means no
+ */
+static bool ring_canRead(int fd) {
+    struct io_uring_probe *p;
+    bool status = false;
+
+    p = (struct io_uring_probe *)calloc(1, sizeof(struct io_uring_probe) +
+                              MAX_PROBE_OPS * sizeof(struct io_uring_probe_op));
+    if (p == NULL)
+        return false;
+    if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, p,
+                MAX_PROBE_OPS) == 0 && IORING_OP_READ < p->ops_len)
+        status = (p->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED) != 0;
+    free(p);
+    return status;
+}
+
+static void ring_destroy(Ring *r) {
+    munmap(r->sqes, r->sqesSize);
+    if (r->cqMap != r->sqMap)
+        munmap(r->cqMap, r->cqMapSize);
+    munmap(r->sqMap, r->sqMapSize);
+    close(r->fd);
+    free(r);
+}
+
+/*
+ *	map the submission and completion rings for a new io_uring
+ *
+ *	returns NULL if io_uring, or its IORING_OP_READ, is not available
+ */
+static Ring *ring_create(unsigned entries) {
+    struct io_uring_params p;
+    Ring *r = (Ring *)malloc(sizeof(Ring));
+    char *sq, *cq;
+
+    if (r == NULL)
+        return NULL;
+    for (sq = (char *)&p; sq < (char *)(&p + 1); sq++)
+        *sq = '\0';
+    if ((r->fd = ring_setup(entries, &p)) < 0) {
+        free(r);
+        return NULL;
+    }
+    if (! ring_canRead(r->fd)) {
+        close(r->fd);
+        free(r);
+        return NULL;
+    }
+    r->entries = p.sq_entries;
+    r->sqMapSize = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    r->cqMapSize = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        if (r->cqMapSize > r->sqMapSize)
+            r->sqMapSize = r->cqMapSize;
+        r->cqMapSize = r->sqMapSize;
+    }
+    r->sqMap = mmap(NULL, r->sqMapSize, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQ_RING);
+    if (r->sqMap == MAP_FAILED) {
+        close(r->fd);
+        free(r);
+        return NULL;
+    }
+    if (p.features & IORING_FEAT_SINGLE_MMAP)
+        r->cqMap = r->sqMap;
+    else {
+        r->cqMap = mmap(NULL, r->cqMapSize, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_CQ_RING);
+        if (r->cqMap == MAP_FAILED) {
+            munmap(r->sqMap, r->sqMapSize);
+            close(r->fd);
+            free(r);
+            return NULL;
+        }
+    }
+    r->sqesSize = p.sq_entries * sizeof(struct io_uring_sqe);
+    r->sqes = (struct io_uring_sqe *)mmap(NULL, r->sqesSize,
+                    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    r->fd, IORING_OFF_SQES);
+    if (r->sqes == MAP_FAILED) {
+        if (r->cqMap != r->sqMap)
+            munmap(r->cqMap, r->cqMapSize);
+        munmap(r->sqMap, r->sqMapSize);
+        close(r->fd);
+        free(r);
+        return NULL;
+    }
+    sq = (char *)r->sqMap;
+    cq = (char *)r->cqMap;
+    r->sqHead = (unsigned *)(sq + p.sq_off.head);
+    r->sqTail = (unsigned *)(sq + p.sq_off.tail);
+    r->sqMask = (unsigned *)(sq + p.sq_off.ring_mask);
+    r->sqArray = (unsigned *)(sq + p.sq_off.array);
+    r->cqHead = (unsigned *)(cq + p.cq_off.head);
+    r->cqTail = (unsigned *)(cq + p.cq_off.tail);
+    r->cqMask = (unsigned *)(cq + p.cq_off.ring_mask);
+    r->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+    return r;
+}
+
+SampleTable *ps_create(int capacity) {
+    SampleTable *st = (SampleTable *)malloc(sizeof(SampleTable));
+    unsigned entries;
+
+    if (st == NULL)
+        return NULL;
+    if (capacity < 1)
+        capacity = 1;
+    st->n = 0;
+    st->capacity = capacity;
+    st->pid = (pid_t *)malloc(capacity * sizeof(pid_t));
+    st->fd = (int *)malloc(capacity * sizeof(int));
+    st->alive = (bool *)malloc(capacity * sizeof(bool));
+    st->state = (char *)malloc(capacity * sizeof(char));
+    st->utime = (unsigned long *)malloc(capacity * sizeof(unsigned long));
+    st->stime = (unsigned long *)malloc(capacity * sizeof(unsigned long));
+    st->rss = (long *)malloc(capacity * sizeof(long));
+    st->comm = malloc(capacity * sizeof(*st->comm));
+    st->buf = (char *)malloc((size_t)capacity * SAMPLE_BUF_SIZE);
+    st->nread = (int *)malloc(capacity * sizeof(int));
+    if (st->pid == NULL || st->fd == NULL || st->alive == NULL ||
+        st->state == NULL || st->utime == NULL || st->stime == NULL ||
+        st->rss == NULL || st->comm == NULL || st->buf == NULL ||
+        st->nread == NULL) {
+        st->ring = NULL;
+        ps_destroy(st);
+        return NULL;
+    }
+    entries = (capacity > MAX_RING_ENTRIES) ? MAX_RING_ENTRIES : capacity;
+    st->ring = ring_create(entries);
+    return st;
+}
+
+/*
+ *	double the capacity of every array in the table; the ring keeps its
+ *	size, since refreshes already proceed a ring-full at a time
+ *
+ *	no read is outstanding between refreshes, so moving buf is safe
+ */
+static bool grow(SampleTable *st) {
+    int capacity = 2 * st->capacity;
+    void *p;
+
+#define GROW(field, size) \
+    if ((p = realloc(st->field, (size_t)capacity * (size))) == NULL) \
+        return false; \
+    st->field = p;
+    GROW(pid, sizeof(pid_t))
+    GROW(fd, sizeof(int))
+    GROW(alive, sizeof(bool))
+    GROW(state, sizeof(char))
+    GROW(utime, sizeof(unsigned long))
+    GROW(stime, sizeof(unsigned long))
+    GROW(rss, sizeof(long))
+    GROW(comm, sizeof(*st->comm))
+    GROW(buf, SAMPLE_BUF_SIZE)
+    GROW(nread, sizeof(int))
+#undef GROW
+    st->capacity = capacity;
+    return true;
+}
+
+bool ps_add(SampleTable *st, pid_t pid) {
+    char path[32];
+    int i;
+
+    if (st->n >= st->capacity && ! grow(st))
+        return false;
+    p1strcpy(path, "/proc/");
+    p1itoa((int)pid, path + p1strlen(path));
+    p1strcat(path, "/stat");
+    if ((i = open(path, O_RDONLY | O_CLOEXEC)) < 0)
+        return false;
+    st->fd[st->n] = i;
+    st->pid[st->n] = pid;
+    st->alive[st->n] = true;
+    st->state[st->n] = '?';
+    st->utime[st->n] = 0UL;
+    st->stime[st->n] = 0UL;
+    st->rss[st->n] = 0L;
+    st->comm[st->n][0] = '\0';
+    st->nread[st->n] = 0;
+    st->n++;
+    return true;
+}
+
+int ps_find(SampleTable *st, pid_t pid) {
+    int i;
+
+    for (i = 0; i < st->n; i++)
+        if (st->pid[i] == pid)
+            return i;
+    return -1;
+}
+
+void ps_remove(SampleTable *st, pid_t pid) {
+    int i = ps_find(st, pid);
+    int last = st->n - 1;
+
+    if (i < 0)
+        return;
+    close(st->fd[i]);
+    if (i != last) {
+        st->pid[i] = st->pid[last];
+        st->fd[i] = st->fd[last];
+        st->alive[i] = st->alive[last];
+        st->state[i] = st->state[last];
+        st->utime[i] = st->utime[last];
+        st->stime[i] = st->stime[last];
+        st->rss[i] = st->rss[last];
+        p1strcpy(st->comm[i], st->comm[last]);
+    }
+    st->n--;
+}
+
+/*
+ *	fetch the unsigned decimal starting at s; returns pointer past it
+ */
+static char *getnum(char *s, unsigned long *v) {
+    unsigned long ans = 0UL;
+
+    if (*s == '-')
+        s++;
+    for (; *s >= '0' && *s <= '9'; s++)
+        ans = 10UL * ans + (unsigned long)(*s - '0');
+    *v = ans;
+    return s;
+}
+
+/*
+ *	parse one stat line into slot i
+ *
+ *	the command name is parenthesized and may itself contain blanks or
+ *	parentheses, so fields are counted from the last ')'
+ */
+static void parse(SampleTable *st, int i) {
+    char *b = st->buf + (size_t)i * SAMPLE_BUF_SIZE;
+    char *p, *rparen = NULL;
+    unsigned long v;
+    int field, j;
+
+    b[st->nread[i]] = '\0';
+    for (p = b; *p != '\0'; p++)
+        if (*p == ')')
+            rparen = p;
+    if (rparen == NULL)
+        return;
+    for (p = b; *p != '\0' && *p != '('; p++)
+        ;
+    for (j = 0, p++; p < rparen && j < SAMPLE_COMM_SIZE - 1; j++)
+        st->comm[i][j] = *p++;
+    st->comm[i][j] = '\0';
+    if (rparen[1] == '\0' || rparen[2] == '\0')
+        return;				/* truncated before the state */
+    p = rparen + 2;			/* field 3, the state */
+    st->state[i] = *p;
+    for (field = 3; *p != '\0' && field < 24; ) {
+        while (*p != ' ' && *p != '\0')
+            p++;
+        if (*p == '\0')
+            break;
+        p++;
+        field++;
+        if (field == 14 || field == 15 || field == 24) {
+            p = getnum(p, &v);
+            if (field == 14)
+                st->utime[i] = v;
+            else if (field == 15)
+                st->stime[i] = v;
+            else
+                st->rss[i] = (long)v;
+        }
+    }
+}
+
+/*
+ *	record the result of a read into slot i
+ */
+static bool complete(SampleTable *st, int i, int res) {
+    if (res <= 0) {
+        st->alive[i] = false;
+        return false;
+    }
+    if (res >= SAMPLE_BUF_SIZE)
+        res = SAMPLE_BUF_SIZE - 1;
+    st->nread[i] = res;
+    parse(st, i);
+    return true;
+}
+
+static int refresh_pread(SampleTable *st) {
+    int i, count = 0;
+
+    for (i = 0; i < st->n; i++) {
+        if (st->alive[i]) {
+            int res = (int)pread(st->fd[i], st->buf + (size_t)i * SAMPLE_BUF_SIZE,
+                                 SAMPLE_BUF_SIZE - 1, 0);
+            if (complete(st, i, res))
+                count++;
+        }
+    }
+    return count;
+}
+
+/*
+ *	submit reads for up to one ring-full of live slots starting at
+ *	*next, then wait for all of them; returns number sampled, or -1 if
+ *	io_uring_enter() fails for a reason other than a signal
+ */
+static int refresh_batch(SampleTable *st, Ring *r, int *next) {
+    unsigned tail = *r->sqTail;
+    unsigned mask = *r->sqMask;
+    unsigned submitted = 0, reaped = 0;
+    int i, count = 0;
+
+    for (i = *next; i < st->n && submitted < r->entries; i++) {
+        struct io_uring_sqe *sqe;
+        unsigned idx;
+
+        if (! st->alive[i])
+            continue;
+        idx = tail & mask;
+        sqe = &r->sqes[idx];
+        {
+            char *z;
+            for (z = (char *)sqe; z < (char *)(sqe + 1); z++)
+                *z = '\0';
+        }
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = st->fd[i];
+        sqe->addr = (unsigned long)(st->buf + (size_t)i * SAMPLE_BUF_SIZE);
+        sqe->len = SAMPLE_BUF_SIZE - 1;
+        sqe->off = 0;
+        sqe->user_data = (unsigned long)i;
+        r->sqArray[idx] = idx;
+        tail++;
+        submitted++;
+    }
+    *next = i;
+    if (submitted == 0)
+        return 0;
+    __atomic_store_n(r->sqTail, tail, __ATOMIC_RELEASE);
+    while (reaped < submitted) {
+        unsigned head, cqTail;
+        unsigned toSubmit = tail - __atomic_load_n(r->sqHead, __ATOMIC_ACQUIRE);
+
+        if (ring_enter(r->fd, toSubmit, submitted - reaped) < 0) {
+            if (errno != EINTR)
+                return -1;
+        }
+        head = *r->cqHead;
+        cqTail = __atomic_load_n(r->cqTail, __ATOMIC_ACQUIRE);
+        for (; head != cqTail; head++) {
+            struct io_uring_cqe *cqe = &r->cqes[head & *r->cqMask];
+            if (complete(st, (int)cqe->user_data, cqe->res))
+                count++;
+            reaped++;
+        }
+        __atomic_store_n(r->cqHead, head, __ATOMIC_RELEASE);
+    }
+    return count;
+}
+
+int ps_refresh(SampleTable *st) {
+    Ring *r = (Ring *)st->ring;
+    int next = 0, count = 0;
+
+    if (r == NULL)
+        return refresh_pread(st);
+    while (next < st->n) {
+        int n = refresh_batch(st, r, &next);
+        if (n < 0) {			/* ring unusable, stop using it */
+            ring_destroy(r);
+            st->ring = NULL;
+            return refresh_pread(st);
+        }
+        count += n;
+    }
+    return count;
+}
+
+void ps_destroy(SampleTable *st) {
+    int i;
+
+    if (st->ring != NULL)
+        ring_destroy((Ring *)st->ring);
+    if (st->fd != NULL)
+        for (i = 0; i < st->n; i++)
+            close(st->fd[i]);
+    free(st->pid);
+    free(st->fd);
+    free(st->alive);
+    free(st->state);
+    free(st->utime);
+    free(st->stime);
+    free(st->rss);
+    free(st->comm);
+    free(st->buf);
+    free(st->nread);
+    free(st);
+}
@@ -0,0 +1,87 @@
+/*
+ *	batched /proc/<pid>/stat sampling for the USPS monitor
+ *
+ *	each tracked pid keeps its stat file open; a refresh submits one
+ *	read per pid as a single io_uring batch and parses the results into
+ *	a struct-of-arrays sample table
+ */
+
+#ifndef _PROCSAMPLE_H_
+#define _PROCSAMPLE_H_
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+#define SAMPLE_BUF_SIZE 512	/* enough for one /proc/<pid>/stat line */
+#define SAMPLE_COMM_SIZE 16	/* matches the kernel's TASK_COMM_LEN */
+
+/*
+ *	sample table - slot i of each array describes the same pid
+ *
+ *	alive[i] is cleared once a read fails (process reaped); the slot
+ *	stays in the table until ps_remove() is called for that pid
+ */
+typedef struct sampletable {
+    int n;				/* number of slots in use */
+    int capacity;
+    pid_t *pid;
+    int *fd;				/* open fd on /proc/<pid>/stat */
+    bool *alive;
+    char *state;
+    unsigned long *utime;		/* clock ticks */
+    unsigned long *stime;		/* clock ticks */
+    long *rss;				/* pages */
+    char (*comm)[SAMPLE_COMM_SIZE];
+    char *buf;				/* capacity * SAMPLE_BUF_SIZE bytes */
+    int *nread;
+    void *ring;				/* io_uring state, NULL if unavailable */
+} SampleTable;
+
+/*
+ *	ps_create - create a sample table initially able to track
+ *	`capacity' pids; ps_add() grows it as needed
+ *
+ *	tries to set up an io_uring for batched refreshes; if the kernel
+ *	does not support it, refreshes fall back to one pread() per pid
+ *
+ *	returns NULL if malloc errors
+ */
+SampleTable *ps_create(int capacity);
+
+/*
+ *	ps_add - start tracking `pid', opening its stat file
+ *
+ *	returns true if successful, false if the table could not be grown
+ *	or the stat file could not be opened
+ */
+bool ps_add(SampleTable *st, pid_t pid);
+
+/*
+ *	ps_remove - stop tracking `pid', closing its stat file
+ *
+ *	the last slot is moved into the vacated one, so indices are not
+ *	stable across calls
+ */
+void ps_remove(SampleTable *st, pid_t pid);
+
+/*
+ *	ps_find - return the slot index for `pid', or -1 if not tracked
+ */
+int ps_find(SampleTable *st, pid_t pid);
+
+/*
+ *	ps_refresh - re-read the stat file of every live pid in the table
+ *
+ *	with io_uring all reads are submitted and reaped with a single
+ *	io_uring_enter() per ring-full of pids
+ *
+ *	returns the number of pids successfully sampled
+ */
+int ps_refresh(SampleTable *st);
+
+/*
+ *	ps_destroy - close all stat files and return the table to the heap
+ */
+void ps_destroy(SampleTable *st);
+
+#endif	/* _PROCSAMPLE_H_ */
@@ -0,0 +1,242 @@
+/*
+ *	priority scheduler with aging for the USPS
+ *
+ *	a promoted job's heap key is LONG_MIN + since, which sorts it ahead
+ *	of every ordinary priority and behind jobs that became runnable
+ *	earlier; the waiter FIFO lets each round find the jobs that are due
+ *	for promotion without scanning the heap
+ *
+ *	why the bound holds: with N jobs runnable, a job is promoted once
+ *	it has waited maxWait - (N-1) rounds, and at most N-1 promoted jobs
+ *	can be ahead of it, each of which takes one round
+ *
+ *	aging is lazy: each period only bumps s->ages, the number of
+ *	halvings so far; a job's priority is brought up to date when it is
+ *	dispatched or promoted, by shifting it right once per halving it
+ *	missed.  an ordinary job's heap key is its priority scaled up to
+ *	s->base, i.e. about priority << (aged - base); the aged priority of
+ *	every job is its key >> (ages - base), so ordering by key orders by
+ *	aged priority.  when a key would overflow, every waiting job is
+ *	brought up to date and base moves up to ages, which happens at most
+ *	once every few dozen periods
+ */
+
+#include "psched.h"
+#include "ADTs/heapprioqueue.h"
+#include "ADTs/arrayqueue.h"
+#include <stdlib.h>
+#include <limits.h>
+
+#define DEFAULT_WAITERS 64
+#define LONG_BITS (8 * (long)sizeof(long))
+
+static int cmp(void *p1, void *p2) {
+    long a = (long)p1;
+    long b = (long)p2;
+
+    return (a < b) ? -1 : (a > b);
+}
+
+static long *slot(void *v) {
+    return &(((SJob *)v)->index);
+}
+
+/*
+ *	apply to j the halvings that it has missed since j->aged
+ */
+static void catchUp(Scheduler *s, SJob *j) {
+    long missed = s->ages - j->aged;
+
+    if (j->priority > 0)
+        j->priority = (missed < LONG_BITS) ? j->priority >> missed : 0L;
+    j->aged = s->ages;
+}
+
+/*
+ *	bring every waiting job up to date, so that keys need no scaling
+ */
+static void rebase(Scheduler *s) {
+    long i, len;
+    void **jobs = s->ready->toArray(s->ready, &len);
+
+    if (jobs == NULL)
+        return;
+    s->base = s->ages;
+    for (i = 0; i < len; i++) {
+        SJob *j = (SJob *)jobs[i];
+        if (! j->urgent) {
+            catchUp(s, j);
+            s->ready->changePriority(s->ready, j, (void *)j->priority);
+        }
+    }
+    free(jobs);
+}
+
+/*
+ *	heap key of an up to date, ordinary job: the last of the keys that
+ *	age to its priority, so that it runs after jobs that have aged to
+ *	the same priority; negative priorities are not aged, so need no
+ *	scaling
+ */
+static long key(Scheduler *s, SJob *j) {
+    long shift = s->ages - s->base;
+
+    if (j->priority < 0 || shift == 0)
+        return j->priority;
+    if (shift >= LONG_BITS - 1 || j->priority >= (LONG_MAX >> shift)) {
+        rebase(s);
+        return j->priority;
+    }
+    return ((j->priority + 1) << shift) - 1;
+}
+
+Scheduler *sc_create(long maxWait, long agePeriod) {
+    Scheduler *s = (Scheduler *)malloc(sizeof(Scheduler));
+
+    if (s == NULL)
+        return NULL;
+    s->ready = TrackedHeapPrioQueue(cmp, doNothing, doNothing, slot);
+    s->waiters = ArrayQueue(DEFAULT_WAITERS, doNothing);
+    if (s->ready == NULL || s->waiters == NULL) {
+        if (s->ready != NULL)
+            s->ready->destroy(s->ready);
+        if (s->waiters != NULL)
+            s->waiters->destroy(s->waiters);
+        free(s);
+        return NULL;
+    }
+    s->round = 0L;
+    s->ages = 0L;
+    s->base = 0L;
+    s->maxWait = maxWait;
+    s->agePeriod = agePeriod;
+    s->njobs = 0L;
+    s->changed = NULL;
+    return s;
+}
+
+void sc_notify(Scheduler *s, void (*changed)(SJob *j)) {
+    s->changed = changed;
+}
+
+/*
+ *	put j in the heap at its current priority and note when it became
+ *	runnable
+ */
+static bool makeRunnable(Scheduler *s, SJob *j) {
+    j->since = s->round;
+    j->urgent = false;
+    j->aged = s->ages;
+    if (s->ready->isEmpty(s->ready))
+        s->base = s->ages;
+    if (! s->ready->insert(s->ready, (void *)key(s, j), j))
+        return false;
+    j->waiting = true;
+    if (s->waiters->enqueue(s->waiters, j))
+        j->queued++;
+    else {			/* cannot be promoted, so no bound */
+        j->urgent = true;
+        s->ready->changePriority(s->ready, j, (void *)(LONG_MIN + j->since));
+    }
+    return true;
+}
+
+SJob *sc_admit(Scheduler *s, void *job, long priority) {
+    SJob *j = (SJob *)malloc(sizeof(SJob));
+
+    if (j == NULL)
+        return NULL;
+    j->job = job;
+    j->priority = priority;
+    j->index = 0L;
+    j->queued = 0;
+    j->waiting = false;
+    j->retired = false;
+    if (! makeRunnable(s, j)) {
+        free(j);
+        return NULL;
+    }
+    s->njobs++;
+    return j;
+}
+
+/*
+ *	promote every job that has waited long enough
+ *
+ *	a waiter entry is stale if its job is not in the heap, or if the
+ *	job has a later entry; stale entries are dropped as they reach the
+ *	front of the FIFO
+ */
+static void promote(Scheduler *s) {
+    long threshold = s->maxWait - (s->ready->size(s->ready) - 1);
+    SJob *j;
+
+    while (s->waiters->front(s->waiters, (void **)&j)) {
+        bool current = (j->waiting && j->queued == 1);
+
+        if (current && s->round - j->since < threshold)
+            break;
+        s->waiters->dequeue(s->waiters, (void **)&j);
+        j->queued--;
+        if (current) {
+            catchUp(s, j);
+            j->urgent = true;
+            s->ready->changePriority(s->ready, j,
+                                     (void *)(LONG_MIN + j->since));
+            if (s->changed != NULL)
+                s->changed(j);
+        } else if (j->retired && j->queued == 0)
+            free(j);
+    }
+}
+
+SJob *sc_next(Scheduler *s, long *waited) {
+    SJob *j;
+    void *prio;
+
+    if (s->agePeriod > 0 && s->round > 0 && s->round % s->agePeriod == 0)
+        s->ages++;
+    promote(s);
+    if (! s->ready->removeMin(s->ready, &prio, (void **)&j))
+        return NULL;
+    if (! j->urgent)
+        catchUp(s, j);
+    j->waiting = false;
+    j->urgent = false;
+    *waited = s->round - j->since;
+    s->round++;
+    return j;
+}
+
+bool sc_requeue(Scheduler *s, SJob *j, long penalty) {
+    j->priority += penalty;
+    return makeRunnable(s, j);
+}
+
+void sc_retire(Scheduler *s, SJob *j) {
+    s->njobs--;
+    if (j->queued == 0)
+        free(j);
+    else
+        j->retired = true;
+}
+
+bool sc_isEmpty(Scheduler *s) {
+    return s->ready->isEmpty(s->ready);
+}
+
+void sc_destroy(Scheduler *s) {
+    SJob *j;
+    void *prio;
+
+    while (s->waiters->dequeue(s->waiters, (void **)&j)) {
+        j->queued--;
+        if (j->retired && j->queued == 0)
+            free(j);
+    }
+    while (s->ready->removeMin(s->ready, &prio, (void **)&j))
+        free(j);
+    s->waiters->destroy(s->waiters);
+    s->ready->destroy(s->ready);
+    free(s);
+}
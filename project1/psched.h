@@ -0,0 +1,107 @@
+/*
+ *	priority scheduler with aging for the USPS
+ *
+ *	jobs are kept in a tracked HeapPrioQueue (lower priority runs first)
+ *	and each dispatch is one round; two mechanisms prevent starvation:
+ *
+ *	- every agePeriod rounds the priority of each waiting job is halved,
+ *	  so that penalties for past CPU use decay; halving is lazy, and
+ *	  costs O(1) a period however many jobs are waiting
+ *	- a job that has waited long enough is promoted in place ahead of
+ *	  all non-promoted jobs; promoted jobs run in the order in which
+ *	  they became runnable
+ *
+ *	for a fixed set of N jobs, no job waits more than max(maxWait, N-1)
+ *	rounds between becoming runnable and being dispatched
+ */
+
+#ifndef _PSCHED_H_
+#define _PSCHED_H_
+
+#include <stdbool.h>
+#include "ADTs/prioqueue.h"
+#include "ADTs/queue.h"
+
+typedef struct sjob {
+    void *job;			/* the caller's job */
+    long priority;		/* lower runs first; aged when dispatched */
+    long aged;			/* halvings applied to priority so far */
+    long since;			/* round in which the job became runnable */
+    long index;			/* heap position, maintained by the heap */
+    int queued;			/* entries in the waiter FIFO */
+    bool waiting;		/* in the heap */
+    bool urgent;		/* promoted to guarantee its wait bound */
+    bool retired;
+} SJob;
+
+typedef struct scheduler {
+    const PrioQueue *ready;
+    const Queue *waiters;	/* runnable jobs in order of `since' */
+    long round;			/* number of dispatches so far */
+    long ages;			/* number of halvings so far */
+    long base;			/* halvings that heap keys are scaled to */
+    long maxWait;
+    long agePeriod;		/* 0 disables aging */
+    long njobs;			/* admitted and not yet retired */
+    void (*changed)(SJob *j);	/* see sc_notify(), or NULL */
+} Scheduler;
+
+/*
+ *	sc_create - create a scheduler that bounds waits at maxWait rounds
+ *	and halves waiting priorities every agePeriod rounds
+ *
+ *	returns NULL if malloc errors
+ */
+Scheduler *sc_create(long maxWait, long agePeriod);
+
+/*
+ *	sc_notify - have `changed' called on each waiting job that is
+ *	promoted to guarantee its wait bound
+ *
+ *	aging is not reported, as it is applied lazily: a waiting job's
+ *	priority field is the one it was made runnable at, and is brought
+ *	up to date when it is dispatched or promoted
+ */
+void sc_notify(Scheduler *s, void (*changed)(SJob *j));
+
+/*
+ *	sc_admit - make `job' runnable at `priority'
+ *
+ *	returns the job's scheduler handle, or NULL if malloc errors
+ */
+SJob *sc_admit(Scheduler *s, void *job, long priority);
+
+/*
+ *	sc_next - dispatch the job that should run next, starting a round
+ *
+ *	the number of rounds the job waited is returned in *waited
+ *
+ *	returns NULL if no job is runnable
+ */
+SJob *sc_next(Scheduler *s, long *waited);
+
+/*
+ *	sc_requeue - make a dispatched job runnable again, adding `penalty'
+ *	to its priority for the CPU it has just used
+ *
+ *	returns true if successful, false if malloc errors
+ */
+bool sc_requeue(Scheduler *s, SJob *j, long penalty);
+
+/*
+ *	sc_retire - a dispatched job has finished; its handle is released
+ */
+void sc_retire(Scheduler *s, SJob *j);
+
+/*
+ *	sc_isEmpty - returns true if no job is runnable
+ */
+bool sc_isEmpty(Scheduler *s);
+
+/*
+ *	sc_destroy - release the scheduler and every handle it holds;
+ *	the caller's jobs are untouched
+ */
+void sc_destroy(Scheduler *s);
+
+#endif	/* _PSCHED_H_ */
@@ -9,8 +9,6 @@
 #define UNUSED __attribute__((unused))
 #define MAX_PROCESSES 256
 #define MAX_LINE_SIZE 2048
-#define MAX_ARGS 64
-#define MAX_WORD_SIZE 128
 
 int main(UNUSED int argc, UNUSED char** argv) {
 	/* Set up and read through first line, determine if q is given and if a file is given and act accordingly*/
@@ -59,28 +57,11 @@ After establishing environment variables and input types being parsing line by l
 
 */
 	int len, num_args, status;
-	int pos = 0;
 	int process_count = 0;
 
 	UNUSED pid_t pids[MAX_PROCESSES];
 	pid_t pid;
 
-/*	Allocate space for arguments */
-	char** arguments = (char**)malloc(MAX_ARGS * sizeof(char*));
-
-	if(arguments == NULL){
-		p1perror(2, "Error allocating space for arguments");
-		return EXIT_FAILURE;
-	}
-
-	for(int i = 0; i < MAX_ARGS; i++){
-		arguments[i] = malloc(MAX_WORD_SIZE * sizeof(char));
-		if(arguments[i] == NULL){
-			p1perror(2, "Error allocating space for arguments");
-			return EXIT_FAILURE;
-		}
-	}
-
 	char* line = (char*)malloc(MAX_LINE_SIZE * sizeof(char));
 
 	if(line == NULL){
@@ -95,11 +76,15 @@ After establishing environment variables and input types being parsing line by l
 		int len = p1strlen(line);
 		if(line[len-1] == '\n'){line[len-1] = '\0';}
 
-		pos = p1getword(line, 0, arguments[num_args]);
-		num_args += 1;
+		char** arguments = p1argv(line, &num_args);
 
-		while((pos = p1getword(line, pos, arguments[num_args]))> -1 && (num_args < MAX_ARGS)){ 
-			num_args+= 1;
+		if(arguments == NULL){
+			p1perror(2, "Error allocating space for arguments");
+			return EXIT_FAILURE;
+		}
+		if(num_args == 0){
+			free(arguments);
+			continue;
 		}
 
 		pid = fork();
@@ -108,13 +93,12 @@ After establishing environment variables and input types being parsing line by l
 			return EXIT_FAILURE;
 		}
 		else if(pid == 0){
-			free(arguments[num_args]);
-			arguments[num_args] = NULL;
 			execvp(arguments[0], arguments);
 			p1perror(2, "Error with child process");
 			return EXIT_FAILURE;
 		}
 		else{
+			free(arguments);
 			pids[process_count] = pid;    /* Add new child to list of children */
 			process_count++;
 		}
@@ -123,10 +107,6 @@ After establishing environment variables and input types being parsing line by l
 	/* Clean up memory and close file*/
 	close(fd);
 	free(line);
-	for(int i = 0; i < MAX_ARGS; i++){
-		free(arguments[i]);
-	}
-	free(arguments);
 
 	/*Wait for all children to finish*/
 	for(int i = 0; i < process_count; i++){
@@ -11,8 +11,6 @@
 #define UNUSED __attribute__((unused))
 #define MAX_PROCESSES 128
 #define MAX_LINE_SIZE 4096
-#define MAX_ARGS 64
-#define MAX_WORD_SIZE 64
 
 typedef struct ChildProcess{
 	pid_t pid;
@@ -74,28 +72,11 @@ After establishing environment variables and input types being parsing line by l
 
 */
 	int len, num_args, status;
-	int pos = 0;
 	int process_count = 0;
 
 	ChildProcess Child_Processes[MAX_PROCESSES];
 	pid_t pid;
 
-/*	Allocate space for arguments */
-	char** arguments = (char**)malloc(MAX_ARGS * sizeof(char*));
-
-	if(arguments == NULL){
-		p1perror(2, "Error allocating space for arguments");
-		return EXIT_FAILURE;
-	}
-
-	for(int i = 0; i < MAX_ARGS; i++){
-		arguments[i] = malloc(MAX_WORD_SIZE * sizeof(char));
-		if(arguments[i] == NULL){
-			p1perror(2, "Error allocating space for arguments");
-			return EXIT_FAILURE;
-		}
-	}
-
 	char* line = (char*)malloc(MAX_LINE_SIZE * sizeof(char));
 
 	if(line == NULL){
@@ -110,11 +91,15 @@ After establishing environment variables and input types being parsing line by l
 		int len = p1strlen(line);
 		if(line[len-1] == '\n'){line[len-1] = '\0';}
 
-		pos = p1getword(line, 0, arguments[num_args]);
-		num_args += 1;
+		char** arguments = p1argv(line, &num_args);
 
-		while((pos = p1getword(line, pos, arguments[num_args]))> -1 && (num_args < MAX_ARGS)){ 
-			num_args+= 1;
+		if(arguments == NULL){
+			p1perror(2, "Error allocating space for arguments");
+			return EXIT_FAILURE;
+		}
+		if(num_args == 0){
+			free(arguments);
+			continue;
 		}
 
 
@@ -125,9 +110,6 @@ After establishing environment variables and input types being parsing line by l
 			return EXIT_FAILURE;
 		}
 		else if(pid == 0){
-			free(arguments[num_args]);
-			arguments[num_args] = NULL;
-			
 			signal(SIGUSR1, signal_handler); /* Set up signal handler for SIG_START */
 			
 			while(not_ready){} /* Wait for parent to finish parsing */
@@ -136,6 +118,7 @@ After establishing environment variables and input types being parsing line by l
 			return EXIT_FAILURE;
 		}
 		else if(pid > 0){
+			free(arguments);
 			Child_Processes[process_count].pid = pid;
 			process_count += 1;
 		}
@@ -173,10 +156,6 @@ After establishing environment variables and input types being parsing line by l
 	}
 
 	free(line);
-	for(int i = 0; i < MAX_ARGS; i++){
-		free(arguments[i]);
-	}
-	free(arguments);
 
 	return 0;
 }
@@ -1,5 +1,7 @@
 #include "p1fxns.h"
+#include "journal.h"
 #include "ADTs/arrayqueue.h"
+#include "ADTs/heapprioqueue.h"
 #include <unistd.h>
 #include <stdlib.h>
 #include <fcntl.h>
@@ -7,19 +9,22 @@
 #include <sys/time.h>
 #include <signal.h>
 #include <time.h>
+#include <limits.h>
 
 
 #define UNUSED __attribute__((unused))
 #define MAX_PROCESSES 128
 #define MAX_LINE_SIZE 4096
-#define MAX_ARGS 64
-#define MAX_WORD_SIZE 64
 
 typedef struct ChildProcess{
 	pid_t pid;
     float totalCPUTime;
+	float baseCPUTime;	/* CPU used before a restart */
 	bool running;
 	bool finished;
+	int job;		/* index of the command line in the batch */
+	unsigned long hash;
+	long order;		/* admission order, kept in the journal */
 } ChildProcess;
 
 struct itimerval timer;
@@ -29,6 +34,8 @@ volatile pid_t current_pid = -1;
 int QUANT_SECONDS = -1;
 float timeRuning = 0.0;
 const Queue *queue;
+Journal *journal = NULL;
+long admissions = 0;
 
 
 /* Signal handler for SIGALARM */
@@ -36,6 +43,12 @@ void alarm_handler(UNUSED int sig);
 
 void sigchld_handler(UNUSED int sig);
 
+/* Record a job's new state in the journal, if one is being kept */
+void journal_job(ChildProcess* child, int state);
+
+/* Order jobs by the admission order of the previous run */
+int admit_cmp(void* p1, void* p2);
+
 void start_handler(UNUSED int sig);
 
 int main(UNUSED int argc, UNUSED char** argv) {
@@ -46,12 +59,20 @@ int main(UNUSED int argc, UNUSED char** argv) {
 	char* filename = NULL;
 	char* QUANT_ENV;
 	
-	while ((opt = getopt(argc, argv, "q:")) != -1) {
+	while ((opt = getopt(argc, argv, "q:j:")) != -1) {
 		switch (opt) {
 		case 'q':
 			QUANT_SECONDS = p1atoi(optarg);
 			break;
 
+		case 'j':
+			journal = jn_open(optarg);
+			if(journal == NULL){
+				p1perror(2, "Error opening journal");
+				return EXIT_FAILURE;
+			}
+			break;
+
 		default:
 		;
 		}
@@ -89,26 +110,9 @@ After establishing environment variables and input types being parsing line by l
 
 */
 	int len, num_args;
-	int pos = 0;
 	pid_t pid;
 	queue = ArrayQueue(MAX_PROCESSES, free);
 
-/*	Allocate space for arguments */
-	char** arguments = (char**)malloc(MAX_ARGS * sizeof(char*));
-
-	if(arguments == NULL){
-		p1perror(2, "Error allocating space for arguments");
-		return EXIT_FAILURE;
-	}
-
-	for(int i = 0; i < MAX_ARGS; i++){
-		arguments[i] = malloc(MAX_WORD_SIZE * sizeof(char));
-		if(arguments[i] == NULL){
-			p1perror(2, "Error allocating space for arguments");
-			return EXIT_FAILURE;
-		}
-	}
-
 	char* line = (char*)malloc(MAX_LINE_SIZE * sizeof(char));
 
 	if(line == NULL){
@@ -126,17 +130,40 @@ After establishing environment variables and input types being parsing line by l
 	signal(SIGALRM, alarm_handler);
 	signal(SIGCHLD, sigchld_handler);
 
+	/* Jobs are admitted through a heap so a restart resumes the previous order */
+	const PrioQueue* admit = HeapPrioQueue(admit_cmp, doNothing, doNothing);
+	int job = -1;
+	JRecord rec;
+
+	if(admit == NULL){
+		p1perror(2, "Error allocating admission queue");
+		return EXIT_FAILURE;
+	}
+
 /* Process line by line, either from file or stdin */
 	while((len = p1getline(fd, line, MAX_LINE_SIZE)) != 0){
 		num_args = 0;
 		int len = p1strlen(line);
 		if(line[len-1] == '\n'){line[len-1] = '\0';}
 
-		pos = p1getword(line, 0, arguments[num_args]);
-		num_args += 1;
+		char** arguments = p1argv(line, &num_args);
 
-		while((pos = p1getword(line, pos, arguments[num_args]))> -1 && (num_args < MAX_ARGS)){ 
-			num_args+= 1;
+		if(arguments == NULL){
+			p1perror(2, "Error allocating space for arguments");
+			return EXIT_FAILURE;
+		}
+		if(num_args == 0){
+			free(arguments);
+			continue;
+		}
+
+		/* Skip jobs that completed before a restart */
+		job++;
+		unsigned long hash = jn_hash(line);
+		bool resumed = (journal != NULL && jn_lookup(journal, job, hash, &rec));
+		if(resumed && rec.state == JOB_DONE){
+			free(arguments);
+			continue;
 		}
 
 		pid = fork();
@@ -146,9 +173,6 @@ After establishing environment variables and input types being parsing line by l
 			return EXIT_FAILURE;
 		}
 		else if(pid == 0){
-			free(arguments[num_args]);
-			arguments[num_args] = NULL;
-
 			raise(SIGSTOP);
 			execvp(arguments[0], arguments);
 
@@ -156,21 +180,35 @@ After establishing environment variables and input types being parsing line by l
 			return EXIT_FAILURE;
 		}
 		else{
+			free(arguments);
 			ChildProcess* child = malloc(sizeof(ChildProcess));
 			child->pid = pid;
-			child->totalCPUTime = 0;
+			child->baseCPUTime = resumed ? (float)rec.cpu : 0;
+			child->totalCPUTime = child->baseCPUTime;
 			child->finished = false;
 			child->running = false;
-			queue->enqueue(queue, child);
+			child->job = job;
+			child->hash = hash;
+			admit->insert(admit, (void*)(resumed ? rec.order : LONG_MAX), child);
 		}
 	}
 
 	/* Close file*/
 	close(fd);
+
+	/* Resumed jobs keep their prior order, jobs new to the journal follow in file order */
+	ChildProcess* next = NULL;
+	void* prio = NULL;
+	while(admit->removeMin(admit, &prio, (void**)&next)){
+		journal_job(next, JOB_PENDING);
+		queue->enqueue(queue, next);
+	}
+	admit->destroy(admit);
 	while(!queue->isEmpty(queue)){
 		/*Start next process, reset global flags and timer*/
 		ChildProcess* child = NULL;
 		queue->dequeue(queue, (void**)&child);
+		journal_job(child, JOB_RUNNING);
 		kill(child->pid, SIGCONT);
 		childRunning = true;
 		timeLeft = true;
@@ -187,25 +225,43 @@ After establishing environment variables and input types being parsing line by l
 		if(pid == 0){
 			kill(child->pid, SIGSTOP);
 			child->totalCPUTime += QUANT_SECONDS/1000;
+			journal_job(child, JOB_PENDING);
 			queue->enqueue(queue, child);
 		}
 		else{
 			child->finished = true;
+			journal_job(child, JOB_DONE);
 			free(child);
 		}
 	}
 
 	/* Clean up*/
 	queue->destroy(queue);
-	free(line);
-	for(int i = 0; i < MAX_ARGS; i++){
-		free(arguments[i]);
+	if(journal != NULL){
+		jn_close(journal, true);
 	}
-	free(arguments);
+	free(line);
 	return 0;
 }
 
 
+/* Record a job's new state in the journal, if one is being kept */
+void journal_job(ChildProcess* child, int state){
+	if(state == JOB_PENDING){
+		child->order = admissions++;
+	}
+	if(journal != NULL){
+		jn_update(journal, child->job, child->hash, state, child->order, 0, child->totalCPUTime);
+	}
+}
+
+/* Order jobs by the admission order of the previous run */
+int admit_cmp(void* p1, void* p2){
+	long a = (long)p1;
+	long b = (long)p2;
+	return (a < b) ? -1 : (a > b);
+}
+
 /* Signal handler for SIGALARM */
 void alarm_handler(UNUSED int sig){
 	timeRuning += QUANT_SECONDS/1000;
@@ -1,5 +1,8 @@
 #include "p1fxns.h"
-#include "ADTs/arrayqueue.h"
+#include "procsample.h"
+#include "journal.h"
+#include "psched.h"
+#include "ADTs/heapprioqueue.h"
 #include <unistd.h>
 #include <stdlib.h>
 #include <fcntl.h>
@@ -7,20 +10,27 @@
 #include <sys/time.h>
 #include <signal.h>
 #include <time.h>
+#include <limits.h>
 #include <stdio.h>
 
 
 #define UNUSED __attribute__((unused))
 #define MAX_PROCESSES 128
+#define AGE_PERIOD 16	/* rounds between halvings of waiting priorities */
 #define MAX_LINE_SIZE 4096
-#define MAX_ARGS 64
-#define MAX_WORD_SIZE 64
 
 typedef struct ChildProcess{
 	pid_t pid;
     float totalCPUTime;
+	float baseCPUTime;	/* CPU used before a restart */
 	bool running;
 	bool finished;
+	int job;		/* index of the command line in the batch */
+	unsigned long hash;
+	long order;		/* admission order, kept in the journal */
+	long resumePriority;	/* scheduler priority to admit the job at */
+	SJob* sjob;		/* scheduler handle */
+	unsigned long lastTicks;	/* CPU ticks when last dispatched */
 } ChildProcess;
 
 struct itimerval timer;
@@ -30,7 +40,12 @@ volatile pid_t current_pid = -1;
 int QUANT_SECONDS = -1;
 int timeRuning = 0;
 long numProcesses = 0;
-const Queue *queue;
+long clockTicks = 100;
+Scheduler *sched;
+long MAX_WAIT = MAX_PROCESSES;
+Journal *journal = NULL;
+long admissions = 0;
+SampleTable *samples;
 
 
 /* Signal handler for SIGALARM */
@@ -38,6 +53,18 @@ void alarm_handler(UNUSED int sig);
 
 void sigchld_handler(UNUSED int sig);
 
+/* Record a job's new state in the journal, if one is being kept */
+void journal_job(ChildProcess* child, int state);
+
+/* Record a waiting job's aged or promoted priority in the journal */
+void journal_priority(SJob* sjob);
+
+/* Order jobs by the admission order of the previous run */
+int admit_cmp(void* p1, void* p2);
+
+/* Display the most recent sample of every child */
+void print_samples(pid_t current);
+
 int main(UNUSED int argc, UNUSED char** argv) {
 
 	/* Set up and read through first line, determine if q is given and if a file is given and act accordingly*/
@@ -46,12 +73,24 @@ int main(UNUSED int argc, UNUSED char** argv) {
 	char* filename = NULL;
 	char* QUANT_ENV;
 	
-	while ((opt = getopt(argc, argv, "q:")) != -1) {
+	while ((opt = getopt(argc, argv, "q:j:w:")) != -1) {
 		switch (opt) {
 		case 'q':
 			QUANT_SECONDS = p1atoi(optarg);
 			break;
 
+		case 'w':
+			MAX_WAIT = p1atoi(optarg);
+			break;
+
+		case 'j':
+			journal = jn_open(optarg);
+			if(journal == NULL){
+				p1perror(2, "Error opening journal");
+				return EXIT_FAILURE;
+			}
+			break;
+
 		default:
 		;
 		}
@@ -89,28 +128,21 @@ After establishing environment variables and input types being parsing line by l
 
 */
 	int len, num_args;
-	int pos = 0;
 	pid_t pid;
-	pid_t pid_list[MAX_PROCESSES];
-	queue = ArrayQueue(MAX_PROCESSES, free);
-	char stats[256], fileLine[1024];
-	
-	
-
-/*	Allocate space for arguments */
-	char** arguments = (char**)malloc(MAX_ARGS * sizeof(char*));
+	sched = sc_create(MAX_WAIT, AGE_PERIOD);
+	samples = ps_create(MAX_PROCESSES);
 
-	if(arguments == NULL){
-		p1perror(2, "Error allocating space for arguments");
+	if(sched == NULL){
+		p1perror(2, "Error allocating scheduler");
 		return EXIT_FAILURE;
 	}
+	if(journal != NULL){
+		sc_notify(sched, journal_priority);
+	}
 
-	for(int i = 0; i < MAX_ARGS; i++){
-		arguments[i] = malloc(MAX_WORD_SIZE * sizeof(char));
-		if(arguments[i] == NULL){
-			p1perror(2, "Error allocating space for arguments");
-			return EXIT_FAILURE;
-		}
+	if(samples == NULL){
+		p1perror(2, "Error allocating sample table");
+		return EXIT_FAILURE;
 	}
 
 	char* line = (char*)malloc(MAX_LINE_SIZE * sizeof(char));
@@ -121,6 +153,8 @@ After establishing environment variables and input types being parsing line by l
 	}
 
 
+	clockTicks = sysconf(_SC_CLK_TCK);
+
 	/* Set up timer */
 	timer.it_value.tv_sec = QUANT_SECONDS / 1000;
 	timer.it_value.tv_usec = QUANT_SECONDS * 1000;
@@ -131,17 +165,40 @@ After establishing environment variables and input types being parsing line by l
 	signal(SIGALRM, alarm_handler);
 	signal(SIGCHLD, sigchld_handler);
 
+	/* Jobs are admitted through a heap so a restart resumes the previous order */
+	const PrioQueue* admit = HeapPrioQueue(admit_cmp, doNothing, doNothing);
+	int job = -1;
+	JRecord rec;
+
+	if(admit == NULL){
+		p1perror(2, "Error allocating admission queue");
+		return EXIT_FAILURE;
+	}
+
 /* Process line by line, either from file or stdin */
 	while((len = p1getline(fd, line, MAX_LINE_SIZE)) != 0){
 		num_args = 0;
 		int len = p1strlen(line);
 		if(line[len-1] == '\n'){line[len-1] = '\0';}
 
-		pos = p1getword(line, 0, arguments[num_args]);
-		num_args += 1;
+		char** arguments = p1argv(line, &num_args);
+
+		if(arguments == NULL){
+			p1perror(2, "Error allocating space for arguments");
+			return EXIT_FAILURE;
+		}
+		if(num_args == 0){
+			free(arguments);
+			continue;
+		}
 
-		while((pos = p1getword(line, pos, arguments[num_args]))> -1 && (num_args < MAX_ARGS)){ 
-			num_args+= 1;
+		/* Skip jobs that completed before a restart */
+		job++;
+		unsigned long hash = jn_hash(line);
+		bool resumed = (journal != NULL && jn_lookup(journal, job, hash, &rec));
+		if(resumed && rec.state == JOB_DONE){
+			free(arguments);
+			continue;
 		}
 
 		pid = fork();
@@ -151,9 +208,6 @@ After establishing environment variables and input types being parsing line by l
 			return EXIT_FAILURE;
 		}
 		else if(pid == 0){
-			free(arguments[num_args]);
-			arguments[num_args] = NULL;
-
 			raise(SIGSTOP);
 			
 			execvp(arguments[0], arguments);
@@ -162,140 +216,152 @@ After establishing environment variables and input types being parsing line by l
 			return EXIT_FAILURE;
 		}
 		else{
+			free(arguments);
 			ChildProcess* child = malloc(sizeof(ChildProcess));
 			child->pid = pid;
-			child->totalCPUTime = 0;
+			child->baseCPUTime = resumed ? (float)rec.cpu : 0;
+			child->totalCPUTime = child->baseCPUTime;
 			child->finished = false;
 			child->running = false;
-			queue->enqueue(queue, child);
-			pid_list[numProcesses] = pid;
+			child->job = job;
+			child->hash = hash;
+			child->resumePriority = resumed ? rec.priority : 0;
+			admit->insert(admit, (void*)(resumed ? rec.order : LONG_MAX), child);
+			if(!ps_add(samples, pid)){
+				p1perror(2, "Error adding job to sample table");
+				return EXIT_FAILURE;
+			}
 			numProcesses++;
 		}
 	}
 
 	/* Close file*/
 	close(fd);
-	char* path = "/proc/";
-	char** table = (char**)malloc(8 * sizeof(char*));
-	for(int i = 0; i < numProcesses; i++){
-		table[i] = (char*)malloc(MAX_LINE_SIZE * sizeof(char));
-	}
 
-	char* header = "PID\t\tCommand\t\tUtime\t\t\tMemory\t\t\tRunning\n";
-	char* line2 = "Number of processes: ";
-	char pidStr[10];
+	/* Resumed jobs keep their prior order and priority, jobs new to the journal follow in file order */
+	ChildProcess* next = NULL;
+	void* prio = NULL;
+	while(admit->removeMin(admit, &prio, (void**)&next)){
+		next->lastTicks = 0;
+		next->sjob = sc_admit(sched, next, next->resumePriority);
+		if(next->sjob == NULL){
+			p1perror(2, "Error admitting job");
+			return EXIT_FAILURE;
+		}
+		journal_job(next, JOB_PENDING);
+	}
+	admit->destroy(admit);
 
-	table[0] = header;
-	while(!queue->isEmpty(queue)){
+	while(!sc_isEmpty(sched)){
 		/*Start next process, reset global flags and timer*/
-		ChildProcess* child = NULL;
-		queue->dequeue(queue, (void**)&child);
+		long waited;
+		ChildProcess* child = (ChildProcess*)sc_next(sched, &waited)->job;
+		journal_job(child, JOB_RUNNING);
 		kill(child->pid, SIGCONT);
 		childRunning = true;
 		timeLeft = true;
 		setitimer(ITIMER_REAL, &timer, NULL);
 
-		/*In version 4 there will be work occuring within the loop but here I just left it empty because nothing was specified to be done*/
 		while(childRunning && timeLeft){
-			if(timeRuning %  2000 != 0){
-			p1itoa(timeRuning, pidStr);
-			p1strcat(line2, pidStr);
-			p1strcat(line2, "\t\t\t");
-			p1strcat(line2, "Current process: ");
-			p1itoa(child->pid, pidStr);
-			p1strcat(line2, pidStr);
-			p1strcat(line2, "\t\t\t");
-			p1strcat(line2, "Time Running: ");
-			p1itoa(timeRuning, pidStr);
-			p1strcat(line2, pidStr);
-			p1strcat(line2, "\t\t\t");
-			table[1] = line2;
-
-			for(int i = 0; i < 6; i++){
-				if(pid_list[i] != -1){
-					p1itoa(pid_list[i], pidStr);
-					p1strcat(path, pidStr);
-					p1strcat(path, "/stat");
-
-					fd = open(path, O_RDONLY);
-
-					if(fd == -1){
-						p1perror(2, "Error opening file");
-						return EXIT_FAILURE;
-					}
-					p1getline(fd, fileLine, MAX_LINE_SIZE);
-					int pos = 0;
-					int indCount = 0;
-					p1getword(fileLine, pos, stats);
-					indCount++;
-					p1strcat(table[i+2], stats);
-					p1strcat(table[i+2], "\t\t");
-					while(indCount < 14){
-						p1getword(fileLine, pos, stats);
-						indCount++;
-					}
-					p1getword(fileLine, pos, stats);
-					p1strcat(table[i+2], stats);
-					p1strcat(table[i+2], "\t\t");
-					
-					while(indCount < 22){
-						p1getword(fileLine, pos, stats);
-						indCount++;
-					}
-					p1getword(fileLine, pos, stats);
-					p1strcat(table[i+2], stats);
-					p1strcat(table[i+2], "\t\t");
-					close(fd);
-					for(int i = 0; i < numProcesses; i++){
-						if(pid_list[i] != -1){
-							p1strcat(table[i+2], "Yes");
-						}
-						else{
-							p1strcat(table[i+2], "No");
-						}
-
-					}
-				}
-			}
-			}
-			else{
-				for(int i = 0; i < 12; i++){
-					p1putstr(1, table[i]);
-					p1putchr(1, '\n');
-				}
-			}
+			pause();
+		}
 
+		/* Sample every child in one batch and account its CPU time */
+		ps_refresh(samples);
+		unsigned long ticks = child->lastTicks;
+		int i = ps_find(samples, child->pid);
+		if(i >= 0){
+			ticks = samples->utime[i] + samples->stime[i];
+			child->totalCPUTime = child->baseCPUTime + (float)ticks / clockTicks;
 		}
+		print_samples(child->pid);
 
 		int status;
 		pid_t pid = waitpid(child->pid, &status, WNOHANG);
 
 		if(pid == 0){
 			kill(child->pid, SIGSTOP);
-			queue->enqueue(queue, child);
+			/* Penalize the job by the CPU it used in this quantum */
+			sc_requeue(sched, child->sjob, (long)(ticks - child->lastTicks));
+			child->lastTicks = ticks;
+			journal_job(child, JOB_PENDING);
 		}
 		else{
-			for(int i = 0; i < numProcesses; i++){
-				if(pid_list[i] == child->pid){
-					pid_list[i] = -1;
-					break;
-				}
-			}
+			journal_job(child, JOB_DONE);
+			sc_retire(sched, child->sjob);
+			ps_remove(samples, child->pid);
 			numProcesses--;
 			free(child);
 		}
 	}
 
 	/* Clean up*/
-	queue->destroy(queue);
-	free(line);
-	for(int i = 0; i < MAX_ARGS; i++){
-		free(arguments[i]);
+	sc_destroy(sched);
+	if(journal != NULL){
+		jn_close(journal, true);
 	}
-	free(arguments);
+	ps_destroy(samples);
+	free(line);
 	return 0;
 }
 
+/* Display the most recent sample of every child */
+void print_samples(pid_t current){
+	char num[25];
+
+	p1putstr(1, "Processes: ");
+	p1putint(1, (int)numProcesses);
+	p1putstr(1, "\tCurrent: ");
+	p1putint(1, (int)current);
+	p1putstr(1, "\tTime Running: ");
+	p1putint(1, timeRuning);
+	p1putstr(1, "\nPID\tCommand\t\tState\tUtime\tStime\tRSS\n");
+	for(int i = 0; i < samples->n; i++){
+		p1itoa((int)samples->pid[i], num);
+		p1putstr(1, num);
+		p1putchr(1, '\t');
+		p1putstr(1, samples->comm[i]);
+		p1putstr(1, "\t\t");
+		p1putchr(1, samples->alive[i] ? samples->state[i] : 'Z');
+		p1putchr(1, '\t');
+		p1itoa((int)samples->utime[i], num);
+		p1putstr(1, num);
+		p1putchr(1, '\t');
+		p1itoa((int)samples->stime[i], num);
+		p1putstr(1, num);
+		p1putchr(1, '\t');
+		p1itoa((int)samples->rss[i], num);
+		p1putstr(1, num);
+		p1putchr(1, '\n');
+	}
+}
+
+/* Record a job's new state in the journal, if one is being kept */
+void journal_job(ChildProcess* child, int state){
+	if(state == JOB_PENDING){
+		child->order = admissions++;
+	}
+	if(journal != NULL){
+		jn_update(journal, child->job, child->hash, state, child->order,
+		          child->sjob->priority, child->totalCPUTime);
+	}
+}
+
+/* A promoted job is journaled at priority 0, so it resumes near the front */
+void journal_priority(SJob* sjob){
+	ChildProcess* child = (ChildProcess*)sjob->job;
+
+	jn_update(journal, child->job, child->hash, JOB_PENDING, child->order,
+	          sjob->urgent ? 0 : sjob->priority, child->totalCPUTime);
+}
+
+/* Order jobs by the admission order of the previous run */
+int admit_cmp(void* p1, void* p2){
+	long a = (long)p1;
+	long b = (long)p2;
+	return (a < b) ? -1 : (a > b);
+}
+
 /* Signal handler for SIGALARM */
 void alarm_handler(UNUSED int sig){
 	timeRuning += QUANT_SECONDS;